@@ -46,28 +46,48 @@ static inline uint8_t wirerecv(TwoWire *theWire) {
 #endif
 }
 
+#if MCP23017_FAULT_INJECTION
+/*!
+ * Error counter for fault injection (shared by all chips)
+ */
+uint8_t mcp23017::_faults = 0;
+#endif
+
 /*!
  * Initializes the MCP23017 given its HW selected address, see datasheet for
  * Address selection.
+ * The register shadow is set to the power on reset values.
  * @param addr configurable part of the address (0x20)
  * @param theWire the I2C object to use, defaults to &Wire
  * @return Returns the 0 on success, else errorcode
  */
 uint8_t mcp23017::begin(uint8_t addr, TwoWire *theWire) {
   uint8_t error;
+  uint8_t i;
   if (addr > 7) {
     addr = 7;
   }
   i2caddr = addr;
   _wire = theWire;
+  _errors = 0;
+  _lastError = MCP23017_OK;
+  // power on reset values: IODIR = 0xff, all other registers 0x00
+  for (i = 0; i < MCP23017_REGS; i++) {
+    _shadow[i] = 0x00;
+  }
+  _shadow[MCP23017_IODIRA] = 0xff;
+  _shadow[MCP23017_IODIRB] = 0xff;
   _wire->begin();
+#ifdef WIRE_HAS_TIMEOUT
+  _wire->setWireTimeout(MCP23017_TIMEOUT_US, true);
+#endif
   // test if device is present
   _wire->beginTransmission(MCP23017_ADDRESS | i2caddr);
-  error = _wire->endTransmission();
+  error = countError(_wire->endTransmission());
   if (error==0){
     // set port A and B to input
     writeRegister(MCP23017_IODIRA, 0xff);
-    writeRegister(MCP23017_IODIRB, 0xff);
+    error = writeRegister(MCP23017_IODIRB, 0xff);
   }
   return (error);
 }
@@ -84,82 +104,186 @@ uint8_t mcp23017::begin(TwoWire *theWire) {
   }
 
 
+/*!
+ * Counts an error of this chip
+ * @param error result of a transfer
+ * @return Returns error
+ */
+uint8_t mcp23017::countError(uint8_t error) {
+  if (error != MCP23017_OK) {
+    _lastError = error;
+    if (_errors < 0xffff) {
+      _errors++;
+    }
+  }
+  return (error);
+}
+
+
+/*!
+ * Reads consecutive registers in one transaction. All reads end here.
+ * @param reg first register to be read
+ * @param buf buffer for the register values
+ * @param num number of registers to be read (max. 22)
+ * @return Returns 0 on success, else errorcode
+ */
+uint8_t mcp23017::readBytes(uint8_t reg, uint8_t *buf, uint8_t num) {
+  uint8_t error;
+  uint8_t i;
+#if MCP23017_FAULT_INJECTION
+  if (_faults) {
+    _faults--;
+    return (countError(MCP23017_ERR_TIMEOUT));
+  }
+#endif
+  _wire->beginTransmission(MCP23017_ADDRESS | i2caddr);
+  wiresend(reg, _wire);
+  error = _wire->endTransmission();
+  if (error != 0) {
+    return (countError(error));
+  }
+  // get response: 
+  if (_wire->requestFrom(MCP23017_ADDRESS | i2caddr, (int)num) != num) {
+    // flush partial response
+    while (_wire->available()) {
+      wirerecv(_wire);
+    }
+    return (countError(MCP23017_ERR_SHORT));
+  }
+  for (i = 0; i < num; i++) {
+    buf[i] = wirerecv(_wire);
+  }
+  return (MCP23017_OK);
+}
+
+
+/*!
+ * Writes consecutive registers in one transaction and updates the
+ * register shadow. All writes end here.
+ * Values written to GPIO are stored in the OLAT shadow as well.
+ * @param reg first register to be written
+ * @param buf register values
+ * @param num number of registers to be written (max. 22)
+ * @return Returns 0 on success, else errorcode
+ */
+uint8_t mcp23017::writeBytes(uint8_t reg, const uint8_t *buf, uint8_t num) {
+  uint8_t i;
+  // shadow holds the wanted state, even if the write fails
+  for (i = 0; (i < num) && (reg + i < MCP23017_REGS); i++) {
+    _shadow[reg + i] = buf[i];
+    if ((reg + i == MCP23017_GPIOA) || (reg + i == MCP23017_GPIOB)) {
+      _shadow[reg + i + 2] = buf[i];
+    }
+  }
+#if MCP23017_FAULT_INJECTION
+  if (_faults) {
+    _faults--;
+    return (countError(MCP23017_ERR_TIMEOUT));
+  }
+#endif
+  _wire->beginTransmission(MCP23017_ADDRESS | i2caddr);
+  wiresend(reg, _wire);
+  for (i = 0; i < num; i++) {
+    wiresend(buf[i], _wire);
+  }
+  return (countError(_wire->endTransmission()));
+}
+
+
 /**
  * Read a single port, A or B, and return its current 8 bit value.
  * @param portb Decided what gpio to use. Should be 0 for GPIOA, and 1 for GPIOB.
- * @return Returns the b bit value of the port
+ * @param value Returns the 8 bit value of the port
+ * @return Returns 0 on success, else errorcode
  */
-uint8_t mcp23017::readGPIO(uint8_t portb) {
-// send cmd: read GPIOA
-  _wire->beginTransmission(MCP23017_ADDRESS | i2caddr);
-  if (portb == 0)
-    wiresend(MCP23017_GPIOA, _wire);
-  else {
-    wiresend(MCP23017_GPIOB, _wire);
+uint8_t mcp23017::readGPIO(uint8_t portb, uint8_t &value) {
+  if (portb == 0) {
+    return (readBytes(MCP23017_GPIOA, &value, 1));
   }
-  _wire->endTransmission();
-  // get response: 
-  _wire->requestFrom(MCP23017_ADDRESS | i2caddr, 1);
-  return wirerecv(_wire);
+  return (readBytes(MCP23017_GPIOB, &value, 1));
 }
 
 
 /*!
  * Reads all 16 pins (port A and B) into a single 16 bits variable.
- * @return Returns the 16 bit variable representing all 16 pins
+ * @param value Returns the 16 bit variable representing all 16 pins
+ * @return Returns 0 on success, else errorcode
  */
-uint16_t mcp23017::readGPIOAB() {
-  uint16_t ba = 0;
-  uint8_t a;
-  // send cmd: read GPIOA
-  _wire->beginTransmission(MCP23017_ADDRESS | i2caddr);
-  wiresend(MCP23017_GPIOA, _wire);
-  _wire->endTransmission();
-  // get response: 
-  _wire->requestFrom(MCP23017_ADDRESS | i2caddr, 2);
-  a = wirerecv(_wire);  // GPIOA 
-  ba = wirerecv(_wire); // GPIOB
-  ba <<= 8;             
-  ba |= a;  
-  return ba;
+uint8_t mcp23017::readGPIOAB(uint16_t &value) {
+  uint8_t ab[2];
+  uint8_t error;
+  error = readBytes(MCP23017_GPIOA, ab, 2);
+  if (error == 0) {
+    value = ((uint16_t)ab[1] << 8) | ab[0];
+  }
+  return (error);
+}
+
+
+/*!
+ * Reads the port values captured at the time of the interrupt (INTCAPA and
+ * INTCAPB) into a single 16 bits variable. Reading INTCAP clears the
+ * interrupt.
+ * @param value Returns the 16 bit variable representing all 16 captured pins
+ * @return Returns 0 on success, else errorcode
+ */
+uint8_t mcp23017::readINTCAPAB(uint16_t &value) {
+  uint8_t ab[2];
+  uint8_t error;
+  error = readBytes(MCP23017_INTCAPA, ab, 2);
+  if (error == 0) {
+    value = ((uint16_t)ab[1] << 8) | ab[0];
+  }
+  return (error);
+}
+
+
+/*!
+ * Reads consecutive registers in one transaction (sequential operation,
+ * the address pointer is incremented by the MCP23017).
+ * @param addr first register to be read
+ * @param buf buffer for the register values
+ * @param num number of registers to be read (max. 22)
+ * @return Returns 0 on success, else errorcode
+ */
+uint8_t mcp23017::readRegisters(uint8_t addr, uint8_t *buf, uint8_t num) {
+  return (readBytes(addr, buf, num));
 }
 
 
 /*!
  * Reads a given register
+ * @param addr register to be read
+ * @param value Returns the register value
+ * @return Returns 0 on success, else errorcode
  */
-uint8_t mcp23017::readRegister(uint8_t addr) {
-  // read the current GPINTEN
-  _wire->beginTransmission(MCP23017_ADDRESS | i2caddr);
-  wiresend(addr, _wire);
-  _wire->endTransmission();
-  _wire->requestFrom(MCP23017_ADDRESS | i2caddr, 1);
-  return wirerecv(_wire);
+uint8_t mcp23017::readRegister(uint8_t addr, uint8_t &value) {
+  return (readBytes(addr, &value, 1));
 }
 
 
 /*!
  * Writes all the pins in one go. This method is very useful if you are
  * implementing a multiplexed matrix and want to get a decent refresh rate.
+ * @param ba value for port A (low byte) and port B (high byte)
+ * @return Returns 0 on success, else errorcode
  */
-void mcp23017::writeGPIOAB(uint16_t ba) {
-  _wire->beginTransmission(MCP23017_ADDRESS | i2caddr);
-  wiresend(MCP23017_GPIOA, _wire);
-  wiresend(ba & 0xFF, _wire); // GPIOA
-  wiresend(ba >> 8, _wire);   // GPIOB
-  _wire->endTransmission();
+uint8_t mcp23017::writeGPIOAB(uint16_t ba) {
+  uint8_t ab[2];
+  ab[0] = ba & 0xFF;  // GPIOA
+  ab[1] = ba >> 8;    // GPIOB
+  return (writeBytes(MCP23017_GPIOA, ab, 2));
 }
 
 
 /*!
  * Writes a given register
+ * @param regAddr register to be written
+ * @param regValue value to be written
+ * @return Returns 0 on success, else errorcode
  */
-void mcp23017::writeRegister(uint8_t regAddr, uint8_t regValue) {
-  // Write the register
-  _wire->beginTransmission(MCP23017_ADDRESS | i2caddr);
-  wiresend(regAddr, _wire);
-  wiresend(regValue, _wire);
-  _wire->endTransmission();
+uint8_t mcp23017::writeRegister(uint8_t regAddr, uint8_t regValue) {
+  return (writeBytes(regAddr, &regValue, 1));
 }
 
 
@@ -172,21 +296,101 @@ void mcp23017::writeRegister(uint8_t regAddr, uint8_t regValue) {
  * Default values after Power On Reset are: (false, false, LOW)
  * If you are connecting the INTA/B pin to arduino 2/3, you should configure the
  * interupt handling as FALLING with the default configuration.
+ * IOCON is taken from the register shadow instead of being read back.
+ * @return Returns 0 on success, else errorcode
  */
-void mcp23017::setupInterrupts(uint8_t mirroring, uint8_t openDrain,
+uint8_t mcp23017::setupInterrupts(uint8_t mirroring, uint8_t openDrain,
                                         uint8_t polarity) {
   uint8_t ioconfValue;
-  // configure the port A
-  ioconfValue = readRegister(MCP23017_IOCONA);
+  // IOCONA and IOCONB are the same register
+  ioconfValue = _shadow[MCP23017_IOCONA];
   bitWrite(ioconfValue, 6, mirroring);
   bitWrite(ioconfValue, 2, openDrain);
   bitWrite(ioconfValue, 1, polarity);
   writeRegister(MCP23017_IOCONA, ioconfValue);
-  // Configure the port B
-  ioconfValue = readRegister(MCP23017_IOCONB);
-  bitWrite(ioconfValue, 6, mirroring);
-  bitWrite(ioconfValue, 2, openDrain);
-  bitWrite(ioconfValue, 1, polarity);
-  writeRegister(MCP23017_IOCONB, ioconfValue);
+  return (writeRegister(MCP23017_IOCONB, ioconfValue));
+}
+
+
+/*!
+ * Writes all registers from the register shadow in one transaction
+ * (e.g. after a reset of the chip or a bus recovery).
+ * Read-only registers (INTF, INTCAP) are ignored by the chip,
+ * GPIO is written with the OLAT value.
+ * @return Returns 0 on success, else errorcode
+ */
+uint8_t mcp23017::restore() {
+  uint8_t regs[MCP23017_REGS];
+  memcpy(regs, _shadow, MCP23017_REGS);
+  return (writeBytes(MCP23017_IODIRA, regs, MCP23017_REGS));
+}
+
+
+/*!
+ * @return Returns the number of failed transfers since begin()
+ */
+uint16_t mcp23017::errorCount() {
+  return (_errors);
+}
+
+
+/*!
+ * @return Returns the errorcode of the last failed transfer
+ */
+uint8_t mcp23017::lastError() {
+  return (_lastError);
 }
 
+
+/*!
+ * Releases a bus which is held low by a slave and re-initializes the TWI.
+ * - SCL is clocked up to 9 times until SDA is released
+ * - a STOP condition is generated
+ * - the TWI is re-initialized with the given clock
+ * Takes about 0.1ms.
+ * @param theWire the I2C object to use
+ * @param clock I2C clock after re-initialization [Hz]
+ * @return Returns 0 if SDA and SCL are high afterwards, else MCP23017_ERR_BUS
+ */
+uint8_t mcp23017::clearBus(TwoWire *theWire, uint32_t clock) {
+  uint8_t i;
+  uint8_t error;
+  theWire->end();
+  pinMode(SDA, INPUT_PULLUP);
+  pinMode(SCL, INPUT_PULLUP);
+  delayMicroseconds(5);
+  // clock SCL until the slave releases SDA
+  for (i = 0; (i < 9) && !digitalRead(SDA); i++) {
+    digitalWrite(SCL, LOW);
+    pinMode(SCL, OUTPUT);
+    delayMicroseconds(5);
+    pinMode(SCL, INPUT_PULLUP);
+    delayMicroseconds(5);
+  }
+  // STOP: SDA low -> high while SCL is high
+  digitalWrite(SDA, LOW);
+  pinMode(SDA, OUTPUT);
+  delayMicroseconds(5);
+  pinMode(SDA, INPUT_PULLUP);
+  delayMicroseconds(5);
+  error = (digitalRead(SDA) && digitalRead(SCL)) ? MCP23017_OK : MCP23017_ERR_BUS;
+  theWire->begin();
+  theWire->setClock(clock);
+#ifdef WIRE_HAS_TIMEOUT
+  theWire->setWireTimeout(MCP23017_TIMEOUT_US, true);
+#endif
+  return (error);
+}
+
+
+#if MCP23017_FAULT_INJECTION
+/*!
+ * Fault injection (tests and simulator builds only): the next n
+ * transfers (of any chip) fail with MCP23017_ERR_TIMEOUT without
+ * accessing the bus.
+ * @param n number of transfers to fail
+ */
+void mcp23017::injectFaults(uint8_t n) {
+  _faults = n;
+}
+#endif
@@ -8,6 +8,12 @@
 // Don't forget the Wire library
 #include <Wire.h>
 
+#define MCP23017_REGS 22     //!< Number of registers (IODIRA .. OLATB)
+
+#ifndef MCP23017_FAULT_INJECTION
+#define MCP23017_FAULT_INJECTION 0 //!< 1: injectFaults() for tests (build flag)
+#endif
+
 /*!
  * @brief MCP23017 main class
  */
@@ -16,16 +22,35 @@ public:
   uint8_t begin(uint8_t addr, TwoWire *theWire = &Wire);
   uint8_t begin(TwoWire *theWire = &Wire);
 
-  uint8_t  readGPIO(uint8_t b);
-  uint16_t readGPIOAB();
-  uint8_t  readRegister(uint8_t addr);
-  void     writeGPIOAB(uint16_t);
-  void     writeRegister(uint8_t addr, uint8_t value);
-  void     setupInterrupts(uint8_t mirroring, uint8_t open, uint8_t polarity);
+  uint8_t  readGPIO(uint8_t b, uint8_t &value);
+  uint8_t  readGPIOAB(uint16_t &value);
+  uint8_t  readINTCAPAB(uint16_t &value);
+  uint8_t  readRegister(uint8_t addr, uint8_t &value);
+  uint8_t  readRegisters(uint8_t addr, uint8_t *buf, uint8_t num);
+  uint8_t  writeGPIOAB(uint16_t);
+  uint8_t  writeRegister(uint8_t addr, uint8_t value);
+  uint8_t  setupInterrupts(uint8_t mirroring, uint8_t open, uint8_t polarity);
+  uint8_t  restore();
+  uint16_t errorCount();
+  uint8_t  lastError();
+
+  static uint8_t clearBus(TwoWire *theWire, uint32_t clock);
+#if MCP23017_FAULT_INJECTION
+  static void    injectFaults(uint8_t n);
+#endif
   
 private:
+  uint8_t  readBytes(uint8_t reg, uint8_t *buf, uint8_t num);
+  uint8_t  writeBytes(uint8_t reg, const uint8_t *buf, uint8_t num);
+  uint8_t  countError(uint8_t error);
   uint8_t i2caddr;
   TwoWire *_wire; //!< pointer to a TwoWire object
+  uint16_t _errors;    //!< number of failed transfers
+  uint8_t  _lastError; //!< errorcode of last failed transfer
+  uint8_t  _shadow[MCP23017_REGS]; //!< last written value of each register
+#if MCP23017_FAULT_INJECTION
+  static uint8_t _faults; //!< number of transfers to fail (fault injection)
+#endif
 };
 
 #define MCP23017_ADDRESS 0x20  //!< MCP23017 Address
@@ -57,4 +82,15 @@ private:
 
 #define MCP23017_INT_ERR 255 //!< Interrupt error
 
+// transfer timeout
+#define MCP23017_TIMEOUT_US 5000 //!< Timeout of one transfer [us] (25 bytes @ 100kHz: 2.3ms)
+
+// errorcodes: 1-5 are the return values of Wire.endTransmission()
+#define MCP23017_OK          0 //!< Success
+#define MCP23017_ERR_NACK_ADR 2 //!< Address not acknowledged
+#define MCP23017_ERR_NACK_DATA 3 //!< Data not acknowledged
+#define MCP23017_ERR_TIMEOUT 5 //!< Transfer timed out
+#define MCP23017_ERR_SHORT   6 //!< Less bytes received than requested
+#define MCP23017_ERR_BUS     7 //!< Bus could not be released
+
 #endif
@@ -0,0 +1,118 @@
+/*!
+ * @file autoOff.cpp
+ */
+#include <autoOff.h>
+
+// Instance for the Timer Callback
+static autoOff* autoOffInstance;
+
+/************************************************************
+ * begin (public)
+ * @param[in] cfg    Configuration (Auto-Off Durations)
+ * @param[in] timers Timer Wheel for the Deadlines
+ ************************************************************/
+void autoOff::begin (config& cfg, timerWheel& timers) {
+  uint8_t i;
+  _config = &cfg;
+  _timers = &timers;
+  for (i = 0; i < MCP_OUT_PINS; i++) {
+    _left[i] = 0;
+  }
+  _timer = TIMER_NONE;
+  _expired = 0;
+  autoOffInstance = this;
+}
+
+/************************************************************
+ * update (public)
+ * Set the remaining Time of Outputs switched on, clear it
+ * for Outputs switched off, start the Timer if required
+ * @param[in] oldState Outputs before the Change
+ * @param[in] newState Outputs after the Change
+ ************************************************************/
+void autoOff::update (uint32_t oldState, uint32_t newState) {
+  uint32_t changed;
+  uint8_t i;
+  uint8_t duration;
+  boolean running;
+  // Tick started before this Change: partly over
+  running = (_timer != TIMER_NONE);
+  changed = oldState ^ newState;
+  for (i = 0; changed; i++, changed >>= 1) {
+    if (!(changed & 1)) {
+      continue;
+    }
+    // switched off (or on again): stop Count down
+    _left[i] = 0;
+    _expired &= ~(1UL << i);
+    if (newState & (1UL << i)) {
+      duration = _config->getAutoOffFromEEprom(i);
+      if (duration == 0) {
+        continue;
+      }
+      _left[i] = duration * (AUTO_OFF_UNIT / AUTO_OFF_TICK);
+      if (running) {
+        _left[i]++;
+      } else if (_timer == TIMER_NONE) {
+        _timer = _timers->start(AUTO_OFF_TICK, expire, 0);
+        if (_timer == TIMER_NONE) {
+          DBG_ERROR.println(F("ERROR: no free Timer for Auto-Off"));
+        }
+      }
+    }
+  }
+}
+
+/************************************************************
+ * take (public)
+ * @returns Mask of Outputs expired since the last Call
+ ************************************************************/
+uint32_t autoOff::take (void) {
+  uint32_t m = _expired;
+  _expired = 0;
+  return (m);
+}
+
+/************************************************************
+ * printState (public)
+ * Print remaining Time of all running Auto-Off Timers
+ ************************************************************/
+void autoOff::printState (void) {
+  uint8_t i;
+  DBG.print(F("Auto-Off:"));
+  for (i = 0; i < MCP_OUT_PINS; i++) {
+    if (_left[i] != 0) {
+      DBG.print(F(" "));
+      DBG.print(i);
+      DBG.print(F("="));
+      DBG.print(_left[i] * (AUTO_OFF_TICK / 1000));
+      DBG.print(F("s"));
+    }
+  }
+  DBG.println(F(""));
+}
+
+/************************************************************
+ * expire (private, static)
+ * Timer Callback every AUTO_OFF_TICK: count down, collect 
+ * expired Outputs, restart while an Output is counting
+ * @param[in] arg not used
+ ************************************************************/
+void autoOff::expire (uint8_t arg) {
+  autoOff* a = autoOffInstance;
+  uint8_t i;
+  boolean counting;
+  (void)arg;
+  counting = false;
+  for (i = 0; i < MCP_OUT_PINS; i++) {
+    if (a->_left[i] == 0) {
+      continue;
+    }
+    if (--a->_left[i] == 0) {
+      a->_expired |= (1UL << i);
+    } else {
+      counting = true;
+    }
+  }
+  a->_timer = counting ? a->_timers->start(AUTO_OFF_TICK, expire, 0) : TIMER_NONE;
+}
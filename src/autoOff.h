@@ -0,0 +1,44 @@
+/************************************************************
+ * This File implements the Auto-Off (Staircase) Timers
+ ************************************************************
+ * - Outputs with an Auto-Off Duration in EEPROM (see 
+ *   mySettings.h) are switched off after this Duration
+ * - update() is called by setOutputs() with every Change of
+ *   the Outputs, so every Path switching an Output on 
+ *   starts its Timer, switching it off cancels the Timer
+ * - All Outputs share ONE Timer of the Timer Wheel: it 
+ *   runs every AUTO_OFF_TICK while an Output is on and 
+ *   counts down the remaining Time of each Output (an 
+ *   Output expires between its Duration and Duration + 
+ *   AUTO_OFF_TICK). Expired Outputs are collected in a 
+ *   Mask, which is taken after timerWheel::tick() and 
+ *   written with ONE setOutputs()
+ ************************************************************/
+#ifndef _AUTOOFF_H_
+#define _AUTOOFF_H_
+
+#include <Arduino.h>
+#include <configTools.h>
+#include <timerWheel.h>
+
+#define AUTO_OFF_UNIT     10000UL   // [ms] Unit of Auto-Off Durations
+#define AUTO_OFF_TICK      1000UL   // [ms] Count down of the remaining Time
+
+class autoOff {
+    public:
+    // public functions
+    void begin (config& cfg, timerWheel& timers);
+    void update (uint32_t oldState, uint32_t newState);
+    uint32_t take (void);
+    void printState (void);
+
+    private:
+    static void expire (uint8_t arg);
+    config* _config;                  //!< Auto-Off Durations in EEPROM
+    timerWheel* _timers;              //!< Count down
+    uint8_t  _timer;                  //!< Timer of all Outputs, TIMER_NONE if none on
+    uint16_t _left[MCP_OUT_PINS];     //!< [AUTO_OFF_TICK] remaining, 0 if off
+    uint32_t _expired;                //!< Outputs expired since last take()
+};
+
+#endif  // _AUTOOFF_H_
@@ -0,0 +1,314 @@
+/*!
+ * @file buttons.cpp
+ */
+#include <buttons.h>
+
+// Instance for the Timer Callback
+static buttons* buttonsInstance;
+
+/************************************************************
+ * begin (public)
+ * Reset all Inputs to BTN_IDLE, load the Timing Classes
+ * @param[in] cfg     Configuration (Input and Class Table)
+ * @param[in] timers  Timer Wheel for the Hold Repeats
+ * @param[in] handler Function to be called for each Click
+ ************************************************************/
+void buttons::begin (config& cfg, timerWheel& timers, clickHandler handler) {
+  uint8_t i;
+  _config = &cfg;
+  _timers = &timers;
+  _handler = handler;
+  buttonsInstance = this;
+  _holding = 0;
+  _lastState = 0;
+  _active = 0;
+  _chordHeld = 0;
+  _chordFired = 0;
+  for (i = 0; i < MCP_IN_PINS; i++) {
+    _phase[i] = BTN_IDLE;
+    _edgeTime[i] = 0;
+    _holdTimer[i] = TIMER_NONE;
+  }
+  reload();
+}
+
+/************************************************************
+ * reload (public)
+ * Load Timing Class and Hold Mode of each Input, Times of
+ * each Class and the Chords from EEPROM (after a Configuration Change)
+ ************************************************************/
+void buttons::reload (void) {
+  uint8_t i;
+  boolean invert;
+  boolean pullup;
+  boolean hold;
+  uint32_t inputs;
+  for (i = 0; i < BUTTON_CLASSES; i++) {
+    _config->getButtonClassFromEEprom(i, _timing[i].t0, _timing[i].t1, _timing[i].t2, _timing[i].tr);
+  }
+  _hold = 0;
+  for (i = 0; i < MCP_IN_PINS; i++) {
+    _config->getInputFromEEprom(i, _class[i], invert, pullup, hold);
+    if (hold) {
+      _hold |= (1UL << i);
+    }
+  }
+  // Chords (validated by the Configuration)
+  _chordWindow = _config->getChordWindowFromEEprom();
+  _chordNum = 0;
+  _chordFired = 0;
+  _chordHeld = 0;
+  for (i = 0; i < CHORD_MAX; i++) {
+    _config->getChordFromEEprom(i, inputs);
+    if (inputs != CHORD_NONE) {
+      _chordMask[_chordNum] = inputs;
+      _chordStart[_chordNum] = 0;
+      _chordId[_chordNum] = i;
+      _chordNum++;
+    }
+  }
+}
+
+/************************************************************
+ * update (public)
+ * Feed one Scan of all Inputs into the State Machine
+ * Must be called on each Edge and after the Time given by nextScan()
+ * @param[in] state packed State of all Inputs (1 = pressed)
+ * @param[in] now   actual Time [ms] (lower 16 Bit of millis())
+ ************************************************************/
+void buttons::update (uint32_t state, uint16_t now) {
+  uint32_t todo;        // Inputs to be processed
+  uint32_t last;        // State of last update
+  uint32_t s;
+  uint8_t inPin;
+  // only changed or not idle Inputs
+  last = _lastState;
+  todo = _active | (state ^ last);
+  _lastState = state;
+  inPin = 0;
+  s = state;
+  while (todo) {
+    if (todo & 1) {
+      updatePin(inPin, (s & 1), now);
+    }
+    todo >>= 1;
+    s >>= 1;
+    inPin++;
+  }
+  // Chords on a Press or while a reported Chord is held
+  if ((state & ~last) || _chordFired) {
+    updateChords(state, last, now);
+  }
+}
+
+/************************************************************
+ * holdInputs (private)
+ * Set Inputs to BTN_HELD: no Clicks until they are released
+ * @param[in] mask Inputs
+ ************************************************************/
+void buttons::holdInputs (uint32_t mask) {
+  uint8_t inPin;
+  _active |= mask;
+  for (inPin = 0; mask; inPin++, mask >>= 1) {
+    if (mask & 1) {
+      _phase[inPin] = BTN_HELD;
+    }
+  }
+}
+
+/************************************************************
+ * updateChords (private)
+ * Report Chords whose last Input was pressed in this Scan
+ * within the Window, suppress the Clicks of their Inputs
+ * until all Inputs of the Chord are released
+ * @param[in] state packed State of all Inputs (1 = pressed)
+ * @param[in] last  State of the previous update
+ * @param[in] now   actual Time [ms]
+ ************************************************************/
+void buttons::updateChords (uint32_t state, uint32_t last, uint16_t now) {
+  uint32_t pressed;
+  uint32_t mask;
+  uint32_t held;
+  uint8_t c;
+  pressed = state & ~last;
+  // Input of a reported Chord pressed again (e.g. bounce)
+  if (pressed & _chordHeld) {
+    holdInputs(pressed & _chordHeld);
+  }
+  held = 0;
+  for (c = 0; c < _chordNum; c++) {
+    mask = _chordMask[c];
+    if (_chordFired & (1 << c)) {
+      // reported: done when all Inputs are released
+      if (state & mask) {
+        held |= mask;
+      } else {
+        _chordFired &= ~(1 << c);
+      }
+      continue;
+    }
+    if ((last & mask) == 0) {
+      // first Input of the Chord pressed
+      _chordStart[c] = now;
+    }
+    if (((state & mask) != mask) || ((pressed & mask) == 0) || (_chordHeld & mask) ||
+        ((uint16_t)(now - _chordStart[c]) > _chordWindow)) {
+      continue;
+    }
+    // all Inputs pressed within the Window
+    _chordFired |= (1 << c);
+    held |= mask;
+    holdInputs(mask);
+    _handler(BUTTON_CLICK_CHORD, _chordId[c], 0);
+  }
+  _chordHeld = held;
+}
+
+/************************************************************
+ * repeat (private, static)
+ * Timer Callback: report Hold Repeat, restart the Timer
+ * (cancelled on Release)
+ * @param[in] inPin held Input
+ ************************************************************/
+void buttons::repeat (uint8_t inPin) {
+  buttons* b = buttonsInstance;
+  uint16_t dt;
+  dt = (uint16_t)millis() - b->_edgeTime[inPin];
+  b->_holdTimer[inPin] = b->_timers->start(b->_timing[b->_class[inPin]].tr, repeat, inPin);
+  b->_handler(BUTTON_HOLD_REPEAT, inPin, dt);
+}
+
+/************************************************************
+ * busy (public)
+ * @returns true if any Input is not idle
+ *          (a Click may still be reported)
+ ************************************************************/
+boolean buttons::busy (void) {
+  return (_active != 0);
+}
+
+/************************************************************
+ * nextScan (public)
+ * Time until the next Scan is needed without IRQ
+ * @param[in] now actual Time [ms] (lower 16 Bit of millis())
+ * @returns [ms] until the earliest Decision of all not idle
+ *          Inputs, BUTTON_NO_SCAN if none
+ ************************************************************/
+uint16_t buttons::nextScan (uint16_t now) {
+  uint32_t todo;
+  uint16_t wait;
+  uint16_t dt;
+  uint16_t t;
+  uint8_t inPin;
+  const buttonTiming* tm;
+  wait = BUTTON_NO_SCAN;
+  todo = _active;
+  for (inPin = 0; todo; inPin++, todo >>= 1) {
+    if (!(todo & 1)) {
+      continue;
+    }
+    tm = &_timing[_class[inPin]];
+    dt = now - _edgeTime[inPin];
+    if ((_phase[inPin] != BTN_HELD) && (dt < tm->t0)) {
+      // may still bounce
+      t = BUTTON_SCANINT;
+    } else if (_phase[inPin] == BTN_PRESSED) {
+      // Long-Click Boundary
+      t = (dt < tm->t1) ? tm->t1 - dt : 0;
+    } else if (_phase[inPin] == BTN_RELEASED) {
+      // End of Double-Click Window
+      t = (dt < tm->t2) ? tm->t2 - dt : 0;
+    } else {
+      // wait for Release (IRQ)
+      continue;
+    }
+    if (t < wait) {
+      wait = t;
+    }
+  }
+  return (wait);
+}
+
+/************************************************************
+ * updatePin (private)
+ * State Machine of one Input
+ * @param[in] inPin   Input Pin
+ * @param[in] pressed actual State of Input
+ * @param[in] now     actual Time [ms]
+ ************************************************************/
+void buttons::updatePin (uint8_t inPin, boolean pressed, uint16_t now) {
+  uint16_t dt;          // Time since last Edge
+  uint8_t phase;
+  const buttonTiming* t = &_timing[_class[inPin]];
+  dt = now - _edgeTime[inPin];
+  phase = _phase[inPin];
+  switch (phase) {
+    case BTN_IDLE:
+      if (pressed) {
+        phase = BTN_PRESSED;
+        _edgeTime[inPin] = now;
+      }
+      break;
+    case BTN_PRESSED:
+      if (!pressed) {
+        if (dt < t->t0) {
+          // Noise
+          phase = BTN_IDLE;
+        } else {
+          phase = BTN_RELEASED;
+          _edgeTime[inPin] = now;
+        }
+      } else if (dt >= t->t1) {
+        phase = BTN_HELD;
+        if (_hold & (1UL << inPin)) {
+          _holding |= (1UL << inPin);
+          if (t->tr) {
+            _holdTimer[inPin] = _timers->start(t->tr, repeat, inPin);
+          }
+          _handler(BUTTON_HOLD_START, inPin, dt);
+        } else {
+          _handler(BUTTON_CLICK_LONG, inPin, dt);
+        }
+      }
+      break;
+    case BTN_RELEASED:
+      if (pressed) {
+        phase = BTN_PRESSED2;
+        _edgeTime[inPin] = now;
+      } else if (dt >= t->t2) {
+        phase = BTN_IDLE;
+        _handler(BUTTON_CLICK, inPin, 0);
+      }
+      break;
+    case BTN_PRESSED2:
+      if (!pressed) {
+        if (dt < t->t0) {
+          // Noise, keep waiting for 2nd Press
+          phase = BTN_RELEASED;
+          _edgeTime[inPin] = now;
+        } else {
+          phase = BTN_IDLE;
+          _handler(BUTTON_CLICK_DOUBLE, inPin, 0);
+        }
+      }
+      break;
+    case BTN_HELD:
+      if (!pressed) {
+        phase = BTN_IDLE;
+        if (_holding & (1UL << inPin)) {
+          _holding &= ~(1UL << inPin);
+          _timers->cancel(_holdTimer[inPin]);
+          _holdTimer[inPin] = TIMER_NONE;
+          _handler(BUTTON_HOLD_RELEASE, inPin, dt);
+        }
+      }
+      break;
+  }
+  _phase[inPin] = phase;
+  // maintain Mask of not idle Inputs
+  if (phase == BTN_IDLE) {
+    _active &= ~(1UL << inPin);
+  } else {
+    _active |= (1UL << inPin);
+  }
+}
@@ -0,0 +1,127 @@
+/************************************************************
+ * This File implements the Button State Machine
+ ************************************************************
+ * The State of all 32 Inputs is passed in as one packed
+ * 32 Bit Word (as read by scanButtons()).
+ * For each Input the following Click Types are detected:
+ * - Click:        Press >= T0, Release before T1
+ *                 and no second Press within T2
+ * - Double-Click: second Press within T2 after Release
+ * - Long-Click:   Press held for T1
+ *                 (reported while the Button is still held)
+ * Detected Clicks are reported via a Callback.
+ * T0, T1, T2, TR are taken from the Timing Class of the Input
+ * (Input Table and Class Table in EEPROM, copied to RAM by
+ * begin() and reload(): one Index per processed Input).
+ ************************************************************
+ * Only Inputs which changed or which are not idle are
+ * processed, so a scan without any pressed Button costs
+ * one XOR and one compare.
+ ************************************************************
+ * nextScan() tells the Scanner when the next Scan without
+ * IRQ is needed (Edges always cause an IRQ):
+ * - every BUTTON_SCANINT while an Input may still bounce
+ *   (less than T0 since its last Edge)
+ * - at the End of the Double-Click Window (Click is decided)
+ * - at the Long-Click Boundary (Long Click is decided)
+ * - never if all Inputs are idle, held or wait for Release
+ ************************************************************
+ * Chords (Chord Table, copied to RAM by begin()/reload()):
+ * - checked only in Scans with a Press (rising Edge), each
+ *   Chord costs a few Word Operations on the packed State
+ * - a Chord starts with the first Press of one of its 
+ *   Inputs, it is reported when its last Input is pressed
+ *   within the Window (Click Type BUTTON_CLICK_CHORD, 
+ *   Input Pin = # of Chord)
+ * - its Inputs are set to BTN_HELD: no Click, Double-Click
+ *   or Long-Click until all Inputs of the Chord are released
+ * - Inputs of a reported Chord block all Chords containing
+ *   them until then
+ ************************************************************
+ * Hold Events (Inputs with INMODE_HOLD, instead of the
+ * Long-Click), reported with the Duration since the Press:
+ * - Hold Start:   Press held for T1 (same Decision as the
+ *                 Long-Click)
+ * - Hold Repeat:  every TR while held (TR 0: none)
+ * - Hold Release: Release after Hold Start (Edge, IRQ)
+ * The Repeats are driven by one Timer per held Input (Timer
+ * Wheel), not by Scans: no I2C Read while a Button is held.
+ * Durations are 16 Bit [ms], i.e. modulo 65.5s.
+ ************************************************************/
+#ifndef _BUTTONS_H_
+#define _BUTTONS_H_
+
+#include <Arduino.h>
+#include <mySettings.h>
+#include <configTools.h>
+#include <timerWheel.h>
+
+/********************************************************
+ * Phases of the Button State Machine
+ ********************************************************/
+#define BTN_IDLE              0   // not pressed, nothing pending
+#define BTN_PRESSED           1   // 1st Press: filter noise, measure Long-Click
+#define BTN_RELEASED          2   // released after short Press: wait for Double-Click
+#define BTN_PRESSED2          3   // 2nd Press within BUTTON_T2
+#define BTN_HELD              4   // Long-Click reported, wait for Release
+
+#define BUTTON_NO_SCAN   0xffff   // nextScan(): no Scan needed (IRQ only)
+
+/********************************************************
+ * Callback for detected Clicks and Hold Events
+ * @param[in] clickType BUTTON_CLICK, BUTTON_CLICK_DOUBLE, 
+ *                      BUTTON_CLICK_LONG, BUTTON_CLICK_CHORD
+ *                      or BUTTON_HOLD_xxx
+ * @param[in] inPin Input Pin (Bit in packed Input State),
+ *                  # of Chord for BUTTON_CLICK_CHORD
+ * @param[in] duration [ms] since the Press (Long-Click and
+ *                  Hold Events), else 0
+ ********************************************************/
+typedef void (*clickHandler)(uint8_t clickType, uint8_t inPin, uint16_t duration);
+
+/********************************************************
+ * Times of one Timing Class
+ ********************************************************/
+typedef struct {
+  uint8_t  t0;                        //!< shorter Press is Noise [ms]
+  uint16_t t1;                        //!< Long Click [ms]
+  uint16_t t2;                        //!< Double Click Window [ms]
+  uint16_t tr;                        //!< Repeat Interval of Hold Events [ms]
+} buttonTiming;
+
+class buttons {
+    public:
+    // public functions
+    void begin (config& cfg, timerWheel& timers, clickHandler handler);
+    void reload (void);
+    void update (uint32_t state, uint16_t now);
+    boolean busy (void);
+    uint16_t nextScan (uint16_t now);
+
+    private:
+    void updatePin (uint8_t inPin, boolean pressed, uint16_t now);
+    void updateChords (uint32_t state, uint32_t last, uint16_t now);
+    void holdInputs (uint32_t mask);
+    static void repeat (uint8_t inPin);
+    config* _config;                      //!< Input and Class Table in EEPROM
+    timerWheel* _timers;                  //!< Timers of the Hold Repeats
+    clickHandler _handler;                //!< called for each detected Click
+    uint32_t _lastState;                  //!< State of last update
+    uint32_t _active;                     //!< Bit set if Input is not BTN_IDLE
+    uint8_t  _phase[MCP_IN_PINS];         //!< Phase of each Input
+    uint16_t _edgeTime[MCP_IN_PINS];      //!< Time of last Edge [ms]
+    uint8_t  _class[MCP_IN_PINS];         //!< Timing Class of each Input
+    buttonTiming _timing[BUTTON_CLASSES]; //!< Times of each Class
+    uint32_t _chordMask[CHORD_MAX];       //!< Inputs of each configured Chord
+    uint16_t _chordStart[CHORD_MAX];      //!< Time of first Press of each Chord [ms]
+    uint8_t  _chordId[CHORD_MAX];         //!< # of Chord in the Chord Table
+    uint8_t  _chordNum;                   //!< Number of configured Chords
+    uint8_t  _chordWindow;                //!< [ms] all Inputs of a Chord pressed within
+    uint8_t  _chordFired;                 //!< Bit set if Chord reported, Inputs not all released
+    uint32_t _chordHeld;                  //!< Inputs of reported Chords
+    uint32_t _hold;                       //!< Inputs with Hold Events (INMODE_HOLD)
+    uint32_t _holding;                    //!< Hold Start reported, not released
+    uint8_t  _holdTimer[MCP_IN_PINS];     //!< Repeat Timer of each held Input
+};
+
+#endif  // _BUTTONS_H_
@@ -2,7 +2,9 @@
  * @file configTools.cpp
  */
 #include <configTools.h>
+#include <profiler.h>
 #include <EEPROM.h>
+#include <avr/eeprom.h>
 
 /************************************************************
  * readByteFromE2PROM (private)
@@ -12,6 +14,7 @@
  ************************************************************/ 
 uint8_t config::readByteFromE2PROM (uint16_t E2Adr) {
   uint8_t E2Val;
+  PROF_ENTER(PROF_CONFIG);
   // read from EEPROM  
   if (E2Adr < EEPROM.length()){
     E2Val = EEPROM.read (E2Adr);  
@@ -25,15 +28,34 @@ uint8_t config::readByteFromE2PROM (uint16_t E2Adr) {
       if (E2Val < 0x10) DBG_EE_READ.print(F("0"));
       DBG_EE_READ.println(E2Val,HEX);    
     #endif // DEBUG_EE_INIT
+    PROF_EXIT(PROF_CONFIG);
     return (E2Val);
   } else {
     DBG_ERROR.print(F("ERROR: readByteFromE2PROM failed: Address out of scope: "));
     DBG_ERROR.println(E2Adr);
+    PROF_EXIT(PROF_CONFIG);
     return (0);
   }   
 }
 
 
+/************************************************************
+ * readMaskFromE2PROM (private)
+ * Read a 32 Bit Mask, most significant Byte first
+ * @param[in] E2Adr Address of the first Byte
+ * @returns   Mask
+ ************************************************************/ 
+uint32_t config::readMaskFromE2PROM (uint16_t E2Adr) {
+  uint32_t mask;
+  uint8_t i;
+  mask = 0;
+  for (i = 0; i < 4; i++) {
+    mask = (mask << 8) | readByteFromE2PROM (E2Adr + i);
+  }
+  return (mask);
+}
+
+
 /************************************************************
  * writeByteToE2PROM (private)
  * Write one byte to EEPROM
@@ -60,12 +82,39 @@ void config::writeByteToE2PROM (uint16_t E2Adr, uint8_t E2Val) {
   }
 }
 
+/************************************************************
+ * updateByteToE2PROM (private)
+ * Write one byte to EEPROM only if changed (Endurance)
+ * @param[in] E2Adr Address where Byte shall be written
+ * @param[in] E2Val Value which shall be written 
+ ************************************************************/ 
+void config::updateByteToE2PROM (uint16_t E2Adr, uint8_t E2Val) {
+  if (readByteFromE2PROM (E2Adr) != E2Val) {
+    writeByteToE2PROM (E2Adr, E2Val);
+  }
+}
+
+/************************************************************
+ * begin (public)
+ * Build the Index of the Special Events, report an invalid
+ * Image (aborted Upload)
+ ************************************************************/ 
+void config::begin (void) {
+  indexSpecialEvents();
+  if (!getImageValidFromEEprom()) {
+    DBG_ERROR.println(F("ERROR: Configuration invalid (Upload aborted) - upload again or \"factory\""));
+  }
+}
+
 /************************************************************
  * Read Factory Defaults from Flash (private)
  * To get the Tablesize from a Table read FDTableValType=0 
  * @param[in] FDTable Table to be read [TABLE_INDEX_CLICK, 
  *            TABLE_INDEX_CLICK_DOUBLE, TABLE_INDEX_CLICK_LONG, 
- *            TABLE_INDEX_ROLLER]
+ *            TABLE_INDEX_ROLLER, TABLE_INDEX_SCHEDULE, 
+ *            TABLE_INDEX_AUTO_OFF, TABLE_INDEX_BUTTON_CLASS,
+ *            TABLE_INDEX_INPUT, TABLE_INDEX_RULE,
+ *            TABLE_INDEX_CHORD]
  * @param[in] FDTableValType Type of Value to be read 
  *            [0:Tablesize else FDTable[FDTableEntryNum][FDTableValType-1]
  * @param[in] FDTableEntryNum Entry Number to be read
@@ -101,6 +150,48 @@ uint8_t config::readFactoryDefaultTable (uint8_t FDTableNum, uint8_t FDTableValT
     } else {
       reqVal = sizeof(FactoryDefaultRollerTable);
     }
+  // Schedule Table
+  } else if (FDTableNum == TABLE_INDEX_SCHEDULE) {
+    if (FDTableValType != 0) {
+      reqVal = pgm_read_byte( &FactoryDefaultScheduleTable[FDTableEntryNum][FDTableValType-1]);
+    } else {
+      reqVal = sizeof(FactoryDefaultScheduleTable);
+    }
+  // Auto-Off Table
+  } else if (FDTableNum == TABLE_INDEX_AUTO_OFF) {
+    if (FDTableValType != 0) {
+      reqVal = pgm_read_byte( &FactoryDefaultAutoOffTable[FDTableEntryNum][FDTableValType-1]);
+    } else {
+      reqVal = sizeof(FactoryDefaultAutoOffTable);
+    }
+  // Button Timing Classes
+  } else if (FDTableNum == TABLE_INDEX_BUTTON_CLASS) {
+    if (FDTableValType != 0) {
+      reqVal = pgm_read_byte( &FactoryDefaultButtonClassTable[FDTableEntryNum][FDTableValType-1]);
+    } else {
+      reqVal = sizeof(FactoryDefaultButtonClassTable);
+    }
+  // Input Modes
+  } else if (FDTableNum == TABLE_INDEX_INPUT) {
+    if (FDTableValType != 0) {
+      reqVal = pgm_read_byte( &FactoryDefaultInputTable[FDTableEntryNum][FDTableValType-1]);
+    } else {
+      reqVal = sizeof(FactoryDefaultInputTable);
+    }
+  // Rules
+  } else if (FDTableNum == TABLE_INDEX_RULE) {
+    if (FDTableValType != 0) {
+      reqVal = pgm_read_byte( &FactoryDefaultRuleTable[FDTableEntryNum][FDTableValType-1]);
+    } else {
+      reqVal = sizeof(FactoryDefaultRuleTable);
+    }
+  // Chords
+  } else if (FDTableNum == TABLE_INDEX_CHORD) {
+    if (FDTableValType != 0) {
+      reqVal = pgm_read_byte( &FactoryDefaultChordTable[FDTableEntryNum][FDTableValType-1]);
+    } else {
+      reqVal = sizeof(FactoryDefaultChordTable);
+    }
   }
   return (reqVal);
 }
@@ -114,6 +205,11 @@ uint8_t config::readFactoryDefaultTable (uint8_t FDTableNum, uint8_t FDTableValT
  *   - FactoryDefaultLongClickTable[][3]
  * - Store Roller Config to EEPROM
  * - Store Special Events to EEPROM
+ * - Store Schedule to EEPROM
+ * - Store Auto-Off Durations to EEPROM
+ * - Store Input Modes and Button Timing Classes to EEPROM
+ * - Store Rules to EEPROM
+ * - Store Chords to EEPROM
  **********************************************
  * EEPROM Layout:
  **********************************************
@@ -153,6 +249,31 @@ uint8_t config::readFactoryDefaultTable (uint8_t FDTableNum, uint8_t FDTableValT
  *   - [0x72, ...]    : all Bytes for Special Event 1 
  *   - [0x71 + N1 + 1]: Number of Bytes for Special Event 2 
  *   - [0x71 + N1 + 2]: all Bytes for Special Event 2 
+ **********************************************
+ * - Schedule Table
+ *   - [0x200]        : Number of Entries
+ *   - [0x201, ...]   : Weekdays, Hour, Minute, Action of each Entry
+ *                      (sorted by Hour and Minute, Hour 24/25: 
+ *                      Minute is Offset to Sunrise/Sunset)
+ **********************************************
+ * - Auto-Off Table
+ *   - [0x290 + Output]: Auto-Off Duration [10s], 0 = none
+ **********************************************
+ * - Input Table
+ *   - [0x150 + Input]: [IUHx CCCC] I: inverted Polarity, 
+ *                      U: Pull-Up, H: Hold Events, 
+ *                      C: Button Timing Class
+ *                      (0xff: Factory Default)
+ * - Button Timing Classes
+ *   - [0x170 + Class * 4]: T0 [ms], T1 [10ms], T2 [10ms], 
+ *                          TR [10ms] (0xff: Factory Default)
+ **********************************************
+ * - Rule Table
+ *   - [0x180 + Rule * 18]: Trigger, Action, Out-On, Out-Off,
+ *                          In-On, In-Off (Masks: 4 Byte each)
+ * - Chord Table
+ *   - [0x2B0]            : Alignment Window [ms]
+ *   - [0x2B1 + Chord * 5]: Inputs (4 Byte), Action
  ********************************************************
  * - The following EEPROM Adresses are used:
  *   - 0x00: Click Table 
@@ -160,6 +281,12 @@ uint8_t config::readFactoryDefaultTable (uint8_t FDTableNum, uint8_t FDTableValT
  *   - 0x40: Long Click Table 
  *   - 0x60: Roller Table
  *   - 0x70: Special Events Table
+ *   - 0x150: Input Table
+ *   - 0x170: Button Timing Classes
+ *   - 0x180: Rule Table
+ *   - 0x200: Schedule Table
+ *   - 0x290: Auto-Off Table
+ *   - 0x2B0: Chord Table
  ********************************************************
  * See mySettings.h for further Documentation 
  ************************************************************/ 
@@ -183,6 +310,10 @@ void config::resetToFactoryDefaults (void) {
   uint8_t downTime;       // Time to driver Roller Down  
   uint8_t defaultTime;    // Time to driver Roller Down to night Position  
   uint8_t myIndex;        // to iterate over all Bytes on a Special Event
+  uint8_t hour;           // Hour of Schedule Entry (or SCHED_SUNRISE/SCHED_SUNSET)
+  uint8_t minute;         // Minute of Schedule Entry (or Offset)
+  uint16_t lastKey;       // Hour + Minute of previous Schedule Entry
+  uint16_t thisKey;       // Hour + Minute of this Schedule Entry
   
   // ### Clear E2PROM ### 
   // Click, Double-Click, Long-Click Tables 
@@ -311,6 +442,8 @@ void config::resetToFactoryDefaults (void) {
     E2Val = defaultTime;    
     writeByteToE2PROM(E2Adr, E2Val);
     E2Adr++;
+    // Position unknown until the first End Stop
+    setRollerPosToEEprom(entryNum + 1, ROLLER_POS_UNKNOWN);
   }      
   // ### Special Events ###   
   myIndex = 0;
@@ -352,6 +485,89 @@ void config::resetToFactoryDefaults (void) {
     }
     DBG_EE_INIT.println(F(""));    
   }  
+  indexSpecialEvents();
+  // ### Schedule Table ###
+  FDTableSize = readFactoryDefaultTable (TABLE_INDEX_SCHEDULE, 0, 0) / 4;
+  if (FDTableSize > SCHED_MAX) {
+    DBG_ERROR.println(F("ERROR: Factory Default Schedule Table too long"));
+    FDTableSize = SCHED_MAX;
+  }
+  DBG_EE_INIT.print(F(" -> E2PROM - Schedule Table: "));
+  DBG_EE_INIT.println(FDTableSize);
+  E2Adr = EE_OFFSET_SCHEDULE + 1;
+  SENum = 0;
+  lastKey = 0;
+  for (entryNum = 0; entryNum < FDTableSize; entryNum++ ) {
+    hour = readFactoryDefaultTable (TABLE_INDEX_SCHEDULE, 2, entryNum);
+    minute = readFactoryDefaultTable (TABLE_INDEX_SCHEDULE, 3, entryNum);
+    thisKey = ((uint16_t)hour << 8) | minute;
+    // Entries must be sorted by Hour and Minute and valid
+    if ((thisKey < lastKey) || (hour > SCHED_SUNSET) || ((hour < SCHED_SUNRISE) && (minute > 59))) {
+      DBG_ERROR.print(F("ERROR: Factory Default Schedule Entry #"));
+      DBG_ERROR.print(entryNum);
+      DBG_ERROR.println(F(" not sorted or invalid - not stored"));
+      continue;
+    }
+    lastKey = thisKey;
+    for (myIndex = 1; myIndex < 5; myIndex++) {
+      writeByteToE2PROM(E2Adr++, readFactoryDefaultTable (TABLE_INDEX_SCHEDULE, myIndex, entryNum));
+    }
+    SENum++;
+  }
+  writeByteToE2PROM(EE_OFFSET_SCHEDULE, SENum);
+  // ### Auto-Off Table ###
+  DBG_EE_INIT.print(F(" -> E2PROM - Auto-Off Table ... "));
+  for (E2Adr = EE_OFFSET_AUTO_OFF; E2Adr < EE_OFFSET_AUTO_OFF + MCP_OUT_PINS; E2Adr++) {
+    writeByteToE2PROM(E2Adr, 0x00);
+  }
+  FDTableSize = readFactoryDefaultTable (TABLE_INDEX_AUTO_OFF, 0, 0) / 2;
+  for (entryNum = 0; entryNum < FDTableSize; entryNum++ ) {
+    outPin = readFactoryDefaultTable (TABLE_INDEX_AUTO_OFF, 1, entryNum);
+    if (outPin < MCP_OUT_PINS) {
+      writeByteToE2PROM(EE_OFFSET_AUTO_OFF + outPin, readFactoryDefaultTable (TABLE_INDEX_AUTO_OFF, 2, entryNum));
+    }
+  }
+  DBG_EE_INIT.println(F("done."));
+  // ### Input Table ###
+  DBG_EE_INIT.print(F(" -> E2PROM - Input Table ... "));
+  for (inPin = 0; inPin < MCP_IN_PINS; inPin++) {
+    writeByteToE2PROM(EE_OFFSET_INPUT + inPin, getFactoryDefaultInput(inPin));
+  }
+  DBG_EE_INIT.println(F("done."));
+  // ### Button Timing Classes ###
+  DBG_EE_INIT.print(F(" -> E2PROM - Button Timing Classes ... "));
+  for (entryNum = 0; entryNum < BUTTON_CLASSES; entryNum++ ) {
+    for (myIndex = 0; myIndex < BUTTON_CLASS_SIZE; myIndex++) {
+      writeByteToE2PROM(EE_OFFSET_BUTTON_CLASS + (entryNum * BUTTON_CLASS_SIZE) + myIndex, readFactoryDefaultTable (TABLE_INDEX_BUTTON_CLASS, myIndex + 1, entryNum));
+    }
+  }
+  DBG_EE_INIT.println(F("done."));
+  // ### Rule Table ###
+  DBG_EE_INIT.print(F(" -> E2PROM - Rule Table ... "));
+  for (E2Adr = EE_OFFSET_RULE; E2Adr < EE_OFFSET_RULE + (RULE_MAX * RULE_SIZE); E2Adr++) {
+    writeByteToE2PROM(E2Adr, 0xff);
+  }
+  FDTableSize = readFactoryDefaultTable (TABLE_INDEX_RULE, 0, 0) / RULE_SIZE;
+  for (entryNum = 0; (entryNum < FDTableSize) && (entryNum < RULE_MAX); entryNum++ ) {
+    for (myIndex = 0; myIndex < RULE_SIZE; myIndex++) {
+      writeByteToE2PROM(EE_OFFSET_RULE + (entryNum * RULE_SIZE) + myIndex, readFactoryDefaultTable (TABLE_INDEX_RULE, myIndex + 1, entryNum));
+    }
+  }
+  DBG_EE_INIT.println(F("done."));
+  // ### Chord Table ###
+  DBG_EE_INIT.print(F(" -> E2PROM - Chord Table ... "));
+  writeByteToE2PROM(EE_OFFSET_CHORD, CHORD_WINDOW);
+  for (E2Adr = EE_OFFSET_CHORD + 1; E2Adr < EE_OFFSET_CHORD + 1 + (CHORD_MAX * 5); E2Adr++) {
+    writeByteToE2PROM(E2Adr, 0xff);
+  }
+  FDTableSize = readFactoryDefaultTable (TABLE_INDEX_CHORD, 0, 0) / 5;
+  for (entryNum = 0; (entryNum < FDTableSize) && (entryNum < CHORD_MAX); entryNum++ ) {
+    for (myIndex = 0; myIndex < 5; myIndex++) {
+      writeByteToE2PROM(EE_OFFSET_CHORD + 1 + (entryNum * 5) + myIndex, readFactoryDefaultTable (TABLE_INDEX_CHORD, myIndex + 1, entryNum));
+    }
+  }
+  setImageValidToEEprom(true);
+  DBG_EE_INIT.println(F("done."));
 }
 
 
@@ -379,13 +595,22 @@ uint8_t config::getClickCommandFromEEprom (uint8_t clickType, uint8_t inPinNumbe
   return (E2Val); 
 }
 
+// Bit Numbers of the Output Terminals 1 - 32
+static const uint8_t outTerminals[32] PROGMEM = {
+  OUT_01, OUT_02, OUT_03, OUT_04, OUT_05, OUT_06, OUT_07, OUT_08,
+  OUT_09, OUT_10, OUT_11, OUT_12, OUT_13, OUT_14, OUT_15, OUT_16,
+  OUT_17, OUT_18, OUT_19, OUT_20, OUT_21, OUT_22, OUT_23, OUT_24,
+  OUT_25, OUT_26, OUT_27, OUT_28, OUT_29, OUT_30, OUT_31, OUT_32
+};
+
 /************************************************************
  * getRollerFromEEprom (public)
  ************************************************************
  * Read Roller Config from EEPROM
  * @param[in] roller Number of the Roller (1 to 4)
  * @param[out] upPin
- * @param[out] downPin
+ * @param[out] downPin Output Terminal following upPin
+ *                     (ROLLER_NC if not connected)
  * @param[out] upTime
  * @param[out] downTime
  * @param[out] defaultTime
@@ -393,10 +618,18 @@ uint8_t config::getClickCommandFromEEprom (uint8_t clickType, uint8_t inPinNumbe
 void config::getRollerFromEEprom (uint8_t roller, uint8_t& upPin, uint8_t& downPin,
                           uint8_t& upTime, uint8_t& downTime, uint8_t&  defaultTime) {
   uint16_t E2Adr;  
+  uint8_t i;
   if (roller<5) {
     E2Adr = EE_OFFSET_ROLLER + ((roller-1) * 4);  
     upPin = readByteFromE2PROM (E2Adr);    
-    downPin = upPin + 1;
+    // OUT_xx are Bit Numbers: the following Terminal is not upPin + 1
+    downPin = ROLLER_NC;
+    for (i = 0; i < MCP_OUT_PINS - 1; i++) {
+      if (pgm_read_byte(&outTerminals[i]) == upPin) {
+        downPin = pgm_read_byte(&outTerminals[i + 1]);
+        break;
+      }
+    }
     upTime = readByteFromE2PROM (E2Adr+1);    
     downTime = readByteFromE2PROM (E2Adr+2);    
     defaultTime = readByteFromE2PROM (E2Adr+3);            
@@ -434,43 +667,543 @@ void config::getRollerFromEEprom (uint8_t roller, uint8_t& upPin, uint8_t& downP
  *     - 0x02 CMD_WAIT     N           - Wait 0.1*N Seconds (max 25.5s)      - 2 Byte Command
  *     - 0x03 CMD_ON_MASK  A B C D     - Switch ON  all MASK Bits (ABCD) set - 5 Byte Command
  *     - 0x04 CMD_OFF_MASK A B C D     - Switch OFF all MASK Bits (ABCD) set - 5 Byte Command 
+ *     - 0x05 CMD_ROLLER_POS M P       - Move Rollers of MASK M to P %       - 3 Byte Command
+ *     - 0x06 CMD_REMOTE_ON N A B C D  - Switch ON  MASK Bits on Node N      - 6 Byte Command
+ *     - 0x07 CMD_REMOTE_OFF N A B C D - Switch OFF MASK Bits on Node N      - 6 Byte Command
+ *     - 0x08 CMD_REMOTE_TOGGLE N A B C D - Toggle MASK Bits on Node N       - 6 Byte Command
  ********************************************************/
 uint8_t config::getSpecialEventFromEEprom (uint8_t specialEvent, uint8_t counter) {
   uint16_t E2Adr;    // EEPROM Address  
-  uint8_t SENum;     // Number of Special Events
   uint8_t SELength;  // Length of Special Events
-  uint8_t SECmd;     // Special Events Command
-  uint8_t SECounter; // Counter to iterate over Special Events 
-  // Read Number of Special Events  
-  E2Adr = EE_OFFSET_SPECIAL_EVENT;  
-  SENum = readByteFromE2PROM (E2Adr);  
   if (specialEvent == 0) {
     // return Number of Special Events if specialEvent = 0
-    return (SENum);    
-  } else if (specialEvent > SENum) {
+    return (_seNum);    
+  } else if (specialEvent > _seNum) {
     // return 0 if Special Events does not exist
     return (0);
-  } else {
-    // return next Byte of Special Event
-    E2Adr++;  
-    if (specialEvent < (SENum + 1) ){
-      // find Special Event Startpoint
-      for (SECounter=1; SECounter<specialEvent; SECounter++) {      
-        SELength = readByteFromE2PROM (E2Adr);
-        E2Adr += (SELength + 1);
-      }      
+  }
+  // Length of Special Event searched for (from the Index)
+  E2Adr = EE_OFFSET_SPECIAL_EVENT + _seOffset[specialEvent - 1];
+  SELength = readByteFromE2PROM (E2Adr);  
+  if (counter == 0) {
+    return (SELength);
+  } else if (counter > SELength) {
+    return (0);
+  }
+  return (readByteFromE2PROM (E2Adr + counter));  
+}
+
+/************************************************************
+ * getScheduleNumFromEEprom (public)
+ ************************************************************
+ * @returns Number of Schedule Entries, 0 if Table is invalid
+ ************************************************************/
+uint8_t config::getScheduleNumFromEEprom (void) {
+  uint8_t num;
+  num = readByteFromE2PROM (EE_OFFSET_SCHEDULE);
+  if (num > SCHED_MAX) {
+    // EEPROM not initialized (0xff)
+    return (0);
+  }
+  return (num);
+}
+
+/************************************************************
+ * getScheduleFromEEprom (public)
+ ************************************************************
+ * Read one Entry of the Schedule (sorted by Time of Day)
+ * @param[in]  entry    Number of Entry - STARTING WITH 0
+ * @param[out] weekdays Mask of Weekdays (SCHED_MON ... SCHED_SUN)
+ * @param[out] hour     Hour (0-23), SCHED_SUNRISE or SCHED_SUNSET
+ * @param[out] minute   Minute (0-59) or SCHED_OFFSET(Offset)
+ * @param[out] action   One-Byte Command [CCCP PPPP]
+ ************************************************************/
+void config::getScheduleFromEEprom (uint8_t entry, uint8_t& weekdays, uint8_t& hour, uint8_t& minute, uint8_t& action) {
+  uint16_t E2Adr;
+  E2Adr = EE_OFFSET_SCHEDULE + 1 + (entry * 4);
+  weekdays = readByteFromE2PROM (E2Adr);
+  hour = readByteFromE2PROM (E2Adr + 1);
+  minute = readByteFromE2PROM (E2Adr + 2);
+  action = readByteFromE2PROM (E2Adr + 3);
+}
+
+/************************************************************
+ * getAutoOffFromEEprom (public)
+ ************************************************************
+ * @param[in] outPin Output Pin (0-31)
+ * @returns Auto-Off Duration [10s], 0 if none
+ ************************************************************/
+uint8_t config::getAutoOffFromEEprom (uint8_t outPin) {
+  uint8_t duration;
+  if (outPin < MCP_OUT_PINS) {
+    duration = readByteFromE2PROM (EE_OFFSET_AUTO_OFF + outPin);
+    if (duration != 0xff) {
+      return (duration);
     }
-    // E2Adr points to the length of Special Event searched for
-    SELength = readByteFromE2PROM (E2Adr);  
-    if (counter == 0) {
-      return (SELength);
-    } else if (counter > SELength) {
-      return (0);
-    } else {
-      SECmd = readByteFromE2PROM (E2Adr + counter);  
-      return (SECmd); 
-    }    
+    // not configured (EEPROM of an older Layout)
+  }
+  return (0);
+}
+
+/************************************************************
+ * getRollerPosFromEEprom (public)
+ ************************************************************
+ * @param[in] roller Number of the Roller (1 to 4)
+ * @returns Position stored on the last Stop [%], 
+ *          ROLLER_POS_UNKNOWN if unknown
+ ************************************************************/
+uint8_t config::getRollerPosFromEEprom (uint8_t roller) {
+  uint8_t pos;
+  pos = readByteFromE2PROM (EE_OFFSET_ROLLER_POS + roller - 1);
+  if (pos > 100) {
+    pos = ROLLER_POS_UNKNOWN;
+  }
+  return (pos);
+}
+
+/************************************************************
+ * getInputFromEEprom (public)
+ ************************************************************
+ * @param[in]  inPin  Input Pin (0-31)
+ * @param[out] cls    Button Timing Class (invalid: Class 0)
+ * @param[out] invert Polarity inverted (Switch to GND = 1)
+ * @param[out] pullup Pull-Up enabled
+ * @param[out] hold   Hold Events instead of Long-Click
+ ************************************************************/
+void config::getInputFromEEprom (uint8_t inPin, uint8_t& cls, boolean& invert, boolean& pullup, boolean& hold) {
+  uint8_t mode;
+  mode = readByteFromE2PROM (EE_OFFSET_INPUT + inPin);
+  if (mode == 0xff) {
+    // not configured (EEPROM of an older Layout)
+    mode = getFactoryDefaultInput(inPin);
+  }
+  cls = mode & INMODE_CLASS;
+  if (cls >= BUTTON_CLASSES) {
+    cls = BUTTON_CLASS_STANDARD;
+  }
+  invert = (mode & INMODE_INVERT) != 0;
+  pullup = (mode & INMODE_PULLUP) != 0;
+  hold = (mode & INMODE_HOLD) != 0;
+}
+
+/************************************************************
+ * getFactoryDefaultInput (private)
+ ************************************************************
+ * @param[in] inPin Input Pin (0-31)
+ * @returns Mode of the Input in FactoryDefaultInputTable,
+ *          BUTTON_CLASS_STANDARD | INPUT_LOW_ACTIVE if not 
+ *          listed
+ ************************************************************/
+uint8_t config::getFactoryDefaultInput (uint8_t inPin) {
+  uint8_t FDTableSize;
+  uint8_t entryNum;
+  uint8_t cls;
+  FDTableSize = readFactoryDefaultTable (TABLE_INDEX_INPUT, 0, 0) / 3;
+  for (entryNum = 0; entryNum < FDTableSize; entryNum++ ) {
+    cls = readFactoryDefaultTable (TABLE_INDEX_INPUT, 2, entryNum);
+    if ((readFactoryDefaultTable (TABLE_INDEX_INPUT, 1, entryNum) == inPin) && (cls < BUTTON_CLASSES)) {
+      return (cls | readFactoryDefaultTable (TABLE_INDEX_INPUT, 3, entryNum));
+    }
+  }
+  return (BUTTON_CLASS_STANDARD | INPUT_LOW_ACTIVE);
+}
+
+/************************************************************
+ * getButtonClassFromEEprom (public)
+ ************************************************************
+ * @param[in]  cls Button Timing Class (0 to BUTTON_CLASSES-1)
+ * @param[out] t0  Press shorter than t0 is Noise [ms]
+ * @param[out] t1  Press held for t1 is a Long Click [ms]
+ * @param[out] t2  Double Click Window [ms], 0: none
+ * @param[out] tr  Repeat Interval of Hold Events [ms], 0: none
+ * Bytes 0xff (not configured, EEPROM of an older Layout):
+ * Factory Default of the Class (Class 0: BUTTON_T0/T1/T2/TR)
+ ************************************************************/
+void config::getButtonClassFromEEprom (uint8_t cls, uint8_t& t0, uint16_t& t1, uint16_t& t2, uint16_t& tr) {
+  uint16_t E2Adr;
+  uint8_t t[BUTTON_CLASS_SIZE];
+  uint8_t i;
+  E2Adr = EE_OFFSET_BUTTON_CLASS + (cls * BUTTON_CLASS_SIZE);
+  for (i = 0; i < BUTTON_CLASS_SIZE; i++) {
+    t[i] = readByteFromE2PROM (E2Adr + i);
+    if (t[i] == 0xff) {
+      t[i] = readFactoryDefaultTable (TABLE_INDEX_BUTTON_CLASS, i + 1, cls);
+    }
+  }
+  t0 = t[0];
+  t1 = (uint16_t)t[1] * 10;
+  t2 = (uint16_t)t[2] * 10;
+  tr = (uint16_t)t[3] * 10;
+}
+
+/************************************************************
+ * getRuleFromEEprom (public)
+ ************************************************************
+ * @param[in]  rule   Number of the Rule (0 to RULE_MAX-1)
+ * @param[out] action One-Byte Command [CCCP PPPP]
+ * @param[out] outOn  Outputs which must be on
+ * @param[out] outOff Outputs which must be off
+ * @param[out] inOn   Inputs which must be active
+ * @param[out] inOff  Inputs which must not be active
+ * @returns Trigger RULE_TRIGGER(Click Type, Input), 
+ *          RULE_NONE if not configured
+ ************************************************************/
+uint8_t config::getRuleFromEEprom (uint8_t rule, uint8_t& action, uint32_t& outOn, uint32_t& outOff, uint32_t& inOn, uint32_t& inOff) {
+  uint16_t E2Adr;
+  E2Adr = EE_OFFSET_RULE + (rule * RULE_SIZE);
+  action = readByteFromE2PROM (E2Adr + 1);
+  outOn = readMaskFromE2PROM (E2Adr + 2);
+  outOff = readMaskFromE2PROM (E2Adr + 6);
+  inOn = readMaskFromE2PROM (E2Adr + 10);
+  inOff = readMaskFromE2PROM (E2Adr + 14);
+  return (readByteFromE2PROM (E2Adr));
+}
+
+/************************************************************
+ * getChordFromEEprom (public)
+ ************************************************************
+ * @param[in]  chord  Number of the Chord (0 to CHORD_MAX-1)
+ * @param[out] inputs Inputs of the Chord, CHORD_NONE if 
+ *                    not configured or invalid
+ * @returns One-Byte Command [CCCP PPPP]
+ ************************************************************/
+uint8_t config::getChordFromEEprom (uint8_t chord, uint32_t& inputs) {
+  uint16_t E2Adr;
+  E2Adr = EE_OFFSET_CHORD + 1 + (chord * 5);
+  inputs = readMaskFromE2PROM (E2Adr);
+  if ((inputs & (inputs - 1)) == 0) {
+    // less than 2 Inputs: invalid
+    inputs = CHORD_NONE;
+  }
+  return (readByteFromE2PROM (E2Adr + 4));
+}
+
+/************************************************************
+ * getChordWindowFromEEprom (public)
+ ************************************************************
+ * @returns [ms] all Inputs of a Chord pressed within,
+ *          CHORD_WINDOW if not configured
+ ************************************************************/
+uint8_t config::getChordWindowFromEEprom (void) {
+  uint8_t window;
+  window = readByteFromE2PROM (EE_OFFSET_CHORD);
+  if (window == 0xff) {
+    // not configured (EEPROM of an older Layout)
+    window = CHORD_WINDOW;
+  }
+  return (window);
+}
+
+/************************************************************
+ * setRollerPosToEEprom (public)
+ ************************************************************
+ * Written only if changed (EEPROM Endurance)
+ * @param[in] roller Number of the Roller (1 to 4)
+ * @param[in] pos Position [%] or ROLLER_POS_UNKNOWN
+ ************************************************************/
+void config::setRollerPosToEEprom (uint8_t roller, uint8_t pos) {
+  updateByteToE2PROM (EE_OFFSET_ROLLER_POS + roller - 1, pos);
+}
+
+/************************************************************
+ * setClickCommandToEEprom (public)
+ ************************************************************
+ * @param[in] clickType BUTTON_CLICK, BUTTON_CLICK_DOUBLE or BUTTON_CLICK_LONG
+ * @param[in] inPin Input Pin (0-31)
+ * @param[in] cmdByte Command [CCCP PPPP], 0: no Action
+ * @returns false if out of Range
+ ************************************************************/
+boolean config::setClickCommandToEEprom (uint8_t clickType, uint8_t inPin, uint8_t cmdByte) {
+  if ((inPin >= MCP_IN_PINS) || (clickType > BUTTON_CLICK_LONG)) {
+    return (false);
+  }
+  updateByteToE2PROM (EE_OFFSET_CLICK + inPin + (clickType * MCP_IN_PINS), cmdByte);
+  return (true);
+}
+
+/************************************************************
+ * setRollerToEEprom (public)
+ ************************************************************
+ * @param[in] roller Number of the Roller (1 to 4)
+ * @param[in] upPin Output up (Down: following Terminal),
+ *                  ROLLER_NC if not connected
+ * @param[in] upTime Time to move completely up [500ms]
+ * @param[in] downTime Time to move completely down [500ms]
+ * @param[in] defaultTime Time to move down to Close Position [500ms]
+ * @returns false if out of Range
+ ************************************************************/
+boolean config::setRollerToEEprom (uint8_t roller, uint8_t upPin, uint8_t upTime, uint8_t downTime, uint8_t defaultTime) {
+  uint16_t E2Adr;
+  if ((roller < 1) || (roller > 4) || ((upPin >= MCP_OUT_PINS) && (upPin != ROLLER_NC))) {
+    return (false);
+  }
+  E2Adr = EE_OFFSET_ROLLER + ((roller - 1) * 4);
+  updateByteToE2PROM (E2Adr, upPin);
+  updateByteToE2PROM (E2Adr + 1, upTime);
+  updateByteToE2PROM (E2Adr + 2, downTime);
+  updateByteToE2PROM (E2Adr + 3, defaultTime);
+  return (true);
+}
+
+/************************************************************
+ * setInputToEEprom (public)
+ ************************************************************
+ * @param[in] inPin  Input Pin (0-31)
+ * @param[in] cls    Button Timing Class (0 to BUTTON_CLASSES-1)
+ * @param[in] invert Polarity inverted (Switch to GND = 1)
+ * @param[in] pullup Pull-Up enabled
+ * @param[in] hold   Hold Events instead of Long-Click
+ * @returns false if out of Range
+ ************************************************************/
+boolean config::setInputToEEprom (uint8_t inPin, uint8_t cls, boolean invert, boolean pullup, boolean hold) {
+  if ((inPin >= MCP_IN_PINS) || (cls >= BUTTON_CLASSES)) {
+    return (false);
+  }
+  updateByteToE2PROM (EE_OFFSET_INPUT + inPin, cls | (invert ? INMODE_INVERT : 0) | (pullup ? INMODE_PULLUP : 0) | (hold ? INMODE_HOLD : 0));
+  return (true);
+}
+
+/************************************************************
+ * setButtonClassToEEprom (public)
+ ************************************************************
+ * @param[in] cls Button Timing Class (0 to BUTTON_CLASSES-1)
+ * @param[in] t0  Noise Filter [ms] (max. 254)
+ * @param[in] t1  Long Click [ms] (max. 2540, Steps of 10ms)
+ * @param[in] t2  Double Click Window [ms] (max. 2540, 0: none)
+ * @param[in] tr  Repeat Interval [ms] (max. 2540, 0: none)
+ * (0xff is reserved for "not configured")
+ * @returns false if out of Range
+ ************************************************************/
+boolean config::setButtonClassToEEprom (uint8_t cls, uint16_t t0, uint16_t t1, uint16_t t2, uint16_t tr) {
+  uint16_t E2Adr;
+  if ((cls >= BUTTON_CLASSES) || (t0 > 254) || (t1 > 2549) || (t2 > 2549) || (tr > 2549) || (t1 <= t0)) {
+    return (false);
+  }
+  E2Adr = EE_OFFSET_BUTTON_CLASS + (cls * BUTTON_CLASS_SIZE);
+  updateByteToE2PROM (E2Adr, t0);
+  updateByteToE2PROM (E2Adr + 1, t1 / 10);
+  updateByteToE2PROM (E2Adr + 2, t2 / 10);
+  updateByteToE2PROM (E2Adr + 3, tr / 10);
+  return (true);
+}
+
+/************************************************************
+ * setChordToEEprom (public)
+ ************************************************************
+ * @param[in] chord   Number of the Chord (0 to CHORD_MAX-1)
+ * @param[in] inputs  Inputs (at least 2), CHORD_NONE: clear
+ * @param[in] cmdByte Command [CCCP PPPP]
+ * @returns false if out of Range
+ ************************************************************/
+boolean config::setChordToEEprom (uint8_t chord, uint32_t inputs, uint8_t cmdByte) {
+  uint16_t E2Adr;
+  int8_t i;
+  if ((chord >= CHORD_MAX) || ((inputs & (inputs - 1)) == 0)) {
+    return (false);
+  }
+  E2Adr = EE_OFFSET_CHORD + 1 + (chord * 5);
+  for (i = 3; i >= 0; i--) {
+    updateByteToE2PROM (E2Adr++, (uint8_t)(inputs >> (8 * i)));
+  }
+  updateByteToE2PROM (E2Adr, cmdByte);
+  return (true);
+}
+
+/************************************************************
+ * setChordWindowToEEprom (public)
+ ************************************************************
+ * @param[in] window [ms] all Inputs of a Chord pressed within
+ *                   (max. 254, 0xff is reserved)
+ * @returns false if out of Range
+ ************************************************************/
+boolean config::setChordWindowToEEprom (uint16_t window) {
+  if (window > 254) {
+    return (false);
+  }
+  updateByteToE2PROM (EE_OFFSET_CHORD, window);
+  return (true);
+}
+
+/************************************************************
+ * clearSpecialEventInEEprom (public)
+ ************************************************************
+ * Remove all Commands of a Special Event, the following 
+ * Special Events are moved down.
+ * Number of Special Events + 1: append an empty Special Event
+ * @param[in] specialEvent # of Special Event - STARTING WITH 1
+ * @returns false if out of Range or Table full
+ ************************************************************/
+boolean config::clearSpecialEventInEEprom (uint8_t specialEvent) {
+  uint16_t E2Adr;
+  if ((specialEvent == _seNum + 1) && (specialEvent <= SE_MAX)) {
+    // new Special Event at the End of the Table
+    if (_seOffset[_seNum] >= EE_SIZE_SPECIAL_EVENT) {
+      return (false);
+    }
+    updateByteToE2PROM (EE_OFFSET_SPECIAL_EVENT + _seOffset[_seNum], 0);
+    _seOffset[_seNum + 1] = _seOffset[_seNum] + 1;
+    _seNum++;
+    updateByteToE2PROM (EE_OFFSET_SPECIAL_EVENT, _seNum);
+    return (true);
+  }
+  if ((specialEvent < 1) || (specialEvent > _seNum)) {
+    return (false);
+  }
+  E2Adr = EE_OFFSET_SPECIAL_EVENT + _seOffset[specialEvent - 1];
+  moveSpecialEvents (specialEvent, -(int16_t)readByteFromE2PROM (E2Adr));
+  updateByteToE2PROM (E2Adr, 0);
+  return (true);
+}
+
+/************************************************************
+ * appendSpecialEventToEEprom (public)
+ ************************************************************
+ * Append Bytes to a Special Event, the following Special 
+ * Events are moved up.
+ * @param[in] specialEvent # of Special Event - STARTING WITH 1
+ * @param[in] cmd Bytes to be appended
+ * @param[in] n Number of Bytes
+ * @returns false if out of Range or Table full
+ ************************************************************/
+boolean config::appendSpecialEventToEEprom (uint8_t specialEvent, const uint8_t* cmd, uint8_t n) {
+  uint16_t E2Adr;
+  uint8_t len;
+  uint8_t i;
+  if ((specialEvent < 1) || (specialEvent > _seNum)) {
+    return (false);
+  }
+  E2Adr = EE_OFFSET_SPECIAL_EVENT + _seOffset[specialEvent - 1];
+  len = readByteFromE2PROM (E2Adr);
+  if (((uint16_t)len + n > 0xff) || !moveSpecialEvents (specialEvent, n)) {
+    return (false);
+  }
+  for (i = 0; i < n; i++) {
+    updateByteToE2PROM (E2Adr + 1 + len + i, cmd[i]);
+  }
+  updateByteToE2PROM (E2Adr, len + n);
+  return (true);
+}
+
+/************************************************************
+ * getImageFromEEprom (public)
+ ************************************************************
+ * Block Read of the Configuration Image
+ * @param[in]  offset First Byte (0 ... EE_CONFIG_SIZE - 1)
+ * @param[out] buf Bytes read
+ * @param[in]  n Number of Bytes
+ * @returns false if out of Range
+ ************************************************************/
+boolean config::getImageFromEEprom (uint16_t offset, uint8_t* buf, uint8_t n) {
+  if (offset + n > EE_CONFIG_SIZE) {
+    return (false);
+  }
+  PROF_ENTER(PROF_CONFIG);
+  eeprom_read_block(buf, (const void*)offset, n);
+  PROF_EXIT(PROF_CONFIG);
+  return (true);
+}
+
+/************************************************************
+ * setImageToEEprom (public)
+ ************************************************************
+ * Block Write of the Configuration Image, only changed 
+ * Bytes are written (BLOCKING: 3.4ms per changed Byte)
+ * @param[in] offset First Byte (0 ... EE_CONFIG_SIZE - 1)
+ * @param[in] buf Bytes to be written
+ * @param[in] n Number of Bytes
+ * @returns false if out of Range
+ ************************************************************/
+boolean config::setImageToEEprom (uint16_t offset, const uint8_t* buf, uint8_t n) {
+  if (offset + n > EE_CONFIG_SIZE) {
+    return (false);
   }
+  PROF_ENTER(PROF_CONFIG);
+  eeprom_update_block(buf, (void*)offset, n);
+  PROF_EXIT(PROF_CONFIG);
+  return (true);
+}
+
+/************************************************************
+ * getImageValidFromEEprom (public)
+ ************************************************************
+ * @returns false if an Upload was aborted after the first
+ *          Chunk (Image partly written)
+ ************************************************************/
+boolean config::getImageValidFromEEprom (void) {
+  return (readByteFromE2PROM (EE_OFFSET_CONFIG_VALID) != 0);
+}
+
+/************************************************************
+ * setImageValidToEEprom (public)
+ ************************************************************
+ * Cleared before an Upload writes the first Chunk, set after
+ * the Image has been verified (or reset to Factory Defaults)
+ * @param[in] valid Image completely written
+ ************************************************************/
+void config::setImageValidToEEprom (boolean valid) {
+  updateByteToE2PROM (EE_OFFSET_CONFIG_VALID, valid ? 0xff : 0);
+}
+
+/************************************************************
+ * indexSpecialEvents (private)
+ ************************************************************
+ * Find the Start of all Special Events, an invalid Table 
+ * (e.g. EEPROM not initialized) has no Special Events
+ ************************************************************/
+void config::indexSpecialEvents (void) {
+  uint8_t i;
+  uint16_t offset;
+  _seNum = readByteFromE2PROM (EE_OFFSET_SPECIAL_EVENT);
+  offset = 1;
+  if (_seNum <= SE_MAX) {
+    for (i = 0; i < _seNum; i++) {
+      _seOffset[i] = offset;
+      offset += readByteFromE2PROM (EE_OFFSET_SPECIAL_EVENT + offset) + 1;
+      if (offset > EE_SIZE_SPECIAL_EVENT) {
+        break;
+      }
+    }
+  }
+  if ((_seNum > SE_MAX) || (offset > EE_SIZE_SPECIAL_EVENT)) {
+    DBG_ERROR.println(F("ERROR: Special Event Table invalid"));
+    _seNum = 0;
+    offset = 1;
+  }
+  _seOffset[_seNum] = offset;
+}
+
+/************************************************************
+ * moveSpecialEvents (private)
+ ************************************************************
+ * Move all Special Events following a Special Event and 
+ * patch their Index
+ * @param[in] specialEvent # of Special Event - STARTING WITH 1
+ * @param[in] delta Bytes to move (> 0: up, < 0: down)
+ * @returns false if the Table would not fit
+ ************************************************************/
+boolean config::moveSpecialEvents (uint8_t specialEvent, int16_t delta) {
+  uint16_t from;
+  uint16_t to;
+  uint16_t i;
+  uint8_t n;
+  from = EE_OFFSET_SPECIAL_EVENT + _seOffset[specialEvent];
+  to = EE_OFFSET_SPECIAL_EVENT + _seOffset[_seNum];
+  if ((int16_t)_seOffset[_seNum] + delta > EE_SIZE_SPECIAL_EVENT) {
+    return (false);
+  }
+  if (delta > 0) {
+    for (i = to; i > from; i--) {
+      updateByteToE2PROM (i - 1 + delta, readByteFromE2PROM (i - 1));
+    }
+  } else if (delta < 0) {
+    for (i = from; i < to; i++) {
+      updateByteToE2PROM (i + delta, readByteFromE2PROM (i));
+    }
+  }
+  for (n = specialEvent; n <= _seNum; n++) {
+    _seOffset[n] += delta;
+  }
+  return (true);
 }
 
 /************************************************************
@@ -664,6 +1397,19 @@ void config::printSpecialEventsConfiguration(void) {
           case CMD_OFF_MASK:
             addParams = 4;
             break;          
+          // 3-Byte Commands
+          case CMD_ROLLER_POS:
+            addParams = 2;
+            break;
+          // 6-Byte Commands
+          case CMD_REMOTE_ON:
+          case CMD_REMOTE_OFF:
+          case CMD_REMOTE_TOGGLE:
+            addParams = 5;
+            break;
+          default:
+            addParams = 0;
+            break;
         };
         DBG.print(F(" - Params: "));
         for (paramCnt = 0; paramCnt < addParams; paramCnt++){
@@ -685,6 +1431,225 @@ void config::printSpecialEventsConfiguration(void) {
 }
 
 
+/************************************************************
+ * printAutoOffConfiguration (private)
+ ************************************************************  
+ * Prints all Outputs with an Auto-Off Duration
+ ************************************************************/
+void config::printAutoOffConfiguration(void) {
+  uint8_t outPin;
+  uint8_t duration;
+  for (outPin = 0; outPin < MCP_OUT_PINS; outPin++) {
+    duration = getAutoOffFromEEprom(outPin);
+    if (duration != 0) {
+      DBG.print(F(" - Output "));
+      DBG.print(outPin);
+      DBG.print(F(": "));
+      DBG.print((uint16_t)duration * 10);
+      DBG.println(F("s"));
+    }
+  }
+}
+
+
+/************************************************************
+ * printInputConfiguration (private)
+ ************************************************************  
+ * Prints the Button Timing Classes and all Inputs which
+ * are not Class 0 and low active or report Hold Events
+ ************************************************************/
+void config::printInputConfiguration(void) {
+  uint8_t cls;
+  uint8_t inPin;
+  uint8_t t0;
+  uint16_t t1;
+  uint16_t t2;
+  uint16_t tr;
+  boolean invert;
+  boolean pullup;
+  boolean hold;
+  for (cls = 0; cls < BUTTON_CLASSES; cls++) {
+    getButtonClassFromEEprom(cls, t0, t1, t2, tr);
+    DBG.print(F(" - Class "));
+    DBG.print(cls);
+    DBG.print(F(": T0 "));
+    DBG.print(t0);
+    DBG.print(F("ms, T1 "));
+    DBG.print(t1);
+    DBG.print(F("ms, T2 "));
+    DBG.print(t2);
+    DBG.print(F("ms, TR "));
+    DBG.print(tr);
+    DBG.println(F("ms"));
+  }
+  for (inPin = 0; inPin < MCP_IN_PINS; inPin++) {
+    getInputFromEEprom(inPin, cls, invert, pullup, hold);
+    if ((cls != BUTTON_CLASS_STANDARD) || !invert || !pullup || hold) {
+      DBG.print(F(" - Input "));
+      DBG.print(inPin);
+      DBG.print(F(": Class "));
+      DBG.print(cls);
+      if (invert) {
+        DBG.print(F(", inverted"));
+      }
+      if (pullup) {
+        DBG.print(F(", Pull-Up"));
+      }
+      if (hold) {
+        DBG.print(F(", Hold"));
+      }
+      DBG.println();
+    }
+  }
+}
+
+
+/************************************************************
+ * printRuleConfiguration (private)
+ ************************************************************  
+ * Prints all configured Rules
+ * e.g.: " - Rule 0: Type 2 - Pin 6 - Out +0x0 -0x40000000 
+ *          - In +0x0 -0x0 - Cmd: 0x03"
+ ************************************************************/
+void config::printRuleConfiguration(void) {
+  uint8_t rule;
+  uint8_t trigger;
+  uint8_t action;
+  uint32_t outOn;
+  uint32_t outOff;
+  uint32_t inOn;
+  uint32_t inOff;
+  for (rule = 0; rule < RULE_MAX; rule++) {
+    trigger = getRuleFromEEprom(rule, action, outOn, outOff, inOn, inOff);
+    if (trigger == RULE_NONE) {
+      continue;
+    }
+    DBG.print(F(" - Rule "));
+    DBG.print(rule);
+    DBG.print(F(": Type "));
+    DBG.print(trigger >> 5);
+    DBG.print(F(" - Pin "));
+    DBG.print(trigger & 0x1f);
+    DBG.print(F(" - Out +0x"));
+    DBG.print(outOn, HEX);
+    DBG.print(F(" -0x"));
+    DBG.print(outOff, HEX);
+    DBG.print(F(" - In +0x"));
+    DBG.print(inOn, HEX);
+    DBG.print(F(" -0x"));
+    DBG.print(inOff, HEX);
+    DBG.print(F(" - Cmd: 0x"));
+    if (action < 0x10) {
+      DBG.print(F("0"));
+    }
+    DBG.println(action, HEX);
+  }
+}
+
+
+/************************************************************
+ * printChordConfiguration (private)
+ ************************************************************  
+ * Prints the Alignment Window and all configured Chords
+ * e.g.: " - Chord 0: Inputs 0x9000 - Cmd: 0x04"
+ ************************************************************/
+void config::printChordConfiguration(void) {
+  uint8_t chord;
+  uint8_t action;
+  uint32_t inputs;
+  DBG.print(F(" - Window: "));
+  DBG.print(getChordWindowFromEEprom());
+  DBG.println(F("ms"));
+  for (chord = 0; chord < CHORD_MAX; chord++) {
+    action = getChordFromEEprom(chord, inputs);
+    if (inputs == CHORD_NONE) {
+      continue;
+    }
+    DBG.print(F(" - Chord "));
+    DBG.print(chord);
+    DBG.print(F(": Inputs 0x"));
+    DBG.print(inputs, HEX);
+    DBG.print(F(" - Cmd: 0x"));
+    if (action < 0x10) {
+      DBG.print(F("0"));
+    }
+    DBG.println(action, HEX);
+  }
+}
+
+
+/************************************************************
+ * printScheduleConfiguration (public)
+ ************************************************************  
+ * Prints the Schedule stored in EEPROM 
+ * e.g.: " - 21:30   MTWTFSS - Cmd: 0xCF"
+ *       " - SS+015 MTWTFSS - Cmd: 0xC3"
+ ************************************************************/
+static const char schedDays[] PROGMEM = "MTWTFSS";
+
+void config::printScheduleConfiguration(void) {
+  uint8_t num;
+  uint8_t entry;
+  uint8_t weekdays;
+  uint8_t hour;
+  uint8_t minute;
+  uint8_t action;
+  uint8_t offset;
+  uint8_t i;
+  num = getScheduleNumFromEEprom();
+  for (entry = 0; entry < num; entry++) {
+    getScheduleFromEEprom(entry, weekdays, hour, minute, action);
+    DBG.print(F(" - "));
+    if (hour >= SCHED_SUNRISE) {
+      // Sunrise/Sunset + Offset: e.g. "SS+015"
+      if (hour == SCHED_SUNRISE) {
+        DBG.print(F("SR"));
+      } else {
+        DBG.print(F("SS"));
+      }
+      if (minute < SCHED_OFFSET(0)) {
+        DBG.print(F("-"));
+        offset = SCHED_OFFSET(0) - minute;
+      } else {
+        DBG.print(F("+"));
+        offset = minute - SCHED_OFFSET(0);
+      }
+      if (offset < 100) {
+        DBG.print(F("0"));
+      }
+      if (offset < 10) {
+        DBG.print(F("0"));
+      }
+      DBG.print(offset);
+    } else {
+      if (hour < 10) {
+        DBG.print(F("0"));
+      }
+      DBG.print(hour);
+      DBG.print(F(":"));
+      if (minute < 10) {
+        DBG.print(F("0"));
+      }
+      DBG.print(minute);
+      DBG.print(F("  "));
+    }
+    DBG.print(F(" "));
+    for (i = 0; i < 7; i++) {
+      if (weekdays & (1 << i)) {
+        DBG.print((char)pgm_read_byte(&schedDays[i]));
+      } else {
+        DBG.print(F("-"));
+      }
+    }
+    DBG.print(F(" - Cmd: 0x"));
+    if (action < 0x10) {
+      DBG.print(F("0"));
+    }
+    DBG.println(action, HEX);
+  }
+}
+
+
 /************************************************************
  * printConfig (public)
  ************************************************************ * 
@@ -707,4 +1672,19 @@ void config::printConfig (void) {
   // Special Events Configuration
   DBG.println(F("\nSpecial Events Configuration:"));  
   printSpecialEventsConfiguration();  
+  // Schedule
+  DBG.println(F("\nSchedule:"));  
+  printScheduleConfiguration();  
+  // Auto-Off
+  DBG.println(F("\nAuto-Off:"));  
+  printAutoOffConfiguration();  
+  // Inputs
+  DBG.println(F("\nInputs:"));  
+  printInputConfiguration();  
+  // Rules
+  DBG.println(F("\nRules:"));  
+  printRuleConfiguration();  
+  // Chords
+  DBG.println(F("\nChords:"));  
+  printChordConfiguration();  
 }
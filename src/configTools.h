@@ -9,11 +9,34 @@
  *   - getClickCommandFromEEprom: Read what shall be done whenn an Switch was clickef
  *   - getRollerFromEEprom: Read actual Roller Configuration
  *   - getSpecialEventFromEEprom: Read Special Events
+ *   - getScheduleFromEEprom: Read Schedule (Time of Day)
+ *   - getAutoOffFromEEprom: Read Auto-Off Duration of an Output
+ *   - getRollerPosFromEEprom: Read Roller Position of last Stop
+ *   - getInputFromEEprom: Read Timing Class, Polarity and Hold Mode of an Input
+ *   - getButtonClassFromEEprom: Read Times of a Timing Class
+ *   - getRuleFromEEprom: Read Trigger, Action and Condition of a Rule
+ *   - getChordFromEEprom, getChordWindowFromEEprom: Read Inputs
+ *     and Action of a Chord, Alignment Window of all Chords
+ * - setRollerPosToEEprom: Store Roller Position on Stop
+ * - Change Configuration (only the affected Bytes are written):
+ *   - setClickCommandToEEprom: Set/clear one Click Table Entry
+ *   - setRollerToEEprom: Set Output and Times of one Roller
+ *   - setInputToEEprom, setButtonClassToEEprom: Set Mode of
+ *     one Input, Times of one Timing Class
+ *   - setChordToEEprom, setChordWindowToEEprom: Set one Chord,
+ *     Alignment Window of all Chords
+ *   - clearSpecialEventInEEprom, appendSpecialEventToEEprom:
+ *     Edit one Special Event, the following Special Events
+ *     are moved and their Index is patched
+ * - getImageFromEEprom, setImageToEEprom: Block Access to the
+ *   Configuration Image (0 ... EE_CONFIG_SIZE, see configXfer.h)
+ * - getImageValidFromEEprom, setImageValidToEEprom: Image 
+ *   completely written (invalid after an aborted Upload)
  * - resetToFactoryDefaults: Reset Configuration to factrory default
  * - printConfig: Print Configuration stored in EEPROM 
  ************************************************************
- * ToDo-List
- * - Functions to change Configuration
+ * The Start of each Special Event is kept in an Index in RAM
+ * (built by begin(), no Walk through the Table per Byte)
  ************************************************************/ 
 #ifndef _CONFIGTOOLS_H_
 #define _CONFIGTOOLS_H_
@@ -25,20 +48,55 @@
 class config {
     public:
     // public functions
+    void begin (void);
     uint8_t getClickCommandFromEEprom (uint8_t clickType, uint8_t inPinNumber, uint8_t &cmd, uint8_t &par);
     void getRollerFromEEprom (uint8_t roller, uint8_t& upPin, uint8_t& downPin, uint8_t& upTime, uint8_t& downTime, uint8_t&  defaultTime);
     uint8_t getSpecialEventFromEEprom (uint8_t specialEvent, uint8_t counter);
+    uint8_t getScheduleNumFromEEprom (void);
+    void getScheduleFromEEprom (uint8_t entry, uint8_t& weekdays, uint8_t& hour, uint8_t& minute, uint8_t& action);
+    uint8_t getAutoOffFromEEprom (uint8_t outPin);
+    uint8_t getRollerPosFromEEprom (uint8_t roller);
+    void getInputFromEEprom (uint8_t inPin, uint8_t& cls, boolean& invert, boolean& pullup, boolean& hold);
+    void getButtonClassFromEEprom (uint8_t cls, uint8_t& t0, uint16_t& t1, uint16_t& t2, uint16_t& tr);
+    uint8_t getRuleFromEEprom (uint8_t rule, uint8_t& action, uint32_t& outOn, uint32_t& outOff, uint32_t& inOn, uint32_t& inOff);
+    uint8_t getChordFromEEprom (uint8_t chord, uint32_t& inputs);
+    uint8_t getChordWindowFromEEprom (void);
+    void setRollerPosToEEprom (uint8_t roller, uint8_t pos);
+    boolean setClickCommandToEEprom (uint8_t clickType, uint8_t inPin, uint8_t cmdByte);
+    boolean setRollerToEEprom (uint8_t roller, uint8_t upPin, uint8_t upTime, uint8_t downTime, uint8_t defaultTime);
+    boolean setInputToEEprom (uint8_t inPin, uint8_t cls, boolean invert, boolean pullup, boolean hold);
+    boolean setButtonClassToEEprom (uint8_t cls, uint16_t t0, uint16_t t1, uint16_t t2, uint16_t tr);
+    boolean setChordToEEprom (uint8_t chord, uint32_t inputs, uint8_t cmdByte);
+    boolean setChordWindowToEEprom (uint16_t window);
+    boolean clearSpecialEventInEEprom (uint8_t specialEvent);
+    boolean appendSpecialEventToEEprom (uint8_t specialEvent, const uint8_t* cmd, uint8_t n);
+    boolean getImageFromEEprom (uint16_t offset, uint8_t* buf, uint8_t n);
+    boolean setImageToEEprom (uint16_t offset, const uint8_t* buf, uint8_t n);
+    boolean getImageValidFromEEprom (void);
+    void setImageValidToEEprom (boolean valid);
     void resetToFactoryDefaults (void);
     void printConfig (void);
+    void printScheduleConfiguration (void);
 
     private:
     uint8_t readFactoryDefaultTable (uint8_t FDTableNum, uint8_t FDTableValType, uint8_t FDTableEntryNum);
+    uint8_t getFactoryDefaultInput (uint8_t inPin);
     uint8_t readByteFromE2PROM (uint16_t E2Adr);
+    uint32_t readMaskFromE2PROM (uint16_t E2Adr);
     void writeByteToE2PROM (uint16_t E2Adr, uint8_t E2Val);
+    void updateByteToE2PROM (uint16_t E2Adr, uint8_t E2Val);
+    void indexSpecialEvents (void);
+    boolean moveSpecialEvents (uint8_t specialEvent, int16_t delta);
     void printSpecialEventsConfiguration(void);
     void printClickCommand (uint8_t cType, uint8_t inPin);
     void printClickCommandTable (uint8_t cType);
     void printRollerConfiguration(void);
+    void printAutoOffConfiguration(void);
+    void printInputConfiguration(void);
+    void printRuleConfiguration(void);
+    void printChordConfiguration(void);
+    uint8_t _seNum;                   //!< Number of Special Events (0 if Table invalid)
+    uint8_t _seOffset[SE_MAX + 1];    //!< Offset of each Special Event, [_seNum]: End of Table
 };
 
 #endif  // _CONFIGTOOLS_H_
\ No newline at end of file
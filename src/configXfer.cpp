@@ -0,0 +1,271 @@
+/*!
+ * @file configXfer.cpp
+ */
+#include <configXfer.h>
+
+/************************************************************
+ * crc32
+ * CRC-32 (Polynom 0xEDB88320, as zlib), can be continued
+ * @param[in] crc CRC of the previous Bytes (0 at Start)
+ * @param[in] buf Bytes
+ * @param[in] n Number of Bytes
+ * @returns CRC including buf
+ ************************************************************/
+static uint32_t crc32(uint32_t crc, const uint8_t* buf, uint8_t n) {
+  uint8_t i;
+  crc = ~crc;
+  while (n--) {
+    crc ^= *buf++;
+    for (i = 0; i < 8; i++) {
+      crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1)));
+    }
+  }
+  return (~crc);
+}
+
+/************************************************************
+ * begin (public)
+ * @param[in] cfg     Configuration (EEPROM Access)
+ * @param[in] handler reloads the Configuration after an Upload
+ ************************************************************/
+void configXfer::begin (config& cfg, xferHandler handler) {
+  _config = &cfg;
+  _handler = handler;
+  _state = XFER_IDLE;
+}
+
+/************************************************************
+ * startDownload (public)
+ * Send the Header, the Image follows with poll()
+ ************************************************************/
+void configXfer::startDownload (void) {
+  _crc = imageCrc();
+  _seq = 0;
+  _retries = 0;
+  _state = XFER_SEND;
+  _lastTime = millis();
+  sendFrame();
+}
+
+/************************************************************
+ * startUpload (public)
+ * Receive the Image with poll()
+ ************************************************************/
+void configXfer::startUpload (void) {
+  _seq = 0;
+  _rxPos = 0;
+  _state = XFER_RECV;
+  _lastTime = millis();
+  Serial.write(XFER_ACK);
+}
+
+/************************************************************
+ * active (public)
+ * @returns true while a Transfer is running (Serial
+ *          Commands must not read from Serial)
+ ************************************************************/
+boolean configXfer::active (void) {
+  return (_state != XFER_IDLE);
+}
+
+/************************************************************
+ * poll (public)
+ * Process received Bytes, call every Loop while active()
+ ************************************************************/
+void configXfer::poll (void) {
+  uint8_t c;
+  if (_state == XFER_IDLE) {
+    return;
+  }
+  if (millis() - _lastTime > XFER_TIMEOUT) {
+    finish(XFER_CAN);
+    return;
+  }
+  while (Serial.available() && (_state != XFER_IDLE)) {
+    c = Serial.read();
+    _lastTime = millis();
+    if (_state == XFER_RECV) {
+      receive(c);
+    } else if (c == XFER_ACK) {
+      // next Frame, EOT after the last one
+      _retries = 0;
+      if ((uint16_t)_seq * XFER_CHUNK >= EE_CONFIG_SIZE) {
+        finish(XFER_EOT);
+      } else {
+        _seq++;
+        sendFrame();
+      }
+    } else if (c == XFER_NAK) {
+      if (++_retries > XFER_RETRIES) {
+        finish(XFER_CAN);
+      } else {
+        sendFrame();
+      }
+    } else if (c == XFER_CAN) {
+      finish(XFER_CAN);
+    }
+  }
+}
+
+/************************************************************
+ * sendFrame (private)
+ * Send Frame _seq (Header or Chunk of the Image)
+ ************************************************************/
+void configXfer::sendFrame (void) {
+  uint16_t offset;
+  uint8_t len;
+  uint32_t crc;
+  uint8_t i;
+  if (_seq == 0) {
+    len = 6;
+    _buf[2] = EE_CONFIG_SIZE & 0xff;
+    _buf[3] = EE_CONFIG_SIZE >> 8;
+    for (i = 0; i < 4; i++) {
+      _buf[4 + i] = (uint8_t)(_crc >> (8 * i));
+    }
+  } else {
+    offset = (uint16_t)(_seq - 1) * XFER_CHUNK;
+    len = min(XFER_CHUNK, EE_CONFIG_SIZE - offset);
+    _config->getImageFromEEprom(offset, &_buf[2], len);
+  }
+  _buf[0] = _seq;
+  _buf[1] = len;
+  crc = crc32(0, _buf, len + 2);
+  Serial.write(XFER_STX);
+  Serial.write(_buf, len + 2);
+  for (i = 0; i < 4; i++) {
+    Serial.write((uint8_t)(crc >> (8 * i)));
+  }
+}
+
+/************************************************************
+ * receive (private)
+ * Collect one Byte of a Frame
+ * @param[in] c received Byte
+ ************************************************************/
+void configXfer::receive (uint8_t c) {
+  if (_rxPos == 0) {
+    // wait for Start of Frame
+    if (c == XFER_STX) {
+      _rxPos = 1;
+    } else if (c == XFER_CAN) {
+      finish(XFER_CAN);
+    }
+    return;
+  }
+  _buf[_rxPos - 1] = c;
+  _rxPos++;
+  if ((_rxPos == 3) && (_buf[1] > XFER_CHUNK)) {
+    _rxPos = 0;
+    Serial.write(XFER_NAK);
+    return;
+  }
+  // Seq, Len, Data, CRC
+  if ((_rxPos > 2) && (_rxPos - 1 == _buf[1] + 6)) {
+    _rxPos = 0;
+    frameReceived();
+  }
+}
+
+/************************************************************
+ * frameReceived (private)
+ * Check a complete Frame, write a Chunk, verify the Image
+ * after the last Chunk
+ ************************************************************/
+void configXfer::frameReceived (void) {
+  uint8_t len = _buf[1];
+  uint16_t offset;
+  uint32_t crc;
+  uint8_t i;
+  crc = 0;
+  for (i = 0; i < 4; i++) {
+    crc |= (uint32_t)_buf[len + 2 + i] << (8 * i);
+  }
+  if (crc != crc32(0, _buf, len + 2)) {
+    Serial.write(XFER_NAK);
+    return;
+  }
+  if ((_seq != 0) && (_buf[0] == _seq - 1)) {
+    // ACK lost: Frame already written
+    Serial.write(XFER_ACK);
+    return;
+  }
+  if (_buf[0] != _seq) {
+    Serial.write(XFER_NAK);
+    return;
+  }
+  if (_seq == 0) {
+    // Header: Image must have the same Size
+    if ((len != 6) || (_buf[2] != (EE_CONFIG_SIZE & 0xff)) || (_buf[3] != (EE_CONFIG_SIZE >> 8))) {
+      finish(XFER_CAN);
+      return;
+    }
+    _crc = 0;
+    for (i = 0; i < 4; i++) {
+      _crc |= (uint32_t)_buf[4 + i] << (8 * i);
+    }
+    _seq++;
+    Serial.write(XFER_ACK);
+    return;
+  }
+  // all Chunks but the last one are full
+  offset = (uint16_t)(_seq - 1) * XFER_CHUNK;
+  if ((offset >= EE_CONFIG_SIZE) || (len != min(XFER_CHUNK, EE_CONFIG_SIZE - offset))) {
+    finish(XFER_CAN);
+    return;
+  }
+  if (_seq == 1) {
+    // invalid until verified
+    _config->setImageValidToEEprom(false);
+  }
+  _config->setImageToEEprom(offset, &_buf[2], len);
+  _seq++;
+  Serial.write(XFER_ACK);
+  if (offset + len >= EE_CONFIG_SIZE) {
+    // Verify
+    if (imageCrc() == _crc) {
+      _config->setImageValidToEEprom(true);
+      finish(XFER_EOT);
+    } else {
+      finish(XFER_CAN);
+    }
+  }
+}
+
+/************************************************************
+ * finish (private)
+ * End the Transfer, call the Handler if an Upload has
+ * written the EEPROM (verified or not)
+ * @param[in] result XFER_EOT: successful, XFER_CAN: aborted
+ ************************************************************/
+void configXfer::finish (uint8_t result) {
+  boolean written;
+  written = (_state == XFER_RECV) && (_seq > 1);
+  _state = XFER_IDLE;
+  Serial.write(result);
+  if (result == XFER_EOT) {
+    DBG.println(F("Config Transfer done"));
+  } else {
+    DBG_ERROR.println(F("ERROR: Config Transfer aborted"));
+  }
+  if (written) {
+    // Upload: reload the new (or partly written, invalid) Image
+    _handler();
+  }
+}
+
+/************************************************************
+ * imageCrc (private)
+ * @returns CRC-32 of the Configuration Image in EEPROM
+ ************************************************************/
+uint32_t configXfer::imageCrc (void) {
+  uint16_t offset;
+  uint8_t len;
+  uint32_t crc = 0;
+  for (offset = 0; offset < EE_CONFIG_SIZE; offset += len) {
+    len = min(XFER_CHUNK, EE_CONFIG_SIZE - offset);
+    _config->getImageFromEEprom(offset, &_buf[2], len);
+    crc = crc32(crc, &_buf[2], len);
+  }
+  return (crc);
+}
@@ -0,0 +1,80 @@
+/************************************************************
+ * This File implements the binary Configuration Transfer
+ ************************************************************
+ * The Configuration Image (EEPROM 0 ... EE_CONFIG_SIZE) is
+ * read or written over Serial in Frames (tools/cfgImage.py):
+ *   STX Seq Len Data[Len] CRC-32[4]
+ * - CRC-32 (as zlib, Little Endian) over Seq, Len and Data
+ * - Seq 0: Header, Data = Size[2] CRC-32 of the Image[4]
+ * - Seq 1 ...: XFER_CHUNK Bytes of the Image each
+ * - Each Frame is answered with ACK (NAK: send again)
+ * Download (Serial Command "cfgget"): the Controller sends,
+ *   the Host answers, EOT after the last ACK
+ * Upload (Serial Command "cfgput"): the Controller answers
+ *   ACK when ready, the Host sends. Each Chunk is written
+ *   with Block Update (only changed Bytes), all Chunks but
+ *   the last one must be full. After the last Chunk the 
+ *   Image is read back and its CRC-32 compared: EOT if 
+ *   equal, CAN if not. 
+ * - The Image is marked invalid in EEPROM before the first
+ *   Chunk is written and valid after the Verify. If the 
+ *   EEPROM has been written, the Handler reloads the 
+ *   Configuration after EOT and after an Abort (invalid 
+ *   Image, reported until a new Upload or "factory")
+ * - Text (Debug Output) between Frames is ignored by the
+ *   Host, CAN aborts, XFER_TIMEOUT without a Byte aborts
+ * - The Main Loop keeps running, only the EEPROM Write of a
+ *   Chunk blocks (max. 32 * 3.4ms)
+ ************************************************************/
+#ifndef _CONFIGXFER_H_
+#define _CONFIGXFER_H_
+
+#include <Arduino.h>
+#include <configTools.h>
+
+#define XFER_CHUNK           32     // Image Bytes per Frame
+#define XFER_TIMEOUT       2000     // [ms] max. Time without a Byte
+#define XFER_RETRIES          5     // max. Repetitions of a Frame
+#define XFER_STX           0x02     // Start of Frame
+#define XFER_EOT           0x04     // Transfer complete
+#define XFER_ACK           0x06     // Frame received
+#define XFER_NAK           0x15     // Frame invalid, send again
+#define XFER_CAN           0x18     // Abort
+
+// States
+#define XFER_IDLE             0     // no Transfer, Serial Commands active
+#define XFER_SEND             1     // Download: Frame sent, waiting for ACK
+#define XFER_RECV             2     // Upload: receiving Frames
+
+/********************************************************
+ * Handler after an Upload has written the EEPROM
+ ********************************************************/
+typedef void (*xferHandler)(void);
+
+class configXfer {
+    public:
+    // public functions
+    void begin (config& cfg, xferHandler handler);
+    void startDownload (void);
+    void startUpload (void);
+    boolean active (void);
+    void poll (void);
+
+    private:
+    void sendFrame (void);
+    void receive (uint8_t c);
+    void frameReceived (void);
+    void finish (uint8_t result);
+    uint32_t imageCrc (void);
+    config* _config;                  //!< Access to the EEPROM
+    xferHandler _handler;             //!< reloads the Configuration
+    uint8_t  _state;                  //!< XFER_IDLE, XFER_SEND, XFER_RECV
+    uint8_t  _seq;                    //!< actual Frame
+    uint8_t  _retries;                //!< Repetitions of actual Frame
+    uint8_t  _rxPos;                  //!< Bytes of Frame received (0: wait for STX)
+    uint32_t _crc;                    //!< CRC-32 of the Image (Header)
+    uint32_t _lastTime;               //!< millis() of last Byte
+    uint8_t  _buf[XFER_CHUNK + 6];    //!< Seq, Len, Data, CRC of a Frame
+};
+
+#endif  // _CONFIGXFER_H_
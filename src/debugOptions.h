@@ -18,6 +18,10 @@
 #define DEBUG_HEARTBEAT       1  // Debug Heartbeat
 #define DEBUG_OUTPUT          1  // Debug Output
 #define DEBUG_STATE_CHANGE    1  // Debug The Change of States
+#define DEBUG_EVENT           1  // Debug Click Events and Commands
+#define DEBUG_TRACE           1  // Latency Trace Statistics
+#define DEBUG_PROFILE         0  // Loop Profiler (Serial Command "prof") [~120 Byte RAM]
+#define DEBUG_HTTP            1  // HTTP Requests (Status, Route, Time)
 #define DEBUG_SETUP_DELAY     00 // Debug Delay during setup
 
 /************************************************************
@@ -33,6 +37,10 @@
 #define DBG_OUTPUT        if(DEBUG_OUTPUT)Serial 
 #define DBG_STATE         if(DEBUG_STATE)Serial 
 #define DBG_STATE_CHANGE  if(DEBUG_STATE_CHANGE)Serial 
+#define DBG_EVENT         if(DEBUG_EVENT)Serial 
+#define DBG_TRACE         if(DEBUG_TRACE)Serial 
+#define DBG_PROFILE       if(DEBUG_PROFILE)Serial 
+#define DBG_HTTP          if(DEBUG_HTTP)Serial 
 #define DBG_EE_INIT       if(DEBUG_EE_INIT)Serial 
 #define DBG_EE_WRITE      if(DEBUG_EE_WRITE)Serial 
 #define DBG_EE_READ       if(DEBUG_EE_READ)Serial 
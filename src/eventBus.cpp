@@ -0,0 +1,247 @@
+/*!
+ * @file eventBus.cpp
+ */
+#include <eventBus.h>
+#include <debugOptions.h>
+
+/************************************************************
+ * begin (public)
+ * @param[in] udp     Socket, joined to the Group
+ * @param[in] group   Multicast Group
+ * @param[in] node    own Node (1-254)
+ * @param[in] epoch   different after each Start (Reset Count)
+ * @param[in] handler Function switching the Outputs
+ ************************************************************/
+void eventBus::begin (UDP& udp, IPAddress group, uint8_t node, uint8_t epoch, busHandler handler) {
+  uint8_t i;
+  _udp = &udp;
+  _group = group;
+  _node = node;
+  _epoch = epoch;
+  _handler = handler;
+  _seq = 0;
+  _sentOutputs = 0;
+  _sentInputs = 0;
+  _sentTime = millis() - BUS_STATE_INTERVAL;
+  _tx = 0;
+  _rx = 0;
+  _dup = 0;
+  _bad = 0;
+  for (i = 0; i < BUS_PEERS; i++) {
+    _peer[i].node = BUS_NO_NODE;
+  }
+}
+
+/************************************************************
+ * sendOutputs (public)
+ * Switch Outputs of another Node (Frame sent BUS_REPEAT
+ * Times with the same Seq)
+ * @param[in] target Node, BUS_ALL: all Nodes
+ * @param[in] on     Outputs to be switched on
+ * @param[in] off    Outputs to be switched off
+ * @param[in] toggle Outputs to be toggled
+ ************************************************************/
+void eventBus::sendOutputs (uint8_t target, uint32_t on, uint32_t off, uint32_t toggle) {
+  uint8_t i;
+  _frame[BUS_HEADER] = target;
+  putMask(BUS_HEADER + 1, on);
+  putMask(BUS_HEADER + 5, off);
+  putMask(BUS_HEADER + 9, toggle);
+  for (i = 0; i < BUS_REPEAT; i++) {
+    send(BUS_TYPE_OUTPUTS, BUS_OUTPUTS_LEN);
+  }
+  _seq++;
+}
+
+/************************************************************
+ * update (public)
+ * Called each Loop: State Frame if Outputs or Inputs changed
+ * or after BUS_STATE_INTERVAL
+ * @param[in] outputs State of the Outputs
+ * @param[in] inputs  State of the Inputs
+ ************************************************************/
+void eventBus::update (uint32_t outputs, uint32_t inputs) {
+  if ((outputs == _sentOutputs) && (inputs == _sentInputs) &&
+      (millis() - _sentTime < BUS_STATE_INTERVAL)) {
+    return;
+  }
+  _sentOutputs = outputs;
+  _sentInputs = inputs;
+  _sentTime = millis();
+  putMask(BUS_HEADER, outputs);
+  putMask(BUS_HEADER + 4, inputs);
+  send(BUS_TYPE_STATE, BUS_STATE_LEN);
+  _seq++;
+}
+
+/************************************************************
+ * send (private)
+ * Complete the Header, send the Frame to the Group
+ * @param[in] type BUS_TYPE_xxx
+ * @param[in] len  Length of the Frame
+ ************************************************************/
+void eventBus::send (uint8_t type, uint8_t len) {
+  _frame[0] = BUS_MAGIC;
+  _frame[1] = (BUS_VERSION << 4) | type;
+  _frame[2] = _node;
+  _frame[3] = _epoch;
+  _frame[4] = _seq >> 8;
+  _frame[5] = _seq & 0xff;
+  _udp->beginPacket(_group, BUS_PORT);
+  _udp->write(_frame, len);
+  _udp->endPacket();
+  _tx++;
+}
+
+/************************************************************
+ * poll (public)
+ * Called each Loop: receive up to BUS_POLL_FRAMES Frames
+ ************************************************************/
+void eventBus::poll (void) {
+  uint8_t i;
+  int len;
+  for (i = 0; i < BUS_POLL_FRAMES; i++) {
+    len = _udp->parsePacket();
+    if (len <= 0) {
+      return;
+    }
+    if (len > BUS_FRAME_MAX) {
+      // not a Frame of this Bus
+      _bad++;
+      _udp->flush();
+      continue;
+    }
+    receive(_udp->read(_frame, len) == len ? len : 0);
+  }
+}
+
+/************************************************************
+ * receive (private)
+ * Check Header and Seq of a received Frame, dispatch it
+ * @param[in] len Length of the Frame in _frame
+ ************************************************************/
+void eventBus::receive (uint8_t len) {
+  busPeer* p;
+  uint16_t seq;
+  uint8_t type;
+  type = _frame[1] & 0x0f;
+  if ((len < BUS_HEADER) || (_frame[0] != BUS_MAGIC) || ((_frame[1] >> 4) != BUS_VERSION) ||
+      (_frame[2] == BUS_NO_NODE) || (_frame[2] == BUS_ALL) ||
+      !(((type == BUS_TYPE_OUTPUTS) && (len == BUS_OUTPUTS_LEN)) ||
+        ((type == BUS_TYPE_STATE) && (len == BUS_STATE_LEN)))) {
+    _bad++;
+    return;
+  }
+  if (_frame[2] == _node) {
+    // own Frame (Multicast Loopback)
+    return;
+  }
+  seq = ((uint16_t)_frame[4] << 8) | _frame[5];
+  p = peer(_frame[2]);
+  // same Start of the Peer (Epoch) and Seq not newer: Duplicate
+  if ((p->node == _frame[2]) && (p->epoch == _frame[3]) && ((uint16_t)(p->seq - seq) < BUS_SEQ_WINDOW)) {
+    _dup++;
+    return;
+  }
+  p->node = _frame[2];
+  p->epoch = _frame[3];
+  p->seq = seq;
+  p->lastSeen = millis();
+  _rx++;
+  if (type == BUS_TYPE_OUTPUTS) {
+    if ((_frame[BUS_HEADER] == _node) || (_frame[BUS_HEADER] == BUS_ALL)) {
+      DBG_EVENT.print(F("Bus - Node "));
+      DBG_EVENT.print(_frame[2]);
+      DBG_EVENT.println(F(": Outputs"));
+      _handler(getMask(BUS_HEADER + 1), getMask(BUS_HEADER + 5), getMask(BUS_HEADER + 9));
+    }
+  } else if (type == BUS_TYPE_STATE) {
+    p->outputs = getMask(BUS_HEADER);
+    p->inputs = getMask(BUS_HEADER + 4);
+  }
+}
+
+/************************************************************
+ * peer (private)
+ * @param[in] node Node
+ * @returns Entry of the Node, else a free one, else the
+ *          Entry not seen for the longest Time (to be
+ *          overwritten)
+ ************************************************************/
+busPeer* eventBus::peer (uint8_t node) {
+  uint8_t i;
+  busPeer* p;
+  uint32_t now;
+  now = millis();
+  p = &_peer[0];
+  for (i = 0; i < BUS_PEERS; i++) {
+    if (_peer[i].node == node) {
+      return (&_peer[i]);
+    }
+    if (p->node == BUS_NO_NODE) {
+      // keep the first free Entry
+      continue;
+    }
+    if ((_peer[i].node == BUS_NO_NODE) || (now - _peer[i].lastSeen > now - p->lastSeen)) {
+      p = &_peer[i];
+    }
+  }
+  return (p);
+}
+
+/************************************************************
+ * putMask, getMask (private)
+ * 32 Bit Mask in the Frame, MSB first
+ * @param[in] pos  Offset in the Frame
+ * @param[in] mask Mask to be written
+ ************************************************************/
+void eventBus::putMask (uint8_t pos, uint32_t mask) {
+  uint8_t i;
+  for (i = 0; i < 4; i++) {
+    _frame[pos + i] = mask >> 24;
+    mask <<= 8;
+  }
+}
+
+uint32_t eventBus::getMask (uint8_t pos) {
+  uint8_t i;
+  uint32_t mask;
+  mask = 0;
+  for (i = 0; i < 4; i++) {
+    mask = (mask << 8) | _frame[pos + i];
+  }
+  return (mask);
+}
+
+/************************************************************
+ * printState (public)
+ * e.g. "Bus: Node 1 - TX 12 - RX 10 - Dup 10 - Bad 0"
+ *      " - Node 2: Out 0x8001 In 0x0 - 1200ms ago"
+ ************************************************************/
+void eventBus::printState (void) {
+  uint8_t i;
+  DBG.print(F("Bus: Node "));
+  DBG.print(_node);
+  DBG.print(F(" - TX "));
+  DBG.print(_tx);
+  DBG.print(F(" - RX "));
+  DBG.print(_rx);
+  DBG.print(F(" - Dup "));
+  DBG.print(_dup);
+  DBG.print(F(" - Bad "));
+  DBG.println(_bad);
+  for (i = 0; i < BUS_PEERS; i++) {
+    if (_peer[i].node == BUS_NO_NODE) {
+      continue;
+    }
+    DBG.print(F(" - Node "));
+    DBG.print(_peer[i].node);
+    DBG.print(F(": Out 0x"));
+    DBG.print(_peer[i].outputs, HEX);
+    DBG.print(F(" In 0x"));
+    DBG.print(_peer[i].inputs, HEX);
+    DBG.print(F(" - "));
+    DBG.print(millis() - _peer[i].lastSeen);
+    DBG.println(F("ms ago"));
+  }
+}
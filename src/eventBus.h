@@ -0,0 +1,106 @@
+/************************************************************
+ * This File implements the Event Bus between Controllers
+ ************************************************************
+ * Broker-less UDP Multicast (BUS_GROUP:BUS_PORT): each Node
+ * sends to the Group and receives all Frames of the other
+ * Nodes (own Frames are ignored).
+ * Frame (Masks and Seq MSB first):
+ *   0: Magic BUS_MAGIC
+ *   1: Version [VVVV] + Type [TTTT]
+ *   2: Node (Sender, 1-254)
+ *   3: Epoch (changes with each Start of the Sender)
+ *   4: Seq (2 Byte, +1 per Frame of the Sender)
+ *   6: Payload
+ * - BUS_TYPE_OUTPUTS (19 Byte): Target Node (BUS_ALL: all),
+ *   on, off, toggle Mask (4 Byte each). The Target switches
+ *   its Outputs: ((out | on) & ~off) ^ toggle (one Call of
+ *   setOutputs() via the Handler). Sent BUS_REPEAT Times.
+ * - BUS_TYPE_STATE (14 Byte): Outputs, Inputs of the Sender
+ *   (4 Byte each), sent on each Change and every
+ *   BUS_STATE_INTERVAL, kept in the Peer Table
+ * Duplicates (repeated or late Frames) are dropped by Seq:
+ * a Seq up to BUS_SEQ_WINDOW behind the last Seq of the Peer
+ * is old, a larger Step back is a Restart of the Peer.
+ * A new Epoch is a Restart too: a Peer rebooting quickly
+ * starts again at Seq 0, its Frames are not dropped.
+ ************************************************************
+ * Masks use the packed Bits of the Receiver (as setOutputs())
+ * RAM: ~116 Byte (BUS_PEERS Peers, one Frame)
+ ************************************************************/
+#ifndef _EVENTBUS_H_
+#define _EVENTBUS_H_
+
+#include <Arduino.h>
+#include <Udp.h>
+#include <IPAddress.h>
+
+#define BUS_PORT           4210     // UDP Port
+#define BUS_MAGIC          0xB5     // first Byte of each Frame
+#define BUS_VERSION           2     // Frame Format
+#define BUS_TYPE_OUTPUTS      1     // switch Outputs of the Target
+#define BUS_TYPE_STATE        2     // Outputs and Inputs of the Sender
+#define BUS_ALL            0xff     // Target: all Nodes
+#define BUS_NO_NODE           0     // Peer Entry free
+#define BUS_HEADER            6     // Magic, Version/Type, Node, Epoch, Seq
+#define BUS_OUTPUTS_LEN      19     // Header, Target, 3 Masks
+#define BUS_STATE_LEN        14     // Header, 2 Masks
+#define BUS_FRAME_MAX        19     // longest Frame
+#define BUS_REPEAT            2     // Output Frames sent n Times (lost Packets)
+#define BUS_PEERS             4     // Nodes in the Peer Table
+#define BUS_SEQ_WINDOW       16     // Seq up to n behind: old Frame
+#define BUS_STATE_INTERVAL 10000    // [ms] State Frame without Change
+#define BUS_POLL_FRAMES       4     // max. Frames received per poll()
+
+/********************************************************
+ * Handler of an Output Frame for this Node
+ * @param[in] on     Outputs to be switched on
+ * @param[in] off    Outputs to be switched off
+ * @param[in] toggle Outputs to be toggled
+ ********************************************************/
+typedef void (*busHandler)(uint32_t on, uint32_t off, uint32_t toggle);
+
+/********************************************************
+ * Node in the Peer Table
+ ********************************************************/
+typedef struct {
+  uint8_t  node;                    //!< Node, BUS_NO_NODE if free
+  uint8_t  epoch;                   //!< Epoch of the last Frame
+  uint16_t seq;                     //!< last Seq received
+  uint32_t outputs;                 //!< last State Frame: Outputs
+  uint32_t inputs;                  //!< last State Frame: Inputs
+  uint32_t lastSeen;                //!< millis() of the last Frame
+} busPeer;
+
+class eventBus {
+    public:
+    // public functions
+    void begin (UDP& udp, IPAddress group, uint8_t node, uint8_t epoch, busHandler handler);
+    void sendOutputs (uint8_t target, uint32_t on, uint32_t off, uint32_t toggle);
+    void update (uint32_t outputs, uint32_t inputs);
+    void poll (void);
+    void printState (void);
+
+    private:
+    void send (uint8_t type, uint8_t len);
+    void receive (uint8_t len);
+    busPeer* peer (uint8_t node);
+    void putMask (uint8_t pos, uint32_t mask);
+    uint32_t getMask (uint8_t pos);
+    UDP*      _udp;                   //!< Socket (joined to the Group)
+    IPAddress _group;                 //!< Multicast Group
+    busHandler _handler;              //!< switches the Outputs
+    uint8_t  _node;                   //!< own Node
+    uint8_t  _epoch;                  //!< own Epoch (Start of this Node)
+    uint16_t _seq;                    //!< Seq of the next Frame
+    uint32_t _sentOutputs;            //!< State of the last State Frame
+    uint32_t _sentInputs;
+    uint32_t _sentTime;               //!< millis() of the last State Frame
+    uint16_t _tx;                     //!< Frames sent
+    uint16_t _rx;                     //!< Frames accepted
+    uint16_t _dup;                    //!< Duplicates dropped
+    uint16_t _bad;                    //!< invalid Frames
+    busPeer  _peer[BUS_PEERS];        //!< known Nodes
+    uint8_t  _frame[BUS_FRAME_MAX];   //!< Frame sent/received
+};
+
+#endif  // _EVENTBUS_H_
@@ -0,0 +1,438 @@
+/*!
+ * @file httpServer.cpp
+ */
+#include <httpServer.h>
+
+// JSON Templates ('$' + Key: live Value)
+static const char httpStateJson[] PROGMEM =
+  "{\"fw\":\"$v\",\"uptime\":$u,\"out\":$o,\"in\":$i,\"rollers\":[$r],\"minute\":$t}";
+static const char httpCountersJson[] PROGMEM =
+  "{\"uptime\":$u,\"resets\":[$x],\"i2cErrors\":[$e],\"timers\":$w,"
+  "\"http\":{\"requests\":$q,\"errors\":$f,\"maxUs\":$m,\"overBudget\":$b}}";
+static const char httpConfigJson[] PROGMEM =
+  "{\"click\":[$c],\"double\":[$d],\"long\":[$l],\"autoOff\":[$a]}";
+static const char httpStatsJson[] PROGMEM =
+  "{\"switches\":[$s],\"onMinutes\":[$n],\"presses\":[$p]}";
+static const char* const httpTemplates[] PROGMEM = {
+  httpStateJson, httpCountersJson, httpConfigJson, httpStateJson, httpStatsJson, httpStateJson
+};
+
+/************************************************************
+ * httpStream (public)
+ * @param[in] client Socket of the Response
+ ************************************************************/
+httpStream::httpStream (Client& client) {
+  _client = &client;
+  _len = 0;
+}
+
+/************************************************************
+ * write (public)
+ * Collect one Byte, write the Chunk when it is full
+ * @param[in] c Byte
+ * @returns 1
+ ************************************************************/
+size_t httpStream::write (uint8_t c) {
+  _buf[_len++] = c;
+  if (_len == HTTP_CHUNK) {
+    send();
+  }
+  return (1);
+}
+
+/************************************************************
+ * send (public)
+ * Write the collected Bytes to the Client
+ ************************************************************/
+void httpStream::send (void) {
+  if (_len) {
+    _client->write(_buf, _len);
+    _len = 0;
+  }
+}
+
+/************************************************************
+ * begin (public)
+ * @param[in] cfg     Configuration (Click Tables, Auto-Off)
+ * @param[in] value   Function printing the live Values
+ * @param[in] command Function executing POST /cmd
+ * @param[in] time    Function executing POST /time
+ ************************************************************/
+void httpServer::begin (config& cfg, httpValueHandler value, httpCommandHandler command, httpTimeHandler time) {
+  _config = &cfg;
+  _value = value;
+  _command = command;
+  _time = time;
+  _requests = 0;
+  _errors = 0;
+  _overBudget = 0;
+  _maxTime = 0;
+}
+
+/************************************************************
+ * handle (public)
+ * Receive one Request, execute it, stream the Response and
+ * close the Connection (BLOCKING, max. HTTP_TIMEOUT for the
+ * Request)
+ * @param[in] client connected Client with Data available
+ ************************************************************/
+void httpServer::handle (Client& client) {
+  httpRequest req;
+  uint32_t t;
+  t = micros();
+  receive(client, req);
+  if (req.status == 200) {
+    execute(req);
+  }
+  respond(client, req);
+  client.stop();
+  t = micros() - t;
+  _requests++;
+  if (req.status != 200) {
+    _errors++;
+  }
+  if (t > _maxTime) {
+    _maxTime = t;
+  }
+  if (t > HTTP_BUDGET) {
+    _overBudget++;
+  }
+  DBG_HTTP.print(F("HTTP: "));
+  DBG_HTTP.print(req.status);
+  DBG_HTTP.print(F(" - Route: "));
+  DBG_HTTP.print(req.route);
+  DBG_HTTP.print(F(" - "));
+  DBG_HTTP.print(t);
+  DBG_HTTP.println(F("us"));
+}
+
+/************************************************************
+ * receive (private)
+ * Read the Request in Blocks, parse it Line by Line:
+ * Request Line, Content-Length, Body (POST)
+ * @param[in]  client Socket
+ * @param[out] req    Route, Status and Body
+ ************************************************************/
+void httpServer::receive (Client& client, httpRequest& req) {
+  uint8_t buf[HTTP_CHUNK];
+  char line[HTTP_LINE_LEN + 1];
+  uint8_t len;          // Bytes in line
+  uint8_t lines;        // complete Lines received
+  uint16_t bodyLen;     // Body Bytes still expected
+  boolean inBody;
+  int n;
+  int i;
+  char c;
+  uint32_t start;
+  req.status = 0;
+  req.route = HTTP_ROUTE_STATE;
+  req.body[0] = 0;
+  len = 0;
+  lines = 0;
+  bodyLen = 0;
+  inBody = false;
+  start = millis();
+  while (req.status == 0) {
+    n = client.available();
+    if (n <= 0) {
+      if (!client.connected()) {
+        // closed before the End of the Request
+        req.status = 400;
+      } else if (millis() - start > HTTP_TIMEOUT) {
+        req.status = 408;
+      }
+      continue;
+    }
+    n = client.read(buf, (n < HTTP_CHUNK) ? n : HTTP_CHUNK);
+    for (i = 0; (i < n) && (req.status == 0); i++) {
+      c = buf[i];
+      if (inBody) {
+        if (len < HTTP_LINE_LEN) {
+          req.body[len++] = c;
+          req.body[len] = 0;
+        }
+        if (--bodyLen == 0) {
+          req.status = 200;
+        }
+      } else if (c == '\n') {
+        line[len] = 0;
+        if (lines == 0) {
+          requestLine(line, req);
+        } else if (len == 0) {
+          // End of Header
+          if (((req.route == HTTP_ROUTE_CMD) || (req.route == HTTP_ROUTE_TIME)) && bodyLen) {
+            inBody = true;
+          } else {
+            req.status = 200;
+          }
+        } else if (strncasecmp_P(line, PSTR("Content-Length:"), 15) == 0) {
+          bodyLen = atoi(line + 15);
+        }
+        lines++;
+        len = 0;
+      } else if ((c != '\r') && (len < HTTP_LINE_LEN)) {
+        line[len++] = c;
+      }
+    }
+  }
+}
+
+/************************************************************
+ * requestLine (private)
+ * e.g. "GET /state HTTP/1.0": Route of Method and Path,
+ * Status 404/405 if none
+ * @param[in]  line Request Line (modified)
+ * @param[out] req  Route, Status
+ ************************************************************/
+void httpServer::requestLine (char* line, httpRequest& req) {
+  char* path;
+  char* end;
+  boolean post;
+  path = strchr(line, ' ');
+  if (path == NULL) {
+    req.status = 400;
+    return;
+  }
+  *path++ = 0;
+  end = strpbrk(path, " ?");
+  if (end != NULL) {
+    *end = 0;
+  }
+  post = (strcmp_P(line, PSTR("POST")) == 0);
+  if (!post && (strcmp_P(line, PSTR("GET")) != 0)) {
+    req.status = 405;
+    return;
+  }
+  if ((strcmp_P(path, PSTR("/")) == 0) || (strcmp_P(path, PSTR("/state")) == 0)) {
+    req.route = HTTP_ROUTE_STATE;
+  } else if (strcmp_P(path, PSTR("/counters")) == 0) {
+    req.route = HTTP_ROUTE_COUNTERS;
+  } else if (strcmp_P(path, PSTR("/config")) == 0) {
+    req.route = HTTP_ROUTE_CONFIG;
+  } else if (strcmp_P(path, PSTR("/cmd")) == 0) {
+    req.route = HTTP_ROUTE_CMD;
+  } else if (strcmp_P(path, PSTR("/stats")) == 0) {
+    req.route = HTTP_ROUTE_STATS;
+  } else if (strcmp_P(path, PSTR("/time")) == 0) {
+    req.route = HTTP_ROUTE_TIME;
+  } else {
+    req.status = 404;
+    return;
+  }
+  if (post != ((req.route == HTTP_ROUTE_CMD) || (req.route == HTTP_ROUTE_TIME))) {
+    req.status = 405;
+  }
+}
+
+/************************************************************
+ * execute (private)
+ * POST /cmd: Body "c=N" (decimal or 0x hex), Status 400 if
+ * missing or out of Range, POST /time: see executeTime()
+ * @param[in] req Request
+ ************************************************************/
+void httpServer::execute (httpRequest& req) {
+  const char* p;
+  char* end;
+  uint32_t cmdByte;
+  if (req.route == HTTP_ROUTE_TIME) {
+    executeTime(req);
+    return;
+  }
+  if (req.route != HTTP_ROUTE_CMD) {
+    return;
+  }
+  p = req.body;
+  if ((p[0] != 'c') || (p[1] != '=')) {
+    req.status = 400;
+    return;
+  }
+  p += 2;
+  if ((p[0] == '0') && ((p[1] == 'x') || (p[1] == 'X'))) {
+    p += 2;
+    cmdByte = strtoul(p, &end, 16);
+  } else {
+    cmdByte = strtoul(p, &end, 10);
+  }
+  if ((end == p) || (cmdByte > 0xff) || ((*end != 0) && (*end != '&'))) {
+    req.status = 400;
+    return;
+  }
+  _command(cmdByte);
+}
+
+/************************************************************
+ * httpNumber
+ * @param[in] p Text
+ * @param[in] n Number of Digits
+ * @returns Value of n decimal Digits, -1 if not all Digits
+ ************************************************************/
+static int16_t httpNumber (const char* p, uint8_t n) {
+  int16_t v = 0;
+  for (; n; n--, p++) {
+    if ((*p < '0') || (*p > '9')) {
+      return (-1);
+    }
+    v = (v * 10) + (*p - '0');
+  }
+  return (v);
+}
+
+/************************************************************
+ * executeTime (private)
+ * POST /time: Body "t=YYYY-MM-DDTHH:MM:SS", Status 400 if
+ * the Format or a Field is invalid
+ * @param[in] req Request
+ ************************************************************/
+void httpServer::executeTime (httpRequest& req) {
+  const char* p = req.body;
+  int16_t year;
+  int16_t month;
+  int16_t day;
+  int16_t hour;
+  int16_t minute;
+  int16_t second;
+  if ((p[0] != 't') || (p[1] != '=') || (strlen(p) < 21) || (p[6] != '-') || (p[9] != '-') ||
+      (p[12] != 'T') || (p[15] != ':') || (p[18] != ':') || ((p[21] != 0) && (p[21] != '&'))) {
+    req.status = 400;
+    return;
+  }
+  year = httpNumber(p + 2, 4);
+  month = httpNumber(p + 7, 2);
+  day = httpNumber(p + 10, 2);
+  hour = httpNumber(p + 13, 2);
+  minute = httpNumber(p + 16, 2);
+  second = httpNumber(p + 19, 2);
+  if ((year < 2000) || (month < 1) || (month > 12) || (day < 1) || (day > 31) ||
+      (hour < 0) || (hour > 23) || (minute < 0) || (minute > 59) || (second < 0) || (second > 59)) {
+    req.status = 400;
+    return;
+  }
+  _time(year, month, day, hour, minute, second);
+}
+
+/************************************************************
+ * respond (private)
+ * Stream Status Line, Header and JSON Body
+ * @param[in] client Socket
+ * @param[in] req    Request
+ ************************************************************/
+void httpServer::respond (Client& client, const httpRequest& req) {
+  httpStream out(client);
+  out.print(F("HTTP/1.0 "));
+  out.print(req.status);
+  if (req.status == 200) {
+    out.print(F(" OK"));
+  } else if (req.status == 400) {
+    out.print(F(" Bad Request"));
+  } else if (req.status == 404) {
+    out.print(F(" Not Found"));
+  } else if (req.status == 405) {
+    out.print(F(" Method Not Allowed"));
+  } else {
+    out.print(F(" Request Timeout"));
+  }
+  out.print(F("\r\nContent-Type: application/json\r\nConnection: close\r\n\r\n"));
+  if (req.status == 200) {
+    sendTemplate(out, (const char*)pgm_read_word(&httpTemplates[req.route]));
+  } else {
+    out.print(F("{\"error\":"));
+    out.print(req.status);
+    out.print(F("}"));
+  }
+  out.send();
+}
+
+/************************************************************
+ * sendTemplate (private)
+ * Copy a Template from Flash, replace '$' + Key by its Value
+ * @param[in] out Response
+ * @param[in] tpl Template (PROGMEM)
+ ************************************************************/
+void httpServer::sendTemplate (Print& out, const char* tpl) {
+  char c;
+  while ((c = pgm_read_byte(tpl++)) != 0) {
+    if (c == HTTP_VAL_MARK) {
+      printValue(out, pgm_read_byte(tpl++));
+    } else {
+      out.write(c);
+    }
+  }
+}
+
+/************************************************************
+ * printValue (private)
+ * Values of the Server and the Configuration, else the
+ * Value Handler
+ * @param[in] out Response
+ * @param[in] key HTTP_VAL_xxx
+ ************************************************************/
+void httpServer::printValue (Print& out, uint8_t key) {
+  switch (key) {
+    case HTTP_VAL_REQUESTS:
+      out.print(_requests);
+      break;
+    case HTTP_VAL_ERRORS:
+      out.print(_errors);
+      break;
+    case HTTP_VAL_MAXTIME:
+      out.print(_maxTime);
+      break;
+    case HTTP_VAL_OVERBUDGET:
+      out.print(_overBudget);
+      break;
+    case HTTP_VAL_CLICK:
+    case HTTP_VAL_DOUBLE:
+    case HTTP_VAL_LONG:
+    case HTTP_VAL_AUTO_OFF:
+      printTable(out, key);
+      break;
+    default:
+      _value(key, out);
+      break;
+  }
+}
+
+/************************************************************
+ * printTable (private)
+ * 32 Entries of a Click Table or the Auto-Off Durations,
+ * comma separated
+ * @param[in] out   Response
+ * @param[in] table HTTP_VAL_CLICK, HTTP_VAL_DOUBLE,
+ *                  HTTP_VAL_LONG or HTTP_VAL_AUTO_OFF
+ ************************************************************/
+void httpServer::printTable (Print& out, uint8_t table) {
+  uint8_t i;
+  uint8_t cmd;
+  uint8_t par;
+  // Input Pins = Output Pins = 32
+  for (i = 0; i < MCP_IN_PINS; i++) {
+    if (i) {
+      out.write(',');
+    }
+    if (table == HTTP_VAL_CLICK) {
+      out.print(_config->getClickCommandFromEEprom(BUTTON_CLICK, i, cmd, par));
+    } else if (table == HTTP_VAL_DOUBLE) {
+      out.print(_config->getClickCommandFromEEprom(BUTTON_CLICK_DOUBLE, i, cmd, par));
+    } else if (table == HTTP_VAL_LONG) {
+      out.print(_config->getClickCommandFromEEprom(BUTTON_CLICK_LONG, i, cmd, par));
+    } else {
+      out.print(_config->getAutoOffFromEEprom(i));
+    }
+  }
+}
+
+/************************************************************
+ * printState (public)
+ * e.g. "HTTP: 12 Requests, 1 Errors, max. 3456us, 0 over Budget"
+ ************************************************************/
+void httpServer::printState (void) {
+  DBG.print(F("HTTP: "));
+  DBG.print(_requests);
+  DBG.print(F(" Requests, "));
+  DBG.print(_errors);
+  DBG.print(F(" Errors, max. "));
+  DBG.print(_maxTime);
+  DBG.print(F("us, "));
+  DBG.print(_overBudget);
+  DBG.println(F(" over Budget"));
+}
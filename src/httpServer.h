@@ -0,0 +1,159 @@
+/************************************************************
+ * This File implements the HTTP Status and Control Server
+ ************************************************************
+ * HTTP/1.0, one Request per Connection (the Server closes
+ * it after the Response), JSON Responses:
+ * - GET  /, /state: Firmware, Uptime, Outputs, Inputs,
+ *                   Roller Positions, Minute of Day
+ * - GET  /counters: Reset Counters, I2C Errors, Timers,
+ *                   HTTP Statistics
+ * - GET  /config:   Click Tables and Auto-Off Durations
+ * - GET  /stats:    Switches and On-Time [min] of the
+ *                   Outputs, Presses of the Inputs
+ * - POST /cmd:      Body "c=N": execute One-Byte Command N
+ *                   [CCCP PPPP] (e.g. c=0x61: toggle
+ *                   Output 1), Response as /state
+ * - POST /time:     Body "t=YYYY-MM-DDTHH:MM:SS" (local
+ *                   Time): set Date and Clock of the
+ *                   Scheduler, Response as /state
+ * Errors: 400, 404, 405, 408 with {"error":<Status>}
+ ************************************************************
+ * - The Responses are streamed from JSON Templates in Flash:
+ *   '$' + Key is replaced by a live Value, which is printed
+ *   directly (Keys HTTP_VAL_xxx: Values of main.cpp, passed
+ *   to the Value Handler). Output goes through one
+ *   HTTP_CHUNK Buffer into the Socket (one Write per Chunk,
+ *   no complete Response in RAM).
+ * - The Request is read in HTTP_CHUNK Blocks, only the
+ *   actual Line is kept (HTTP_LINE_LEN, longer Lines are
+ *   cut): Request Line, Content-Length, Body
+ * - The Server works on an Arduino Client (EthernetClient of
+ *   the W5500, or a Stand-In for Tests on the Host)
+ ************************************************************
+ * Budget:
+ * - RAM: 18 Byte static (+ Ethernet Library), ~180 Byte
+ *   Stack while a Request is handled (Line, Body, Chunk)
+ * - Time: HTTP_BUDGET [us] per Request (>= 20 Requests/s
+ *   with the Poll Interval), longer Requests are counted
+ ************************************************************/
+#ifndef _HTTPSERVER_H_
+#define _HTTPSERVER_H_
+
+#include <Arduino.h>
+#include <Client.h>
+#include <configTools.h>
+
+#define HTTP_PORT            80     // TCP Port
+#define HTTP_TIMEOUT        200     // [ms] max. Time to receive a Request
+#define HTTP_BUDGET       20000     // [us] max. Time per Request
+#define HTTP_LINE_LEN        32     // max. Length of Request Line, Header Line, Body
+#define HTTP_CHUNK           64     // [Byte] Socket Read/Write Block
+
+// Routes
+#define HTTP_ROUTE_STATE      0
+#define HTTP_ROUTE_COUNTERS   1
+#define HTTP_ROUTE_CONFIG     2
+#define HTTP_ROUTE_CMD        3
+#define HTTP_ROUTE_STATS      4
+#define HTTP_ROUTE_TIME       5
+
+// Keys of live Values in the Templates ('$' + Key), printed by the Value Handler
+#define HTTP_VAL_MARK       '$'
+#define HTTP_VAL_VERSION    'v'     // Firmware Version (without Quotes)
+#define HTTP_VAL_UPTIME     'u'     // [s] since Start
+#define HTTP_VAL_OUTPUTS    'o'     // State of the Outputs (packed)
+#define HTTP_VAL_INPUTS     'i'     // State of the Inputs (packed)
+#define HTTP_VAL_ROLLERS    'r'     // Roller Positions [%], comma separated
+#define HTTP_VAL_MINUTE     't'     // Minute of Day, -1: Clock not set
+#define HTTP_VAL_RESETS     'x'     // Reset Counters PO, EXT, BO, WD, comma separated
+#define HTTP_VAL_I2C        'e'     // I2C Errors of each MCP, comma separated
+#define HTTP_VAL_TIMERS     'w'     // running Timers
+#define HTTP_VAL_SWITCHES   's'     // Switches of each Output, comma separated
+#define HTTP_VAL_ON_TIME    'n'     // [min] On-Time of each Output
+#define HTTP_VAL_PRESSES    'p'     // Presses of each Input
+// Keys printed by the Server
+#define HTTP_VAL_REQUESTS   'q'     // Requests
+#define HTTP_VAL_ERRORS     'f'     // Requests answered with an Error
+#define HTTP_VAL_MAXTIME    'm'     // [us] longest Request
+#define HTTP_VAL_OVERBUDGET 'b'     // Requests longer than HTTP_BUDGET
+#define HTTP_VAL_CLICK      'c'     // Click Table, comma separated
+#define HTTP_VAL_DOUBLE     'd'     // Double-Click Table
+#define HTTP_VAL_LONG       'l'     // Long-Click Table
+#define HTTP_VAL_AUTO_OFF   'a'     // Auto-Off Durations
+
+/********************************************************
+ * Handler of a live Value
+ * @param[in] key HTTP_VAL_xxx
+ * @param[in] out Response
+ ********************************************************/
+typedef void (*httpValueHandler)(uint8_t key, Print& out);
+
+/********************************************************
+ * Handler of a Command (POST /cmd)
+ * @param[in] cmdByte One-Byte Command [CCCP PPPP]
+ ********************************************************/
+typedef void (*httpCommandHandler)(uint8_t cmdByte);
+
+/********************************************************
+ * Handler of a Time Synchronization (POST /time)
+ * @param[in] year   e.g. 2024
+ * @param[in] month  1-12
+ * @param[in] day    1-31
+ * @param[in] hour   0-23
+ * @param[in] minute 0-59
+ * @param[in] second 0-59
+ ********************************************************/
+typedef void (*httpTimeHandler)(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second);
+
+/********************************************************
+ * Response Stream: collects HTTP_CHUNK Bytes, writes them
+ * to the Client in one Piece
+ ********************************************************/
+class httpStream : public Print {
+    public:
+    httpStream (Client& client);
+    virtual size_t write (uint8_t c);
+    void send (void);
+
+    private:
+    Client*  _client;                 //!< Socket
+    uint8_t  _len;                    //!< Bytes in _buf
+    uint8_t  _buf[HTTP_CHUNK];        //!< Chunk to be written
+};
+
+/********************************************************
+ * received Request
+ ********************************************************/
+typedef struct {
+  uint16_t status;                    //!< 200 or Error
+  uint8_t  route;                     //!< HTTP_ROUTE_xxx
+  char     body[HTTP_LINE_LEN + 1];   //!< Body (POST), cut
+} httpRequest;
+
+class httpServer {
+    public:
+    // public functions
+    void begin (config& cfg, httpValueHandler value, httpCommandHandler command, httpTimeHandler time);
+    void handle (Client& client);
+    void printState (void);
+
+    private:
+    void receive (Client& client, httpRequest& req);
+    void requestLine (char* line, httpRequest& req);
+    void execute (httpRequest& req);
+    void executeTime (httpRequest& req);
+    void respond (Client& client, const httpRequest& req);
+    void sendTemplate (Print& out, const char* tpl);
+    void printValue (Print& out, uint8_t key);
+    void printTable (Print& out, uint8_t table);
+    config* _config;                  //!< Click Tables, Auto-Off
+    httpValueHandler _value;          //!< prints live Values
+    httpCommandHandler _command;      //!< executes POST /cmd
+    httpTimeHandler _time;            //!< executes POST /time
+    uint16_t _requests;               //!< Requests handled
+    uint16_t _errors;                 //!< Requests answered with an Error
+    uint16_t _overBudget;             //!< Requests longer than HTTP_BUDGET
+    uint32_t _maxTime;                //!< [us] longest Request
+};
+
+#endif  // _HTTPSERVER_H_
@@ -0,0 +1,125 @@
+/*!
+ * @file i2cBench.cpp
+ */
+#include <i2cBench.h>
+
+/********************************************************
+ * Tests
+ ********************************************************/
+#define BENCH_REG             0     // readRegister(GPIOA)
+#define BENCH_8BIT            1     // readGPIO(0) + readGPIO(1)
+#define BENCH_16BIT           2     // readGPIOAB()
+#define BENCH_BURST           3     // readRegisters(IODIRA, 22)
+#define BENCH_INTCAP          4     // readINTCAPAB()
+#define BENCH_WRITE           5     // writeGPIOAB()
+#define BENCH_TESTS           6     // Number of Tests
+
+#define BENCH_BURST_LEN      22     // Registers IODIRA .. OLATB
+
+// Names of Tests
+static const char benchName0[] PROGMEM = "reg";
+static const char benchName1[] PROGMEM = "8bit";
+static const char benchName2[] PROGMEM = "16bit";
+static const char benchName3[] PROGMEM = "burst";
+static const char benchName4[] PROGMEM = "intcap";
+static const char benchName5[] PROGMEM = "write";
+static const char* const benchNames[BENCH_TESTS] PROGMEM = {
+  benchName0, benchName1, benchName2, benchName3, benchName4, benchName5
+};
+
+// Bytes on the Wire per Operation
+//   Register Read:  [Adr+W] [Reg] [Adr+R] [Data ...]
+//   Register Write: [Adr+W] [Reg] [Data ...]
+static const uint8_t benchBytes[BENCH_TESTS] PROGMEM = {
+  4, 8, 5, 3 + BENCH_BURST_LEN, 5, 4
+};
+
+// I2C Clocks [Hz]
+static const uint32_t benchClocks[] PROGMEM = {
+  100000, 400000, 800000
+};
+
+/************************************************************
+ * benchTest
+ * Run one Test BENCH_RUNS times
+ * @returns total Time [us]
+ ************************************************************/
+static uint32_t benchTest(uint8_t test, mcp23017& mcpIn, mcp23017& mcpOut, uint16_t outValue) {
+  uint16_t i;
+  uint32_t startT;
+  uint8_t buf[BENCH_BURST_LEN];
+  uint8_t v8;
+  uint16_t v16;
+  startT = micros();
+  for (i = 0; i < BENCH_RUNS; i++) {
+    switch (test) {
+      case BENCH_REG:
+        mcpIn.readRegister(MCP23017_GPIOA, v8);
+        break;
+      case BENCH_8BIT:
+        mcpIn.readGPIO(0, v8);
+        mcpIn.readGPIO(1, v8);
+        break;
+      case BENCH_16BIT:
+        mcpIn.readGPIOAB(v16);
+        break;
+      case BENCH_BURST:
+        mcpIn.readRegisters(MCP23017_IODIRA, buf, BENCH_BURST_LEN);
+        break;
+      case BENCH_INTCAP:
+        mcpIn.readINTCAPAB(v16);
+        break;
+      case BENCH_WRITE:
+        mcpOut.writeGPIOAB(outValue);
+        break;
+    }
+  }
+  return (micros() - startT);
+}
+
+/************************************************************
+ * runI2cBench
+ * Run all Tests with all Clocks (BLOCKING, some Seconds)
+ * @param[in] mcpIn    Input-MCP to be read
+ * @param[in] mcpOut   Output-MCP to be written
+ * @param[in] outValue Value written to mcpOut (actual Output State)
+ * @param[in] clock    I2C Clock to be restored afterwards [Hz]
+ * @param[in] version  Firmware Version printed in each Line
+ ************************************************************/
+void runI2cBench(mcp23017& mcpIn, mcp23017& mcpOut, uint16_t outValue,
+                 uint32_t clock, const __FlashStringHelper* version) {
+  uint8_t c;
+  uint8_t test;
+  uint32_t f;
+  uint32_t t;
+  uint32_t cus;          // 1/100 us per Operation
+  Serial.print(F("# I2C Benchmark - Runs: "));
+  Serial.println(BENCH_RUNS);
+  Serial.println(F("# BENCH,firmware,test,clock,runs,us/op,bytes/op"));
+  for (c = 0; c < sizeof(benchClocks) / sizeof(benchClocks[0]); c++) {
+    f = pgm_read_dword(&benchClocks[c]);
+    Wire.setClock(f);
+    for (test = 0; test < BENCH_TESTS; test++) {
+      t = benchTest(test, mcpIn, mcpOut, outValue);
+      cus = (t * 10) / (BENCH_RUNS / 10);
+      Serial.print(F("BENCH,"));
+      Serial.print(version);
+      Serial.print(F(","));
+      Serial.print((const __FlashStringHelper*)pgm_read_word(&benchNames[test]));
+      Serial.print(F(","));
+      Serial.print(f);
+      Serial.print(F(","));
+      Serial.print(BENCH_RUNS);
+      Serial.print(F(","));
+      Serial.print(cus / 100);
+      Serial.print(F("."));
+      if (cus % 100 < 10) {
+        Serial.print(F("0"));
+      }
+      Serial.print(cus % 100);
+      Serial.print(F(","));
+      Serial.println(pgm_read_byte(&benchBytes[test]));
+    }
+  }
+  Wire.setClock(clock);
+}
@@ -0,0 +1,29 @@
+/************************************************************
+ * This File implements the I2C Access Benchmark
+ ************************************************************
+ * Measures the Time of the MCP23017 Access Patterns used
+ * by the Firmware for each I2C Clock in BenchClocks[]:
+ * - reg:    readRegister(GPIOA)              - 1 Register
+ * - 8bit:   readGPIO(0) + readGPIO(1)        - 2 Transactions
+ * - 16bit:  readGPIOAB()                     - 2 Registers
+ * - burst:  readRegisters(IODIRA, 22)        - all Registers
+ * - intcap: readINTCAPAB()                   - 2 Registers
+ * - write:  writeGPIOAB() on Output-MCP      - actual Value
+ * Bytes on the Wire include the Address Bytes
+ * (Start/Stop/ACK are not counted).
+ ************************************************************
+ * Output: One Line per Test and Clock (CSV):
+ *   BENCH,<firmware>,<test>,<clock [Hz]>,<runs>,<us/op>,<bytes/op>
+ ************************************************************/
+#ifndef _I2CBENCH_H_
+#define _I2CBENCH_H_
+
+#include <Arduino.h>
+#include <mcp23017_DC.h>
+
+#define BENCH_RUNS         1000     // Operations per Test and Clock
+
+void runI2cBench(mcp23017& mcpIn, mcp23017& mcpOut, uint16_t outValue,
+                 uint32_t clock, const __FlashStringHelper* version);
+
+#endif  // _I2CBENCH_H_
@@ -0,0 +1,108 @@
+/*!
+ * @file idleSleep.cpp
+ */
+#include <idleSleep.h>
+#include <avr/sleep.h>
+#include <avr/power.h>
+
+/************************************************************
+ * begin (public)
+ * Switch off the ADC (not used), clear the Statistics
+ * @param[in] check Function reporting pending Work
+ ************************************************************/
+void idleSleep::begin (sleepCheck check) {
+  _check = check;
+  ADCSRA = 0;
+  power_adc_disable();
+  set_sleep_mode(SLEEP_MODE_IDLE);
+  _sleepStart = micros();
+  _sleepEnd = _sleepStart;
+  reset();
+}
+
+/************************************************************
+ * sleep (public)
+ * Sleep until the next Interrupt if nothing is pending
+ ************************************************************/
+void idleSleep::sleep (void) {
+  uint32_t t;
+  noInterrupts();
+  if (_check()) {
+    interrupts();
+    return;
+  }
+  t = micros();
+  sleep_enable();
+  interrupts();
+  sleep_cpu();
+  sleep_disable();
+  _sleepStart = t;
+  _sleepEnd = micros();
+  _asleep += _sleepEnd - t;
+  _sleeps++;
+}
+
+/************************************************************
+ * scanned (public)
+ * Called by scanButtons() for a queued Edge: if the Edge
+ * woke the CPU, the Latency to the Scan is recorded
+ * @param[in] edgeTime micros() of the Edge (ISR)
+ ************************************************************/
+void idleSleep::scanned (uint32_t edgeTime) {
+  uint32_t t;
+  if ((edgeTime - _sleepStart) > (_sleepEnd - _sleepStart)) {
+    // Edge while awake
+    return;
+  }
+  t = micros() - edgeTime;
+  _wakes++;
+  _wakeSum += t;
+  if (t < _wakeMin) {
+    _wakeMin = t;
+  }
+  if (t > _wakeMax) {
+    _wakeMax = t;
+  }
+}
+
+/************************************************************
+ * reset (public)
+ * Clear the Statistics
+ ************************************************************/
+void idleSleep::reset (void) {
+  _statStart = micros();
+  _asleep = 0;
+  _sleeps = 0;
+  _wakes = 0;
+  _wakeMin = 0xffffffff;
+  _wakeMax = 0;
+  _wakeSum = 0;
+}
+
+/************************************************************
+ * printStats (public)
+ * Print Share of Time asleep and Wake-to-Scan Latency [us],
+ * Statistics are cleared (one Heartbeat Interval each)
+ * e.g. "Sleep: 97% (4871 Sleeps) - Wake: 2 min 36 avg 40 max 52 [us]"
+ ************************************************************/
+void idleSleep::printStats (void) {
+  uint32_t elapsed;
+  elapsed = micros() - _statStart;
+  DBG.print(F("Sleep: "));
+  DBG.print(elapsed ? (uint8_t)(((uint64_t)_asleep * 100) / elapsed) : 0);
+  DBG.print(F("% ("));
+  DBG.print(_sleeps);
+  DBG.print(F(" Sleeps) - Wake: "));
+  DBG.print(_wakes);
+  if (_wakes) {
+    DBG.print(F(" min "));
+    DBG.print(_wakeMin);
+    DBG.print(F(" avg "));
+    DBG.print(_wakeSum / _wakes);
+    DBG.print(F(" max "));
+    DBG.print(_wakeMax);
+    DBG.print(F(" [us]"));
+  }
+  DBG.println();
+  reset();
+}
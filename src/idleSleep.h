@@ -0,0 +1,54 @@
+/************************************************************
+ * This File implements the Idle Sleep of the Main Loop
+ ************************************************************
+ * - sleep() is called at the End of each Loop. If the Check
+ *   Function reports no pending Work (no Edge queued, no
+ *   Serial Byte waiting), the CPU is put into
+ *   SLEEP_MODE_IDLE until the next Interrupt:
+ *   - INT_PIN (MCP INT, Edge queued by the ISR)
+ *   - Timer0 Overflow (millis(), every 1.024ms): Timers,
+ *     Scan Interval, Scheduler, Heartbeat go on unchanged
+ *   - UART RX/TX, TWI
+ * - The Check runs with Interrupts disabled and SEI is
+ *   directly followed by SLEEP, an Interrupt in between is
+ *   never slept through
+ * - Power-Down would stop Timer0 (millis()) and the UART,
+ *   and INT0 could only wake on LOW Level, so Idle is used
+ * - Statistics: Share of Time asleep, Wake-to-Scan Latency
+ *   (Edge during Sleep -> Scan started, min/avg/max)
+ ************************************************************/
+#ifndef _IDLESLEEP_H_
+#define _IDLESLEEP_H_
+
+#include <Arduino.h>
+#include <debugOptions.h>
+
+/********************************************************
+ * Check for pending Work (called with Interrupts disabled)
+ * @returns true if the Loop must not sleep
+ ********************************************************/
+typedef boolean (*sleepCheck)(void);
+
+class idleSleep {
+    public:
+    // public functions
+    void begin (sleepCheck check);
+    void sleep (void);
+    void scanned (uint32_t edgeTime);
+    void reset (void);
+    void printStats (void);
+
+    private:
+    sleepCheck _check;                //!< pending Work
+    uint32_t _sleepStart;             //!< micros() at Start of last Sleep
+    uint32_t _sleepEnd;               //!< micros() at End of last Sleep
+    uint32_t _statStart;              //!< micros() at reset()
+    uint32_t _asleep;                 //!< Time asleep since reset() [us]
+    uint32_t _sleeps;                 //!< Number of Sleeps
+    uint16_t _wakes;                  //!< Edges during Sleep
+    uint32_t _wakeMin;                //!< Wake-to-Scan Latency [us]
+    uint32_t _wakeMax;
+    uint32_t _wakeSum;
+};
+
+#endif  // _IDLESLEEP_H_
@@ -0,0 +1,82 @@
+/*!
+ * @file irqQueue.cpp
+ */
+#include <irqQueue.h>
+
+/************************************************************
+ * begin (public)
+ * Clear the Ring, must be called before the ISR is attached
+ * @param[in] pin Arduino Pin of the IRQ (INT_PIN)
+ ************************************************************/
+void irqQueue::begin (uint8_t pin) {
+  _pinReg = portInputRegister(digitalPinToPort(pin));
+  _pinMask = digitalPinToBitMask(pin);
+  _head = 0;
+  _tail = 0;
+  _overflows = 0;
+  _maxFill = 0;
+  _glitches = 0;
+  _count = 0;
+}
+
+/************************************************************
+ * pop (public)
+ * Take the oldest Edge from the Ring (Main Loop only)
+ * @param[out] ev Time and INT Level of the Edge
+ * @returns false if the Ring is empty
+ ************************************************************/
+boolean irqQueue::pop (irqEvent& ev) {
+  uint8_t tail = _tail;
+  uint8_t fill = (_head - tail) & IRQ_QUEUE_MASK;
+  if (fill == 0) {
+    return (false);
+  }
+  if (fill > _maxFill) {
+    _maxFill = fill;
+  }
+  ev.time = _ring[tail].time;
+  ev.level = _ring[tail].level;
+  _tail = (tail + 1) & IRQ_QUEUE_MASK;
+  _count++;
+  if (ev.level == HIGH) {
+    _glitches++;
+  }
+  return (true);
+}
+
+/************************************************************
+ * empty (public)
+ * @returns true if no Edge is waiting
+ ************************************************************/
+boolean irqQueue::empty (void) {
+  return (_head == _tail);
+}
+
+/************************************************************
+ * overflows (public)
+ * @returns Number of Edges dropped because the Ring was full
+ ************************************************************/
+uint16_t irqQueue::overflows (void) {
+  uint16_t n;
+  noInterrupts();
+  n = _overflows;
+  interrupts();
+  return (n);
+}
+
+/************************************************************
+ * printStats (public)
+ * Print processed Edges, Overflows, max. Fill and Glitches
+ ************************************************************/
+void irqQueue::printStats (void) {
+  DBG.print(F("IRQ: Edges: "));
+  DBG.print(_count);
+  DBG.print(F(" - Overflows: "));
+  DBG.print(overflows());
+  DBG.print(F(" - max. Fill: "));
+  DBG.print(_maxFill);
+  DBG.print(F("/"));
+  DBG.print(IRQ_QUEUE_SIZE - 1);
+  DBG.print(F(" - Glitches: "));
+  DBG.println(_glitches);
+}
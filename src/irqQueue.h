@@ -0,0 +1,68 @@
+/************************************************************
+ * This File implements the IRQ Event Queue
+ ************************************************************
+ * Lock-free Single-Producer/Single-Consumer Ring between
+ * the ISR of INT_PIN (Producer) and scanButtons() (Consumer)
+ * - The ISR stores the Time of the Edge [micros()] and the
+ *   Level of INT_PIN when the ISR ran (HIGH: INT has already
+ *   been released, Pulse shorter than the ISR Latency)
+ * - Only the ISR writes _head, only the Main Loop writes
+ *   _tail. Both are single Bytes, so Reads and Writes are
+ *   atomic on AVR and no Interrupt Lock is needed.
+ * - An Entry is complete before _head is advanced, it is
+ *   read before _tail is advanced
+ * - If the Ring is full, the Edge is dropped and counted
+ *   (Overflows: the Main Loop is falling behind)
+ ************************************************************
+ * RAM: IRQ_QUEUE_SIZE * 5 + 10 Byte
+ ************************************************************/
+#ifndef _IRQQUEUE_H_
+#define _IRQQUEUE_H_
+
+#include <Arduino.h>
+#include <debugOptions.h>
+
+#define IRQ_QUEUE_SIZE       16     // Number of Entries (Power of 2, max. 128)
+#define IRQ_QUEUE_MASK  (IRQ_QUEUE_SIZE - 1)
+
+/********************************************************
+ * One Edge on INT_PIN
+ ********************************************************/
+typedef struct {
+  uint32_t time;                    //!< micros() in ISR
+  uint8_t  level;                   //!< Level of INT_PIN in ISR
+} irqEvent;
+
+class irqQueue {
+    public:
+    // public functions
+    void begin (uint8_t pin);
+    inline void push (void) {
+      // called from ISR
+      uint8_t next = (_head + 1) & IRQ_QUEUE_MASK;
+      if (next == _tail) {
+        _overflows++;
+        return;
+      }
+      _ring[_head].time = micros();
+      _ring[_head].level = (*_pinReg & _pinMask) ? HIGH : LOW;
+      _head = next;
+    }
+    boolean pop (irqEvent& ev);
+    boolean empty (void);
+    uint16_t overflows (void);
+    void printStats (void);
+
+    private:
+    volatile irqEvent _ring[IRQ_QUEUE_SIZE];
+    volatile uint8_t _head;           //!< next free Entry (written by ISR)
+    volatile uint8_t _tail;           //!< oldest Entry (written by Main Loop)
+    volatile uint16_t _overflows;     //!< Edges dropped (Ring full)
+    volatile uint8_t* _pinReg;        //!< Input Register of INT_PIN
+    uint8_t  _pinMask;                //!< Bit of INT_PIN
+    uint8_t  _maxFill;                //!< max. Entries seen by pop()
+    uint16_t _glitches;               //!< Edges with INT_PIN already HIGH
+    uint16_t _count;                  //!< Edges processed
+};
+
+#endif  // _IRQQUEUE_H_
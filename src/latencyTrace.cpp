@@ -0,0 +1,233 @@
+/*!
+ * @file latencyTrace.cpp
+ */
+#include <latencyTrace.h>
+
+// Names of Stages for printStats()
+static const char traceName0[] PROGMEM = "Scan    ";
+static const char traceName1[] PROGMEM = "Classify";
+static const char traceName2[] PROGMEM = "Dispatch";
+static const char traceName3[] PROGMEM = "Write   ";
+static const char traceName4[] PROGMEM = "Total   ";
+static const char* const traceNames[TRACE_ROWS] PROGMEM = {
+  traceName0, traceName1, traceName2, traceName3, traceName4
+};
+
+/************************************************************
+ * begin (public)
+ * Clear Ring and Statistics
+ ************************************************************/
+void latencyTrace::begin (void) {
+  _open = false;
+  _dispatch = false;
+  _cur.stageMask = 0;
+  reset();
+}
+
+/************************************************************
+ * reset (public)
+ * Clear Ring and Statistics, an open Event is kept
+ ************************************************************/
+void latencyTrace::reset (void) {
+  memset(_ring, 0, sizeof(_ring));
+  memset(_stat, 0, sizeof(_stat));
+  _ringHead = 0;
+}
+
+/************************************************************
+ * mark (public)
+ * Stage of the open Event has been reached.
+ * Only the first mark of each Stage is recorded, 
+ * TRACE_DISPATCH and TRACE_WRITE only while dispatched.
+ * @param[in] stage TRACE_SCAN, TRACE_CLASSIFY, TRACE_DISPATCH or TRACE_WRITE
+ ************************************************************/
+void latencyTrace::mark (uint8_t stage) {
+  uint32_t now = micros();
+  if (!_open || ((stage >= TRACE_DISPATCH) && !_dispatch)) {
+    return;
+  }
+  // _irqTime is not written by the ISR while _open is set
+  if (_cur.stageMask == 0) {
+    _cur.irqTime = _irqTime;
+  }
+  if (!(_cur.stageMask & (1 << stage))) {
+    _cur.stageMask |= (1 << stage);
+    _cur.stageTime[stage] = now - _cur.irqTime;
+  }
+}
+
+/************************************************************
+ * dispatch (public)
+ * Command of the open Event is executed (true) or done
+ * @param[in] active true: Output Writes belong to the Event
+ ************************************************************/
+void latencyTrace::dispatch (boolean active) {
+  _dispatch = active;
+}
+
+/************************************************************
+ * written (public)
+ * Outputs have been written: close the Event if the Write
+ * belongs to it
+ ************************************************************/
+void latencyTrace::written (void) {
+  if (_dispatch) {
+    mark(TRACE_WRITE);
+    finish();
+  }
+}
+
+/************************************************************
+ * finish (public)
+ * Close the open Event, store it to the Ring and add it to
+ * the Statistics. Events which did not reach TRACE_CLASSIFY
+ * are discarded.
+ ************************************************************/
+void latencyTrace::finish (void) {
+  uint8_t stage;
+  uint32_t prev;
+  if (!_open) {
+    return;
+  }
+  if (_cur.stageMask & (1 << TRACE_CLASSIFY)) {
+    _ring[_ringHead] = _cur;
+    _ringHead = (_ringHead + 1) % TRACE_RING_SIZE;
+    prev = 0;
+    for (stage = 0; stage < TRACE_STAGES; stage++) {
+      if (_cur.stageMask & (1 << stage)) {
+        addStat(stage, _cur.stageTime[stage] - prev);
+        prev = _cur.stageTime[stage];
+      }
+    }
+    addStat(TRACE_TOTAL, prev);
+  }
+  cancel();
+}
+
+/************************************************************
+ * cancel (public)
+ * Discard the open Event, next IRQ opens a new one
+ ************************************************************/
+void latencyTrace::cancel (void) {
+  _cur.stageMask = 0;
+  _open = false;
+}
+
+/************************************************************
+ * addStat (private)
+ * @param[in] row Stage or TRACE_TOTAL
+ * @param[in] t   Time [us]
+ ************************************************************/
+void latencyTrace::addStat (uint8_t row, uint32_t t) {
+  traceStat* s = &_stat[row];
+  uint8_t bucket;
+  uint32_t v;
+  if ((s->count == 0) || (t < s->minTime)) {
+    s->minTime = t;
+  }
+  if (t > s->maxTime) {
+    s->maxTime = t;
+  }
+  if ((s->count < 0xffff) && (s->sumTime + t >= s->sumTime)) {
+    s->count++;
+    s->sumTime += t;
+  }
+  // Bucket = Octave of t
+  bucket = 0;
+  v = t >> TRACE_HIST_SHIFT;
+  while (v && (bucket < TRACE_HIST_BUCKETS - 1)) {
+    v >>= 1;
+    bucket++;
+  }
+  if (s->hist[bucket] < 0xffff) {
+    s->hist[bucket]++;
+  }
+}
+
+/************************************************************
+ * p99 (private)
+ * @param[in] row Stage or TRACE_TOTAL
+ * @returns upper Edge of the Bucket containing the 99th
+ *          Percentile, limited to the Maximum [us]
+ ************************************************************/
+uint32_t latencyTrace::p99 (uint8_t row) {
+  traceStat* s = &_stat[row];
+  uint32_t total;
+  uint32_t limit;
+  uint32_t sum;
+  uint8_t bucket;
+  total = 0;
+  for (bucket = 0; bucket < TRACE_HIST_BUCKETS; bucket++) {
+    total += s->hist[bucket];
+  }
+  limit = (total * 99 + 99) / 100;
+  sum = 0;
+  for (bucket = 0; bucket < TRACE_HIST_BUCKETS - 1; bucket++) {
+    sum += s->hist[bucket];
+    if (sum >= limit) {
+      break;
+    }
+  }
+  if (bucket == TRACE_HIST_BUCKETS - 1) {
+    return (s->maxTime);
+  }
+  return (min(s->maxTime, (1UL << (bucket + TRACE_HIST_SHIFT + 1)) - 1));
+}
+
+/************************************************************
+ * printStats (public)
+ * Print count/min/avg/max/p99 of each Stage [us]
+ ************************************************************/
+void latencyTrace::printStats (void) {
+  uint8_t row;
+  traceStat* s;
+  DBG_TRACE.println(F("Trace: Stage        n       min       avg       max       p99 [us]"));
+  for (row = 0; row < TRACE_ROWS; row++) {
+    s = &_stat[row];
+    DBG_TRACE.print(F("       "));
+    DBG_TRACE.print((const __FlashStringHelper*)pgm_read_word(&traceNames[row]));
+    DBG_TRACE.print(F(" "));
+    DBG_TRACE.print(s->count);
+    if (s->count) {
+      DBG_TRACE.print(F(" "));
+      DBG_TRACE.print(s->minTime);
+      DBG_TRACE.print(F(" "));
+      DBG_TRACE.print(s->sumTime / s->count);
+      DBG_TRACE.print(F(" "));
+      DBG_TRACE.print(s->maxTime);
+      DBG_TRACE.print(F(" "));
+      DBG_TRACE.print(p99(row));
+    }
+    DBG_TRACE.println(F(""));
+  }
+}
+
+/************************************************************
+ * printRing (public)
+ * Print the last TRACE_RING_SIZE Events, oldest first
+ * (Time since IRQ [us] for each Stage, "-" if not reached)
+ ************************************************************/
+void latencyTrace::printRing (void) {
+  uint8_t i;
+  uint8_t stage;
+  traceEvent* e;
+  DBG_TRACE.println(F("Trace: IRQ [us]: Scan Classify Dispatch Write"));
+  for (i = 0; i < TRACE_RING_SIZE; i++) {
+    e = &_ring[(_ringHead + i) % TRACE_RING_SIZE];
+    if (e->stageMask == 0) {
+      continue;
+    }
+    DBG_TRACE.print(F("       "));
+    DBG_TRACE.print(e->irqTime);
+    DBG_TRACE.print(F(":"));
+    for (stage = 0; stage < TRACE_STAGES; stage++) {
+      DBG_TRACE.print(F(" "));
+      if (e->stageMask & (1 << stage)) {
+        DBG_TRACE.print(e->stageTime[stage]);
+      } else {
+        DBG_TRACE.print(F("-"));
+      }
+    }
+    DBG_TRACE.println(F(""));
+  }
+}
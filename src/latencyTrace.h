@@ -0,0 +1,101 @@
+/************************************************************
+ * This File implements the Latency Trace
+ ************************************************************
+ * Measures the Time from the falling Edge of INT_PIN to the
+ * Relay Output being written. Each Event passes the Stages
+ * - IRQ:      Timestamp taken in the ISR [micros()]
+ * - SCAN:     Input-MCPs have been read
+ * - CLASSIFY: Button State Machine reported a Click
+ * - DISPATCH: Command for the Click has been executed
+ * - WRITE:    I2C Write to the Output-MCPs completed
+ * The last TRACE_RING_SIZE Events are kept in a Ring.
+ * For each Stage (Time since previous Stage) and for the
+ * Total (IRQ to WRITE) min/avg/max and a Histogram with
+ * one Bucket per Octave are accumulated, p99 is derived
+ * from the Histogram (upper Edge of the Bucket).
+ ************************************************************
+ * An Event which does not reach CLASSIFY (Noise) is
+ * discarded with cancel(). An Event without Output Change
+ * is closed with finish() after DISPATCH.
+ * DISPATCH and WRITE are only recorded while the Command of
+ * the Event is executed (dispatch(true) ... dispatch(false)),
+ * written() then closes the Event. Output Writes of Timers,
+ * Schedule or Bus do not belong to the Event.
+ ************************************************************/
+#ifndef _LATENCYTRACE_H_
+#define _LATENCYTRACE_H_
+
+#include <Arduino.h>
+#include <debugOptions.h>
+
+/********************************************************
+ * Trace Stages
+ ********************************************************/
+#define TRACE_SCAN            0     // IRQ      -> Inputs read
+#define TRACE_CLASSIFY        1     // SCAN     -> Click detected
+#define TRACE_DISPATCH        2     // CLASSIFY -> Command executed
+#define TRACE_WRITE           3     // DISPATCH -> Outputs written
+#define TRACE_STAGES          4     // Number of Stages
+#define TRACE_TOTAL           4     // IRQ      -> last Stage reached
+#define TRACE_ROWS            5     // Stages + Total
+
+/********************************************************
+ * Sizes
+ ********************************************************/
+#define TRACE_RING_SIZE       8     // Number of Events kept
+#define TRACE_HIST_BUCKETS   16     // Number of Histogram Buckets
+#define TRACE_HIST_SHIFT      7     // Bucket 0: < 128us, Bucket n: < 2^(n+7)us
+
+/********************************************************
+ * One traced Event
+ ********************************************************/
+typedef struct {
+  uint32_t irqTime;                   //!< micros() in ISR
+  uint32_t stageTime[TRACE_STAGES];   //!< Time since IRQ [us] when Stage reached
+  uint8_t  stageMask;                 //!< Bit set for each Stage reached
+} traceEvent;
+
+/********************************************************
+ * Statistics of one Stage
+ ********************************************************/
+typedef struct {
+  uint16_t count;
+  uint32_t minTime;
+  uint32_t maxTime;
+  uint32_t sumTime;                   //!< stops with count (Overflow)
+  uint16_t hist[TRACE_HIST_BUCKETS];
+} traceStat;
+
+class latencyTrace {
+    public:
+    // public functions
+    void begin (void);
+    inline void irq (void) {
+      // called from ISR: only the first IRQ opens an Event
+      if (!_open) {
+        _irqTime = micros();
+        _open = true;
+      }
+    }
+    void mark (uint8_t stage);
+    void dispatch (boolean active);
+    void written (void);
+    void finish (void);
+    void cancel (void);
+    void reset (void);
+    void printStats (void);
+    void printRing (void);
+
+    private:
+    void addStat (uint8_t row, uint32_t t);
+    uint32_t p99 (uint8_t row);
+    volatile boolean  _open;          //!< Event opened by ISR
+    volatile uint32_t _irqTime;       //!< micros() of opening IRQ
+    boolean    _dispatch;             //!< Command of the Event is executed
+    traceEvent _cur;                  //!< Event in progress
+    traceEvent _ring[TRACE_RING_SIZE];
+    uint8_t    _ringHead;             //!< next Entry to be written
+    traceStat  _stat[TRACE_ROWS];
+};
+
+#endif  // _LATENCYTRACE_H_
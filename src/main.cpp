@@ -1,11 +1,3 @@
-# define STATEUP    0B10101010
-# define STATEDOWN  0B01010101
-# define STATEDOWN2 0B01000000
-# define STATESTOP  0B00000000
-# define LED_ON     digitalWrite(13, HIGH)
-# define LED_OFF    digitalWrite(13, LOW)
-# define BUTTON     11
-
 /************************************************************
  * Darios Homeautomatisation v2
  ************************************************************
@@ -22,36 +14,114 @@
  * Includes
  ************************************************************/ 
 #include <Arduino.h>
+#include <avr/wdt.h>
 #include <debugOptions.h>
 #include <mcp23017_DC.h>
-//#include <configTools.h>
-#include <EEPROM.h>
+#include <configTools.h>
+#include <buttons.h>
+#include <latencyTrace.h>
+#include <irqQueue.h>
+#include <profiler.h>
+#include <serialCmd.h>
+#include <i2cBench.h>
+#include <timerWheel.h>
+#include <scheduler.h>
+#include <autoOff.h>
+#include <rollers.h>
+#include <configXfer.h>
+#include <outputRestore.h>
+#include <idleSleep.h>
+#include <rules.h>
+#include <pinMap.h>
+#include <httpServer.h>
+#include <eventBus.h>
+#include <usageStats.h>
+#include <SPI.h>
+#include <Ethernet.h>
 
 /************************************************************
  * Program Configuration Control
  ************************************************************/ 
+#define FW_VERSION    "2.0.0"          // Firmware Version
 #define DO_HEARTBEAT  1
 #define HEARTBEAT     5000             // Print State Interval
-#define DO_SPEED      0
-#define SPEEDRUNS     10000
-#define SPEEDUSDIVISOR (SPEEDRUNS / 1000)
-#define SPEEDBEAT     1000
-#define IRQ_RESETINTERVAL 100
+#define DO_SPEED      0                // I2C and Rule Benchmark (Serial Command "bench")
+#define I2C_RECOVERY_INTERVAL 1000     // [ms] min. Time between two I2C Bus Recoveries
+#define DO_TRACE      0                // Latency Trace IRQ -> Output (printed with Heartbeat)
+#define DO_ROLLER_EMERGENCY 0          // Button on Pin EMERGENCY_BUTTON: Roller-Action for all Rollers
+#define EMERGENCY_BUTTON  11           // Pin of Emergency Button (low active)
+#define EMERGENCY_SCANINT 50           // [ms] Scan Interval of Emergency Button
+#define SCRIPT_NUM    4                // max. Number of concurrently running Special Events
+#define DO_WATCHDOG   1                // Watchdog Reset if the Main Loop hangs
+#define WATCHDOG_TIMEOUT  WDTO_2S      // Watchdog Timeout (> longest blocking Call)
+#define RESTORE_BUDGET 5000            // [us] max. Time from Start to restored Outputs
+#define DO_SLEEP      1                // Idle Sleep at the End of the Loop (Statistics with Heartbeat)
+#define DO_HTTP       1                // HTTP Status and Control Server on the W5500 (see httpServer.h)
+#define HTTP_POLL_INTERVAL  20         // [ms] Check for a new Connection
+#define HTTP_CLOSE_TIMEOUT  50         // [ms] max. Wait for the Close of a Connection
+#define DO_BUS        1                // UDP Multicast Event Bus to the other Controllers (see eventBus.h)
+
+#if (DO_HTTP || DO_BUS) && DO_ROLLER_EMERGENCY && (EMERGENCY_BUTTON >= ETH_CS_PIN) && (EMERGENCY_BUTTON <= 13)
+  #error "EMERGENCY_BUTTON: Pins 10-13 are used by the W5500 (SPI)"
+#endif
+
+/************************************************************
+ * Latency Trace Macros (no Code if DO_TRACE = 0)
+ ************************************************************/ 
+#if DO_TRACE
+  #define TRACE_IRQ()        mytrace.irq()
+  #define TRACE_MARK(stage)  mytrace.mark(stage)
+  #define TRACE_DISPATCHING(active) mytrace.dispatch(active)
+  #define TRACE_WRITTEN()    mytrace.written()
+  #define TRACE_FINISH()     mytrace.finish()
+  #define TRACE_CANCEL()     mytrace.cancel()
+#else
+  #define TRACE_IRQ()
+  #define TRACE_MARK(stage)
+  #define TRACE_DISPATCHING(active)
+  #define TRACE_WRITTEN()
+  #define TRACE_FINISH()
+  #define TRACE_CANCEL()
+#endif // DO_TRACE
 
 /************************************************************
  * Global Vars
  ************************************************************/ 
-volatile bool g_irqFlag = false;
-boolean  g_buttonPollingActive;   //! Polling of Buttons every 10ms active
+boolean  g_scanRequest;           //! Scan Inputs in next Loop (without IRQ)
+uint16_t g_buttonScanWait;        //! [ms] next Scan after last Scan, BUTTON_NO_SCAN: IRQ only
 uint32_t g_lastButtonState;       //! Last State of Buttons
-uint32_t g_lastButtonReadTime;     //! Time when last IRQ was handled 
+uint32_t g_lastButtonReadTime;    //! Time when last IRQ was handled 
 uint32_t g_lastButtonScanTime;    //! Last Time when Buttons (Inputs) habe been read
-uint8_t  g_lastIntState;          //! Last State of INT0 Pin
 uint32_t g_lastOutState;          //! Last State of Output Ports 
 uint32_t g_lastOutTime;           //! last Time when Output Ports have ben set
+uint16_t g_outWrites;             //! Number of Writes to the Output Ports
+uint32_t g_restoreTime;           //! micros() when the Outputs were restored
 
 uint32_t g_lastPrintTime;         // Used by Heartbeat
-uint32_t g_lastResetTime;         // Used by processIrq
+uint32_t g_lastRecoveryTime;      // Used by recoverI2c
+uint16_t g_i2cRecoveries;         //! Number of I2C Bus Recoveries
+uint32_t g_i2cRecoveryMaxTime;    //! longest I2C Bus Recovery [us]
+#if DO_HTTP || DO_BUS
+  boolean  g_netReady;            //! W5500 found, Server listening, Bus joined
+#endif // DO_HTTP || DO_BUS
+#if DO_HTTP
+  uint32_t g_lastHttpPoll;        //! Last Time when the Server was polled
+#endif // DO_HTTP
+#if DO_ROLLER_EMERGENCY
+  uint8_t  g_lastEmergencyState;  //! Last State of Emergency Button
+  uint32_t g_lastEmergencyTime;   //! Last Time when Emergency Button has been read
+#endif // DO_ROLLER_EMERGENCY
+
+/************************************************************
+ * Running Special Events (Scripts)
+ ************************************************************/ 
+typedef struct {
+  uint8_t specialEvent;           //! # of Special Event, SE_NONE if Script is free
+  uint8_t pos;                    //! next Byte of Special Event
+  uint8_t speed;                  //! Wait after each Command [100ms]
+  uint8_t timer;                  //! Timer of actual Wait, TIMER_NONE if not waiting
+} script;
+script g_script[SCRIPT_NUM];
 
 
 /************************************************************
@@ -63,11 +133,82 @@ mcp23017 mcp[MCP_NUM];
 // Access Configuration
 config myconfig;
 
+// Button State Machine
+buttons mybuttons;
+
+// Edges on INT_PIN (ISR -> scanButtons)
+irqQueue myirqs;
+
+// Latency Trace
+#if DO_TRACE
+  latencyTrace mytrace;
+#endif // DO_TRACE
+
+// Serial Commands
+serialCmd mycmd;
+
+// Timers
+timerWheel mytimers;
+
+// Time-of-Day Scheduler
+scheduler myscheduler;
+
+// Auto-Off (Staircase) Timers
+autoOff myautooff;
+
+// Roller Position Model
+rollers myrollers;
+
+// Binary Configuration Transfer
+configXfer myxfer;
+
+// Output Restore after Reset
+outputRestore myrestore;
+
+// Relay Wear and Usage Statistics
+usageStats mystats;
+
+// Idle Sleep
+#if DO_SLEEP
+  idleSleep mysleep;
+#endif // DO_SLEEP
+
+// Rules (Conditions over Outputs and Inputs)
+rules myrules;
+
+// HTTP Status and Control Server (W5500)
+#if DO_HTTP
+  EthernetServer myhttpsock(HTTP_PORT);
+  httpServer myhttp;
+#endif // DO_HTTP
+
+// Event Bus to the other Controllers (UDP Multicast on the W5500)
+#if DO_BUS
+  EthernetUDP mybussock;
+  eventBus mybus;
+#endif // DO_BUS
+
+/************************************************************
+ * Prototypes
+ ************************************************************/ 
+void processClick(uint8_t clickType, uint8_t inPin, uint16_t duration);
+void runSpecialEvent(uint8_t specialEvent);
+void stopSpecialEvent(uint8_t specialEvent);
+void continueScript(uint8_t s);
+void executeCommand(uint8_t cmdByte);
+void rollerOutputs(uint32_t clearMask, uint32_t setMask);
+void configUploaded(void);
+boolean loopPending(void);
+void setupNetwork(void);
+void pollHttp(void);
+void pollBus(void);
+
 /************************************************************
  * IRQ Handler
  ***********************************************************/
 void iqrHandler() {
-    g_irqFlag = true;
+    TRACE_IRQ();
+    myirqs.push();
 }
 
 /************************************************************
@@ -98,6 +239,39 @@ void beginMcp(mcp23017& mcp, uint8_t adr) {
 }
   
 
+/************************************************************
+ * Setup Input Modes
+ ************************************************************
+ * Write Pull-Up (GPPU) and Input Polarity (IPOL) of the 16
+ * Inputs of one Input-MCP from the Input Table
+ * @param[in] mcp Input-MCP
+ * @param[in] adr Adress (0-7) of MCP (Inputs adr*16 ...)
+ ************************************************************/
+void setupInputModes(mcp23017& mcp, uint8_t adr) {
+  uint16_t ipol;
+  uint16_t gppu;
+  uint8_t cls;
+  boolean invert;
+  boolean pullup;
+  boolean hold;
+  uint8_t i;
+  ipol = 0;
+  gppu = 0;
+  for (i = 0; i < 16; i++) {
+    myconfig.getInputFromEEprom((adr * 16) + i, cls, invert, pullup, hold);
+    if (invert) {
+      ipol |= (1 << i);
+    }
+    if (pullup) {
+      gppu |= (1 << i);
+    }
+  }
+  mcp.writeRegister(MCP23017_GPPUA, gppu & 0xff);
+  mcp.writeRegister(MCP23017_GPPUB, gppu >> 8);
+  mcp.writeRegister(MCP23017_IPOLA, ipol & 0xff);
+  mcp.writeRegister(MCP23017_IPOLB, ipol >> 8);
+}
+
 /************************************************************
  * Setup Input-MCP
  * - Input
@@ -108,8 +282,7 @@ void beginMcp(mcp23017& mcp, uint8_t adr) {
  *                e.g: adr=3 -> I2C-Address 0x23
  *********************************************************** 
  * - Set Direction of all Pins to INPUT 
- * - Enable Pull-UP for all Pins
- * - Set Input Polarity to low active (GND=1)
+ * - Pull-Up and Input Polarity from Input Table (EEPROM)
  * - IRQ-Settings: Mirror, Open-Drain, LOW-active
  * - IRQ-Mode: on-change
  * - IRQ-Default-Value: 0x00
@@ -117,19 +290,15 @@ void beginMcp(mcp23017& mcp, uint8_t adr) {
  * - clearInterrupts
  ***********************************************************/
 void setupInputMcp(mcp23017& mcp, uint8_t adr) {    
+  uint16_t intcap;
   beginMcp(mcp,adr);  
   DBG_SETUP_MCP.println(F("  - Direction: INPUT"));
   delay(DEBUG_SETUP_DELAY);
   mcp.writeRegister(MCP23017_IODIRA, 0xff); 
   mcp.writeRegister(MCP23017_IODIRB, 0xff);     
-  DBG_SETUP_MCP.println(F("  - Pull-UP: enable"));
+  DBG_SETUP_MCP.println(F("  - Pull-Up and Input Polarity: Input Table"));
   delay(DEBUG_SETUP_DELAY);
-  mcp.writeRegister(MCP23017_GPPUA, 0xff);  
-  mcp.writeRegister(MCP23017_GPPUB, 0xff);     
-  DBG_SETUP_MCP.println(F("  - Input Polarity: low active"));
-  delay(DEBUG_SETUP_DELAY);
-  mcp.writeRegister(MCP23017_IPOLA, 0xff);  
-  mcp.writeRegister(MCP23017_IPOLB, 0xff);     
+  setupInputModes(mcp, adr);
   DBG_SETUP_MCP.println(F("  - IRQ: Mirror, Open-Drain, LOW-active"));
   delay(DEBUG_SETUP_DELAY);
   mcp.setupInterrupts(1, 1, 0);            
@@ -148,8 +317,7 @@ void setupInputMcp(mcp23017& mcp, uint8_t adr) {
   // clearInterrupts
   DBG_SETUP_MCP.println(F("    - clearInterrupts"));
   delay(DEBUG_SETUP_DELAY);
-  mcp.readRegister(MCP23017_INTCAPA);
-  mcp.readRegister(MCP23017_INTCAPB);        
+  mcp.readINTCAPAB(intcap);
 }
 
 
@@ -160,19 +328,57 @@ void setupInputMcp(mcp23017& mcp, uint8_t adr) {
  *                ATTENTION library does not use I2C-Address
  *                I2C-Address = 0x20 + adr
  *                e.g: adr=3 -> I2C-Address 0x23
+ * @param[in] state State of the 16 Outputs
  *********************************************************** 
+ * - Set the Output Latches to state (Pins are still Inputs)
  * - Set Direction of all Pins to Output
- * - Set all Pins to 0=GND 
+ * No Debug Output: called before Serial is set up
  ***********************************************************/
-void setupOutputMcp(mcp23017& mcp, uint8_t adr) {  
-  beginMcp(mcp,adr);
-  DBG_SETUP_MCP.println(F("  - Direction: OUTPUT"));
-  delay(DEBUG_SETUP_DELAY);
+void setupOutputMcp(mcp23017& mcp, uint8_t adr, uint16_t state) {  
+  mcp.begin(adr, &Wire);
+  mcp.writeGPIOAB(state);  
   mcp.writeRegister(MCP23017_IODIRA, 0x00); 
   mcp.writeRegister(MCP23017_IODIRB, 0x00);     
-  DBG_SETUP_MCP.println(F("  - Set all Pins to GND"));
-  delay(DEBUG_SETUP_DELAY);
-  mcp.writeGPIOAB(0x0000);  
+}
+
+
+/************************************************************
+ * Restore Outputs
+ ************************************************************
+ * First Output Write after a Reset, before everything else
+ * - State from RAM Copy or EEPROM (see outputRestore.h)
+ * - Roller Outputs (Roller Table) are masked: Rollers stay 
+ *   stopped
+ * - Reset all MCPs (short Pulse), set up the Output-MCPs
+ * - no EEPROM Write: the Reset Counters are updated after
+ *   the Outputs (outputRestore::begin())
+ * The Time since Start is kept in g_restoreTime
+ ************************************************************/
+void restoreOutputs(void) {
+  uint32_t state;
+  uint8_t upPin;
+  uint8_t downPin;
+  uint8_t t;
+  uint8_t i;
+  state = myrestore.load();
+  for (i = 1; i <= ROLLER_NUM; i++) {
+    myconfig.getRollerFromEEprom(i, upPin, downPin, t, t, t);
+    if ((upPin < MCP_OUT_PINS) && (downPin < MCP_OUT_PINS)) {
+      state &= ~((1UL << upPin) | (1UL << downPin));
+    }
+  }
+  // Reset all MCP23017s (min. 1us)
+  pinMode(MCP_RST_PIN, OUTPUT); 
+  digitalWrite(MCP_RST_PIN, LOW);
+  delayMicroseconds(10);
+  digitalWrite(MCP_RST_PIN, HIGH);
+  Wire.begin();
+  Wire.setClock(I2CSPEED);
+  for (i = MCP_IN_NUM; i < MCP_NUM; i++) {
+    setupOutputMcp(mcp[i], i, (uint16_t)(state >> (16 * (i - MCP_IN_NUM))));
+  }
+  g_lastOutState = state;
+  g_restoreTime = micros();
 }
 
 
@@ -182,6 +388,11 @@ void setupOutputMcp(mcp23017& mcp, uint8_t adr) {
 void setup() {        
   uint8_t i;
   uint8_t n;
+  // Outputs first (Brown-Out or Watchdog Reset: Lights stay on)
+  restoreOutputs();
+  // then the Reset Counters (EEPROM Writes)
+  myrestore.begin(mytimers);
+
   // Serial Port
   Serial.begin(115200);  
   DBG.println(F(""));
@@ -191,13 +402,16 @@ void setup() {
   DBG.println(F("Init ..."));
   delay(DEBUG_SETUP_DELAY);
 
-  // Reset all MCP23017a
-  DBG_SETUP.print(F("- Resetting all MCP23017s ... "));
-  pinMode(MCP_RST_PIN, OUTPUT); 
-  digitalWrite(MCP_RST_PIN,LOW);
-  delay(100);
-  digitalWrite(MCP_RST_PIN,HIGH);
-  DBG_SETUP.println(F("done."));
+  // Reset Reason and restored Outputs
+  myrestore.printState();
+  DBG.print(F("- Outputs restored: 0x"));
+  DBG.print(g_lastOutState, HEX);
+  DBG.print(F(" after "));
+  DBG.print(g_restoreTime);
+  DBG.println(F("us"));
+  if (g_restoreTime > RESTORE_BUDGET) {
+    DBG_ERROR.println(F("ERROR: Output Restore exceeds RESTORE_BUDGET"));
+  }
   
   // Setup Input MCP23017s
   n=0;
@@ -211,19 +425,26 @@ void setup() {
     }
   }
 
-  // Setup Output MCP23017s
+  // Output MCP23017s (set up by restoreOutputs())
   if (MCP_OUT_NUM > 0) {
     for (i=n; i<MCP_NUM; i++) {
       DBG_SETUP.print(F("- MCP23017 #"));
       DBG_SETUP.print(i);
-      DBG_SETUP.println(F(" - [OUTPUT]"));
-      setupOutputMcp(mcp[i], i);  
+      DBG_SETUP.println(F(" - [OUTPUT] restored"));
+      if (mcp[i].errorCount() != 0) {
+        DBG_ERROR.print(F("ERROR: MCP23017 #"));
+        DBG_ERROR.print(i);
+        DBG_ERROR.print(F(" not responding (Error: "));
+        DBG_ERROR.print(mcp[i].lastError());
+        DBG_ERROR.println(F(")"));
+      }
     }
   }
   
   // Arduino IRQ  
   DBG_SETUP.print(F("- Arduino IRQ ..."));
   pinMode(INT_PIN, INPUT_PULLUP);
+  myirqs.begin(INT_PIN);
   attachInterrupt(digitalPinToInterrupt(INT_PIN), iqrHandler, FALLING);
   DBG_SETUP.println(F(" done."));  
   delay(DEBUG_SETUP_DELAY);
@@ -231,6 +452,11 @@ void setup() {
   // Debug LED
   pinMode(13, OUTPUT);
 
+  // Emergency Button
+  #if DO_ROLLER_EMERGENCY
+    pinMode(EMERGENCY_BUTTON, INPUT_PULLUP);
+  #endif // DO_ROLLER_EMERGENCY
+
   // Set I2C Speed
   DBG_SETUP.print(F("- I2C: Set Speed to "));
   DBG_SETUP.print(I2CSPEED);
@@ -244,40 +470,443 @@ void setup() {
   DBG_SETUP.print(F("- Global Vars ... "));
   delay(DEBUG_SETUP_DELAY);
   
-  g_buttonPollingActive = false;    
-  g_irqFlag = false;
+  g_buttonScanWait = BUTTON_NO_SCAN;
+  g_scanRequest = false;
   g_lastButtonReadTime = millis();
   g_lastButtonState = 0;
   g_lastButtonScanTime = millis();
-  g_lastIntState = 0xff;
-  g_lastOutState = 0x00000000;
   g_lastOutTime = millis();  
+  g_outWrites = 0;
   g_lastPrintTime = millis();
-  g_lastResetTime = millis();    
+  g_lastRecoveryTime = millis() - I2C_RECOVERY_INTERVAL;
+  g_i2cRecoveries = 0;
+  g_i2cRecoveryMaxTime = 0;
+  #if DO_ROLLER_EMERGENCY
+    g_lastEmergencyState = HIGH;
+    g_lastEmergencyTime = millis();
+  #endif // DO_ROLLER_EMERGENCY
+  for (i = 0; i < SCRIPT_NUM; i++) {
+    g_script[i].specialEvent = SE_NONE;
+    g_script[i].timer = TIMER_NONE;
+  }
   
   DBG_SETUP.println(F("done."));
   delay(DEBUG_SETUP_DELAY);
 
+  // Configuration (Index of Special Events)
+  myconfig.begin();
+
+  // Button State Machine
+  DBG_SETUP.print(F("- Button State Machine ... "));
+  mybuttons.begin(myconfig, mytimers, processClick);
+  myrules.begin(myconfig);
+  #if DO_TRACE
+    mytrace.begin();
+  #endif // DO_TRACE
+  DBG_SETUP.println(F("done."));
+
+  // Serial Commands
+  mycmd.begin();
+  delay(DEBUG_SETUP_DELAY);
+
+  // Timers
+  mytimers.begin();
+  myautooff.begin(myconfig, mytimers);
+  mystats.begin();
+  // restored Outputs: start their Auto-Off Timers
+  myautooff.update(0, g_lastOutState);
+
+  // Rollers (Position from EEPROM)
+  myrollers.begin(myconfig, mytimers, rollerOutputs);
+
+  // Time-of-Day Scheduler (Clock is set by Serial Commands "time" and "date")
+  myscheduler.begin(myconfig, executeCommand);
+
+  // Binary Configuration Transfer (Serial Commands "cfgget" and "cfgput")
+  myxfer.begin(myconfig, configUploaded);
+
+  // HTTP Server and Event Bus (fixed Address NET_IP, Node NET_NODE)
+  #if DO_HTTP || DO_BUS
+    setupNetwork();
+  #endif // DO_HTTP || DO_BUS
+
+  // Idle Sleep
+  #if DO_SLEEP
+    mysleep.begin(loopPending);
+  #endif // DO_SLEEP
+
+  // Watchdog
+  #if DO_WATCHDOG
+    wdt_enable(WATCHDOG_TIMEOUT);
+  #endif // DO_WATCHDOG
+
   // init finished
   DBG.println(F("Init complete, starting Main-Loop"));
   DBG.println(F("#################################"));
   delay(DEBUG_SETUP_DELAY);
 }
 
+/************************************************************
+ * Recover I2C Bus
+ ************************************************************
+ * Called after a failed I2C Transfer
+ * - Clock SCL until SDA is released, STOP, re-init TWI
+ * - Restore all Registers of all MCPs from their Shadow
+ *   (one Transfer per MCP)
+ * - Force a Scan of the Inputs
+ * Bounded Time: Bus Clear ~0.1ms + MCP_NUM Transfers each 
+ * limited by MCP23017_TIMEOUT_US (max. 25ms in total).
+ * At most once every I2C_RECOVERY_INTERVAL, the Error 
+ * Counters of the MCP Objects count all failed Transfers.
+ ************************************************************/
+void recoverI2c(void) {
+  uint32_t startT;
+  uint32_t t;
+  uint8_t err;
+  uint8_t i;
+  if (millis() - g_lastRecoveryTime < I2C_RECOVERY_INTERVAL) {
+    return;
+  }
+  g_lastRecoveryTime = millis();
+  startT = micros();
+  err = mcp23017::clearBus(&Wire, I2CSPEED);
+  for (i = 0; i < MCP_NUM; i++) {
+    err |= mcp[i].restore();
+  }
+  // Inputs may have changed in the meantime
+  g_scanRequest = true;
+  t = micros() - startT;
+  g_i2cRecoveries++;
+  if (t > g_i2cRecoveryMaxTime) {
+    g_i2cRecoveryMaxTime = t;
+  }
+  DBG_ERROR.print(F("ERROR: I2C Bus Recovery "));
+  if (err) {
+    DBG_ERROR.print(F("failed"));
+  } else {
+    DBG_ERROR.print(F("done"));
+  }
+  DBG_ERROR.print(F(" ("));
+  DBG_ERROR.print(t);
+  DBG_ERROR.println(F("us)"));
+}
+
+
+/************************************************************
+ * Print I2C Status
+ ************************************************************
+ * Error Counters of all MCPs and Bus Recoveries
+ ************************************************************/
+void printI2cStatus(void) {
+  uint8_t i;
+  DBG.print(F("I2C: Errors:"));
+  for (i = 0; i < MCP_NUM; i++) {
+    DBG.print(F(" "));
+    DBG.print(mcp[i].errorCount());
+    DBG.print(F("/"));
+    DBG.print(mcp[i].lastError());
+  }
+  DBG.print(F(" - Recoveries: "));
+  DBG.print(g_i2cRecoveries);
+  DBG.print(F(" - max: "));
+  DBG.print(g_i2cRecoveryMaxTime);
+  DBG.println(F("us"));
+}
+
+
 /************************************************************
  *  Set Output Ports
  ************************************************************
  * The actual state is stored in g_lastOutState. 
  * The output occures only, if the new state is different.
+ * Roller Outputs are checked by the Interlock (no Reversal
+ * without Dead Time, never both Directions on).
+ * Auto-Off Timers of changed Outputs are started/cancelled.
  * @param[in] newOutState State to be set on Output Ports 0 to 32
  ************************************************************/
 void setOutputs(uint32_t newOutState) {
+  uint8_t err;
+  PROF_ENTER(PROF_OUTPUT);
+  newOutState = myrollers.interlock(g_lastOutState, newOutState);
   // Output only if state has changed
   if (g_lastOutState != newOutState) {
+    myautooff.update(g_lastOutState, newOutState);
+    myrestore.update(newOutState & ~myrollers.outputMask());
+    mystats.outputs(g_lastOutState, newOutState);
     g_lastOutState = newOutState;
-    mcp[2].writeGPIOAB((uint16_t)(newOutState & 0xffff));
-    mcp[3].writeGPIOAB((uint16_t)((newOutState >> 16) & 0xffff));    
+    g_outWrites++;
+    err = mcp[2].writeGPIOAB((uint16_t)(newOutState & 0xffff));
+    err |= mcp[3].writeGPIOAB((uint16_t)((newOutState >> 16) & 0xffff));    
+    // Output-MCPs are restored from their Shadow (= newOutState)
+    if (err) {
+      recoverI2c();
+    }
+    // closes the Trace only if written for the traced Click
+    TRACE_WRITTEN();
+    DBG_OUTPUT.print(F("Out: "));
+    DBG_OUTPUT.println(newOutState, HEX);
+  }
+  PROF_EXIT(PROF_OUTPUT);
+}
+
+
+/************************************************************
+ *  Execute Command
+ ************************************************************
+ * Execute a One-Byte Command CCC-NNNNN 
+ * (Click Table Entry or Special Event Command)
+ * @param[in] cmdByte Command [0-7] and Parameter [0-31], 
+ *                    encoded to one Byte [CCCP PPPP]
+ ************************************************************/
+void executeCommand(uint8_t cmdByte) {
+  uint8_t par;
+  uint16_t writes;
+  uint32_t newOutState;
+  par = cmdByte & 0x1f;
+  newOutState = g_lastOutState;
+  switch (cmdByte & 0xe0) {
+    case EVENT_SPECIAL:
+      if (par != SE_NONE) {
+        runSpecialEvent(par);
+      }
+      return;
+    case EVENT_ON:
+      newOutState |= (1UL << par);
+      break;
+    case EVENT_OFF:
+      newOutState &= ~(1UL << par);
+      break;
+    case EVENT_TOGGLE:
+      newOutState ^= (1UL << par);
+      break;
+    case EVENT_ROLLER_ACTION:
+    case EVENT_ROLLER_UP:
+    case EVENT_ROLLER_DOWN:
+    case EVENT_ROLLER_STOP:
+      // all Rollers of the Mask in one Write
+      writes = g_outWrites;
+      myrollers.command(cmdByte & 0xe0, par);
+      DBG_EVENT.print(F("Roller Command 0x"));
+      DBG_EVENT.print(cmdByte, HEX);
+      DBG_EVENT.print(F(" - Writes: "));
+      DBG_EVENT.println(g_outWrites - writes);
+      return;
+  }
+  TRACE_MARK(TRACE_DISPATCH);
+  setOutputs(newOutState);
+}
+
+
+/************************************************************
+ *  Roller Outputs
+ ************************************************************
+ * Output Handler of the Rollers
+ * @param[in] clearMask Outputs to be switched off
+ * @param[in] setMask   Outputs to be switched on
+ ************************************************************/
+void rollerOutputs(uint32_t clearMask, uint32_t setMask) {
+  TRACE_MARK(TRACE_DISPATCH);
+  setOutputs((g_lastOutState & ~clearMask) | setMask);
+}
+
+
+/************************************************************
+ *  Run Special Event
+ ************************************************************
+ * Start a Script executing all Commands of a Special Event 
+ * stored in EEPROM (see mySettings.h for the Format).
+ * Waits (CMD_WAIT, CMD_SPEED) do not block, the Script is 
+ * continued by a Timer. A waiting Special Event is restarted,
+ * a Special Event calling itself is ignored.
+ * @param[in] specialEvent # of Special Event - STARTING WITH 1
+ ************************************************************/
+void runSpecialEvent(uint8_t specialEvent) {
+  uint8_t s;
+  uint8_t i;
+  DBG_EVENT.print(F("Special Event #"));
+  DBG_EVENT.println(specialEvent);
+  // same Special Event running or free Script
+  s = SCRIPT_NUM;
+  for (i = 0; i < SCRIPT_NUM; i++) {
+    if (g_script[i].specialEvent == specialEvent) {
+      s = i;
+      break;
+    }
+    if ((g_script[i].specialEvent == SE_NONE) && (s == SCRIPT_NUM)) {
+      s = i;
+    }
+  }
+  if (s == SCRIPT_NUM) {
+    DBG_ERROR.println(F("ERROR: too many Special Events running"));
+    return;
+  }
+  if ((g_script[s].specialEvent == specialEvent) && (g_script[s].timer == TIMER_NONE)) {
+    DBG_ERROR.println(F("ERROR: recursive Special Event"));
+    return;
   }
+  mytimers.cancel(g_script[s].timer);
+  g_script[s].specialEvent = specialEvent;
+  g_script[s].pos = 1;
+  g_script[s].speed = 0;
+  g_script[s].timer = TIMER_NONE;
+  continueScript(s);
+}
+
+
+/************************************************************
+ *  Stop Special Event
+ ************************************************************
+ * Stop the Script of a Special Event (before it is changed)
+ * @param[in] specialEvent # of Special Event - STARTING WITH 1
+ ************************************************************/
+void stopSpecialEvent(uint8_t specialEvent) {
+  uint8_t i;
+  for (i = 0; i < SCRIPT_NUM; i++) {
+    if (g_script[i].specialEvent == specialEvent) {
+      mytimers.cancel(g_script[i].timer);
+      g_script[i].timer = TIMER_NONE;
+      g_script[i].specialEvent = SE_NONE;
+    }
+  }
+}
+
+
+/************************************************************
+ *  Continue Script
+ ************************************************************
+ * Execute the Commands of a running Special Event until 
+ * the next Wait or the End of the Special Event.
+ * Timer Callback of the Waits.
+ * @param[in] s # of Script
+ ************************************************************/
+void continueScript(uint8_t s) {
+  script* sc = &g_script[s];
+  uint8_t len;          // Number of Bytes of Special Event
+  uint8_t cmdByte;      // actual Command
+  uint16_t wait;        // Wait after this Command [100ms]
+  uint8_t i;
+  uint8_t node;         // Node of a Remote Command
+  uint32_t mask;
+  sc->timer = TIMER_NONE;
+  len = myconfig.getSpecialEventFromEEprom(sc->specialEvent, 0);
+  while (sc->pos <= len) {
+    cmdByte = myconfig.getSpecialEventFromEEprom(sc->specialEvent, sc->pos++);
+    wait = sc->speed;
+    if (cmdByte & 0xe0) {
+      // One-Byte Command
+      executeCommand(cmdByte);
+    } else {
+      // Multi-Byte Command
+      switch (cmdByte) {
+        case CMD_SPEED:
+          sc->speed = myconfig.getSpecialEventFromEEprom(sc->specialEvent, sc->pos++);
+          wait = sc->speed;
+          break;
+        case CMD_WAIT:
+          wait += myconfig.getSpecialEventFromEEprom(sc->specialEvent, sc->pos++);
+          break;
+        case CMD_ON_MASK:
+        case CMD_OFF_MASK:
+          // Mask: A B C D, A = most significant Byte
+          mask = 0;
+          for (i = 0; i < 4; i++) {
+            mask = (mask << 8) | myconfig.getSpecialEventFromEEprom(sc->specialEvent, sc->pos++);
+          }
+          TRACE_MARK(TRACE_DISPATCH);
+          if (cmdByte == CMD_ON_MASK) {
+            setOutputs(g_lastOutState | mask);
+          } else {
+            setOutputs(g_lastOutState & ~mask);
+          }
+          break;
+        case CMD_ROLLER_POS:
+          // Roller Mask, Position [%]
+          i = myconfig.getSpecialEventFromEEprom(sc->specialEvent, sc->pos++);
+          myrollers.moveTo(i, myconfig.getSpecialEventFromEEprom(sc->specialEvent, sc->pos++));
+          break;
+        case CMD_REMOTE_ON:
+        case CMD_REMOTE_OFF:
+        case CMD_REMOTE_TOGGLE:
+          // Node, Mask: A B C D
+          node = myconfig.getSpecialEventFromEEprom(sc->specialEvent, sc->pos++);
+          mask = 0;
+          for (i = 0; i < 4; i++) {
+            mask = (mask << 8) | myconfig.getSpecialEventFromEEprom(sc->specialEvent, sc->pos++);
+          }
+          #if DO_BUS
+            mybus.sendOutputs(node, (cmdByte == CMD_REMOTE_ON) ? mask : 0,
+                              (cmdByte == CMD_REMOTE_OFF) ? mask : 0, (cmdByte == CMD_REMOTE_TOGGLE) ? mask : 0);
+          #endif // DO_BUS
+          break;
+      }
+    }
+    if (wait && (sc->pos <= len)) {
+      sc->timer = mytimers.start(100 * (uint32_t)wait, continueScript, s);
+      if (sc->timer == TIMER_NONE) {
+        DBG_ERROR.println(F("ERROR: no free Timer"));
+        break;
+      }
+      return;
+    }
+  }
+  sc->specialEvent = SE_NONE;
+}
+
+
+/************************************************************
+ *  Process Click
+ ************************************************************
+ * Called by the Button State Machine for each Click and
+ * Hold Event
+ * Executes the Command of the first Rule of this Click 
+ * whose Condition holds, else the Command configured in 
+ * the Click Tables (Chord Table for Chords)
+ * Hold Events without Rule (Jog):
+ * - Hold Start:   Command of the Long-Click Table
+ * - Hold Repeat:  no Command
+ * - Hold Release: Roller Command of the Long-Click Table is
+ *                 stopped (same Rollers), else no Command
+ * @param[in] clickType BUTTON_CLICK, BUTTON_CLICK_DOUBLE, 
+ *                      BUTTON_CLICK_LONG, BUTTON_CLICK_CHORD
+ *                      or BUTTON_HOLD_xxx
+ * @param[in] inPin Input Pin, # of Chord for BUTTON_CLICK_CHORD
+ * @param[in] duration [ms] since the Press (Long-Click and
+ *                     Hold Events), else 0
+ ************************************************************/
+void processClick(uint8_t clickType, uint8_t inPin, uint16_t duration) {
+  uint8_t cmdByte;
+  uint8_t cmd;
+  uint8_t par;
+  uint32_t inputs;
+  TRACE_MARK(TRACE_CLASSIFY);
+  if (myrules.match(RULE_TRIGGER(clickType, inPin), g_lastOutState, g_lastButtonState, cmdByte)) {
+    DBG_EVENT.print(F("Rule - "));
+  } else if (clickType == BUTTON_CLICK_CHORD) {
+    cmdByte = myconfig.getChordFromEEprom(inPin, inputs);
+  } else if (clickType == BUTTON_HOLD_REPEAT) {
+    cmdByte = EVENT_NULL;
+  } else if (clickType >= BUTTON_HOLD_START) {
+    cmdByte = myconfig.getClickCommandFromEEprom(BUTTON_CLICK_LONG, inPin, cmd, par);
+    if (clickType == BUTTON_HOLD_RELEASE) {
+      cmdByte = (cmdByte >= EVENT_ROLLER_ACTION) ? (EVENT_ROLLER_STOP | par) : EVENT_NULL;
+    }
+  } else {
+    cmdByte = myconfig.getClickCommandFromEEprom(clickType, inPin, cmd, par);
+  }
+  DBG_EVENT.print(F("Click: "));
+  DBG_EVENT.print(clickType);
+  DBG_EVENT.print(F(" - Pin: "));
+  DBG_EVENT.print(inPin);
+  DBG_EVENT.print(F(" - "));
+  DBG_EVENT.print(duration);
+  DBG_EVENT.print(F("ms - Cmd: 0x"));
+  DBG_EVENT.println(cmdByte, HEX);
+  TRACE_DISPATCHING(true);
+  executeCommand(cmdByte);
+  // Close Trace if no Output was changed
+  TRACE_MARK(TRACE_DISPATCH);
+  TRACE_DISPATCHING(false);
+  TRACE_FINISH();
 }
 
 
@@ -341,63 +970,23 @@ void setOutputs(uint32_t newOutState) {
     DBG_STATE.println(F("]"));
   }
 #else
-  void printStateABCD(uint32_t s) {};
+  void printMcpStateABCD(uint32_t s) {};
 #endif  // DEBUG_STATE
 
-#if DO_SPEED
-  /************************************************************
-   * speedTest 
-   ************************************************************/
-  void speedTest() {
-    uint32_t i;
-    uint8_t  v8;
-    uint16_t v16;
-    uint32_t startT;
-    uint32_t endT;
-    uint16_t us16bit;
-    uint16_t us8bit;
-    if (millis() - lastPrint > SPEEDBEAT) {          
-      Serial.println(F("-------------------------------------"));
-      Serial.println(F("Speedtest started ..."));
-      // 8 Bit Mode
-      Serial.println(F("1: 8 Bit Mode (read MCP-Registers seperate)"));
-      startT = millis();
-      for (i=0; i<SPEEDRUNS; i++) {
-        v8 = mcp[0].readGPIO(0);                // Read Port A + B
-        v8 = mcp[0].readGPIO(1);                // Read Port A + B          
-      }     
-      endT = millis();    
-      us8bit = (endT-startT) / SPEEDUSDIVISOR;
-      Serial.print(F("   Started: "));     Serial.print(startT);  
-      Serial.print(F(" - Finished: "));    Serial.print(endT);  
-      Serial.print(F(" - Dauer: "));       Serial.println(endT-startT);              
-      Serial.println(F("-------------------------------------"));
-      
-      // 16 Bit Mode
-      Serial.println(F("2: 16 Bit Mode (read both MCP-Registers in one call)"));
-      startT = millis();
-      for (i=0; i<SPEEDRUNS; i++) {      
-        v16 = mcp[0].readGPIOAB();                // Read Port A + B    
-      } 
-      endT = millis();    
-      us16bit = (endT-startT) / SPEEDUSDIVISOR;
-      Serial.print(F("   Started: "));     Serial.print(startT);  
-      Serial.print(F(" - Finished: "));    Serial.print(endT);  
-      Serial.print(F(" - Dauer: "));       Serial.println(endT-startT);  
-      Serial.println(F("-------------------------------------"));
-      Serial.print(F("  I2C-Speed: "));  Serial.println(I2CSPEED);
-      Serial.print(F("      8-Bit: "));  Serial.print(us8bit);   Serial.println(F("us per Sample"));
-      Serial.print(F("     16-Bit: "));  Serial.print(us16bit);  Serial.println(F("us per Sample"));
-      Serial.println(F("--------------------------------------------------------------------------"));
-      lastPrint = millis();
-      // to surpress "unused Variable" warnings
-      v16 = v8++;
-      v8 = (v16 | 0xff);
-    }
-  }
-#endif  // DO_SPEED
 
 
+/************************************************************
+ * Read Input Port 
+ ************************************************************
+ * @param[in] mcp Input-MCP
+ * @returns GPIO A + B, 0 if the Read failed
+ ************************************************************/
+uint16_t readPortAB(mcp23017& mcp) {
+  uint16_t v = 0;
+  mcp.readGPIOAB(v);
+  return (v);
+}
+
 #if DO_HEARTBEAT
   /************************************************************
    * Read Inputs
@@ -407,203 +996,90 @@ void setOutputs(uint32_t newOutState) {
       g_lastPrintTime = millis();
       #if DEBUG_HEARTBEAT        
         DBG_HEARTBEAT.print(F("H-0"));
-        printStateAB(mcp[0].readGPIOAB());      
+        printStateAB(readPortAB(mcp[0]));      
         DBG_HEARTBEAT.print(F("H-1"));
-        printStateAB(mcp[1].readGPIOAB());      
+        printStateAB(readPortAB(mcp[1]));      
       #endif // DEBUG_HEARTBEAT
+      #if DO_TRACE
+        mytrace.printStats();
+      #endif // DO_TRACE
+      myirqs.printStats();
+      #if DO_SLEEP
+        mysleep.printStats();
+      #endif // DO_SLEEP
+      printI2cStatus();
     } 
   } 
 #else 
   void readInputs() {}  
 #endif // DO_HEARTBEAT
 
-/************************************************************
- * Process IRQ 
- ************************************************************/
-void processIrq(void) {    
-  uint16_t i_port;    
-  uint8_t intstate;
-  // Print Value
-  if (g_irqFlag) {
-    // Print Portstate      
-    #if DEBUG_IRQ   
-      DBG_IRQ.print(F("I-0"));
-      printStateAB(mcp[0].readGPIOAB());      
-      DBG_IRQ.print(F("I-1"));
-      printStateAB(mcp[1].readGPIOAB());      
-    #endif //  DEBUG_IRQ   
-    g_irqFlag = false;    
-  } 
-  delay(100);
-  // Arduino IRQ-Pin changed        
-  intstate = digitalRead(INT_PIN);
-  if (g_lastIntState != intstate) {
-    g_lastIntState = intstate;
-    #if DEBUG_IRQ   
-      DBG_IRQ.print(F("Int: "));
-      DBG_IRQ.println(g_lastIntState);      
-    #endif // DEBUG_IRQ   
-  } 
-  // Reset IRQ State if INT=0 (active)
-  if (!intstate){      
-    if (millis() - g_lastResetTime > IRQ_RESETINTERVAL) {
-      g_lastResetTime = millis();
-      i_port = mcp[0].readGPIOAB();  // Read Port A + B    
-      if (i_port == 0) {
-        // clearInterrupts    
-        intstate = mcp[0].readRegister(MCP23017_INTCAPA);
-        intstate = mcp[0].readRegister(MCP23017_INTCAPB);      
-        #if DEBUG_IRQ   
-          DBG_IRQ.println(F("I-0: Reset IRQ"));                  
-        #endif // DEBUG_IRQ             
-      } 
-      i_port = mcp[1].readGPIOAB();  // Read Port A + B    
-      if (i_port == 0) {
-        // clearInterrupts    
-        intstate = mcp[1].readRegister(MCP23017_INTCAPA);
-        intstate = mcp[1].readRegister(MCP23017_INTCAPB);
-        #if DEBUG_IRQ
-          DBG_IRQ.println(F("I-1: Reset IRQ"));
-        #endif // DEBUG_IRQ
-      } 
-    }
-  }
-} 
-
-
-/************************************************************
- * timerOrButton
- ************************************************************
- * Wait for time or until button pressed
- * returns true if button was pressed
- ************************************************************/
-boolean timerOrButton(uint16_t t){  
-  boolean buttonReleased;
-  uint32_t starttime = millis();  
-  DBG.print(F("timerOrButton - "));        
-  DBG.print(t);        
-  DBG.print(F(" ... "));        
-  // Button released?
-  buttonReleased = digitalRead(BUTTON);
-  // int running = 1;  
-  while (true) {
-    if ((millis() - starttime) > t) {
-      // running = 0;      
-      DBG.println(F("false"));        
-      return(false);
-    }
-    if (buttonReleased) {
-      if (! digitalRead(BUTTON)) {        
-        DBG.println(F("true"));   
-        return(true);     
-      }      
-    } else {
-      buttonReleased = digitalRead(BUTTON);      
-    }    
-  }
-}
-
-
-/************************************************************
- * rollerUp 
- ************************************************************
- * Move Roller Up (BLOCKING)
- ************************************************************/
-void rollerUp(){      
-  DBG.println(F("Moving Up"));
-  // Start Moving Down
-  LED_ON;
-  DBG.println(F("up start"));
-  mcp[2].writeGPIOAB(STATEUP);
-  delay(25000);
-  // timerOrButton (25000);    
-  DBG.println(F("up stop"));
-  mcp[2].writeGPIOAB(STATESTOP);
-  LED_OFF;
-}
-
-/************************************************************
- * rollerDown
- ************************************************************
- * Move Roller Down (BLOCKING)
- ************************************************************/
-void rollerDown(){    
-  DBG.println(F("Moving DOWN"));
-  // Start Moving Down
-  LED_ON;
-  DBG.println(F("down start"));
-  mcp[2].writeGPIOAB(STATEDOWN);  
-  delay(14000);
-  // if (! timerOrButton (14000)) {
-  DBG.println(F("stop 2-4"));
-  mcp[2].writeGPIOAB(STATEDOWN2);  
-  timerOrButton (4000);  
-  delay(4000);
-  // }  
-  DBG.println(F("down stop"));
-  mcp[2].writeGPIOAB(STATESTOP);
-  LED_OFF;
-}
-
-/************************************************************
- * rollerHandleTimer
- ************************************************************
- * - Stop Roller if timer expired
- * - Global Vars needed
- *   - roller[0] - roller[4]
- *   - roller[0] - roller[4]
- ************************************************************/
-void rollerHandleTimer(){      
-  // 
-
-  LED_ON;
-  DBG.println(F("down start"));
-  mcp[2].writeGPIOAB(STATEDOWN);  
-  if (! timerOrButton (14000)) {
-    DBG.println(F("stop 2-4"));
-    mcp[2].writeGPIOAB(STATEDOWN2);  
-    timerOrButton (4000);  
-  }  
-  DBG.println(F("down stop"));
-  mcp[2].writeGPIOAB(STATESTOP);
-  LED_OFF;
-}
-
-
 /************************************************************
  * Scan Input Buttons
  ************************************************************
  * Read Input-State if
- *  - IRQ occured since last call                         [1]
- *  - after IRQ occured                                   [2] 
- *    - every BUTTON_SCANINT [ms]                         [3]
- *    - untill all inputs=0 for at least BUTTON_SCANTIME  [4]
+ *  - IRQ occured since last call (Edge in myirqs)        [1]
+ *  - the Button State Machine has a Decision pending     [2]
+ *    - every BUTTON_SCANINT [ms] while an Input bounces,
+ *      else at the Long-Click/Double-Click Boundary      [3]
+ *    - no Scan if all Inputs are idle or held: IRQ only,
+ *      no Traffic on the Bus                             [4]
+ * Each Scan is passed to the Button State Machine, dated
+ * with the Time of the oldest queued Edge (not the Scan
+ * Time), but not before the previous Scan
  ***********************************************************/
 void scanButtons(void) {           
   uint32_t thisstate;   // state of this scan
   boolean dothisscan;   // scan this time
+  uint16_t in0;         // Inputs MCP #0
+  uint16_t in1;         // Inputs MCP #1
+  uint32_t edgetime;    // Time of the State Change [ms]
+  irqEvent ev;          // Edge on INT_PIN
   // init vars
   dothisscan = false;
   thisstate = 0x0000;    
+  edgetime = millis();
   // IRQ occured [1]
-  if (g_irqFlag) {     
+  if (myirqs.pop(ev)) {
+    PROF_ENTER(PROF_IRQ);
+    #if DO_SLEEP
+      mysleep.scanned(ev.time);
+    #endif // DO_SLEEP
+    // micros() -> millis(), later Edges are covered by this Scan
+    edgetime -= (micros() - ev.time) / 1000;
+    if ((int32_t)(edgetime - g_lastButtonScanTime) < 0) {
+      edgetime = g_lastButtonScanTime;
+    }
+    while (myirqs.pop(ev)) {
+    }
+    PROF_EXIT(PROF_IRQ);
     dothisscan = true;        
-    g_irqFlag = false;    
-    g_buttonPollingActive = true;
     g_lastButtonReadTime = millis();    
-  } else if (g_buttonPollingActive) {
-    // scan is still active [2]    
-    if (millis() - g_lastButtonReadTime > BUTTON_SCANINT) {
-      // scan every BUTTON_SCANINT[ms]  [3]
+  } else if (g_scanRequest) {
+    // forced by I2C Recovery
+    dothisscan = true;
+    g_scanRequest = false;
+    g_lastButtonReadTime = millis();    
+  } else if (g_buttonScanWait != BUTTON_NO_SCAN) {
+    // Decision pending [2]    
+    if (millis() - g_lastButtonScanTime >= g_buttonScanWait) {
       dothisscan = true;              
     }
   }  
   // Do a scan
   if (dothisscan) {     
+    g_lastButtonScanTime = millis();
     // Read all GPIO Registers        
-    thisstate = (uint32_t)mcp[0].readGPIOAB() + ((uint32_t)mcp[1].readGPIOAB() << 16);        
+    if ((mcp[0].readGPIOAB(in0) != MCP23017_OK) || (mcp[1].readGPIOAB(in1) != MCP23017_OK)) {
+      // keep last State, scan again after Recovery
+      recoverI2c();
+      return;
+    }
+    thisstate = (uint32_t)in0 + ((uint32_t)in1 << 16);        
+    TRACE_MARK(TRACE_SCAN);
     // State changed?
     if (thisstate != g_lastButtonState) {    
+      mystats.inputs(g_lastButtonState, thisstate);
       g_lastButtonState = thisstate;      
       DBG_STATE_CHANGE.print(F("Scan: "));
       printMcpStateABCD(thisstate);
@@ -611,94 +1087,522 @@ void scanButtons(void) {
       if (thisstate == 0) {
         // Reset IRQ 
         DBG_IRQ.println(F("Reseting IRQs"));
-        mcp[0].readRegister(MCP23017_INTCAPA);
-        mcp[0].readRegister(MCP23017_INTCAPB);      
-        mcp[1].readRegister(MCP23017_INTCAPA);
-        mcp[1].readRegister(MCP23017_INTCAPB);
-        // End Scan [4]
-        if (millis() - g_lastButtonReadTime > BUTTON_SCANINT) {
-          g_buttonPollingActive = false;      
-        }
+        mcp[0].readINTCAPAB(in0);
+        mcp[1].readINTCAPAB(in1);
       }
     }    
+    // Button State Machine
+    mybuttons.update(thisstate, (uint16_t)edgetime);
+    // next Scan [3] or IRQ only [4]
+    g_buttonScanWait = mybuttons.nextScan((uint16_t)g_lastButtonScanTime);
+    // IRQ without Click (Noise)
+    if ((thisstate == 0) && !mybuttons.busy() && myirqs.empty()) {
+      TRACE_CANCEL();
+    }
   } 
 }
 
+#if DO_ROLLER_EMERGENCY
+  /************************************************************
+   * Roller Emergency Function (Rolladennotfunktion)
+   ************************************************************
+   * Button on Pin EMERGENCY_BUTTON works like a Roller Button
+   * for all Rollers (Start opposite - Stop - Start opposite)
+   * Scanned every EMERGENCY_SCANINT, not blocking
+   ************************************************************/
+  void rollerEmergency(void) {
+    uint8_t b;
+    if (millis() - g_lastEmergencyTime < EMERGENCY_SCANINT) {
+      return;
+    }
+    g_lastEmergencyTime = millis();
+    b = digitalRead(EMERGENCY_BUTTON);
+    if ((b == LOW) && (g_lastEmergencyState == HIGH)) {
+      DBG_EVENT.println(F("Emergency Button"));
+      myrollers.command(EVENT_ROLLER_ACTION, ROLL_1 | ROLL_2 | ROLL_3 | ROLL_4);
+    }
+    g_lastEmergencyState = b;
+  }
+#else
+  void rollerEmergency(void) {}
+#endif // DO_ROLLER_EMERGENCY
+
+/************************************************************
+ * Configuration uploaded
+ ************************************************************
+ * Called after an Upload of the Configuration Image (verified
+ * or aborted after the first Chunk, then reported invalid)
+ * and after "factory":
+ * stop all Scripts, Roller Positions are unknown (Image may
+ * come from another Controller), reload all Tables and the
+ * Input Modes
+ ************************************************************/
+void configUploaded(void) {
+  uint8_t i;
+  for (i = 0; i < SCRIPT_NUM; i++) {
+    stopSpecialEvent(g_script[i].specialEvent);
+  }
+  myconfig.begin();
+  for (i = 1; i <= ROLLER_NUM; i++) {
+    myconfig.setRollerPosToEEprom(i, ROLLER_POS_UNKNOWN);
+  }
+  myrollers.reload();
+  myscheduler.reload();
+  myrules.reload();
+  for (i = 0; i < MCP_IN_NUM; i++) {
+    setupInputModes(mcp[i], i);
+  }
+  mybuttons.reload();
+}
+
+/************************************************************
+ * Process Serial Commands
+ ************************************************************
+ * - prof:  print and reset Profiling Table
+ * - trace: print last traced Events
+ * - bench: run I2C and Rule Benchmark (BLOCKING, DO_SPEED,
+ *   refused while a Roller is moving)
+ * - i2c:   print I2C Error Counters
+ * - pins:  print pressed Inputs by Terminal (IN_01 = Bit 0)
+ * - pins M: print the Expander Bits of the Output Terminals M
+ *          (OUT_01 = Bit 0, decimal or "0x" hex)
+ * - i2cfault N: let the next N I2C Transfers fail (only with
+ *   the Build Flag MCP23017_FAULT_INJECTION, Tests)
+ * - reset: print Reset Reason and Reset Counters
+ * - time:  print Time of Day
+ * - time D H M [S]: set Time of Day, D: 1=Monday ... 7=Sunday
+ * - date Y M D: set Date (and Weekday)
+ * - sched: print Schedule and next Entry
+ * - autooff: print running Auto-Off Timers
+ * - roller: print Roller Positions
+ * - roller R P: move Roller R (1-4) to P % (0 = up, 100 = down)
+ * - config: print Configuration
+ * - rules: print Number of compiled Rules
+ * - http: print HTTP Statistics
+ * - bus: print Event Bus Statistics and Peers
+ * - bus N ON OFF TGL: switch Outputs of Node N (255: all) by
+ *   Masks (decimal)
+ * - stats: print Switches and On-Time of the Outputs, Presses
+ *   of the Inputs
+ * - stats save: flush the Statistics to EEPROM
+ * - stats clear [O]: clear the Counters of Output O (0-31,
+ *   after a Relay Replacement), without O: all Counters
+ * - click T P C: set Click Table Entry, T: 0=Click, 1=Double,
+ *   2=Long, P: Input (0-31), C: Command Byte (0: no Action)
+ * - rollcfg R P U D C: set Roller R (1-4): Output up P 
+ *   (255: not connected), Time up/down/close [500ms]
+ * - se N: clear Special Event N (N = Number + 1: new one)
+ * - se N B1 [... B6]: append Bytes to Special Event N
+ * - input P C I U [H]: set Input P (0-31) to Timing Class C,
+ *   I: 1=inverted Polarity, U: 1=Pull-Up, H: 1=Hold Events
+ * - btncls C T0 T1 T2 [TR]: set Times of Timing Class C [ms]
+ * - chord N M C: set Chord N (0-5) to Inputs M (Mask, e.g.
+ *   0x9000), C: Command Byte, M = 0xffffffff: clear
+ * - chordwin T: set Chord Window [ms] (max. 254)
+ * Configuration Changes are effective immediately
+ * - cfgget: send binary Configuration Image (see configXfer.h)
+ * - cfgput: receive binary Configuration Image
+ * - factory: reset the Configuration to the Factory Defaults
+ *   of mySettings.h (e.g. after an Upgrade to a new Layout)
+ * While a Transfer is running, Serial is read by the Transfer
+ ************************************************************/
+void processSerialCommand(void) {
+  uint8_t cmd[SERIAL_CMD_ARGS];
+  uint8_t i;
+  boolean ok;
+  if (myxfer.active()) {
+    myxfer.poll();
+    return;
+  }
+  if (!mycmd.poll()) {
+    return;
+  }
+  if (mycmd.is(0, F("prof"))) {
+    #if DEBUG_PROFILE
+      profPrintAndReset();
+    #endif // DEBUG_PROFILE
+  } else if (mycmd.is(0, F("trace"))) {
+    #if DO_TRACE
+      mytrace.printRing();
+      mytrace.printStats();
+    #endif // DO_TRACE
+  } else if (mycmd.is(0, F("bench"))) {
+    #if DO_SPEED
+      if (myrollers.moving()) {
+        // BLOCKING: no Roller would be stopped during the Benchmark
+        DBG.println(F("ERROR: Roller moving"));
+      } else {
+        wdt_disable();
+        runI2cBench(mcp[0], mcp[2], (uint16_t)(g_lastOutState & 0xffff), I2CSPEED, F(FW_VERSION));
+        myrules.bench(F(FW_VERSION));
+        #if DO_WATCHDOG
+          wdt_enable(WATCHDOG_TIMEOUT);
+        #endif // DO_WATCHDOG
+      }
+    #endif // DO_SPEED
+  } else if (mycmd.is(0, F("i2c"))) {
+    printI2cStatus();
+  } else if (mycmd.is(0, F("pins"))) {
+    DBG.print(F("Inputs (Terminals): 0x"));
+    DBG.println(inputsToLogical(g_lastButtonState), HEX);
+    if (mycmd.argc() >= 2) {
+      DBG.print(F("Outputs (Expander): 0x"));
+      DBG.println(outputsToPhysical((uint32_t)mycmd.num(1)), HEX);
+    }
+  } else if (mycmd.is(0, F("reset"))) {
+    myrestore.printState();
+  } else if (mycmd.is(0, F("i2cfault"))) {
+    #if MCP23017_FAULT_INJECTION
+      mcp23017::injectFaults(mycmd.num(1));
+    #endif // MCP23017_FAULT_INJECTION
+  } else if (mycmd.is(0, F("time"))) {
+    if ((mycmd.argc() >= 4) && (mycmd.num(1) >= 1) && (mycmd.num(1) <= 7)) {
+      myscheduler.setTime(mycmd.num(1) - 1, mycmd.num(2), mycmd.num(3), mycmd.num(4));
+    }
+    myscheduler.printTime();
+  } else if (mycmd.is(0, F("date"))) {
+    if (mycmd.argc() >= 4) {
+      myscheduler.setDate(mycmd.num(1), mycmd.num(2), mycmd.num(3));
+    }
+    myscheduler.printTime();
+  } else if (mycmd.is(0, F("autooff"))) {
+    myautooff.printState();
+  } else if (mycmd.is(0, F("stats"))) {
+    if (mycmd.is(1, F("save"))) {
+      mystats.flush();
+    } else if (mycmd.is(1, F("clear"))) {
+      if (mycmd.argc() >= 3) {
+        if ((mycmd.num(2) >= 0) && (mycmd.num(2) < MCP_OUT_PINS)) {
+          mystats.clear(mycmd.num(2));
+        }
+      } else {
+        mystats.clear(STATS_ALL);
+      }
+    }
+    mystats.printState();
+  } else if (mycmd.is(0, F("roller"))) {
+    if ((mycmd.argc() >= 3) && (mycmd.num(1) >= 1) && (mycmd.num(1) <= ROLLER_NUM)) {
+      myrollers.moveTo(1 << (mycmd.num(1) - 1), mycmd.num(2));
+    }
+    myrollers.printState();
+  } else if (mycmd.is(0, F("config"))) {
+    myconfig.printConfig();
+  } else if (mycmd.is(0, F("rules"))) {
+    myrules.printState();
+  } else if (mycmd.is(0, F("http"))) {
+    #if DO_HTTP
+      myhttp.printState();
+    #endif // DO_HTTP
+  } else if (mycmd.is(0, F("bus"))) {
+    #if DO_BUS
+      if (mycmd.argc() >= 5) {
+        mybus.sendOutputs(mycmd.num(1), mycmd.num(2), mycmd.num(3), mycmd.num(4));
+      }
+      mybus.printState();
+    #endif // DO_BUS
+  } else if (mycmd.is(0, F("cfgget"))) {
+    myxfer.startDownload();
+  } else if (mycmd.is(0, F("cfgput"))) {
+    myxfer.startUpload();
+  } else if (mycmd.is(0, F("click"))) {
+    ok = (mycmd.argc() >= 4) && myconfig.setClickCommandToEEprom(mycmd.num(1), mycmd.num(2), mycmd.num(3));
+    DBG.println(ok ? F("OK") : F("ERROR"));
+  } else if (mycmd.is(0, F("rollcfg"))) {
+    ok = (mycmd.argc() >= 6) && myconfig.setRollerToEEprom(mycmd.num(1), mycmd.num(2), mycmd.num(3), mycmd.num(4), mycmd.num(5));
+    if (ok) {
+      myrollers.update(mycmd.num(1));
+    }
+    DBG.println(ok ? F("OK") : F("ERROR"));
+  } else if (mycmd.is(0, F("se"))) {
+    ok = false;
+    if (mycmd.argc() >= 2) {
+      stopSpecialEvent(mycmd.num(1));
+      if (mycmd.argc() == 2) {
+        ok = myconfig.clearSpecialEventInEEprom(mycmd.num(1));
+      } else {
+        for (i = 2; i < mycmd.argc(); i++) {
+          cmd[i - 2] = mycmd.num(i);
+        }
+        ok = myconfig.appendSpecialEventToEEprom(mycmd.num(1), cmd, mycmd.argc() - 2);
+      }
+    }
+    DBG.println(ok ? F("OK") : F("ERROR"));
+  } else if (mycmd.is(0, F("input"))) {
+    ok = (mycmd.argc() >= 5) && myconfig.setInputToEEprom(mycmd.num(1), mycmd.num(2), mycmd.num(3), mycmd.num(4), (mycmd.argc() >= 6) && mycmd.num(5));
+    if (ok) {
+      setupInputModes(mcp[mycmd.num(1) / 16], mycmd.num(1) / 16);
+      mybuttons.reload();
+    }
+    DBG.println(ok ? F("OK") : F("ERROR"));
+  } else if (mycmd.is(0, F("btncls"))) {
+    ok = (mycmd.argc() >= 5) && myconfig.setButtonClassToEEprom(mycmd.num(1), mycmd.num(2), mycmd.num(3), mycmd.num(4), (mycmd.argc() >= 6) ? mycmd.num(5) : 0);
+    if (ok) {
+      mybuttons.reload();
+    }
+    DBG.println(ok ? F("OK") : F("ERROR"));
+  } else if (mycmd.is(0, F("chord"))) {
+    ok = (mycmd.argc() >= 4) && myconfig.setChordToEEprom(mycmd.num(1), (uint32_t)mycmd.num(2), mycmd.num(3));
+    if (ok) {
+      mybuttons.reload();
+    }
+    DBG.println(ok ? F("OK") : F("ERROR"));
+  } else if (mycmd.is(0, F("chordwin"))) {
+    ok = (mycmd.argc() >= 2) && myconfig.setChordWindowToEEprom(mycmd.num(1));
+    if (ok) {
+      mybuttons.reload();
+    }
+    DBG.println(ok ? F("OK") : F("ERROR"));
+  } else if (mycmd.is(0, F("sched"))) {
+    myconfig.printScheduleConfiguration();
+    myscheduler.printNext();
+  } else if (mycmd.is(0, F("factory"))) {
+    myconfig.resetToFactoryDefaults();
+    configUploaded();
+    DBG.println(F("OK"));
+  } else {
+    DBG.print(F("Unknown Command: "));
+    DBG.println(mycmd.arg(0));
+  }
+}
+
+#if DO_HTTP
+  /************************************************************
+   * HTTP Value
+   ************************************************************
+   * Called by the HTTP Server for the live Values of the JSON
+   * Templates
+   * @param[in] key HTTP_VAL_xxx (see httpServer.h)
+   * @param[in] out Response
+   ************************************************************/
+  void httpValue(uint8_t key, Print& out) {
+    uint8_t i;
+    switch (key) {
+      case HTTP_VAL_VERSION:
+        out.print(F(FW_VERSION));
+        break;
+      case HTTP_VAL_UPTIME:
+        out.print(millis() / 1000);
+        break;
+      case HTTP_VAL_OUTPUTS:
+        out.print(g_lastOutState);
+        break;
+      case HTTP_VAL_INPUTS:
+        out.print(g_lastButtonState);
+        break;
+      case HTTP_VAL_ROLLERS:
+        for (i = 1; i <= ROLLER_NUM; i++) {
+          if (i > 1) {
+            out.print(F(","));
+          }
+          if (myrollers.position(i) == ROLLER_POS_UNKNOWN) {
+            out.print(F("null"));
+          } else {
+            out.print(myrollers.position(i));
+          }
+        }
+        break;
+      case HTTP_VAL_MINUTE:
+        if (myscheduler.synced()) {
+          out.print(myscheduler.minuteOfDay());
+        } else {
+          out.print(F("-1"));
+        }
+        break;
+      case HTTP_VAL_RESETS:
+        for (i = PORF; i <= WDRF; i++) {
+          if (i > PORF) {
+            out.print(F(","));
+          }
+          out.print(myrestore.resetCount(i));
+        }
+        break;
+      case HTTP_VAL_I2C:
+        for (i = 0; i < MCP_NUM; i++) {
+          if (i > 0) {
+            out.print(F(","));
+          }
+          out.print(mcp[i].errorCount());
+        }
+        break;
+      case HTTP_VAL_TIMERS:
+        out.print(mytimers.used());
+        break;
+      case HTTP_VAL_SWITCHES:
+      case HTTP_VAL_ON_TIME:
+      case HTTP_VAL_PRESSES:
+        // Output Pins = Input Pins = 32
+        for (i = 0; i < MCP_OUT_PINS; i++) {
+          if (i > 0) {
+            out.print(F(","));
+          }
+          if (key == HTTP_VAL_SWITCHES) {
+            out.print(mystats.switches(i));
+          } else if (key == HTTP_VAL_ON_TIME) {
+            out.print(mystats.onTime(i));
+          } else {
+            out.print(mystats.presses(i));
+          }
+        }
+        break;
+      default:
+        out.print(F("null"));
+        break;
+    }
+  }
+
+  /************************************************************
+   * HTTP Time
+   ************************************************************
+   * Called by the HTTP Server for POST /time: set Clock and
+   * Date of the Scheduler (as the Serial Commands "time" and
+   * "date"), the Weekday follows from the Date
+   * @param[in] year, month, day, hour, minute, second local Time
+   ************************************************************/
+  void httpTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second) {
+    myscheduler.setTime(0, hour, minute, second);
+    myscheduler.setDate(year, month, day);
+  }
+
+  /************************************************************
+   * Poll HTTP Server
+   ************************************************************
+   * Every HTTP_POLL_INTERVAL: handle one waiting Request
+   * (BLOCKING until the Response is sent)
+   ************************************************************/
+  void pollHttp(void) {
+    EthernetClient client;
+    if (!g_netReady || (millis() - g_lastHttpPoll < HTTP_POLL_INTERVAL)) {
+      return;
+    }
+    g_lastHttpPoll = millis();
+    client = myhttpsock.available();
+    if (client) {
+      client.setConnectionTimeout(HTTP_CLOSE_TIMEOUT);
+      myhttp.handle(client);
+    }
+  }
+#else
+  void pollHttp(void) {}
+#endif // DO_HTTP
+
+#if DO_BUS
+  /************************************************************
+   * Bus Outputs
+   ************************************************************
+   * Called by the Event Bus for an Output Frame of another
+   * Node: one Write of the Outputs. Roller Outputs are
+   * masked (only the Roller Control switches them, both
+   * Directions on at once would harm the Motor)
+   * @param[in] on     Outputs to be switched on
+   * @param[in] off    Outputs to be switched off
+   * @param[in] toggle Outputs to be toggled
+   ************************************************************/
+  void busOutputs(uint32_t on, uint32_t off, uint32_t toggle) {
+    uint32_t m;
+    m = ~myrollers.outputMask();
+    setOutputs(((g_lastOutState | (on & m)) & ~(off & m)) ^ (toggle & m));
+  }
+
+  /************************************************************
+   * Poll Event Bus
+   ************************************************************
+   * Each Loop: receive waiting Frames (Output Frames switch 
+   * the Outputs at once), send the State Frame if Outputs or
+   * Inputs have changed
+   ************************************************************/
+  void pollBus(void) {
+    if (!g_netReady) {
+      return;
+    }
+    mybus.poll();
+    mybus.update(g_lastOutState, g_lastButtonState);
+  }
+#else
+  void pollBus(void) {}
+#endif // DO_BUS
+
+#if DO_HTTP || DO_BUS
+  /************************************************************
+   * Setup Network
+   ************************************************************
+   * W5500 with fixed MAC and Address (mySettings.h), no DHCP
+   * - HTTP Server on HTTP_PORT
+   * - Event Bus: Node NET_NODE, Multicast Group BUS_GROUP
+   ************************************************************/
+  void setupNetwork(void) {
+    uint8_t mac[] = {NET_MAC};
+    DBG_SETUP.print(F("- Network ... "));
+    g_netReady = false;
+    Ethernet.init(ETH_CS_PIN);
+    Ethernet.begin(mac, IPAddress(NET_IP));
+    if (Ethernet.hardwareStatus() == EthernetNoHardware) {
+      DBG_ERROR.println(F("ERROR: W5500 not found"));
+      return;
+    }
+    #if DO_HTTP
+      g_lastHttpPoll = 0;
+      myhttpsock.begin();
+      myhttp.begin(myconfig, httpValue, executeCommand, httpTime);
+    #endif // DO_HTTP
+    #if DO_BUS
+      mybussock.beginMulticast(IPAddress(BUS_GROUP), BUS_PORT);
+      mybus.begin(mybussock, IPAddress(BUS_GROUP), NET_NODE, (uint8_t)myrestore.resets(), busOutputs);
+    #endif // DO_BUS
+    g_netReady = true;
+    DBG_SETUP.print(Ethernet.localIP());
+    DBG_SETUP.println(F(" done."));
+  }
+#endif // DO_HTTP || DO_BUS
+
+/************************************************************
+ * Loop Pending
+ ************************************************************
+ * Called by idleSleep with Interrupts disabled
+ * @returns true if the next Loop must run without Sleep
+ *          (Edge queued, Scan requested, Serial Byte waiting)
+ ************************************************************/
+boolean loopPending(void) {
+  return (!myirqs.empty() || g_scanRequest || Serial.available());
+}
+
 /************************************************************
  * Main Loop
  ************************************************************/
 void loop(){ 
-  
-  // scanButtons();
-  // speedTest();
-  // readInputs();
-  // processIrq();  
-  delay(500);
-  // rollerDown();
-  // rollerUp();
+  uint32_t autoOffMask;
+  PROF_ENTER(PROF_LOOP);
+  #if DO_WATCHDOG
+    wdt_reset();
+  #endif // DO_WATCHDOG
+  PROF_ENTER(PROF_SCAN);
+  scanButtons();
+  rollerEmergency();
+  PROF_EXIT(PROF_SCAN);
+  PROF_ENTER(PROF_TIMER);
+  mytimers.tick();
+  // all Outputs expired in this Tick: one Write
+  autoOffMask = myautooff.take();
+  if (autoOffMask) {
+    setOutputs(g_lastOutState & ~autoOffMask);
+  }
+  myrollers.flush();
+  myscheduler.tick();
+  mystats.tick(g_lastOutState);
+  PROF_EXIT(PROF_TIMER);
+  PROF_ENTER(PROF_HEARTBEAT);
+  readInputs();
+  PROF_EXIT(PROF_HEARTBEAT);
+  processSerialCommand();
+  pollHttp();
+  pollBus();
 
   // DBG.println(F("\n\nresetToFactoryDefaults"));    
   // myconfig.resetToFactoryDefaults();
 
   //DBG.println(F("\n\nprintConfig"));    
   //myconfig.printConfig();
-
-  // Rolladennotfunktion  
-  uint16_t E2Adr;
-  uint8_t E2Val;
-  E2Adr = 0x142;
-  pinMode(BUTTON,INPUT_PULLUP);  // inverted (button pressed = 0)
-  // Read state from EEPROM
-  E2Val = EEPROM.read (E2Adr);
-  // If State is invalif, set to UP (0)
-  if (E2Val > 1) {
-    E2Val = 1;    
-    EEPROM.write(E2Adr, E2Val);       
-  }  
-  // Loop forever
-  while (true) {
-    // if Button pressed 
-    if (!digitalRead(BUTTON)) {
-      if (E2Val == 0) {
-        DBG.println(F("Rollade runter ... \n  "));
-        rollerDown();
-        E2Val = 1;
-        EEPROM.write(E2Adr, E2Val);
-      } else {
-        DBG.println(F("Rollade hoch ... \n  "));
-        rollerUp();
-        E2Val = 0;
-        EEPROM.write(E2Adr, E2Val);
-      }      
-      // wait untill Button released
-      while (digitalRead(BUTTON)) {
-        delay (10);
-      }
-    }
-  }
-
-  // end here
-  while (true) {
-    DBG.println(F("delay (3600000L);"));
-    delay (3600000L);
-  }
-
-    // uint32_t newout;
-  //if (millis() - g_lastOutTime > 50000000) {    
-    //g_lastOutTime = millis();
-    //g_lastButtonState++;
-    //if (g_lastButtonState == 1){
-    //  newout = 0xFF00;      
-    //} else {
-    //  newout = 0x00FF;
-    //  g_lastButtonState =0;
-    //}
-    //DBG_OUTPUT.print(F("Out: "));
-    //DBG_OUTPUT.println(newout,HEX);
-    //mcp[2].writeGPIOAB(newout);
-    //mcp[3].writeGPIOAB(newout);
-    //MCP23017_GPIOA
-    // mcp[3].writeGPIOAB(newout);
- //  }
-
-} 
\ No newline at end of file
+  PROF_EXIT(PROF_LOOP);
+  #if DO_SLEEP
+    mysleep.sleep();
+  #endif // DO_SLEEP
+}
@@ -24,6 +24,20 @@
 #define BUTTON_CLICK          0
 #define BUTTON_CLICK_DOUBLE   1
 #define BUTTON_CLICK_LONG     2
+#define BUTTON_CLICK_CHORD    3     // Chord (Input Pin: # of Chord)
+#define BUTTON_HOLD_START     4     // Hold started (Inputs with INMODE_HOLD, instead of Long-Click)
+#define BUTTON_HOLD_REPEAT    5     // still held, every TR of the Timing Class
+#define BUTTON_HOLD_RELEASE   6     // released after Hold Start
+
+/********************************************************
+ * Input Modes (Input Table)
+ ********************************************************/
+#define INMODE_INVERT         0x80     // Polarity inverted (IPOL)
+#define INMODE_PULLUP         0x40     // Pull-Up enabled (GPPU)
+#define INMODE_HOLD           0x20     // Hold Events instead of Long-Click
+#define INMODE_CLASS          0x0f     // Button Timing Class
+#define INPUT_LOW_ACTIVE      (INMODE_INVERT | INMODE_PULLUP)  // Switch to GND
+#define INPUT_HIGH_ACTIVE     0x00                             // active Output
 
 /********************************************************
  * Event Types
@@ -42,7 +56,27 @@
 #define CMD_WAIT              0x02     // Wait 0.N Seconds (max 25.5s) - 2 Byte Command
 #define CMD_ON_MASK           0x03     // Switch ON  Outputs accorting Mask - 5 Byte Command
 #define CMD_OFF_MASK          0x04     // Switch OFF Outputs accorting Mask - 5 Byte Command
+#define CMD_ROLLER_POS        0x05     // Move Rollers according Mask to Position [%] - 3 Byte Command
+#define CMD_REMOTE_ON         0x06     // Switch ON  Outputs of another Node (Event Bus) - 6 Byte Command
+#define CMD_REMOTE_OFF        0x07     // Switch OFF Outputs of another Node (Event Bus) - 6 Byte Command
+#define CMD_REMOTE_TOGGLE     0x08     // Toggle Outputs of another Node (Event Bus)     - 6 Byte Command
  
+/********************************************************
+ * 32 Bit Mask as 4 Table Bytes: A B C D, A = most 
+ * significant Byte (Special Events, Rules, Chords)
+ ********************************************************/
+#define MASK_BYTES(m)         (uint8_t)((m) >> 24), (uint8_t)((m) >> 16), (uint8_t)((m) >> 8), (uint8_t)(m)
+
+/********************************************************
+ * Rule Triggers (Rule Table)
+ ********************************************************/
+#define RULE_TRIGGER(c, p)    (((c) << 5) | (p))   // Click Type [CCC] + Input Pin [PPPPP]
+#define RULE_NONE             0xff     // Rule not configured (erased EEPROM)
+
+/********************************************************
+ * Chords (Chord Table)
+ ********************************************************/
+#define CHORD_NONE            0xffffffffUL  // Chord not configured (erased EEPROM)
 
 /********************************************************
  * Table Indicies for readFactoryDefaultTable()
@@ -51,6 +85,36 @@
 #define TABLE_INDEX_CLICK_DOUBLE   1
 #define TABLE_INDEX_CLICK_LONG     2
 #define TABLE_INDEX_ROLLER         3
+#define TABLE_INDEX_SCHEDULE       4
+#define TABLE_INDEX_AUTO_OFF       5
+#define TABLE_INDEX_BUTTON_CLASS   6
+#define TABLE_INDEX_INPUT          7
+#define TABLE_INDEX_RULE           8
+#define TABLE_INDEX_CHORD          9
+
+
+/********************************************************
+ * Weekday Masks for Schedule Entries
+ ********************************************************/
+#define SCHED_MON             0x01
+#define SCHED_TUE             0x02
+#define SCHED_WED             0x04
+#define SCHED_THU             0x08
+#define SCHED_FRI             0x10
+#define SCHED_SAT             0x20
+#define SCHED_SUN             0x40
+#define SCHED_WORKDAYS        0x1f     // Monday - Friday
+#define SCHED_WEEKEND         0x60     // Saturday + Sunday
+#define SCHED_DAILY           0x7f     // every Day
+
+/********************************************************
+ * Sunrise/Sunset Schedule Entries
+ * (Hour = SCHED_SUNRISE/SCHED_SUNSET, 
+ *  Minute = SCHED_OFFSET(Offset [min], -128 ... +127))
+ ********************************************************/
+#define SCHED_SUNRISE         24       // Hour: relative to Sunrise
+#define SCHED_SUNSET          25       // Hour: relative to Sunset
+#define SCHED_OFFSET(m)       ((m) + 128)
 
 
 /********************************************************
@@ -64,6 +128,8 @@
 #define ROLL_ACTION           5     // Roller Click State Machine (Start opposite - Stop - Start opposite - Stop...)
 #define ROLL_TICK             6     // Poll Roller (to Stop a moving Roller after Time)
 #define ROLLER_NC             0xff  // Roller not connected
+#define ROLLER_POS_UNKNOWN    0xff  // Roller Position [%] unknown
+#define ROLLER_POS_DEFAULT    0xfe  // Roller Position [%]: Close Position (defaultTime)
 
 
 #endif  //  _MYDEFINES_H_
\ No newline at end of file
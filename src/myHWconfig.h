@@ -34,6 +34,21 @@
  * 0x061+0x062: Adress of Roller-Config Table [RRRR]   [EE_OFFSET_ROLL_ADR]
  * 0x063      : Number of Special Events               [EE_OFFSET_SPECIAL_EVENT_NUM]
  * 0x064+0x065: Adress of Special Events-Table [SSSS]  [EE_OFFSET_SPECIAL_EVENT_ADR]
+ * 0x140-0x143: Roller Positions [%]                   [EE_OFFSET_ROLLER_POS]
+ * 0x150-0x16F: Input Modes (Class, Polarity, Pull-Up) [EE_OFFSET_INPUT]
+ * 0x170-0x17F: Button Timing Classes                  [EE_OFFSET_BUTTON_CLASS]
+ * 0x180-0x1FD: Rules (Condition + Action)             [EE_OFFSET_RULE]
+ * 0x200-0x280: Schedule (Time of Day)                 [EE_OFFSET_SCHEDULE]
+ * 0x290-0x2AF: Auto-Off Durations                     [EE_OFFSET_AUTO_OFF]
+ * 0x2B0-0x2CE: Chord Window + Chords                  [EE_OFFSET_CHORD]
+ * 0x000-0x2CF: Configuration Image                    [EE_CONFIG_SIZE]
+ * 0x300-0x307: Output State + Complement              [EE_OFFSET_OUT_STATE]
+ * 0x308-0x30F: Reset Counters (PO, EXT, BO, WD)       [EE_OFFSET_RESET_COUNT]
+ * 0x310-0x36F: Switch Counters of the Outputs         [EE_OFFSET_STATS_SWITCH]
+ * 0x370-0x3AF: On-Time of the Outputs [h]             [EE_OFFSET_STATS_ON_TIME]
+ * 0x3B0-0x3EF: Press Counters of the Inputs           [EE_OFFSET_STATS_PRESS]
+ * 0x3F0      : Usage Statistics initialized           [EE_OFFSET_STATS_MARK]
+ * 0x3F1      : Configuration Image valid              [EE_OFFSET_CONFIG_VALID]
  *********************************************************
  * Roller-Config Table:                                [EE_OFFSET_BEGIN_VARSPACE]
  * [RRRR]     :  Two values for each Roller            
@@ -62,8 +77,46 @@
 #define EE_OFFSET_CLICK_LONG         0x040    // EE_OFFSET_CLICK_DOUBLE + (MCP_IN_NUM * 16)
 // Roller Table (4 Rollers, 3 Byte each: 12 Byte)
 #define EE_OFFSET_ROLLER             0x060    // EE_OFFSET_CLICK_DOUBLE + (MCP_IN_NUM * 16)
-// Special Events  
+// Special Events: up to EE_OFFSET_ROLLER_POS (208 Byte)
 #define EE_OFFSET_SPECIAL_EVENT      0x070    // EE_OFFSET_ROLLER + 16
+#define EE_SIZE_SPECIAL_EVENT        0x0D0    // EE_OFFSET_ROLLER_POS - EE_OFFSET_SPECIAL_EVENT
+#define SE_MAX                       31       // max. Number of Special Events (5 Bit Parameter)
+// Roller Positions: 4 Byte, Position of last Stop [%], 0xff: unknown
+// (replaces the Direction Bit of the old Emergency Function at 0x142)
+#define EE_OFFSET_ROLLER_POS         0x140
+// Input Modes: 32 Byte (Number of Input Pins)
+#define EE_OFFSET_INPUT              0x150
+// Button Timing Classes: BUTTON_CLASSES * 4 Byte (T0, T1, T2, TR)
+#define EE_OFFSET_BUTTON_CLASS       0x170
+#define BUTTON_CLASSES               4
+#define BUTTON_CLASS_SIZE            4
+// Rules: RULE_MAX * 18 Byte (Trigger, Action, 4 Masks)
+#define EE_OFFSET_RULE               0x180
+#define RULE_MAX                     7
+#define RULE_SIZE                    18
+// Schedule: Number of Entries + SCHED_MAX Entries, 4 Byte each (129 Byte)
+#define EE_OFFSET_SCHEDULE           0x200
+#define SCHED_MAX                    32
+// Auto-Off Durations: 32 Byte (Number of Output Pins)
+#define EE_OFFSET_AUTO_OFF           0x290
+// Chords: Window [ms] + CHORD_MAX * 5 Byte (Inputs, Action)
+#define EE_OFFSET_CHORD              0x2B0
+#define CHORD_MAX                    6
+// Configuration Image (Serial Upload/Download): 0x000 up to here
+#define EE_CONFIG_SIZE               0x2D0
+// Runtime Data (not in the Configuration Image)
+// Output State of last Commit: 4 Byte + 4 Byte Complement
+#define EE_OFFSET_OUT_STATE          0x300
+// Reset Counters: 4 x 2 Byte (Power-On, External, Brown-Out, Watchdog)
+#define EE_OFFSET_RESET_COUNT        0x308
+// Usage Statistics: 3 Byte per Output (Switches), 2 Byte per Output (On-Time [h]),
+// 2 Byte per Input (Presses), Marker
+#define EE_OFFSET_STATS_SWITCH       0x310
+#define EE_OFFSET_STATS_ON_TIME      0x370
+#define EE_OFFSET_STATS_PRESS        0x3B0
+#define EE_OFFSET_STATS_MARK         0x3F0
+// Configuration Image valid: 0xff, 0 while an Upload writes (aborted Upload)
+#define EE_OFFSET_CONFIG_VALID       0x3F1
 
 
 
@@ -177,6 +230,12 @@
  ************************************************************/ 
 #define MCP_RST_PIN           7
 
+
+/************************************************************
+ * W5500 Chip Select (SPI: D11 MOSI, D12 MISO, D13 SCK)
+ ************************************************************/ 
+#define ETH_CS_PIN           10
+
 /************************************************************
  * Mask Values for Roller Selection
  ************************************************************/ 
@@ -106,6 +106,7 @@
 #define SE_3L1_3L2       1         // Special Action: Licht Kinderzimmer: Bettseite + Schrankseite
 #define SE_CHRISTMAS     2         // Special Action: Christmas Lights (out_3D3 + out_3D4 + out_8D1)
 #define SE_LEAVING       3         // Special Action: Leaving - Alle Lichter aus 
+#define SE_LIVING_OFF    4         // Special Action: Licht Wohnzimmer aus (L1 - L4)
  
 
 /********************************************************
@@ -205,11 +206,13 @@ static const uint8_t FactoryDefaultClickDoubleTable[][2] PROGMEM = {
 };
 
 // BUTTON_LONG_CLICK - Events
+// Inputs with INMODE_HOLD (Input Table): Command at Hold Start,
+// Roller Commands are stopped at Hold Release (Jog while held)
 static const uint8_t FactoryDefaultClickLongTable[][2] PROGMEM = {    
-    {in_3R1,  EVENT_ROLLER_STOP + ROLL_1 + ROLL_2},   // Rollade Kinderzimmer Bett      -> [Roller-Stop (1 + 2)]
-    {in_3R2,  EVENT_ROLLER_STOP + ROLL_1 + ROLL_2},   // Rollade Kinderzimmer Schrank   -> [Roller-Stop (1 + 2)]
-    {in_2R1,  EVENT_ROLLER_STOP + ROLL_3 + ROLL_4},   // Rollade Schlafzimmer Yvonne    -> [Roller-Stop (3 + 4)]
-    {in_2R2,  EVENT_ROLLER_STOP + ROLL_3 + ROLL_4},   // Rollade Schlafzimmer Dario     -> [Roller-Stop (3 + 4)]
+    {in_3R1,  EVENT_ROLLER_ACTION + ROLL_1},          // Rollade Kinderzimmer Bett      -> Jog (Bett)
+    {in_3R2,  EVENT_ROLLER_ACTION + ROLL_2},          // Rollade Kinderzimmer Schrank   -> Jog (Schrank)
+    {in_2R1,  EVENT_ROLLER_ACTION + ROLL_3},          // Rollade Schlafzimmer Yvonne    -> Jog (Yvonne)
+    {in_2R2,  EVENT_ROLLER_ACTION + ROLL_4},          // Rollade Schlafzimmer Dario     -> Jog (Dario)
     {in_S1,   EVENT_NULL},                            // Wohnzimmer 4er - 1             -> [     ]
     {in_S2,   EVENT_NULL},                            // Wohnzimmer 4er - 2             -> [     ]
     {in_S3,   EVENT_NULL},                            // Wohnzimmer 4er - 3             -> [     ]
@@ -254,6 +257,13 @@ static const uint8_t FactoryDefaultClickLongTable[][2] PROGMEM = {
  *     - 0x02 0xNN: CMD_WAIT               Wait 0.N Seconds (max 25.5s)   - 2 Byte Command
  *     - 0x03 0xLLLLLLLL: CMD_ON_MASK      Switch ON all MASK Bits set    - 5 Byte Command
  *     - 0x04 0xLLLLLLLL: CMD_OFF_MASK     Switch OFF all MASK Bits set   - 5 Byte Command 
+ *     - 0x05 0xMM 0xPP:  CMD_ROLLER_POS   Move Rollers of MASK to PP %   - 3 Byte Command
+ *                                         (0 = up/open, 100 = down/closed,
+ *                                          0xfe = Close Position)
+ *     - 0x06 0xNN 0xLLLLLLLL: CMD_REMOTE_ON     Switch ON  MASK Bits on Node NN  - 6 Byte Command
+ *     - 0x07 0xNN 0xLLLLLLLL: CMD_REMOTE_OFF    Switch OFF MASK Bits on Node NN  - 6 Byte Command
+ *     - 0x08 0xNN 0xLLLLLLLL: CMD_REMOTE_TOGGLE Toggle MASK Bits on Node NN      - 6 Byte Command
+ *                                         (Event Bus, NN = 0xff: all Nodes)
  ********************************************************
  * In Order to use the Names for Inputs and Outputs the
  * following Field is stored in FLASH as factory default.
@@ -261,7 +271,7 @@ static const uint8_t FactoryDefaultClickLongTable[][2] PROGMEM = {
  ********************************************************/
 static const uint8_t FactoryDefaultSpecialEventsTable[] PROGMEM = {    
     // # of Special Events:
-    3,
+    4,
         // ROOM3: Toggle both Lights in Room 3
         2,                               // Two 1-Byte Events   
             EVENT_TOGGLE + out_3L1,      // Toggle 3L1
@@ -291,7 +301,10 @@ static const uint8_t FactoryDefaultSpecialEventsTable[] PROGMEM = {
             EVENT_OFF + out_14L2,        // Licht Gäste-WC Decke                     
             EVENT_OFF + out_14M1,        // Licht Gäste-WC Motor                     
             CMD_WAIT, 20,                // Wait 2s                                  
-            EVENT_OFF + out_L5           // Off L5                                   
+            EVENT_OFF + out_L5,          // Off L5                                   
+        // LIVING_OFF: all Lights Wohnzimmer OFF
+        5,                               // One 5-Byte Event
+            CMD_OFF_MASK, MASK_BYTES((1UL << out_L1) | (1UL << out_L2) | (1UL << out_L3) | (1UL << out_L4))
 };
 
 
@@ -300,9 +313,9 @@ static const uint8_t FactoryDefaultSpecialEventsTable[] PROGMEM = {
  ********************************************************
  * - Rollers are attached to two OUTPUT Ports one for each
  *   motor direction. The Port for Down-Direction must be 
- *   the Port following the Port which drives the motor 
- *   up. e.g: 
- *   - UP Port 7, DOWN Port 8 * 
+ *   the Terminal following the Terminal which drives the 
+ *   motor up. e.g: 
+ *   - UP OUT_07, DOWN OUT_08 (Bits 9 and 8)
  * - For each Roller the Time to move completely up/down
  *   has to be configured in Half Seconds [500ms]
  * - A maximum of 4 Rollers is supported
@@ -319,7 +332,14 @@ static const uint8_t FactoryDefaultSpecialEventsTable[] PROGMEM = {
  *   - Default-Time: Half-Seconds to travel down to default Close Position
  * - Four Rollers must be configured (16 Byte)
  *   - If a Roller is not connected, use ROLLER_NC (0xff) as Port #
+ * - Motor Protection: the Up and Down Output of a Roller are
+ *   never on at the same Time, after switching off a Motor
+ *   both Outputs stay off for ROLLER_DEAD_TIME
  ********************************************************/
+#define ROLLER_DEAD_TIME      500     // [ms] Dead Time before a Motor is switched on again
+#ifndef ROLLER_STAGGER
+  #define ROLLER_STAGGER        0     // [ms] Delay between the Motor Starts of one Command (0: all at once)
+#endif
 
 static const uint8_t FactoryDefaultRollerTable[][4] PROGMEM = {    
     {out_R1_up, 46, 45, 44},     //  Roller 1:  Kinderzimmer Bett:     Up: 23s, Down 22.5s, Close: 22s
@@ -329,14 +349,213 @@ static const uint8_t FactoryDefaultRollerTable[][4] PROGMEM = {
 };  
 
 
+/********************************************************
+ * Auto-Off (Staircase Timers)
+ ********************************************************
+ * Outputs which are switched off automatically after 
+ * a Duration, whenever they have been switched on 
+ * (by Click, Special Event, Schedule, ...)
+ * - Output: e.g. out_L5
+ * - Duration: [10s] 1 - 254 (max. 42.3 min)
+ ********************************************************
+ * EEPROM Format: 
+ * - Auto-Off Table starts at EE_OFFSET_AUTO_OFF = 0x290
+ * - One Byte for each Output (0 = no Auto-Off,
+ *   0xff = not configured: no Auto-Off)
+ ********************************************************/
+static const uint8_t FactoryDefaultAutoOffTable[][2] PROGMEM = {    
+    {out_L5,    30},      // Licht Diele:              5 min
+    {out_7L2,   30},      // Licht Vorratskammer:      5 min
+    {out_13L1, 180},      // Licht Bad Decke:         30 min
+    {out_13L2, 180},      // Licht Bad Spiegel:       30 min
+    {out_14L1,  60},      // Licht Gäste-WC Spiegel:  10 min
+    {out_14L2,  60},      // Licht Gäste-WC Decke:    10 min
+    {out_14M1,  90}       // Licht Gäste-WC Motor:    15 min
+};
+
+
+/********************************************************
+ * Schedule (Time of Day)
+ ********************************************************
+ * Commands executed at a Time of Day on selected Weekdays
+ * - Weekdays: Mask SCHED_MON ... SCHED_SUN, SCHED_WORKDAYS,
+ *             SCHED_WEEKEND, SCHED_DAILY
+ * - Hour, Minute: Time of Day (local Time) or
+ *   - SCHED_SUNRISE, SCHED_OFFSET(Offset [min]) or
+ *   - SCHED_SUNSET,  SCHED_OFFSET(Offset [min])
+ *   e.g. SCHED_SUNSET, SCHED_OFFSET(-10): 10 min before Sunset
+ * - Action: One-Byte Command as in the Click Tables 
+ *           (EVENT_xxx + Parameter)
+ * - ENTRIES MUST BE SORTED BY HOUR AND MINUTE
+ *   (fixed Times, then Sunrise and Sunset by Offset)
+ * - max. SCHED_MAX Entries
+ ********************************************************
+ * EEPROM Format: 
+ * - Schedule starts at EE_OFFSET_SCHEDULE = 0x200
+ * - 0x200: Number of Entries
+ * - 0x201++: 4 Byte for each Entry: Weekdays, Hour, Minute, Action
+ ********************************************************/
+static const uint8_t FactoryDefaultScheduleTable[][4] PROGMEM = {    
+    {SCHED_WORKDAYS,  6, 30, EVENT_ROLLER_UP + ROLL_1 + ROLL_2 + ROLL_3 + ROLL_4},    // Workdays 06:30 -> all Rollers up
+    {SCHED_WEEKEND,   8, 30, EVENT_ROLLER_UP + ROLL_1 + ROLL_2 + ROLL_3 + ROLL_4},    // Weekend  08:30 -> all Rollers up
+    {SCHED_DAILY, SCHED_SUNSET, SCHED_OFFSET(15), EVENT_ROLLER_DOWN + ROLL_1 + ROLL_2},   // Daily Sunset + 15min -> Rollers Kinderzimmer down
+    {SCHED_DAILY, SCHED_SUNSET, SCHED_OFFSET(30), EVENT_ROLLER_DOWN + ROLL_3 + ROLL_4}    // Daily Sunset + 30min -> Rollers Schlafzimmer down
+};
+
+
+/********************************************************
+ * Location and Time Zone (Sunrise/Sunset)
+ ********************************************************/
+#define SUN_LATITUDE       4945    // [1/100 deg] North
+#define SUN_LONGITUDE       1108   // [1/100 deg] East
+#define SUN_TIMEZONE          60   // [min] Local Standard Time - UTC
+#define SUN_DST_EU             1   // Daylight Saving Time: last Sunday in March - last Sunday in October
+
+
+/********************************************************
+ * Network (HTTP Server and Event Bus on the W5500, 
+ * fixed Address)
+ ********************************************************/
+#define NET_NODE           1                                    // Node on the Event Bus (1-254), unique per Controller
+#define NET_MAC            0xDE, 0xAD, 0xBE, 0xEF, 0x20, NET_NODE
+#define NET_IP             192, 168, 1, 200 + NET_NODE
+#define BUS_GROUP          239, 255, 42, 1                      // Multicast Group of the Event Bus (same on all Nodes)
+
+
 /********************************************************
  * Time Constants for Button State Machine
  ********************************************************/
 #define BUTTON_T0            20  // <T0= No Klick (Noise)  20ms (T0-1)*10ms (max   30ms)
 #define BUTTON_T1          1000  // >T1= Long Klick       950ms (T1-1)*10ms (max 1000ms)
 #define BUTTON_T2           200  // <T2= Double Klick     190ms (T2-1)*10ms (max  200ms)
-#define BUTTON_SCANINT       10  // [ms] Scan interval after IRQ occured
-#define BUTTON_SCANTIME    1000  // [ms] Stop scanning every BUTTON_SCANINT after this time 
+#define BUTTON_TR           250  // Repeat Interval while held (Hold Events)
+#define BUTTON_SCANINT       10  // [ms] Scan interval while an Input may bounce (< T0 after Edge)
+#define CHORD_WINDOW        150  // [ms] all Buttons of a Chord pressed within (max. 254ms, < T1)
+
+
+/********************************************************
+ * Button Timing Classes
+ ********************************************************
+ * Each Input belongs to one of BUTTON_CLASSES Classes
+ * - T0: Press shorter than T0 is Noise [ms]
+ * - T1: Press held for T1 is a Long Click [10ms]
+ * - T2: second Press within T2 is a Double Click [10ms],
+ *       0: no Double Click (Click reported on Release)
+ * - TR: Repeat Interval of Hold Events [10ms], 0: no Repeat
+ * BUTTON_T0/T1/T2/TR are the Times of Class 0
+ ********************************************************
+ * EEPROM Format: 
+ * - Class Table starts at EE_OFFSET_BUTTON_CLASS = 0x170
+ * - 4 Byte for each Class: T0, T1, T2, TR
+ ********************************************************/
+#define BUTTON_CLASS_STANDARD  0  // Standard Switches
+#define BUTTON_CLASS_STIFF     1  // stiff Push-Buttons (Bad)
+#define BUTTON_CLASS_SOFT      2  // soft Rockers (Wohnzimmer)
+#define BUTTON_CLASS_SENSOR    3  // Motion Sensors (no Double/Long Click)
+
+static const uint8_t FactoryDefaultButtonClassTable[BUTTON_CLASSES][BUTTON_CLASS_SIZE] PROGMEM = {
+    {BUTTON_T0, BUTTON_T1 / 10, BUTTON_T2 / 10, BUTTON_TR / 10},   // Standard:  20ms,  1s, 200ms, 250ms
+    {30,        150,            35,             25},               // Stiff:     30ms, 1.5s, 350ms, 250ms
+    {20,         70,            15,             20},               // Soft:      20ms, 0.7s, 150ms, 200ms
+    {50,        254,             0,              0}                // Sensor:    50ms, 2.54s, no Double Click, no Repeat
+};
+
+
+/********************************************************
+ * Input Modes
+ ********************************************************
+ * Timing Class and Electrical Mode of each Input, Inputs
+ * not listed: BUTTON_CLASS_STANDARD, INPUT_LOW_ACTIVE
+ * - Input: e.g. in_S1
+ * - Class: BUTTON_CLASS_xxx
+ * - Mode: INPUT_LOW_ACTIVE:  Pull-Up, Switch to GND (=1)
+ *         INPUT_HIGH_ACTIVE: no Pull-Up, active Output (e.g.
+ *                            Motion Sensor)
+ *         + INMODE_HOLD:     Hold Events instead of 
+ *                            Long-Click (Start, Repeat every
+ *                            TR, Release with Duration)
+ ********************************************************
+ * EEPROM Format: 
+ * - Input Table starts at EE_OFFSET_INPUT = 0x150
+ * - One Byte for each Input: [IUHx CCCC] 
+ *   I: inverted Polarity, U: Pull-Up, H: Hold, C: Class
+ * - Polarity and Pull-Up are written to IPOL/GPPU at Setup
+ ********************************************************/
+static const uint8_t FactoryDefaultInputTable[][3] PROGMEM = {    
+    {in_3R1,  BUTTON_CLASS_STANDARD, INPUT_LOW_ACTIVE | INMODE_HOLD},   // Rollade Kinderzimmer Bett
+    {in_3R2,  BUTTON_CLASS_STANDARD, INPUT_LOW_ACTIVE | INMODE_HOLD},   // Rollade Kinderzimmer Schrank
+    {in_2R1,  BUTTON_CLASS_STANDARD, INPUT_LOW_ACTIVE | INMODE_HOLD},   // Rollade Schlafzimmer Yvonne
+    {in_2R2,  BUTTON_CLASS_STANDARD, INPUT_LOW_ACTIVE | INMODE_HOLD},   // Rollade Schlafzimmer Dario
+    {in_13S1, BUTTON_CLASS_STIFF, INPUT_LOW_ACTIVE},   // Bad oben
+    {in_13S2, BUTTON_CLASS_STIFF, INPUT_LOW_ACTIVE},   // Bad unten
+    {in_S1,   BUTTON_CLASS_SOFT,  INPUT_LOW_ACTIVE},   // Wohnzimmer 4er - 1
+    {in_S2,   BUTTON_CLASS_SOFT,  INPUT_LOW_ACTIVE},   // Wohnzimmer 4er - 2
+    {in_S3,   BUTTON_CLASS_SOFT,  INPUT_LOW_ACTIVE},   // Wohnzimmer 4er - 3
+    {in_S4,   BUTTON_CLASS_SOFT,  INPUT_LOW_ACTIVE}    // Wohnzimmer 4er - 4
+};
+
+
+/********************************************************
+ * Rules
+ ********************************************************
+ * Commands depending on the State of Outputs and Inputs.
+ * A Rule takes Precedence over the Click Tables: on a
+ * Click the Rules of this Click are checked in Table 
+ * Order, the first Rule whose Condition holds replaces
+ * the Click Table Command. If no Rule holds, the Click
+ * Table Command is executed.
+ * - Trigger: RULE_TRIGGER(BUTTON_CLICK_xxx, Input),
+ *            RULE_TRIGGER(BUTTON_HOLD_xxx, Input) or
+ *            RULE_TRIGGER(BUTTON_CLICK_CHORD, # of Chord)
+ * - Action: One-Byte Command as in the Click Tables 
+ *           (EVENT_xxx + Parameter)
+ * - Condition: all Outputs of Out-On on, all of Out-Off
+ *   off, all Inputs of In-On active, all of In-Off not 
+ *   active (each a 32 Bit Mask, 0: don't care)
+ * - max. RULE_MAX Rules
+ ********************************************************
+ * EEPROM Format: 
+ * - Rule Table starts at EE_OFFSET_RULE = 0x180
+ * - RULE_SIZE (18) Byte for each Rule: Trigger, Action, 
+ *   Out-On, Out-Off, In-On, In-Off (4 Byte each, most 
+ *   significant Byte first)
+ * - Trigger RULE_NONE: Rule not configured
+ ********************************************************/
+static const uint8_t FactoryDefaultRuleTable[][RULE_SIZE] PROGMEM = {
+    // Diele Wohnungseingang long -> Leaving, only if Balkon is off
+    {RULE_TRIGGER(BUTTON_CLICK_LONG, in_S11), EVENT_SPECIAL + SE_LEAVING,
+     MASK_BYTES(0), MASK_BYTES(1UL << out_6D1), MASK_BYTES(0), MASK_BYTES(0)}
+};
+
+
+/********************************************************
+ * Chords
+ ********************************************************
+ * Buttons pressed together: when the last Button of a
+ * Chord is pressed within CHORD_WINDOW after the first
+ * one, the Chord is reported (Click Type BUTTON_CLICK_CHORD,
+ * Rules apply) and the Clicks of its Buttons are 
+ * suppressed until all of them are released
+ * - Inputs: Mask of at least 2 Inputs (1UL << in_xxx)
+ * - Action: One-Byte Command as in the Click Tables 
+ *           (EVENT_xxx + Parameter)
+ * - A Chord is not reported while one of its Inputs 
+ *   belongs to a reported Chord which is still held
+ * - max. CHORD_MAX Chords
+ ********************************************************
+ * EEPROM Format: 
+ * - Chord Table starts at EE_OFFSET_CHORD = 0x2B0
+ * - 0x2B0: CHORD_WINDOW [ms] (0xff: not configured, 
+ *   CHORD_WINDOW is used)
+ * - 0x2B1++: 5 Byte for each Chord: Inputs (4 Byte, most 
+ *   significant Byte first), Action
+ * - Inputs CHORD_NONE or less than 2 Inputs: Chord not 
+ *   configured
+ ********************************************************/
+static const uint8_t FactoryDefaultChordTable[][5] PROGMEM = {
+    // Wohnzimmer 4er - 1 + 4 -> Licht Wohnzimmer aus
+    {MASK_BYTES((1UL << in_S1) | (1UL << in_S4)), EVENT_SPECIAL + SE_LIVING_OFF}
+};
 
 
 /********************************************************
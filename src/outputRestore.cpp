@@ -0,0 +1,193 @@
+/*!
+ * @file outputRestore.cpp
+ */
+#include <outputRestore.h>
+#include <avr/eeprom.h>
+#include <avr/wdt.h>
+
+// Names of Reset Reasons (Bits of MCUSR) for printState()
+static const char resetName0[] PROGMEM = " PO";
+static const char resetName1[] PROGMEM = " EXT";
+static const char resetName2[] PROGMEM = " BO";
+static const char resetName3[] PROGMEM = " WD";
+static const char* const resetNames[WDRF + 1] PROGMEM = {
+  resetName0, resetName1, resetName2, resetName3
+};
+
+// Instance for the Timer Callback
+static outputRestore* outputRestoreInstance;
+
+// Reset Flags (MCUSR), saved by saveResetFlags()
+static uint8_t outResetFlags __attribute__ ((section (".noinit")));
+
+// Copy of the Outputs, not cleared at Startup
+static uint32_t outRamState __attribute__ ((section (".noinit")));
+static uint32_t outRamCheck __attribute__ ((section (".noinit")));
+
+/************************************************************
+ * saveResetFlags
+ * Runs before the C Runtime (.init3): save and clear MCUSR,
+ * switch off the Watchdog. Optiboot clears MCUSR itself and
+ * passes it in r2.
+ ************************************************************/
+void saveResetFlags (void) __attribute__ ((naked, used, section (".init3")));
+void saveResetFlags (void) {
+  outResetFlags = MCUSR;
+  if (outResetFlags == 0) {
+    __asm__ __volatile__ ("sts %0, r2\n" : "=m" (outResetFlags) :);
+  }
+  MCUSR = 0;
+  wdt_disable();
+}
+
+/************************************************************
+ * load (public)
+ * Determine the State to be restored. Called first in
+ * setup(), no Serial Output, no EEPROM Write (a Write
+ * blocks the following Reads for ~3.4ms per Byte)
+ * @returns State of the Outputs (Roller Outputs to be masked)
+ ************************************************************/
+uint32_t outputRestore::load (void) {
+  uint32_t state;
+  state = 0;
+  _source = OUTRESTORE_NONE;
+  if (!(outResetFlags & (1 << PORF)) && (outRamCheck == (~outRamState ^ OUTRESTORE_MAGIC))) {
+    state = outRamState;
+    _source = OUTRESTORE_RAM;
+  } else if (!(outResetFlags & (1 << PORF)) || OUTRESTORE_POWER_ON) {
+    state = eeprom_read_dword((const uint32_t*)EE_OFFSET_OUT_STATE);
+    if (eeprom_read_dword((const uint32_t*)(EE_OFFSET_OUT_STATE + 4)) == ~state) {
+      _source = OUTRESTORE_EEPROM;
+    } else {
+      // never committed (erased EEPROM)
+      state = 0;
+    }
+  }
+  outRamState = state;
+  outRamCheck = ~state ^ OUTRESTORE_MAGIC;
+  _state = state;
+  _timer = TIMER_NONE;
+  _commits = 0;
+  return (state);
+}
+
+/************************************************************
+ * begin (public)
+ * Count the Reset Reason in EEPROM (BLOCKING, ~3.4ms per
+ * changed Byte). Called after the Outputs are written.
+ * @param[in] timers Timer Wheel for the Commit Deadline
+ ************************************************************/
+void outputRestore::begin (timerWheel& timers) {
+  uint8_t i;
+  uint16_t* counter;
+  _timers = &timers;
+  outputRestoreInstance = this;
+  // Counter of each Reset Reason (PORF, EXTRF, BORF, WDRF)
+  for (i = PORF; i <= WDRF; i++) {
+    if (outResetFlags & (1 << i)) {
+      counter = (uint16_t*)(EE_OFFSET_RESET_COUNT + (i * 2));
+      eeprom_update_word(counter, eeprom_read_word(counter) + 1);
+    }
+  }
+}
+
+/************************************************************
+ * update (public)
+ * Called by setOutputs() with every Change: copy to RAM,
+ * commit to EEPROM after OUTRESTORE_DELAY
+ * @param[in] state new State of the Outputs without Rollers
+ ************************************************************/
+void outputRestore::update (uint32_t state) {
+  if (state == _state) {
+    return;
+  }
+  _state = state;
+  outRamState = state;
+  outRamCheck = ~state ^ OUTRESTORE_MAGIC;
+  if (_timer == TIMER_NONE) {
+    _timer = _timers->start(OUTRESTORE_DELAY, commit, 0);
+    if (_timer == TIMER_NONE) {
+      // no Timer free: commit now
+      commit(0);
+    }
+  }
+}
+
+/************************************************************
+ * resetFlags (public)
+ * @returns MCUSR of the last Reset (Bits PORF, EXTRF, BORF, WDRF)
+ ************************************************************/
+uint8_t outputRestore::resetFlags (void) {
+  return (outResetFlags);
+}
+
+/************************************************************
+ * resetCount (public)
+ * @param[in] reason Bit of MCUSR (PORF, EXTRF, BORF, WDRF)
+ * @returns Number of Resets with this Reason
+ ************************************************************/
+uint16_t outputRestore::resetCount (uint8_t reason) {
+  return (eeprom_read_word((const uint16_t*)(EE_OFFSET_RESET_COUNT + (reason * 2))));
+}
+
+/************************************************************
+ * resets (public)
+ * @returns Number of Resets of all Reasons (changes with
+ *          each Start, e.g. Epoch of the Event Bus)
+ ************************************************************/
+uint16_t outputRestore::resets (void) {
+  uint8_t i;
+  uint16_t n;
+  n = 0;
+  for (i = PORF; i <= WDRF; i++) {
+    n += resetCount(i);
+  }
+  return (n);
+}
+
+/************************************************************
+ * commit (private, static)
+ * Timer Callback: write State and Complement to EEPROM
+ * (only changed Bytes)
+ * @param[in] arg not used
+ ************************************************************/
+void outputRestore::commit (uint8_t arg) {
+  outputRestore* o = outputRestoreInstance;
+  (void)arg;
+  o->_timer = TIMER_NONE;
+  eeprom_update_dword((uint32_t*)EE_OFFSET_OUT_STATE, o->_state);
+  eeprom_update_dword((uint32_t*)(EE_OFFSET_OUT_STATE + 4), ~o->_state);
+  o->_commits++;
+}
+
+/************************************************************
+ * printState (public)
+ * Print Reset Reason, Source of the restored State and the
+ * Counters of all Reset Reasons
+ * e.g. "Reset: WD - Restore: RAM - Count: PO 3 EXT 1 BO 0 WD 2 - Commits: 5"
+ ************************************************************/
+void outputRestore::printState (void) {
+  uint8_t i;
+  DBG.print(F("Reset:"));
+  for (i = PORF; i <= WDRF; i++) {
+    if (outResetFlags & (1 << i)) {
+      DBG.print((const __FlashStringHelper*)pgm_read_word(&resetNames[i]));
+    }
+  }
+  DBG.print(F(" - Restore: "));
+  if (_source == OUTRESTORE_RAM) {
+    DBG.print(F("RAM"));
+  } else if (_source == OUTRESTORE_EEPROM) {
+    DBG.print(F("EEPROM"));
+  } else {
+    DBG.print(F("none"));
+  }
+  DBG.print(F(" - Count:"));
+  for (i = PORF; i <= WDRF; i++) {
+    DBG.print((const __FlashStringHelper*)pgm_read_word(&resetNames[i]));
+    DBG.print(F(" "));
+    DBG.print(resetCount(i));
+  }
+  DBG.print(F(" - Commits: "));
+  DBG.println(_commits);
+}
@@ -0,0 +1,61 @@
+/************************************************************
+ * This File implements the Output Restore after a Reset
+ ************************************************************
+ * - The Reset Flags (MCUSR) are saved before the C Runtime
+ *   starts (.init3), the Watchdog is switched off there
+ *   (after a Watchdog Reset it would still run with 15ms).
+ *   A Counter for each Reset Reason is kept in EEPROM,
+ *   updated by begin() after the Outputs are written (each
+ *   changed Byte blocks ~3.4ms).
+ * - Each Output Change is copied to a RAM Area which is not
+ *   cleared at Startup (.noinit, checked by a Complement).
+ *   It survives Watchdog and External Resets.
+ * - The State is committed to EEPROM OUTRESTORE_DELAY after
+ *   a Change (Changes within this Time cost one Commit,
+ *   only changed Bytes are written). It survives Brown-Out
+ *   and Power Loss.
+ * - load() returns the State to be restored: RAM Copy if
+ *   valid, else EEPROM (Reads only). After Power-On only if
+ *   OUTRESTORE_POWER_ON, else all Outputs off.
+ * - Roller Outputs are never stored and are masked on
+ *   Restore (Rollers stay stopped, their Position is
+ *   unknown if they were moving)
+ ************************************************************/
+#ifndef _OUTPUTRESTORE_H_
+#define _OUTPUTRESTORE_H_
+
+#include <Arduino.h>
+#include <debugOptions.h>
+#include <myHWconfig.h>
+#include <timerWheel.h>
+
+#define OUTRESTORE_DELAY      5000UL  // [ms] Commit to EEPROM after last Change
+#define OUTRESTORE_POWER_ON   1       // restore after Power-On too
+#define OUTRESTORE_MAGIC  0x5AA55AA5UL  // RAM Copy valid: check = ~state ^ MAGIC
+
+// Source of the restored State
+#define OUTRESTORE_NONE       0       // all Outputs off
+#define OUTRESTORE_RAM        1       // RAM Copy (Watchdog/External Reset)
+#define OUTRESTORE_EEPROM     2       // EEPROM (Brown-Out/Power-On)
+
+class outputRestore {
+    public:
+    // public functions
+    uint32_t load (void);
+    void begin (timerWheel& timers);
+    void update (uint32_t state);
+    uint8_t resetFlags (void);
+    uint16_t resetCount (uint8_t reason);
+    uint16_t resets (void);
+    void printState (void);
+
+    private:
+    static void commit (uint8_t arg);
+    timerWheel* _timers;              //!< Commit Deadline
+    uint32_t _state;                  //!< State to be committed
+    uint8_t  _timer;                  //!< Commit Timer, TIMER_NONE if committed
+    uint8_t  _source;                 //!< OUTRESTORE_NONE, _RAM or _EEPROM
+    uint16_t _commits;                //!< Commits to EEPROM since Reset
+};
+
+#endif  // _OUTPUTRESTORE_H_
@@ -0,0 +1,124 @@
+/*!
+ * @file pinMap.cpp
+ */
+#include <pinMap.h>
+
+// Expander Bit of each Terminal (Compile Time only)
+static constexpr uint8_t inPhysical[32] = {
+  IN_01, IN_02, IN_03, IN_04, IN_05, IN_06, IN_07, IN_08,
+  IN_09, IN_10, IN_11, IN_12, IN_13, IN_14, IN_15, IN_16,
+  IN_17, IN_18, IN_19, IN_20, IN_21, IN_22, IN_23, IN_24,
+  IN_25, IN_26, IN_27, IN_28, IN_29, IN_30, IN_31, IN_32
+};
+static constexpr uint8_t outPhysical[32] = {
+  OUT_01, OUT_02, OUT_03, OUT_04, OUT_05, OUT_06, OUT_07, OUT_08,
+  OUT_09, OUT_10, OUT_11, OUT_12, OUT_13, OUT_14, OUT_15, OUT_16,
+  OUT_17, OUT_18, OUT_19, OUT_20, OUT_21, OUT_22, OUT_23, OUT_24,
+  OUT_25, OUT_26, OUT_27, OUT_28, OUT_29, OUT_30, OUT_31, OUT_32
+};
+
+/************************************************************
+ * inTerminal (Compile Time)
+ * @param[in] bit Expander Bit of an Input
+ * @param[in] t   first Terminal to be checked (0)
+ * @returns Terminal (0-31) of the Bit, 0xff if none
+ ************************************************************/
+static constexpr uint8_t inTerminal (uint8_t bit, uint8_t t) {
+  return ((t >= 32) ? 0xff : ((inPhysical[t] == bit) ? t : inTerminal(bit, t + 1)));
+}
+
+/************************************************************
+ * Destination Bit b (0-7) of Bit i of Source Byte k
+ * - Inputs:  Expander Byte -> Terminal Byte
+ * - Outputs: Terminal Byte -> Expander Byte
+ ************************************************************/
+static constexpr uint8_t inDest (uint8_t k, uint8_t i) {
+  return (inTerminal((8 * k) + i, 0));
+}
+static constexpr uint8_t outDest (uint8_t k, uint8_t i) {
+  return (outPhysical[(8 * k) + i]);
+}
+
+/************************************************************
+ * Check of Source Byte k (Compile Time)
+ * @returns true if all 8 Bits are mapped into one Byte
+ ************************************************************/
+static constexpr bool inByteOk (uint8_t k, uint8_t i) {
+  return ((i >= 8) || ((inDest(k, i) < 32) && ((inDest(k, i) >> 3) == (inDest(k, 0) >> 3)) && inByteOk(k, i + 1)));
+}
+static constexpr bool outByteOk (uint8_t k, uint8_t i) {
+  return ((i >= 8) || ((outDest(k, i) < 32) && ((outDest(k, i) >> 3) == (outDest(k, 0) >> 3)) && outByteOk(k, i + 1)));
+}
+static_assert(inByteOk(0, 0) && inByteOk(1, 0) && inByteOk(2, 0) && inByteOk(3, 0),
+              "pinMap: Bits of an Input Port Byte must stay in one Terminal Byte");
+static_assert(outByteOk(0, 0) && outByteOk(1, 0) && outByteOk(2, 0) && outByteOk(3, 0),
+              "pinMap: Bits of an Output Terminal Byte must stay in one Port Byte");
+
+/************************************************************
+ * Table Entries (Compile Time)
+ * @param[in] k Source Byte (0-3)
+ * @param[in] v Value of the Source Byte
+ * @returns permuted Bits (Destination Byte: Shift (k))
+ ************************************************************/
+#define PERM_BIT(v, i, d)  ((((v) >> (i)) & 1) << ((d) & 7))
+static constexpr uint8_t inEntry (uint8_t k, uint8_t v) {
+  return (PERM_BIT(v, 0, inDest(k, 0)) | PERM_BIT(v, 1, inDest(k, 1)) |
+          PERM_BIT(v, 2, inDest(k, 2)) | PERM_BIT(v, 3, inDest(k, 3)) |
+          PERM_BIT(v, 4, inDest(k, 4)) | PERM_BIT(v, 5, inDest(k, 5)) |
+          PERM_BIT(v, 6, inDest(k, 6)) | PERM_BIT(v, 7, inDest(k, 7)));
+}
+static constexpr uint8_t outEntry (uint8_t k, uint8_t v) {
+  return (PERM_BIT(v, 0, outDest(k, 0)) | PERM_BIT(v, 1, outDest(k, 1)) |
+          PERM_BIT(v, 2, outDest(k, 2)) | PERM_BIT(v, 3, outDest(k, 3)) |
+          PERM_BIT(v, 4, outDest(k, 4)) | PERM_BIT(v, 5, outDest(k, 5)) |
+          PERM_BIT(v, 6, outDest(k, 6)) | PERM_BIT(v, 7, outDest(k, 7)));
+}
+static constexpr uint8_t inShift (uint8_t k) {
+  return (inDest(k, 0) & 0x18);
+}
+static constexpr uint8_t outShift (uint8_t k) {
+  return (outDest(k, 0) & 0x18);
+}
+
+// 256 Entries of Source Byte k
+#define PERM_4(f, k, v)    f(k, (v)), f(k, (v) + 1), f(k, (v) + 2), f(k, (v) + 3)
+#define PERM_16(f, k, v)   PERM_4(f, k, (v)), PERM_4(f, k, (v) + 4), PERM_4(f, k, (v) + 8), PERM_4(f, k, (v) + 12)
+#define PERM_64(f, k, v)   PERM_16(f, k, (v)), PERM_16(f, k, (v) + 16), PERM_16(f, k, (v) + 32), PERM_16(f, k, (v) + 48)
+#define PERM_256(f, k)     { PERM_64(f, k, 0), PERM_64(f, k, 64), PERM_64(f, k, 128), PERM_64(f, k, 192) }
+
+// Expander Byte -> Terminal Byte
+static const uint8_t inPerm[4][256] PROGMEM = {
+  PERM_256(inEntry, 0), PERM_256(inEntry, 1), PERM_256(inEntry, 2), PERM_256(inEntry, 3)
+};
+
+// Terminal Byte -> Expander Byte
+static const uint8_t outPerm[4][256] PROGMEM = {
+  PERM_256(outEntry, 0), PERM_256(outEntry, 1), PERM_256(outEntry, 2), PERM_256(outEntry, 3)
+};
+
+/************************************************************
+ * inputsToLogical
+ * @param[in] inState packed Input State (Expander Bits, as
+ *                    read by scanButtons())
+ * @returns Input State in Terminal Order (Bit 0 = IN_01)
+ ************************************************************/
+uint32_t inputsToLogical (uint32_t inState) {
+  return (((uint32_t)pgm_read_byte(&inPerm[0][(uint8_t)inState]) << inShift(0)) |
+          ((uint32_t)pgm_read_byte(&inPerm[1][(uint8_t)(inState >> 8)]) << inShift(1)) |
+          ((uint32_t)pgm_read_byte(&inPerm[2][(uint8_t)(inState >> 16)]) << inShift(2)) |
+          ((uint32_t)pgm_read_byte(&inPerm[3][(uint8_t)(inState >> 24)]) << inShift(3)));
+}
+
+/************************************************************
+ * outputsToPhysical
+ * @param[in] terminals Output State in Terminal Order
+ *                      (Bit 0 = OUT_01)
+ * @returns packed Output State (Expander Bits, as written
+ *          by setOutputs())
+ ************************************************************/
+uint32_t outputsToPhysical (uint32_t terminals) {
+  return (((uint32_t)pgm_read_byte(&outPerm[0][(uint8_t)terminals]) << outShift(0)) |
+          ((uint32_t)pgm_read_byte(&outPerm[1][(uint8_t)(terminals >> 8)]) << outShift(1)) |
+          ((uint32_t)pgm_read_byte(&outPerm[2][(uint8_t)(terminals >> 16)]) << outShift(2)) |
+          ((uint32_t)pgm_read_byte(&outPerm[3][(uint8_t)(terminals >> 24)]) << outShift(3)));
+}
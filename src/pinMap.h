@@ -0,0 +1,26 @@
+/************************************************************
+ * This File implements the Pin Permutation between
+ * Expander Bits and Terminals
+ ************************************************************
+ * The packed Port Words use the Bits of the MCP23017s
+ * (IN_xx, OUT_xx in myHWconfig.h), which are scrambled
+ * against the Terminals (IN_01 is Bit 8, OUT_01 is Bit 15,
+ * OUT_09 is Bit 0, ...). The logical Words use Terminal
+ * Order: Bit 0 = IN_01/OUT_01 ... Bit 31 = IN_32/OUT_32.
+ * - Lookup Tables are generated by the Compiler from the
+ *   IN_xx/OUT_xx Definitions (Flash, 256 Byte per Port Byte)
+ * - A whole Word is permuted with four Table Lookups, no
+ *   Loop over the Bits
+ * - The Bits of one Port Byte must stay in one Byte of the
+ *   other Word (in any Order), else the Build fails
+ ************************************************************/
+#ifndef _PINMAP_H_
+#define _PINMAP_H_
+
+#include <Arduino.h>
+#include <myHWconfig.h>
+
+uint32_t inputsToLogical (uint32_t inState);
+uint32_t outputsToPhysical (uint32_t terminals);
+
+#endif  // _PINMAP_H_
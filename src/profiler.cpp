@@ -0,0 +1,50 @@
+/*!
+ * @file profiler.cpp
+ */
+#include <profiler.h>
+
+#if DEBUG_PROFILE
+
+profZone g_profTable[PROF_ZONES];
+
+// Names of Zones for profPrintAndReset()
+static const char profName0[] PROGMEM = "loop      ";
+static const char profName1[] PROGMEM = "scan      ";
+static const char profName2[] PROGMEM = "irq       ";
+static const char profName3[] PROGMEM = "heartbeat ";
+static const char profName4[] PROGMEM = "output    ";
+static const char profName5[] PROGMEM = "config    ";
+static const char profName6[] PROGMEM = "timer     ";
+static const char* const profNames[PROF_ZONES] PROGMEM = {
+  profName0, profName1, profName2, profName3, profName4, profName5,
+  profName6
+};
+
+/************************************************************
+ * profPrintAndReset
+ * Print count, total, average and maximum Time [us] of all
+ * Zones and reset the Table
+ ************************************************************/
+void profPrintAndReset(void) {
+  uint8_t zone;
+  profZone z;
+  DBG_PROFILE.println(F("Profile: zone n total avg max [us]"));
+  for (zone = 0; zone < PROF_ZONES; zone++) {
+    z = g_profTable[zone];
+    g_profTable[zone].count = 0;
+    g_profTable[zone].totalTime = 0;
+    g_profTable[zone].maxTime = 0;
+    DBG_PROFILE.print(F("         "));
+    DBG_PROFILE.print((const __FlashStringHelper*)pgm_read_word(&profNames[zone]));
+    DBG_PROFILE.print(F(" "));
+    DBG_PROFILE.print(z.count);
+    DBG_PROFILE.print(F(" "));
+    DBG_PROFILE.print(z.totalTime);
+    DBG_PROFILE.print(F(" "));
+    DBG_PROFILE.print(z.count ? (z.totalTime / z.count) : 0);
+    DBG_PROFILE.print(F(" "));
+    DBG_PROFILE.println(z.maxTime);
+  }
+}
+
+#endif // DEBUG_PROFILE
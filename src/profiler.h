@@ -0,0 +1,67 @@
+/************************************************************
+ * This File implements the Loop Profiler
+ ************************************************************
+ * Profiling Zones are placed with PROF_ENTER(zone) and
+ * PROF_EXIT(zone) around the Stages of the Main-Loop.
+ * For each Zone the Number of Calls, the total and the
+ * maximum Time [us] are accumulated in a static Table.
+ * The Table is printed and reset with the Serial Command
+ * "prof" (see main.cpp).
+ ************************************************************
+ * If DEBUG_PROFILE is 0 the Macros are empty and the Table
+ * is not compiled.
+ ************************************************************/
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#include <Arduino.h>
+#include <debugOptions.h>
+
+/********************************************************
+ * Profiling Zones
+ ********************************************************/
+#define PROF_LOOP             0     // loop()
+#define PROF_SCAN             1     // scanButtons()
+#define PROF_IRQ              2     // irqQueue Drain in scanButtons()
+#define PROF_HEARTBEAT        3     // readInputs()
+#define PROF_OUTPUT           4     // setOutputs()
+#define PROF_CONFIG           5     // EEPROM Access of Configuration
+#define PROF_TIMER            6     // timerWheel::tick() incl. Callbacks
+#define PROF_ZONES            7     // Number of Zones
+
+#if DEBUG_PROFILE
+  /********************************************************
+   * One Zone of the Profiling Table
+   ********************************************************/
+  typedef struct {
+    uint32_t enterTime;             //!< micros() of last PROF_ENTER
+    uint32_t count;                 //!< Number of Calls
+    uint32_t totalTime;             //!< accumulated Time [us]
+    uint32_t maxTime;               //!< longest Call [us]
+  } profZone;
+
+  extern profZone g_profTable[PROF_ZONES];
+
+  inline void profEnter(uint8_t zone) {
+    g_profTable[zone].enterTime = micros();
+  }
+
+  inline void profExit(uint8_t zone) {
+    uint32_t t = micros() - g_profTable[zone].enterTime;
+    g_profTable[zone].count++;
+    g_profTable[zone].totalTime += t;
+    if (t > g_profTable[zone].maxTime) {
+      g_profTable[zone].maxTime = t;
+    }
+  }
+
+  void profPrintAndReset(void);
+
+  #define PROF_ENTER(zone)  profEnter(zone)
+  #define PROF_EXIT(zone)   profExit(zone)
+#else
+  #define PROF_ENTER(zone)
+  #define PROF_EXIT(zone)
+#endif // DEBUG_PROFILE
+
+#endif  // _PROFILER_H_
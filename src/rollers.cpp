@@ -0,0 +1,559 @@
+/*!
+ * @file rollers.cpp
+ */
+#include <rollers.h>
+
+// Instance for the Timer Callback
+static rollers* rollersInstance;
+
+/************************************************************
+ * begin (public)
+ * @param[in] cfg    Configuration (Roller Table, Positions)
+ * @param[in] timers Timer Wheel for the Stop Deadlines
+ * @param[in] output Output Handler
+ ************************************************************/
+void rollers::begin (config& cfg, timerWheel& timers, rollerOutput output) {
+  uint8_t r;
+  _config = &cfg;
+  _timers = &timers;
+  _output = output;
+  for (r = 0; r < ROLLER_NUM; r++) {
+    _roller[r].dir = ROLL_STOP;
+    _roller[r].lastDir = ROLL_STOP;
+    _roller[r].timer = TIMER_NONE;
+    _roller[r].waiting = false;
+    _roller[r].pending = ROLLER_NO_TARGET;
+    _release[r] = millis() - ROLLER_DEAD_TIME;
+    _roller[r].upPin = ROLLER_NC;
+    _pairMask[r] = 0;
+  }
+  _clear = 0;
+  _set = 0;
+  rollersInstance = this;
+  reload();
+}
+
+/************************************************************
+ * reload (public)
+ * Read Roller Table and stored Positions of all Rollers
+ ************************************************************/
+void rollers::reload (void) {
+  uint8_t r;
+  for (r = 0; r < ROLLER_NUM; r++) {
+    update(r + 1);
+  }
+}
+
+/************************************************************
+ * update (public)
+ * Stop a Roller, read its Configuration and stored Position
+ * from EEPROM and patch the Interlock Table
+ * @param[in] num Number of the Roller (1 to 4)
+ ************************************************************/
+void rollers::update (uint8_t num) {
+  uint8_t r;
+  uint8_t pos;
+  roller* ro;
+  if ((num < 1) || (num > ROLLER_NUM)) {
+    return;
+  }
+  ro = &_roller[num - 1];
+  if (ro->upPin != ROLLER_NC) {
+    stop(num - 1);
+    flush();
+  }
+  _config->getRollerFromEEprom(num, ro->upPin, ro->downPin, ro->upTime, ro->downTime, ro->defaultTime);
+  if ((ro->upPin >= MCP_OUT_PINS) || (ro->downPin >= MCP_OUT_PINS) || (ro->upTime == 0) || (ro->downTime == 0)) {
+    ro->upPin = ROLLER_NC;
+    _pairMask[num - 1] = 0;
+  } else {
+    _pairMask[num - 1] = (1UL << ro->upPin) | (1UL << ro->downPin);
+  }
+  pos = _config->getRollerPosFromEEprom(num);
+  ro->known = (pos != ROLLER_POS_UNKNOWN);
+  ro->pos = ro->known ? (uint16_t)pos * 100 : 0;
+  _lockMask = 0;
+  for (r = 0; r < ROLLER_NUM; r++) {
+    _lockMask |= _pairMask[r];
+  }
+}
+
+/************************************************************
+ * command (public)
+ * Execute a Roller Event for all Rollers of the Mask,
+ * the Outputs of all Rollers are written at once
+ * - EVENT_ROLLER_UP:     move up (0%)
+ * - EVENT_ROLLER_DOWN:   move to the Close Position
+ * - EVENT_ROLLER_STOP:   stop
+ * - EVENT_ROLLER_ACTION: stop if moving, else start
+ *                        opposite to the last Direction
+ * @param[in] event EVENT_ROLLER_ACTION, _UP, _DOWN or _STOP
+ * @param[in] mask  Rollers (ROLL_1 ... ROLL_4)
+ ************************************************************/
+void rollers::command (uint8_t event, uint8_t mask) {
+  uint8_t r;
+  uint16_t stagger;
+  uint16_t target;
+  roller* ro;
+  stagger = 0;
+  for (r = 0; r < ROLLER_NUM; r++) {
+    if (!(mask & (1 << r))) {
+      continue;
+    }
+    ro = &_roller[r];
+    switch (event) {
+      case EVENT_ROLLER_UP:
+        target = 0;
+        break;
+      case EVENT_ROLLER_DOWN:
+        target = closePos(r);
+        break;
+      case EVENT_ROLLER_ACTION:
+        if (ro->dir != ROLL_STOP) {
+          target = ROLLER_NO_TARGET;
+        } else if (ro->known && (ro->pos == 0)) {
+          target = closePos(r);
+        } else if ((ro->lastDir == ROLL_START_UP) && (!ro->known || (ro->pos < closePos(r)))) {
+          target = closePos(r);
+        } else {
+          target = 0;
+        }
+        break;
+      default:
+        target = ROLLER_NO_TARGET;
+        break;
+    }
+    if (target == ROLLER_NO_TARGET) {
+      stop(r);
+    } else if (drive(r, target, stagger)) {
+      stagger += ROLLER_STAGGER;
+    }
+  }
+  flush();
+}
+
+/************************************************************
+ * moveTo (public)
+ * Move all Rollers of the Mask, the Outputs of all Rollers
+ * are written at once
+ * @param[in] mask    Rollers (ROLL_1 ... ROLL_4)
+ * @param[in] percent Target Position: 0 = up/open ...
+ *                    100 = down/closed, ROLLER_POS_DEFAULT:
+ *                    Close Position
+ ************************************************************/
+void rollers::moveTo (uint8_t mask, uint8_t percent) {
+  uint8_t r;
+  uint16_t stagger;
+  uint16_t target;
+  stagger = 0;
+  for (r = 0; r < ROLLER_NUM; r++) {
+    if (!(mask & (1 << r))) {
+      continue;
+    }
+    if (percent == ROLLER_POS_DEFAULT) {
+      target = closePos(r);
+    } else {
+      target = (uint16_t)min(percent, 100) * 100;
+    }
+    if (drive(r, target, stagger)) {
+      stagger += ROLLER_STAGGER;
+    }
+  }
+  flush();
+}
+
+/************************************************************
+ * outputMask (public)
+ * @returns Up and Down Outputs of all Rollers
+ ************************************************************/
+uint32_t rollers::outputMask (void) {
+  return (_lockMask);
+}
+
+/************************************************************
+ * flush (public)
+ * Write the collected Output Changes of all Rollers with
+ * ONE Call of the Output Handler. Called after each Command
+ * and after timerWheel::tick()
+ ************************************************************/
+void rollers::flush (void) {
+  uint32_t clearMask;
+  uint32_t setMask;
+  if (!(_clear | _set)) {
+    return;
+  }
+  clearMask = _clear;
+  setMask = _set;
+  _clear = 0;
+  _set = 0;
+  _output(clearMask, setMask);
+}
+
+/************************************************************
+ * position (public)
+ * @param[in] num Number of the Roller (1 to 4)
+ * @returns actual Position [%], ROLLER_POS_UNKNOWN if unknown
+ ************************************************************/
+uint8_t rollers::position (uint8_t num) {
+  if ((num < 1) || (num > ROLLER_NUM) || !_roller[num - 1].known) {
+    return (ROLLER_POS_UNKNOWN);
+  }
+  return ((current(num - 1) + 50) / 100);
+}
+
+/************************************************************
+ * moving (public)
+ * @returns true if a Roller is moving or waiting for the
+ *          Dead Time
+ ************************************************************/
+boolean rollers::moving (void) {
+  uint8_t r;
+  for (r = 0; r < ROLLER_NUM; r++) {
+    if (_roller[r].dir != ROLL_STOP) {
+      return (true);
+    }
+  }
+  return (false);
+}
+
+/************************************************************
+ * interlock (public)
+ * Output Layer Protection of the Motors, called with every
+ * Write of the Outputs
+ * @param[in] oldState Outputs before the Write
+ * @param[in] newState Outputs to be written
+ * @returns newState without refused Outputs
+ ************************************************************/
+uint32_t rollers::interlock (uint32_t oldState, uint32_t newState) {
+  uint8_t r;
+  uint32_t changed;
+  uint32_t set;
+  changed = oldState ^ newState;
+  if (!(changed & _lockMask)) {
+    return (newState);
+  }
+  for (r = 0; r < ROLLER_NUM; r++) {
+    if (!(changed & _pairMask[r])) {
+      continue;
+    }
+    // switched off: Dead Time starts
+    if (changed & oldState & _pairMask[r]) {
+      _release[r] = millis();
+    }
+    set = changed & newState & _pairMask[r];
+    if (set && (((newState & _pairMask[r]) == _pairMask[r])
+                || (oldState & _pairMask[r])
+                || (millis() - _release[r] < ROLLER_DEAD_TIME))) {
+      newState &= ~set;
+      DBG_ERROR.print(F("ERROR: Interlock Roller "));
+      DBG_ERROR.println(r + 1);
+    }
+  }
+  return (newState);
+}
+
+/************************************************************
+ * printState (public)
+ * Print Position, Direction and Target of all Rollers
+ ************************************************************/
+void rollers::printState (void) {
+  uint8_t r;
+  roller* ro;
+  for (r = 0; r < ROLLER_NUM; r++) {
+    ro = &_roller[r];
+    DBG.print(F("Roller "));
+    DBG.print(r + 1);
+    if (ro->upPin == ROLLER_NC) {
+      DBG.println(F(": not connected"));
+      continue;
+    }
+    DBG.print(F(": "));
+    if (ro->known) {
+      DBG.print(position(r + 1));
+      DBG.print(F("%"));
+    } else {
+      DBG.print(F("unknown"));
+    }
+    if (ro->waiting) {
+      DBG.print(F(" - Dead Time"));
+    }
+    if (ro->dir != ROLL_STOP) {
+      DBG.print((ro->dir == ROLL_START_UP) ? F(" - up to ") : F(" - down to "));
+      DBG.print(ro->target / 100);
+      DBG.print(F("% - "));
+      DBG.print(_timers->remaining(ro->timer));
+      DBG.print(F("ms"));
+    }
+    if (ro->pending != ROLLER_NO_TARGET) {
+      DBG.print(F(" - then "));
+      DBG.print(ro->pending / 100);
+      DBG.print(F("%"));
+    }
+    DBG.println(F(""));
+  }
+}
+
+/************************************************************
+ * arrive (private, static)
+ * Timer Callback: Stop Deadline of a Roller reached
+ * @param[in] r Index of the Roller (0 to 3)
+ ************************************************************/
+void rollers::arrive (uint8_t r) {
+  rollersInstance->finish(r);
+}
+
+/************************************************************
+ * output (private)
+ * Collect Output Changes until flush()
+ * @param[in] clearMask Outputs to be switched off
+ * @param[in] setMask   Outputs to be switched on
+ ************************************************************/
+void rollers::output (uint32_t clearMask, uint32_t setMask) {
+  _clear |= clearMask;
+  _set = (_set & ~clearMask) | setMask;
+}
+
+/************************************************************
+ * drive (private)
+ * Start a Move to a Target, a running Move is replaced.
+ * A stopped or reversing Motor starts after the Dead Time
+ * (ROLLER_DEAD_TIME since its Outputs were switched off)
+ * and after the Stagger Delay.
+ * @param[in] r       Index of the Roller (0 to 3)
+ * @param[in] target  Target Position [0.01%]
+ * @param[in] stagger Delay of the Motor Start [ms]
+ * @returns true if the Motor is started
+ ************************************************************/
+boolean rollers::drive (uint8_t r, uint16_t target, uint16_t stagger) {
+  roller* ro = &_roller[r];
+  uint16_t pos;
+  uint8_t dir;
+  boolean running;
+  uint32_t elapsed;
+  uint32_t wait;
+  if (ro->upPin == ROLLER_NC) {
+    return (false);
+  }
+  // Calibration: End Stop nearest the Target first
+  ro->pending = ROLLER_NO_TARGET;
+  if (!ro->known) {
+    if ((target != 0) && (target != ROLLER_POS_MAX)) {
+      ro->pending = target;
+      target = (target < ROLLER_POS_MAX / 2) ? 0 : ROLLER_POS_MAX;
+    }
+    // assume the opposite End Stop
+    pos = (target == 0) ? ROLLER_POS_MAX : 0;
+  } else {
+    pos = current(r);
+  }
+  _timers->cancel(ro->timer);
+  ro->timer = TIMER_NONE;
+  ro->pos = pos;
+  ro->startTime = millis();
+  if (pos == target) {
+    if (ro->dir != ROLL_STOP) {
+      halt(r);
+    }
+    return (false);
+  }
+  dir = (target < pos) ? ROLL_START_UP : ROLL_START_DOWN;
+  running = (ro->dir != ROLL_STOP) && !ro->waiting;
+  // not known after a Power Loss while moving
+  if (ro->dir == ROLL_STOP) {
+    _config->setRollerPosToEEprom(r + 1, ROLLER_POS_UNKNOWN);
+  }
+  ro->target = target;
+  ro->lastDir = dir;
+  if (running && (ro->dir == dir)) {
+    // same Direction: new Deadline only
+    run(r);
+    return (false);
+  }
+  if (running) {
+    // Reversal: Motor off, Dead Time starts now
+    output((1UL << ro->upPin) | (1UL << ro->downPin), 0);
+    _release[r] = millis();
+  }
+  ro->dir = dir;
+  elapsed = millis() - _release[r];
+  wait = stagger;
+  if (elapsed < ROLLER_DEAD_TIME) {
+    // Timers may expire up to one Tick early
+    wait = max(wait, ROLLER_DEAD_TIME - elapsed + TIMER_TICK);
+  }
+  if (wait == 0) {
+    run(r);
+    return (true);
+  }
+  ro->waiting = true;
+  ro->timer = _timers->start(wait, arrive, r);
+  if (ro->timer == TIMER_NONE) {
+    DBG_ERROR.println(F("ERROR: no free Timer for Roller"));
+    halt(r);
+    return (false);
+  }
+  return (true);
+}
+
+/************************************************************
+ * run (private)
+ * Switch the Motor on and start the Stop Deadline
+ * (Direction, Position and Target are set)
+ * @param[in] r Index of the Roller (0 to 3)
+ ************************************************************/
+void rollers::run (uint8_t r) {
+  roller* ro = &_roller[r];
+  uint32_t travel;
+  uint32_t duration;
+  travel = travelTime(r, ro->dir);
+  duration = (uint32_t)((ro->target < ro->pos) ? (ro->pos - ro->target) : (ro->target - ro->pos)) * travel / ROLLER_POS_MAX;
+  if ((ro->target == 0) || (ro->target == ROLLER_POS_MAX)) {
+    duration += travel * ROLLER_OVERTRAVEL / 100;
+  }
+  ro->waiting = false;
+  ro->timer = _timers->start(duration, arrive, r);
+  if (ro->timer == TIMER_NONE) {
+    DBG_ERROR.println(F("ERROR: no free Timer for Roller"));
+    halt(r);
+    return;
+  }
+  ro->startTime = millis();
+  DBG_EVENT.print(F("Roller "));
+  DBG_EVENT.print(r + 1);
+  DBG_EVENT.print(F(": "));
+  DBG_EVENT.print(ro->pos / 100);
+  DBG_EVENT.print(F("% -> "));
+  DBG_EVENT.print(ro->target / 100);
+  DBG_EVENT.print(F("% ("));
+  DBG_EVENT.print(duration);
+  DBG_EVENT.println(F("ms)"));
+  if (ro->dir == ROLL_START_UP) {
+    output(1UL << ro->downPin, 1UL << ro->upPin);
+  } else {
+    output(1UL << ro->upPin, 1UL << ro->downPin);
+  }
+}
+
+/************************************************************
+ * stop (private)
+ * Stop a Roller at its estimated Position
+ * @param[in] r Index of the Roller (0 to 3)
+ ************************************************************/
+void rollers::stop (uint8_t r) {
+  roller* ro = &_roller[r];
+  ro->pending = ROLLER_NO_TARGET;
+  if (ro->dir == ROLL_STOP) {
+    return;
+  }
+  _timers->cancel(ro->timer);
+  ro->timer = TIMER_NONE;
+  ro->pos = current(r);
+  halt(r);
+}
+
+/************************************************************
+ * halt (private)
+ * Switch the Motor off and store the Position
+ * @param[in] r Index of the Roller (0 to 3)
+ ************************************************************/
+void rollers::halt (uint8_t r) {
+  roller* ro = &_roller[r];
+  if (!ro->waiting) {
+    // Dead Time starts with the (collected) Write
+    _release[r] = millis();
+  }
+  ro->dir = ROLL_STOP;
+  ro->waiting = false;
+  output((1UL << ro->upPin) | (1UL << ro->downPin), 0);
+  save(r);
+}
+
+/************************************************************
+ * finish (private)
+ * Dead Time over: start the Motor. 
+ * Target reached: stop, re-zero at End Stops and continue
+ * with the pending Target of a Calibration
+ * @param[in] r Index of the Roller (0 to 3)
+ ************************************************************/
+void rollers::finish (uint8_t r) {
+  roller* ro = &_roller[r];
+  uint16_t pending;
+  ro->timer = TIMER_NONE;
+  if (ro->waiting) {
+    run(r);
+    return;
+  }
+  ro->pos = ro->target;
+  if ((ro->pos == 0) || (ro->pos == ROLLER_POS_MAX)) {
+    ro->known = true;
+  }
+  halt(r);
+  pending = ro->pending;
+  if (pending != ROLLER_NO_TARGET) {
+    drive(r, pending, 0);
+  }
+}
+
+/************************************************************
+ * save (private)
+ * Store the Position of a stopped Roller in EEPROM
+ * @param[in] r Index of the Roller (0 to 3)
+ ************************************************************/
+void rollers::save (uint8_t r) {
+  if (_roller[r].known) {
+    _config->setRollerPosToEEprom(r + 1, (_roller[r].pos + 50) / 100);
+  }
+}
+
+/************************************************************
+ * current (private)
+ * @param[in] r Index of the Roller (0 to 3)
+ * @returns Position [0.01%], estimated from the Run Time
+ *          if moving
+ ************************************************************/
+uint16_t rollers::current (uint8_t r) {
+  roller* ro = &_roller[r];
+  uint32_t elapsed;
+  uint32_t travel;
+  uint16_t delta;
+  if ((ro->dir == ROLL_STOP) || ro->waiting) {
+    return (ro->pos);
+  }
+  elapsed = millis() - ro->startTime;
+  travel = travelTime(r, ro->dir);
+  if (elapsed >= travel) {
+    delta = ROLLER_POS_MAX;
+  } else {
+    delta = (uint16_t)(elapsed * ROLLER_POS_MAX / travel);
+  }
+  if (ro->dir == ROLL_START_UP) {
+    return ((delta >= ro->pos) ? 0 : ro->pos - delta);
+  }
+  return ((ro->pos + delta >= ROLLER_POS_MAX) ? ROLLER_POS_MAX : ro->pos + delta);
+}
+
+/************************************************************
+ * closePos (private)
+ * @param[in] r Index of the Roller (0 to 3)
+ * @returns Close Position (defaultTime) [0.01%]
+ ************************************************************/
+uint16_t rollers::closePos (uint8_t r) {
+  roller* ro = &_roller[r];
+  if ((ro->downTime == 0) || (ro->defaultTime >= ro->downTime)) {
+    return (ROLLER_POS_MAX);
+  }
+  return ((uint16_t)((uint32_t)ro->defaultTime * ROLLER_POS_MAX / ro->downTime));
+}
+
+/************************************************************
+ * travelTime (private)
+ * @param[in] r   Index of the Roller (0 to 3)
+ * @param[in] dir ROLL_START_UP or ROLL_START_DOWN
+ * @returns Time for the complete Travel [ms]
+ ************************************************************/
+uint32_t rollers::travelTime (uint8_t r, uint8_t dir) {
+  if (dir == ROLL_START_UP) {
+    return (ROLLER_TIME_UNIT * _roller[r].upTime);
+  }
+  return (ROLLER_TIME_UNIT * _roller[r].downTime);
+}
@@ -0,0 +1,116 @@
+/************************************************************
+ * This File implements the Roller Position Model
+ ************************************************************
+ * - Each Roller keeps an estimated Position in 0.01%
+ *   (0 = up/open ... ROLLER_POS_MAX = down/closed),
+ *   integrated from Run Time and Direction of the Motor
+ *   (Travel Times up/down from the Roller Table)
+ * - A Move to a Target Position computes its Stop Deadline
+ *   directly and starts ONE Timer (no Polling), the Position
+ *   while moving is estimated from the elapsed Time
+ * - Moves to an End Stop run ROLLER_OVERTRAVEL % longer,
+ *   the Position is re-zeroed there
+ * - If the Position is unknown, the Roller is driven to the
+ *   End Stop nearest the Target first (Calibration), the
+ *   Move to the Target follows
+ * - The Position is stored in EEPROM on each Stop (in %,
+ *   only if changed) and marked unknown while moving, so a
+ *   Power Loss while moving forces a Calibration
+ * - Outputs are changed by the Output Handler (setOutputs):
+ *   the Changes of all Rollers of one Command (Roller Mask)
+ *   or of one Timer Tick are collected and written with ONE
+ *   Write by flush()
+ * - Optional: the Motor Starts of one Command are staggered
+ *   by ROLLER_STAGGER (mySettings.h) on Timers, to limit the
+ *   Inrush Current
+ ************************************************************
+ * Interlock (Output Layer): 
+ * - interlock() is called by setOutputs() with every Write.
+ *   A Table of the Up/Down Output Pairs is derived from the
+ *   Roller Table, Writes which do not touch a Pair pass with
+ *   one AND.
+ * - Refused are: both Outputs of a Pair on, Reversal within
+ *   one Write, switching on within ROLLER_DEAD_TIME after 
+ *   the Pair was switched off (mySettings.h)
+ * - Reversals of the Roller Engine wait for the Dead Time on
+ *   a Timer (no Delay)
+ ************************************************************/
+#ifndef _ROLLERS_H_
+#define _ROLLERS_H_
+
+#include <Arduino.h>
+#include <configTools.h>
+#include <timerWheel.h>
+
+#define ROLLER_NUM             4      // Number of Rollers
+#define ROLLER_POS_MAX     10000      // Position down/closed [0.01%]
+#define ROLLER_OVERTRAVEL     10      // [%] of Travel Time added at End Stops
+#define ROLLER_TIME_UNIT    500UL     // [ms] Unit of Travel Times
+#define ROLLER_NO_TARGET  0xffff      // no pending Target
+
+/********************************************************
+ * Output Handler
+ * @param[in] clearMask Outputs to be switched off
+ * @param[in] setMask   Outputs to be switched on
+ ********************************************************/
+typedef void (*rollerOutput)(uint32_t clearMask, uint32_t setMask);
+
+/********************************************************
+ * One Roller
+ ********************************************************/
+typedef struct {
+  uint8_t  upPin;                 //!< Output up, ROLLER_NC if not connected
+  uint8_t  downPin;               //!< Output down
+  uint8_t  upTime;                //!< Travel Time up [500ms]
+  uint8_t  downTime;              //!< Travel Time down [500ms]
+  uint8_t  defaultTime;           //!< Travel Time to Close Position [500ms]
+  uint8_t  dir;                   //!< ROLL_STOP, ROLL_START_UP, ROLL_START_DOWN
+  uint8_t  lastDir;               //!< Direction of last Move
+  uint8_t  timer;                 //!< Stop Deadline, TIMER_NONE if stopped
+  boolean  known;                 //!< Position is known
+  boolean  waiting;               //!< Motor waits for the Dead Time
+  uint16_t pos;                   //!< Position [0.01%] (at startTime if moving)
+  uint16_t target;                //!< Target of actual Move [0.01%]
+  uint16_t pending;               //!< Target after Calibration
+  uint32_t startTime;             //!< millis() at Start of actual Move
+} roller;
+
+class rollers {
+    public:
+    // public functions
+    void begin (config& cfg, timerWheel& timers, rollerOutput output);
+    void reload (void);
+    void update (uint8_t num);
+    void command (uint8_t event, uint8_t mask);
+    void moveTo (uint8_t mask, uint8_t percent);
+    uint8_t position (uint8_t num);
+    boolean moving (void);
+    uint32_t interlock (uint32_t oldState, uint32_t newState);
+    uint32_t outputMask (void);
+    void flush (void);
+    void printState (void);
+
+    private:
+    static void arrive (uint8_t r);
+    boolean drive (uint8_t r, uint16_t target, uint16_t stagger);
+    void output (uint32_t clearMask, uint32_t setMask);
+    void run (uint8_t r);
+    void stop (uint8_t r);
+    void halt (uint8_t r);
+    void finish (uint8_t r);
+    void save (uint8_t r);
+    uint16_t current (uint8_t r);
+    uint16_t closePos (uint8_t r);
+    uint32_t travelTime (uint8_t r, uint8_t dir);
+    config* _config;                  //!< Roller Table and Positions in EEPROM
+    timerWheel* _timers;              //!< Stop Deadlines
+    rollerOutput _output;             //!< switches the Motors
+    roller _roller[ROLLER_NUM];
+    uint32_t _pairMask[ROLLER_NUM];   //!< Up and Down Output of each Roller
+    uint32_t _lockMask;               //!< all Roller Outputs
+    uint32_t _release[ROLLER_NUM];    //!< millis() when a Pair was switched off
+    uint32_t _clear;                  //!< collected Outputs to be switched off
+    uint32_t _set;                    //!< collected Outputs to be switched on
+};
+
+#endif  // _ROLLERS_H_
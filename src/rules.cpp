@@ -0,0 +1,158 @@
+/*!
+ * @file rules.cpp
+ */
+#include <rules.h>
+
+/************************************************************
+ * begin (public)
+ * @param[in] cfg Configuration (Rule Table)
+ ************************************************************/
+void rules::begin (config& cfg) {
+  _config = &cfg;
+  reload();
+}
+
+/************************************************************
+ * reload (public)
+ * Compile the Rule Table from EEPROM (after a Change of
+ * the Configuration)
+ ************************************************************/
+void rules::reload (void) {
+  uint8_t i;
+  uint8_t trigger;
+  uint8_t action;
+  uint32_t outOn;
+  uint32_t outOff;
+  uint32_t inOn;
+  uint32_t inOff;
+  rule* r;
+  _num = 0;
+  _invalid = 0;
+  for (i = 0; i < RULE_MAX; i++) {
+    trigger = _config->getRuleFromEEprom(i, action, outOn, outOff, inOn, inOff);
+    if (trigger == RULE_NONE) {
+      continue;
+    }
+    if ((outOn & outOff) || (inOn & inOff)) {
+      _invalid++;
+      DBG_ERROR.print(F("ERROR: Rule "));
+      DBG_ERROR.print(i);
+      DBG_ERROR.println(F(" never holds (Bit on and off)"));
+      continue;
+    }
+    r = &_rule[_num++];
+    r->outMask = outOn | outOff;
+    r->outValue = outOn;
+    r->inMask = inOn | inOff;
+    r->inValue = inOn;
+    r->trigger = trigger;
+    r->action = action;
+  }
+}
+
+/************************************************************
+ * find (private, static)
+ * Evaluate compiled Rules in Order
+ * @param[in] r        First Rule
+ * @param[in] n        Number of Rules
+ * @param[in] trigger  RULE_TRIGGER(Click Type, Input)
+ * @param[in] outState State of the Outputs
+ * @param[in] inState  State of the Inputs
+ * @returns first Rule which holds, NULL if none
+ ************************************************************/
+const rule* rules::find (const rule* r, uint8_t n, uint8_t trigger, uint32_t outState, uint32_t inState) {
+  for (; n; n--, r++) {
+    if ((r->trigger == trigger) &&
+        ((((outState & r->outMask) ^ r->outValue) | ((inState & r->inMask) ^ r->inValue)) == 0)) {
+      return (r);
+    }
+  }
+  return (NULL);
+}
+
+/************************************************************
+ * match (public)
+ * Called for each Click before the Click Table
+ * @param[in]  trigger  RULE_TRIGGER(Click Type, Input)
+ * @param[in]  outState State of the Outputs
+ * @param[in]  inState  State of the Inputs
+ * @param[out] action   Command of the first Rule which holds
+ * @returns false if no Rule holds (Click Table applies)
+ ************************************************************/
+boolean rules::match (uint8_t trigger, uint32_t outState, uint32_t inState, uint8_t& action) {
+  const rule* r;
+  r = find(_rule, _num, trigger, outState, inState);
+  if (r == NULL) {
+    return (false);
+  }
+  action = r->action;
+  return (true);
+}
+
+/************************************************************
+ * bench (public)
+ * Measure the Evaluation Time of RULE_BENCH_RULES Rules
+ * (BLOCKING, some ms). Worst Case: all Rules have the same
+ * Trigger, every Condition is evaluated and fails on the
+ * last Compare. A Table of RULE_BENCH_TABLE Rules is
+ * evaluated RULE_BENCH_RUNS Times and the Time is scaled to
+ * RULE_BENCH_RULES (linear, same Code per Rule). The AVR
+ * has RAM for RULE_MAX Rules only, the Host (env:native)
+ * evaluates a Table of 100 Rules.
+ * Output (Format of the I2C Benchmark, Clock 0, no Bytes):
+ *   BENCH,<firmware>,rules,0,<runs>,<us/100 Rules>,0
+ * @param[in] version Firmware Version printed in the Line
+ ************************************************************/
+void rules::bench (const __FlashStringHelper* version) {
+  rule table[RULE_BENCH_TABLE];
+  volatile uint32_t outState;
+  volatile uint32_t inState;
+  const rule* volatile hit;
+  uint16_t i;
+  uint32_t t;
+  uint32_t cus;          // 1/100 us per Operation
+  for (i = 0; i < RULE_BENCH_TABLE; i++) {
+    table[i].outMask = 0xffff0000UL;
+    table[i].outValue = 0x55aa0000UL;
+    table[i].inMask = 0x0000ffffUL;
+    table[i].inValue = 0x000055aaUL + i;
+    table[i].trigger = RULE_TRIGGER(BUTTON_CLICK, 0);
+    table[i].action = EVENT_NULL;
+  }
+  outState = 0x55aa0000UL;
+  inState = 0;
+  Serial.print(F("# Rule Benchmark - Rules: "));
+  Serial.print(RULE_BENCH_RULES);
+  Serial.println(F(" (worst Case)"));
+  t = micros();
+  for (i = 0; i < RULE_BENCH_RUNS; i++) {
+    hit = find(table, RULE_BENCH_TABLE, RULE_TRIGGER(BUTTON_CLICK, 0), outState, inState);
+  }
+  t = micros() - t;
+  (void)hit;
+  cus = (t * RULE_BENCH_RULES) / ((uint32_t)RULE_BENCH_RUNS * RULE_BENCH_TABLE / 100);
+  Serial.print(F("BENCH,"));
+  Serial.print(version);
+  Serial.print(F(",rules,0,"));
+  Serial.print(RULE_BENCH_RUNS);
+  Serial.print(F(","));
+  Serial.print(cus / 100);
+  Serial.print(F("."));
+  if (cus % 100 < 10) {
+    Serial.print(F("0"));
+  }
+  Serial.print(cus % 100);
+  Serial.println(F(",0"));
+}
+
+/************************************************************
+ * printState (public)
+ * e.g. "Rules: 1 compiled, 0 invalid"
+ ************************************************************/
+void rules::printState (void) {
+  DBG.print(F("Rules: "));
+  DBG.print(_num);
+  DBG.print(F(" compiled, "));
+  DBG.print(_invalid);
+  DBG.println(F(" invalid"));
+}
@@ -0,0 +1,59 @@
+/************************************************************
+ * This File implements the Rule Engine
+ ************************************************************
+ * - A Rule replaces the Click Table Command of one Click
+ *   if its Condition over the Outputs and Inputs holds
+ *   (Format see mySettings.h)
+ * - The Rules are compiled from EEPROM at begin()/reload()
+ *   into a flat Array in RAM: unused Rules are dropped, each
+ *   Condition (on-Mask, off-Mask) becomes (Mask, Value):
+ *     Mask = on | off, Value = on
+ *   A Rule holds if
+ *     ((out & outMask) ^ outValue) | ((in & inMask) ^ inValue) == 0
+ *   i.e. one Byte Compare and a few 32 Bit AND/XOR/OR per
+ *   Rule, no EEPROM Access on a Click
+ * - Rules with a Bit in both Masks can never hold, they are
+ *   dropped and counted as invalid
+ * - bench() measures the Evaluation Time of 100 Rules
+ *   (Table of RULE_BENCH_TABLE Rules, scaled to 100)
+ ************************************************************/
+#ifndef _RULES_H_
+#define _RULES_H_
+
+#include <Arduino.h>
+#include <configTools.h>
+
+#define RULE_BENCH_RUNS      1000     // Evaluations of the Table per Benchmark
+#define RULE_BENCH_RULES      100     // Rules per reported Operation
+#ifndef RULE_BENCH_TABLE
+  #define RULE_BENCH_TABLE  RULE_MAX  // Rules in the Benchmark Table (Stack), env:native: 100
+#endif
+
+// Compiled Rule
+typedef struct {
+  uint32_t outMask;               //!< Outputs in the Condition
+  uint32_t outValue;              //!< required State of these Outputs
+  uint32_t inMask;                //!< Inputs in the Condition
+  uint32_t inValue;               //!< required State of these Inputs
+  uint8_t  trigger;               //!< RULE_TRIGGER(Click Type, Input)
+  uint8_t  action;                //!< One-Byte Command
+} rule;
+
+class rules {
+    public:
+    // public functions
+    void begin (config& cfg);
+    void reload (void);
+    boolean match (uint8_t trigger, uint32_t outState, uint32_t inState, uint8_t& action);
+    void bench (const __FlashStringHelper* version);
+    void printState (void);
+
+    private:
+    static const rule* find (const rule* r, uint8_t n, uint8_t trigger, uint32_t outState, uint32_t inState);
+    config* _config;                  //!< Rule Table in EEPROM
+    rule    _rule[RULE_MAX];          //!< compiled Rules in Table Order
+    uint8_t _num;                     //!< Number of compiled Rules
+    uint8_t _invalid;                 //!< Rules dropped (Condition never holds)
+};
+
+#endif  // _RULES_H_
@@ -0,0 +1,452 @@
+/*!
+ * @file scheduler.cpp
+ */
+#include <scheduler.h>
+#include <sunCalc.h>
+
+// Names of Weekdays for printTime()
+static const char schedDayNames[] PROGMEM = "MoTuWeThFrSaSu";
+
+// Days per Month (February without Leap Day)
+static const uint8_t schedMonthDays[12] PROGMEM = {
+  31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+};
+
+/************************************************************
+ * daysInMonth
+ * @returns Number of Days of a Month (28 - 31)
+ ************************************************************/
+static uint8_t daysInMonth(uint16_t year, uint8_t month) {
+  if ((month == 2) && ((year % 4) == 0) && (((year % 100) != 0) || ((year % 400) == 0))) {
+    return (29);
+  }
+  return (pgm_read_byte(&schedMonthDays[month - 1]));
+}
+
+/************************************************************
+ * dayOfWeek
+ * @returns Weekday of a Date (0=Monday ... 6=Sunday)
+ ************************************************************/
+static uint8_t dayOfWeek(uint16_t year, uint8_t month, uint8_t day) {
+  // Sakamoto: 0=Sunday
+  static const uint8_t t[12] PROGMEM = {0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4};
+  if (month < 3) {
+    year--;
+  }
+  return ((year + year / 4 - year / 100 + year / 400 + pgm_read_byte(&t[month - 1]) + day + 6) % 7);
+}
+
+/************************************************************
+ * lastSunday
+ * @returns Day of Month of the last Sunday of a Month with
+ *          31 Days (March, October)
+ ************************************************************/
+static uint8_t lastSunday(uint16_t year, uint8_t month) {
+  return (31 - ((dayOfWeek(year, month, 31) + 1) % 7));
+}
+
+/************************************************************
+ * begin (public)
+ * Clock not synchronized, Schedule loaded from EEPROM
+ * @param[in] cfg     Configuration (Schedule in EEPROM)
+ * @param[in] handler called with the Action of each due Entry
+ ************************************************************/
+void scheduler::begin (config& cfg, scheduleHandler handler) {
+  _config = &cfg;
+  _handler = handler;
+  _synced = false;
+  _dated = false;
+  _dst = false;
+  _second = 0;
+  _minute = 0;
+  _weekday = 0;
+  _sunrise = SUN_NONE;
+  _sunset = SUN_NONE;
+  _lastSecond = millis();
+  reload();
+}
+
+/************************************************************
+ * setTime (public)
+ * Synchronize the Clock (local Time)
+ * @param[in] weekday 0=Monday ... 6=Sunday
+ * @param[in] hour    0-23
+ * @param[in] minute  0-59
+ * @param[in] second  0-59
+ ************************************************************/
+void scheduler::setTime (uint8_t weekday, uint8_t hour, uint8_t minute, uint8_t second) {
+  _weekday = weekday % 7;
+  _minute = ((uint16_t)(hour % 24) * 60) + (minute % 60);
+  _second = second % 60;
+  _lastSecond = millis();
+  _synced = true;
+  reload();
+}
+
+/************************************************************
+ * setDate (public)
+ * Set the Date, also sets the Weekday
+ * @param[in] year  e.g. 2024
+ * @param[in] month 1-12
+ * @param[in] day   1-31
+ ************************************************************/
+void scheduler::setDate (uint16_t year, uint8_t month, uint8_t day) {
+  if ((month < 1) || (month > 12) || (day < 1) || (day > daysInMonth(year, month))) {
+    DBG_ERROR.println(F("ERROR: invalid Date"));
+    return;
+  }
+  _year = year;
+  _month = month;
+  _day = day;
+  _weekday = dayOfWeek(year, month, day);
+  _dated = true;
+  _dst = dstActive();
+  calcSun();
+  reload();
+}
+
+/************************************************************
+ * synced (public)
+ * @returns true if the Clock has been set
+ ************************************************************/
+boolean scheduler::synced (void) {
+  return (_synced);
+}
+
+/************************************************************
+ * weekday (public)
+ * @returns 0=Monday ... 6=Sunday
+ ************************************************************/
+uint8_t scheduler::weekday (void) {
+  return (_weekday);
+}
+
+/************************************************************
+ * minuteOfDay (public)
+ * @returns Minutes since Midnight (0-1439)
+ ************************************************************/
+uint16_t scheduler::minuteOfDay (void) {
+  return (_minute);
+}
+
+/************************************************************
+ * sunrise (public)
+ * @returns Sunrise today [Minute of Day], SUN_NONE if unknown
+ ************************************************************/
+uint16_t scheduler::sunrise (void) {
+  return (_sunrise);
+}
+
+/************************************************************
+ * sunset (public)
+ * @returns Sunset today [Minute of Day], SUN_NONE if unknown
+ ************************************************************/
+uint16_t scheduler::sunset (void) {
+  return (_sunset);
+}
+
+/************************************************************
+ * reload (public)
+ * Find the first Entries after the actual Time
+ * (call after the Schedule in EEPROM has been changed)
+ ************************************************************/
+void scheduler::reload (void) {
+  uint8_t part;
+  restart();
+  for (part = 0; part < SCHED_PARTS; part++) {
+    while (_headMinute[part] <= _minute) {
+      _head[part]++;
+      loadHead(part);
+    }
+  }
+  selectNext();
+}
+
+/************************************************************
+ * printTime (public)
+ * e.g.: "Time: 2024-06-21 Fr 21:30:05 DST"
+ ************************************************************/
+void scheduler::printTime (void) {
+  DBG.print(F("Time: "));
+  if (!_synced) {
+    DBG.println(F("not synchronized"));
+    return;
+  }
+  if (_dated) {
+    DBG.print(_year);
+    DBG.print(F("-"));
+    if (_month < 10) {
+      DBG.print(F("0"));
+    }
+    DBG.print(_month);
+    DBG.print(F("-"));
+    if (_day < 10) {
+      DBG.print(F("0"));
+    }
+    DBG.print(_day);
+    DBG.print(F(" "));
+  }
+  DBG.print((char)pgm_read_byte(&schedDayNames[_weekday * 2]));
+  DBG.print((char)pgm_read_byte(&schedDayNames[_weekday * 2 + 1]));
+  DBG.print(F(" "));
+  if (_minute / 60 < 10) {
+    DBG.print(F("0"));
+  }
+  DBG.print(_minute / 60);
+  DBG.print(F(":"));
+  if (_minute % 60 < 10) {
+    DBG.print(F("0"));
+  }
+  DBG.print(_minute % 60);
+  DBG.print(F(":"));
+  if (_second < 10) {
+    DBG.print(F("0"));
+  }
+  DBG.print(_second);
+  if (_dst) {
+    DBG.print(F(" DST"));
+  }
+  DBG.println(F(""));
+}
+
+/************************************************************
+ * printNext (public)
+ * Print Sunrise, Sunset and next Entry due today
+ ************************************************************/
+void scheduler::printNext (void) {
+  DBG.print(F("Sunrise: "));
+  DBG.print(_sunrise);
+  DBG.print(F(" - Sunset: "));
+  DBG.print(_sunset);
+  DBG.println(F(" [Minute of Day]"));
+  DBG.print(F("Schedule: "));
+  DBG.print(_num);
+  DBG.print(F(" Entries - next: "));
+  if (_nextMinute == SCHED_NO_TIME) {
+    DBG.println(F("tomorrow"));
+    return;
+  }
+  DBG.print(_head[_nextPart]);
+  DBG.print(F(" at "));
+  DBG.print(_nextMinute / 60);
+  DBG.print(F(":"));
+  if (_nextMinute % 60 < 10) {
+    DBG.print(F("0"));
+  }
+  DBG.print(_nextMinute % 60);
+  DBG.print(F(" - Cmd: 0x"));
+  DBG.println(_headAction[_nextPart], HEX);
+}
+
+/************************************************************
+ * tick (public)
+ * Advance the Clock by all Seconds elapsed since the last
+ * call, execute the next Entry when it is due.
+ * Call every Loop.
+ ************************************************************/
+void scheduler::tick (void) {
+  while ((uint32_t)(millis() - _lastSecond) >= 1000) {
+    _lastSecond += 1000;
+    if (++_second == 60) {
+      _second = 0;
+      nextMinute();
+    }
+  }
+}
+
+/************************************************************
+ * nextMinute (private)
+ * Advance Clock by one Minute, execute due Entries
+ ************************************************************/
+void scheduler::nextMinute (void) {
+  uint8_t part;
+  _minute++;
+  if (_minute == SCHED_MINUTES) {
+    // Midnight: start with first Entries
+    _minute = 0;
+    _weekday = (_weekday + 1) % 7;
+    nextDay();
+    restart();
+  }
+  if (!_synced) {
+    return;
+  }
+  // Daylight Saving Time: 02:00 -> 03:00, 03:00 -> 02:00
+  if (_dst != dstActive()) {
+    if (!_dst && (_minute == 120)) {
+      _dst = true;
+      calcSun();
+      // skip up to 02:59, Entries at 03:00 are executed below
+      _minute = 179;
+      reload();
+      _minute = 180;
+    } else if (_dst && (_minute == 180)) {
+      _dst = false;
+      calcSun();
+      // 02:00 - 02:59 already executed, next Entries from 03:00
+      _minute = 179;
+      reload();
+      _minute = 120;
+    }
+  }
+  // all Entries of this Minute
+  while (_nextMinute == _minute) {
+    part = _nextPart;
+    if (_headWeekdays[part] & (1 << _weekday)) {
+      DBG_EVENT.print(F("Schedule #"));
+      DBG_EVENT.println(_head[part]);
+      _handler(_headAction[part]);
+    }
+    _head[part]++;
+    loadHead(part);
+    selectNext();
+  }
+}
+
+/************************************************************
+ * nextDay (private)
+ * Advance the Date, calculate Sunrise and Sunset
+ ************************************************************/
+void scheduler::nextDay (void) {
+  if (!_dated) {
+    return;
+  }
+  _day++;
+  if (_day > daysInMonth(_year, _month)) {
+    _day = 1;
+    _month++;
+    if (_month > 12) {
+      _month = 1;
+      _year++;
+    }
+  }
+  calcSun();
+}
+
+/************************************************************
+ * calcSun (private)
+ * Sunrise and Sunset of today (local Time)
+ ************************************************************/
+void scheduler::calcSun (void) {
+  uint16_t doy;
+  uint8_t m;
+  int16_t offset;
+  doy = _day;
+  for (m = 1; m < _month; m++) {
+    doy += daysInMonth(_year, m);
+  }
+  offset = SUN_TIMEZONE;
+  if (_dst) {
+    offset += 60;
+  }
+  sunCalc(doy, offset, _sunrise, _sunset);
+}
+
+/************************************************************
+ * dstActive (private)
+ * @returns true if Daylight Saving Time is active at the
+ *          actual Date (the Switch is done at 02:00/03:00)
+ ************************************************************/
+boolean scheduler::dstActive (void) {
+  #if SUN_DST_EU
+    if (!_dated) {
+      return (_dst);
+    }
+    if ((_month > 3) && (_month < 10)) {
+      return (true);
+    }
+    if (_month == 3) {
+      return ((_day > lastSunday(_year, 3)) || ((_day == lastSunday(_year, 3)) && (_minute >= 120)));
+    }
+    if (_month == 10) {
+      // 02:00 - 03:00 is repeated: once with, once without DST
+      return ((_day < lastSunday(_year, 10)) ||
+              ((_day == lastSunday(_year, 10)) && ((_minute < 120) || (_dst && (_minute < 180)))));
+    }
+    return (false);
+  #else
+    return (false);
+  #endif // SUN_DST_EU
+}
+
+/************************************************************
+ * restart (private)
+ * Read the Parts of the Schedule, Heads to the first Entries
+ ************************************************************/
+void scheduler::restart (void) {
+  uint8_t entry;
+  uint8_t weekdays;
+  uint8_t hour;
+  uint8_t minute;
+  uint8_t action;
+  uint8_t part;
+  _num = _config->getScheduleNumFromEEprom();
+  _end[SCHED_PART_FIXED] = _num;
+  _end[SCHED_PART_SUNRISE] = _num;
+  for (entry = _num; entry > 0; entry--) {
+    _config->getScheduleFromEEprom(entry - 1, weekdays, hour, minute, action);
+    if (hour < SCHED_SUNRISE) {
+      break;
+    }
+    if (hour == SCHED_SUNRISE) {
+      _end[SCHED_PART_FIXED] = entry - 1;
+    } else {
+      _end[SCHED_PART_FIXED] = entry - 1;
+      _end[SCHED_PART_SUNRISE] = entry - 1;
+    }
+  }
+  _end[SCHED_PART_SUNSET] = _num;
+  _head[SCHED_PART_FIXED] = 0;
+  _head[SCHED_PART_SUNRISE] = _end[SCHED_PART_FIXED];
+  _head[SCHED_PART_SUNSET] = _end[SCHED_PART_SUNRISE];
+  for (part = 0; part < SCHED_PARTS; part++) {
+    loadHead(part);
+  }
+  selectNext();
+}
+
+/************************************************************
+ * loadHead (private)
+ * Read Head of a Part from EEPROM, Sunrise/Sunset Entries
+ * are converted to the Minute of Day (Offset is limited to
+ * the same Day)
+ * @param[in] part SCHED_PART_FIXED, SCHED_PART_SUNRISE or
+ *                 SCHED_PART_SUNSET
+ ************************************************************/
+void scheduler::loadHead (uint8_t part) {
+  uint8_t hour;
+  uint8_t minute;
+  uint16_t base;
+  int16_t t;
+  if (_head[part] >= _end[part]) {
+    _headMinute[part] = SCHED_NO_TIME;
+    return;
+  }
+  _config->getScheduleFromEEprom(_head[part], _headWeekdays[part], hour, minute, _headAction[part]);
+  if (part == SCHED_PART_FIXED) {
+    _headMinute[part] = ((uint16_t)hour * 60) + minute;
+    return;
+  }
+  base = (part == SCHED_PART_SUNRISE) ? _sunrise : _sunset;
+  if (base == SUN_NONE) {
+    _headMinute[part] = SCHED_NO_TIME;
+    return;
+  }
+  t = (int16_t)base + (int16_t)minute - SCHED_OFFSET(0);
+  _headMinute[part] = constrain(t, 0, SCHED_MINUTES - 1);
+}
+
+/************************************************************
+ * selectNext (private)
+ * The earliest Head is the next due Entry
+ ************************************************************/
+void scheduler::selectNext (void) {
+  uint8_t part;
+  _nextPart = SCHED_PART_FIXED;
+  for (part = 1; part < SCHED_PARTS; part++) {
+    if (_headMinute[part] < _headMinute[_nextPart]) {
+      _nextPart = part;
+    }
+  }
+  _nextMinute = _headMinute[_nextPart];
+}
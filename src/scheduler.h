@@ -0,0 +1,97 @@
+/************************************************************
+ * This File implements the Time-of-Day Scheduler
+ ************************************************************
+ * - A Wall Clock (Date, Weekday, Minute of Day, Second) is
+ *   kept with millis(). It is invalid until it is
+ *   synchronized with setTime() and setDate() (Serial
+ *   Commands "time" and "date", HTTP POST /time, see
+ *   main.cpp).
+ * - The Schedule is stored in EEPROM sorted by Time of Day
+ *   (see mySettings.h). It consists of three sorted Parts:
+ *   Entries at a fixed Time, Entries relative to Sunrise and
+ *   Entries relative to Sunset. Only the Head of each Part
+ *   is kept in RAM, the earliest Head is the next due Entry:
+ *   each Minute it is compared with the Clock, if it is due
+ *   (and the Weekday matches) its Action is passed to the
+ *   Handler and the following Entry of its Part is loaded.
+ * - Sunrise and Sunset are calculated once per Day (at
+ *   Midnight and after setDate()) with sunCalc().
+ * - The Table is scanned only after setTime(), setDate() and
+ *   reload(), to find the first Entries after the actual
+ *   Time. Entries skipped by setting the Clock forward are
+ *   not executed.
+ * - If SUN_DST_EU is set, the Clock is switched to and from
+ *   Daylight Saving Time (needs the Date). Entries between
+ *   02:00 and 02:59 are skipped in spring and executed once
+ *   in autumn, Entries at 03:00 are executed.
+ ************************************************************/
+#ifndef _SCHEDULER_H_
+#define _SCHEDULER_H_
+
+#include <Arduino.h>
+#include <configTools.h>
+
+#define SCHED_MINUTES      1440     // Minutes per Day
+#define SCHED_NO_TIME     0xffff    // Minute of Day: no (further) Entry today
+
+// Parts of the Schedule
+#define SCHED_PART_FIXED      0     // fixed Time of Day
+#define SCHED_PART_SUNRISE    1     // relative to Sunrise
+#define SCHED_PART_SUNSET     2     // relative to Sunset
+#define SCHED_PARTS           3
+
+/********************************************************
+ * Handler of a due Schedule Entry
+ * @param[in] action One-Byte Command [CCCP PPPP]
+ ********************************************************/
+typedef void (*scheduleHandler)(uint8_t action);
+
+class scheduler {
+    public:
+    // public functions
+    void begin (config& cfg, scheduleHandler handler);
+    void setTime (uint8_t weekday, uint8_t hour, uint8_t minute, uint8_t second);
+    void setDate (uint16_t year, uint8_t month, uint8_t day);
+    boolean synced (void);
+    uint8_t weekday (void);
+    uint16_t minuteOfDay (void);
+    uint16_t sunrise (void);
+    uint16_t sunset (void);
+    void reload (void);
+    void printTime (void);
+    void printNext (void);
+    void tick (void);
+
+    private:
+    void nextMinute (void);
+    void nextDay (void);
+    void calcSun (void);
+    void restart (void);
+    void loadHead (uint8_t part);
+    void selectNext (void);
+    boolean dstActive (void);
+    config* _config;                  //!< Access to the Schedule in EEPROM
+    scheduleHandler _handler;         //!< called for each due Entry
+    boolean  _synced;                 //!< Clock has been set
+    boolean  _dated;                  //!< Date has been set
+    boolean  _dst;                    //!< Daylight Saving Time active
+    uint32_t _lastSecond;             //!< millis() of last Second
+    uint8_t  _second;                 //!< Second (0-59)
+    uint16_t _minute;                 //!< Minute of Day (0-1439)
+    uint8_t  _weekday;                //!< Weekday (0=Monday ... 6=Sunday)
+    uint16_t _year;                   //!< Year (e.g. 2024)
+    uint8_t  _month;                  //!< Month (1-12)
+    uint8_t  _day;                    //!< Day of Month (1-31)
+    uint16_t _sunrise;                //!< Sunrise today [Minute of Day]
+    uint16_t _sunset;                 //!< Sunset today [Minute of Day]
+    uint8_t  _num;                    //!< Number of Entries
+    uint8_t  _end[SCHED_PARTS];       //!< first Entry after each Part
+    uint8_t  _head[SCHED_PARTS];      //!< next Entry of each Part
+    uint16_t _headMinute[SCHED_PARTS];   //!< Minute of Day of each Head
+    uint8_t  _headWeekdays[SCHED_PARTS]; //!< Weekdays of each Head
+    uint8_t  _headAction[SCHED_PARTS];   //!< Action of each Head
+    uint8_t  _nextPart;               //!< Part of next due Entry
+    uint16_t _nextMinute;             //!< Minute of Day of next due Entry
+};
+
+#endif  // _SCHEDULER_H_
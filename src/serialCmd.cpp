@@ -0,0 +1,102 @@
+/*!
+ * @file serialCmd.cpp
+ */
+#include <serialCmd.h>
+
+/************************************************************
+ * begin (public)
+ ************************************************************/
+void serialCmd::begin (void) {
+  _len = 0;
+  _argc = 0;
+}
+
+/************************************************************
+ * poll (public)
+ * Read all available Characters from Serial (non-blocking)
+ * @returns true if a complete, non-empty Line was received.
+ *          The Words are valid until the next call of poll()
+ ************************************************************/
+boolean serialCmd::poll (void) {
+  int c;
+  while (Serial.available()) {
+    c = Serial.read();
+    if ((c == '\r') || (c == '\n')) {
+      if (_len == 0) {
+        continue;
+      }
+      _line[_len] = 0;
+      _len = 0;
+      split();
+      return (_argc > 0);
+    }
+    // ignore Characters beyond SERIAL_CMD_LEN
+    if (_len < SERIAL_CMD_LEN) {
+      _line[_len++] = (char)c;
+    }
+  }
+  return (false);
+}
+
+/************************************************************
+ * split (private)
+ * Split _line into Words at Blanks
+ ************************************************************/
+void serialCmd::split (void) {
+  char* p = _line;
+  _argc = 0;
+  while (*p && (_argc < SERIAL_CMD_ARGS)) {
+    while (*p == ' ') {
+      *p++ = 0;
+    }
+    if (*p) {
+      _argv[_argc++] = p;
+    }
+    while (*p && (*p != ' ')) {
+      p++;
+    }
+  }
+}
+
+/************************************************************
+ * argc (public)
+ * @returns Number of Words of the last Line
+ ************************************************************/
+uint8_t serialCmd::argc (void) {
+  return (_argc);
+}
+
+/************************************************************
+ * arg (public)
+ * @param[in] i Number of Word (0 = Command)
+ * @returns Word i, "" if not present
+ ************************************************************/
+const char* serialCmd::arg (uint8_t i) {
+  if (i < _argc) {
+    return (_argv[i]);
+  }
+  return ("");
+}
+
+/************************************************************
+ * is (public)
+ * @param[in] i Number of Word (0 = Command)
+ * @param[in] word String in Flash, e.g. F("prof")
+ * @returns true if Word i equals word
+ ************************************************************/
+boolean serialCmd::is (uint8_t i, const __FlashStringHelper* word) {
+  return (strcmp_P(arg(i), (const char*)word) == 0);
+}
+
+/************************************************************
+ * num (public)
+ * @param[in] i Number of Word (0 = Command)
+ * @returns Word i as Number (decimal or "0x" hex), 0 if not present
+ ************************************************************/
+int32_t serialCmd::num (uint8_t i) {
+  const char* p = arg(i);
+  if ((p[0] == '0') && ((p[1] == 'x') || (p[1] == 'X'))) {
+    return ((int32_t)strtoul(p + 2, NULL, 16));
+  }
+  return (strtol(p, NULL, 10));
+}
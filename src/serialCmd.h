@@ -0,0 +1,38 @@
+/************************************************************
+ * This File implements the Serial Command Reader
+ ************************************************************
+ * Characters received on Serial are collected until a
+ * Line End ('\r' or '\n'). The Line is split into Words
+ * separated by Blanks, which can be accessed as String
+ * or as Number (decimal, or hex with Prefix "0x").
+ * Reading is non-blocking, call poll() every loop.
+ ************************************************************
+ * The Commands themselves are executed in main.cpp
+ ************************************************************/
+#ifndef _SERIALCMD_H_
+#define _SERIALCMD_H_
+
+#include <Arduino.h>
+
+#define SERIAL_CMD_LEN       32     // max. Length of a Command Line
+#define SERIAL_CMD_ARGS       8     // max. Number of Words in a Command Line
+
+class serialCmd {
+    public:
+    // public functions
+    void begin (void);
+    boolean poll (void);
+    uint8_t argc (void);
+    const char* arg (uint8_t i);
+    boolean is (uint8_t i, const __FlashStringHelper* word);
+    int32_t num (uint8_t i);
+
+    private:
+    void split (void);
+    char    _line[SERIAL_CMD_LEN + 1];  //!< received Line
+    uint8_t _len;                       //!< Characters received so far
+    uint8_t _argc;                      //!< Number of Words
+    char*   _argv[SERIAL_CMD_ARGS];     //!< Start of each Word in _line
+};
+
+#endif  // _SERIALCMD_H_
@@ -0,0 +1,141 @@
+/*!
+ * @file sunCalc.cpp
+ */
+#include <sunCalc.h>
+#include <mySettings.h>
+
+#define Q14               16384     // 1.0 in Q14
+#define ANGLE_90          16384     // 90 deg as Binary Angle
+#define ANGLE_180         32768     // 180 deg as Binary Angle
+
+// sin(0 .. 90 deg) in 64 Steps, Q14
+static const int16_t sinTable[65] PROGMEM = {
+      0,   402,   804,  1205,  1606,  2006,  2404,  2801,
+   3196,  3590,  3981,  4370,  4756,  5139,  5520,  5897,
+   6270,  6639,  7005,  7366,  7723,  8076,  8423,  8765,
+   9102,  9434,  9760, 10080, 10394, 10702, 11003, 11297,
+  11585, 11866, 12140, 12406, 12665, 12916, 13160, 13395,
+  13623, 13842, 14053, 14256, 14449, 14635, 14811, 14978,
+  15137, 15286, 15426, 15557, 15679, 15791, 15893, 15986,
+  16069, 16143, 16207, 16261, 16305, 16340, 16364, 16379,
+  16384
+};
+
+/************************************************************
+ * isin
+ * @param[in] a Binary Angle (65536 = 360 deg)
+ * @returns sin(a) in Q14
+ ************************************************************/
+static int16_t isin(uint16_t a) {
+  uint16_t q;
+  uint8_t i;
+  int16_t s0;
+  int16_t s1;
+  int16_t s;
+  // reduce to first Quarter
+  q = a & (ANGLE_90 - 1);
+  if (a & ANGLE_90) {
+    q = ANGLE_90 - q;
+  }
+  // 256 Binary Angle Units per Table Step
+  i = q >> 8;
+  s0 = (int16_t)pgm_read_word(&sinTable[i]);
+  if (i < 64) {
+    s1 = (int16_t)pgm_read_word(&sinTable[i + 1]);
+    s = s0 + (int16_t)(((int32_t)(s1 - s0) * (q & 0xff)) >> 8);
+  } else {
+    s = s0;
+  }
+  return ((a & ANGLE_180) ? -s : s);
+}
+
+/************************************************************
+ * icos
+ * @param[in] a Binary Angle (65536 = 360 deg)
+ * @returns cos(a) in Q14
+ ************************************************************/
+static int16_t icos(uint16_t a) {
+  return (isin(a + ANGLE_90));
+}
+
+/************************************************************
+ * iacos
+ * @param[in] x Q14 (-1.0 .. 1.0)
+ * @returns acos(x) as Binary Angle (0 .. 180 deg)
+ ************************************************************/
+static uint16_t iacos(int16_t x) {
+  uint16_t lo = 0;
+  uint16_t hi = ANGLE_180;
+  uint16_t mid;
+  // cos is falling from 0 to 180 deg
+  while (hi - lo > 1) {
+    mid = (lo + hi) >> 1;
+    if (icos(mid) > x) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  return (lo);
+}
+
+/************************************************************
+ * sunCalc
+ * Sunrise and Sunset of a Day at the configured Location
+ * @param[in]  dayOfYear 1 .. 366
+ * @param[in]  utcOffset Local Time - UTC [min]
+ * @param[out] sunrise   Minute of Day (local), SUN_NONE if
+ *                       the Sun does not rise/set
+ * @param[out] sunset    Minute of Day (local), SUN_NONE if
+ *                       the Sun does not rise/set
+ ************************************************************/
+void sunCalc(uint16_t dayOfYear, int16_t utcOffset, uint16_t& sunrise, uint16_t& sunset) {
+  uint16_t g;           // Fractional Year (Binary Angle)
+  int32_t eq;           // Equation of Time / 229.18 [Q16]
+  int32_t decl;         // Declination [Q16 rad]
+  uint16_t d;           // Declination (Binary Angle)
+  uint16_t lat;         // Latitude (Binary Angle)
+  int32_t num;
+  int32_t den;
+  int32_t cosha;        // cos(Hour Angle) Q14
+  uint16_t ha;          // Hour Angle (Binary Angle)
+  int32_t noon;         // Solar Noon, local [1/10 min]
+  int32_t half;         // Hour Angle [1/10 min]
+  // Fractional Year at Noon
+  g = (uint16_t)(((uint32_t)(dayOfYear - 1) << 16) / 365);
+  // Equation of Time: 229.18 * (0.000075 + 0.001868 cos g - 0.032077 sin g
+  //                             - 0.014615 cos 2g - 0.040849 sin 2g) [min]
+  eq = 5
+     + ((122L * icos(g)) >> 14)
+     - ((2102L * isin(g)) >> 14)
+     - ((958L * icos(2 * g)) >> 14)
+     - ((2677L * isin(2 * g)) >> 14);
+  // Declination: 0.006918 - 0.399912 cos g + 0.070257 sin g - 0.006758 cos 2g
+  //              + 0.000907 sin 2g - 0.002697 cos 3g + 0.00148 sin 3g [rad]
+  decl = 453
+       - ((26209L * icos(g)) >> 14)
+       + ((4604L * isin(g)) >> 14)
+       - ((443L * icos(2 * g)) >> 14)
+       + ((59L * isin(2 * g)) >> 14)
+       - ((177L * icos(3 * g)) >> 14)
+       + ((97L * isin(3 * g)) >> 14);
+  // rad -> Binary Angle (65536 / 2pi = 10430.38)
+  d = (uint16_t)(int16_t)((decl * 10430L) >> 16);
+  lat = (uint16_t)(int16_t)(((int32_t)SUN_LATITUDE << 16) / 36000L);
+  // cos(ha) = (cos(90.833) - sin(lat) sin(d)) / (cos(lat) cos(d))
+  num = -238L - (((int32_t)isin(lat) * isin(d)) >> 14);
+  den = ((int32_t)icos(lat) * icos(d)) >> 14;
+  cosha = (num << 14) / den;
+  if ((cosha > Q14) || (cosha < -Q14)) {
+    sunrise = SUN_NONE;
+    sunset = SUN_NONE;
+    return;
+  }
+  ha = iacos((int16_t)cosha);
+  // Solar Noon = 720 - 4 * Longitude - Equation of Time [min]
+  noon = 7200L - (((int32_t)SUN_LONGITUDE * 4) / 10) - ((eq * 2292L) >> 16) + (int32_t)utcOffset * 10;
+  // 4 min per deg: Binary Angle * 1440 / 65536 [min]
+  half = ((int32_t)ha * 14400L) >> 16;
+  sunrise = (uint16_t)((noon - half + 5) / 10);
+  sunset = (uint16_t)((noon + half + 5) / 10);
+}
@@ -0,0 +1,24 @@
+/************************************************************
+ * This File implements the Sunrise/Sunset Calculation
+ ************************************************************
+ * NOAA Approximation (Equation of Time, Declination, Hour
+ * Angle for a Zenith of 90.833 deg) computed with Integer
+ * Arithmetic only:
+ * - Angles are Binary Angles (65536 = 360 deg)
+ * - sin/cos: Table of a Quarter Wave (Q14) with linear
+ *   Interpolation, acos: Binary Search on cos
+ * - Location is configured in mySettings.h
+ *   (SUN_LATITUDE, SUN_LONGITUDE)
+ ************************************************************
+ * Error against the same Formulas in double: < 1 Minute
+ ************************************************************/
+#ifndef _SUNCALC_H_
+#define _SUNCALC_H_
+
+#include <Arduino.h>
+
+#define SUN_NONE          0xffff    // Sun does not rise/set (Polar Day/Night)
+
+void sunCalc(uint16_t dayOfYear, int16_t utcOffset, uint16_t& sunrise, uint16_t& sunset);
+
+#endif  // _SUNCALC_H_
@@ -0,0 +1,205 @@
+/*!
+ * @file timerWheel.cpp
+ */
+#include <timerWheel.h>
+
+#define TIMER_FREE         0xff     // slot: Timer is in Free-List
+#define TIMER_EXPIRED      0xfe     // slot: Timer expired, Callback pending
+
+/************************************************************
+ * begin (public)
+ * All Timers free, Wheel starts now
+ ************************************************************/
+void timerWheel::begin (void) {
+  uint8_t i;
+  for (i = 0; i < TIMER_SLOTS; i++) {
+    _slot[i] = TIMER_NONE;
+  }
+  for (i = 0; i < TIMER_NUM; i++) {
+    _timer[i].next = (i + 1 < TIMER_NUM) ? (i + 1) : TIMER_NONE;
+    _timer[i].slot = TIMER_FREE;
+  }
+  _free = 0;
+  _used = 0;
+  _cur = 0;
+  _lastTick = millis();
+}
+
+/************************************************************
+ * start (public)
+ * Start a Timer
+ * @param[in] ms  Duration [ms], rounded up to the next Tick 
+ *                (never early), limited to TIMER_MAX
+ * @param[in] cb  Callback called when the Timer expires
+ * @param[in] arg Argument of the Callback
+ * @returns Handle of the Timer, TIMER_NONE if no Timer is free
+ ************************************************************/
+uint8_t timerWheel::start (uint32_t ms, timerCallback cb, uint8_t arg) {
+  uint8_t h;
+  uint8_t s;
+  uint32_t ticks;
+  h = _free;
+  if (h == TIMER_NONE) {
+    return (TIMER_NONE);
+  }
+  _free = _timer[h].next;
+  _used++;
+  if (ms > TIMER_MAX) {
+    ms = TIMER_MAX;
+  }
+  // from the last Tick: the actual Tick is already running
+  ticks = (ms + (uint32_t)(millis() - _lastTick) + TIMER_TICK - 1) / TIMER_TICK;
+  if (ticks == 0) {
+    ticks = 1;
+  } else if (ticks > TIMER_MAX / TIMER_TICK) {
+    ticks = TIMER_MAX / TIMER_TICK;
+  }
+  s = (_cur + ticks) & (TIMER_SLOTS - 1);
+  _timer[h].rounds = (ticks - 1) >> TIMER_SLOT_SHIFT;
+  _timer[h].cb = cb;
+  _timer[h].arg = arg;
+  _timer[h].slot = s;
+  // link in front of Slot
+  _timer[h].prev = TIMER_NONE;
+  _timer[h].next = _slot[s];
+  if (_slot[s] != TIMER_NONE) {
+    _timer[_slot[s]].prev = h;
+  }
+  _slot[s] = h;
+  return (h);
+}
+
+/************************************************************
+ * cancel (public)
+ * Stop a Timer, its Callback will not be called
+ * @param[in] handle Handle returned by start()
+ ************************************************************/
+void timerWheel::cancel (uint8_t handle) {
+  if (handle >= TIMER_NUM) {
+    return;
+  }
+  if (_timer[handle].slot < TIMER_SLOTS) {
+    unlink(handle);
+    release(handle);
+  } else if (_timer[handle].slot == TIMER_EXPIRED) {
+    // released after the pending Callbacks
+    _timer[handle].cb = NULL;
+  }
+}
+
+/************************************************************
+ * active (public)
+ * @param[in] handle Handle returned by start()
+ * @returns true if the Timer is running
+ ************************************************************/
+boolean timerWheel::active (uint8_t handle) {
+  return ((handle < TIMER_NUM) && (_timer[handle].slot < TIMER_SLOTS));
+}
+
+/************************************************************
+ * remaining (public)
+ * @param[in] handle Handle returned by start()
+ * @returns Time until the Timer expires [ms], 0 if not running
+ ************************************************************/
+uint32_t timerWheel::remaining (uint8_t handle) {
+  uint32_t ticks;
+  uint32_t elapsed;
+  if (!active(handle)) {
+    return (0);
+  }
+  ticks = (_timer[handle].slot - _cur) & (TIMER_SLOTS - 1);
+  if (ticks == 0) {
+    ticks = TIMER_SLOTS;
+  }
+  ticks += (uint32_t)_timer[handle].rounds << TIMER_SLOT_SHIFT;
+  // Time since last Tick
+  elapsed = (uint32_t)(millis() - _lastTick);
+  ticks *= TIMER_TICK;
+  return ((ticks > elapsed) ? (ticks - elapsed) : 0);
+}
+
+/************************************************************
+ * used (public)
+ * @returns Number of running Timers
+ ************************************************************/
+uint8_t timerWheel::used (void) {
+  return (_used);
+}
+
+/************************************************************
+ * tick (public)
+ * Advance the Wheel by all Ticks elapsed since the last call
+ ************************************************************/
+void timerWheel::tick (void) {
+  while ((uint32_t)(millis() - _lastTick) >= TIMER_TICK) {
+    _lastTick += TIMER_TICK;
+    advance();
+  }
+}
+
+/************************************************************
+ * advance (private)
+ * Move to the next Slot, call the Callbacks of all Timers
+ * expiring in this Slot
+ ************************************************************/
+void timerWheel::advance (void) {
+  uint8_t h;
+  uint8_t next;
+  uint8_t expired;
+  timerCallback cb;
+  uint8_t arg;
+  _cur = (_cur + 1) & (TIMER_SLOTS - 1);
+  // collect expired Timers, Callbacks may change the Slot
+  expired = TIMER_NONE;
+  h = _slot[_cur];
+  while (h != TIMER_NONE) {
+    next = _timer[h].next;
+    if (_timer[h].rounds == 0) {
+      unlink(h);
+      _timer[h].slot = TIMER_EXPIRED;
+      _timer[h].next = expired;
+      expired = h;
+    } else {
+      _timer[h].rounds--;
+    }
+    h = next;
+  }
+  // call Callbacks
+  while (expired != TIMER_NONE) {
+    h = expired;
+    expired = _timer[h].next;
+    cb = _timer[h].cb;
+    arg = _timer[h].arg;
+    release(h);
+    if (cb) {
+      cb(arg);
+    }
+  }
+}
+
+/************************************************************
+ * unlink (private)
+ * Remove Timer from its Slot
+ ************************************************************/
+void timerWheel::unlink (uint8_t handle) {
+  timerEntry* t = &_timer[handle];
+  if (t->prev != TIMER_NONE) {
+    _timer[t->prev].next = t->next;
+  } else {
+    _slot[t->slot] = t->next;
+  }
+  if (t->next != TIMER_NONE) {
+    _timer[t->next].prev = t->prev;
+  }
+}
+
+/************************************************************
+ * release (private)
+ * Put Timer back to the Free-List
+ ************************************************************/
+void timerWheel::release (uint8_t handle) {
+  _timer[handle].slot = TIMER_FREE;
+  _timer[handle].next = _free;
+  _free = handle;
+  _used--;
+}
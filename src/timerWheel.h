@@ -0,0 +1,84 @@
+/************************************************************
+ * This File implements the Timers (Hashed Timing Wheel)
+ ************************************************************
+ * - TIMER_NUM Timers are taken from a fixed Pool
+ * - The Wheel has TIMER_SLOTS Slots, one Slot per Tick
+ *   (TIMER_TICK ms). A Timer is linked into the Slot in
+ *   which it expires, Timers longer than one Revolution
+ *   count down their Rounds.
+ * - start() and cancel() are O(1) (doubly linked Slots)
+ * - tick() must be called every loop, it advances the Wheel
+ *   by all Ticks elapsed since the last call. Only Time
+ *   Differences of millis() are used, so the Wrap-Around of
+ *   millis() after 49 Days does not matter.
+ * - Expired Timers call their Callback with their Argument,
+ *   Callbacks may start and cancel Timers.
+ ************************************************************
+ * Resolution: TIMER_TICK, a Timer expires between ms and 
+ * ms + TIMER_TICK after start()
+ * max. Duration: TIMER_MAX (65535 Revolutions, 11.6h), 
+ * longer Durations are limited
+ * RAM: TIMER_NUM * 8 + TIMER_SLOTS Byte
+ ************************************************************
+ * Worst Case of running Timers (TIMER_NUM):
+ * - Rollers: 1 per Roller (Stagger and Stop)    4
+ * - Special Events: 1 per Script (SCRIPT_NUM)   4
+ * - Auto-Off: 1 for all Outputs                 1
+ * - Output Restore: Commit Deadline             1
+ * - Hold Repeats: 1 per held Input              6
+ *   (more held at once: no Repeats)
+ ************************************************************/
+#ifndef _TIMERWHEEL_H_
+#define _TIMERWHEEL_H_
+
+#include <Arduino.h>
+
+#define TIMER_NUM            16     // Number of Timers (max. 250, see above)
+#define TIMER_SLOTS          64     // Slots of the Wheel (Power of 2)
+#define TIMER_SLOT_SHIFT      6     // log2(TIMER_SLOTS)
+#define TIMER_TICK           10     // [ms] Resolution
+#define TIMER_NONE         0xff     // Handle of no Timer
+#define TIMER_MAX   ((uint32_t)TIMER_SLOTS * TIMER_TICK * 65535)  // [ms] max. Duration
+
+/********************************************************
+ * Callback of an expired Timer
+ * @param[in] arg Argument given to start()
+ ********************************************************/
+typedef void (*timerCallback)(uint8_t arg);
+
+/********************************************************
+ * One Timer
+ ********************************************************/
+typedef struct {
+  uint8_t  next;                    //!< next Timer in Slot / Free-List
+  uint8_t  prev;                    //!< previous Timer in Slot
+  uint8_t  slot;                    //!< Slot, TIMER_FREE or TIMER_EXPIRED
+  uint16_t rounds;                  //!< Revolutions left
+  timerCallback cb;                 //!< Callback
+  uint8_t  arg;                     //!< Argument of Callback
+} timerEntry;
+
+class timerWheel {
+    public:
+    // public functions
+    void begin (void);
+    uint8_t start (uint32_t ms, timerCallback cb, uint8_t arg);
+    void cancel (uint8_t handle);
+    boolean active (uint8_t handle);
+    uint32_t remaining (uint8_t handle);
+    uint8_t used (void);
+    void tick (void);
+
+    private:
+    void unlink (uint8_t handle);
+    void release (uint8_t handle);
+    void advance (void);
+    timerEntry _timer[TIMER_NUM];
+    uint8_t  _slot[TIMER_SLOTS];      //!< first Timer of each Slot
+    uint8_t  _free;                   //!< first free Timer
+    uint8_t  _used;                   //!< Number of running Timers
+    uint8_t  _cur;                    //!< actual Slot
+    uint32_t _lastTick;               //!< millis() of last Tick
+};
+
+#endif  // _TIMERWHEEL_H_
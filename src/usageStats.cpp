@@ -0,0 +1,276 @@
+/*!
+ * @file usageStats.cpp
+ */
+#include <usageStats.h>
+#include <avr/eeprom.h>
+
+/************************************************************
+ * begin (public)
+ * Clear the Deltas, initialize the EEPROM Area on first Use
+ * (erased EEPROM, BLOCKING ~0.8s once)
+ ************************************************************/
+void usageStats::begin (void) {
+  uint16_t adr;
+  memset(_switches, 0, sizeof(_switches));
+  memset(_presses, 0, sizeof(_presses));
+  memset(_onSecs, 0, sizeof(_onSecs));
+  _lastSecond = millis();
+  _lastFlush = millis();
+  _flushPos = STATS_IDLE;
+  _full = false;
+  _flushes = 0;
+  _lost = 0;
+  if (eeprom_read_byte((const uint8_t*)EE_OFFSET_STATS_MARK) != STATS_MARK) {
+    DBG_SETUP.println(F("- Stats: EEPROM Area cleared"));
+    for (adr = EE_OFFSET_STATS_SWITCH; adr < EE_OFFSET_STATS_MARK; adr++) {
+      eeprom_update_byte((uint8_t*)adr, 0);
+    }
+    eeprom_update_byte((uint8_t*)EE_OFFSET_STATS_MARK, STATS_MARK);
+  }
+}
+
+/************************************************************
+ * outputs (public)
+ * Called by setOutputs() with every Change: count Switches
+ * @param[in] oldState Outputs before the Change
+ * @param[in] newState Outputs after the Change
+ ************************************************************/
+void usageStats::outputs (uint32_t oldState, uint32_t newState) {
+  count(_switches, oldState ^ newState);
+}
+
+/************************************************************
+ * inputs (public)
+ * Called by the Scan with every Change: count Presses
+ * (Inputs which became active)
+ * @param[in] oldState Inputs before the Change
+ * @param[in] newState Inputs after the Change
+ ************************************************************/
+void usageStats::inputs (uint32_t oldState, uint32_t newState) {
+  count(_presses, (oldState ^ newState) & newState);
+}
+
+/************************************************************
+ * count (private)
+ * One Pass over the changed Bits, Delta Counters stop at
+ * 255 (lost Counts are counted)
+ * @param[in] delta   Delta Counters (32)
+ * @param[in] changed Bits to be counted
+ ************************************************************/
+void usageStats::count (uint8_t* delta, uint32_t changed) {
+  uint8_t i;
+  for (i = 0; changed; i++, changed >>= 1) {
+    if (!(changed & 1)) {
+      continue;
+    }
+    if (delta[i] == 0xff) {
+      _lost++;
+      continue;
+    }
+    if (++delta[i] >= STATS_DELTA_FULL) {
+      _full = true;
+    }
+  }
+}
+
+/************************************************************
+ * tick (public)
+ * Called each Loop: On-Time of the Outputs which are on,
+ * start and continue the Flush (one Field per Call, only
+ * when the EEPROM is ready)
+ * @param[in] outState State of the Outputs
+ ************************************************************/
+void usageStats::tick (uint32_t outState) {
+  uint8_t i;
+  uint32_t m;
+  while (millis() - _lastSecond >= 1000) {
+    _lastSecond += 1000;
+    for (i = 0, m = outState; m; i++, m >>= 1) {
+      if ((m & 1) && (_onSecs[i] != 0xffff)) {
+        _onSecs[i]++;
+      }
+    }
+  }
+  if (_flushPos == STATS_IDLE) {
+    if ((millis() - _lastFlush >= STATS_FLUSH_INTERVAL) ||
+        (_full && (millis() - _lastFlush >= STATS_FLUSH_MIN))) {
+      flush();
+    }
+    return;
+  }
+  if (!eeprom_is_ready()) {
+    return;
+  }
+  flushField(_flushPos++);
+  if (_flushPos == STATS_FIELDS) {
+    _flushPos = STATS_IDLE;
+    _flushes++;
+    DBG_EVENT.println(F("Stats: flushed"));
+  }
+}
+
+/************************************************************
+ * flush (public)
+ * Start a Flush of all Deltas (continued by tick())
+ ************************************************************/
+void usageStats::flush (void) {
+  if (_flushPos == STATS_IDLE) {
+    _flushPos = 0;
+    _full = false;
+    _lastFlush = millis();
+  }
+}
+
+/************************************************************
+ * flushField (private)
+ * Add the Delta of one Field to its EEPROM Total
+ * @param[in] pos Field: Switches of Output 0-31, On-Time of
+ *                Output 0-31, Presses of Input 0-31
+ ************************************************************/
+void usageStats::flushField (uint8_t pos) {
+  uint16_t adr;
+  uint32_t total;
+  uint16_t hours;
+  if (pos < MCP_OUT_PINS) {
+    if (_switches[pos]) {
+      adr = EE_OFFSET_STATS_SWITCH + (pos * 3);
+      total = getCounter(adr, 3) + _switches[pos];
+      setCounter(adr, 3, (total > 0xffffffUL) ? 0xffffffUL : total);
+      _switches[pos] = 0;
+    }
+  } else if (pos < 2 * MCP_OUT_PINS) {
+    pos -= MCP_OUT_PINS;
+    // whole Hours, the Rest stays in RAM
+    hours = _onSecs[pos] / 3600;
+    if (hours) {
+      adr = EE_OFFSET_STATS_ON_TIME + (pos * 2);
+      total = getCounter(adr, 2) + hours;
+      setCounter(adr, 2, (total > 0xffff) ? 0xffff : total);
+      _onSecs[pos] -= hours * 3600;
+    }
+  } else {
+    pos -= 2 * MCP_OUT_PINS;
+    if (_presses[pos]) {
+      adr = EE_OFFSET_STATS_PRESS + (pos * 2);
+      total = getCounter(adr, 2) + _presses[pos];
+      setCounter(adr, 2, (total > 0xffff) ? 0xffff : total);
+      _presses[pos] = 0;
+    }
+  }
+}
+
+/************************************************************
+ * getCounter, setCounter (private, static)
+ * Counter in EEPROM, LSB first (only changed Bytes written)
+ * @param[in] adr   EEPROM Address
+ * @param[in] len   Bytes (2 or 3)
+ * @param[in] value Counter to be written
+ * @returns Counter
+ ************************************************************/
+uint32_t usageStats::getCounter (uint16_t adr, uint8_t len) {
+  uint32_t value;
+  value = 0;
+  while (len--) {
+    value = (value << 8) | eeprom_read_byte((const uint8_t*)(adr + len));
+  }
+  return (value);
+}
+
+void usageStats::setCounter (uint16_t adr, uint8_t len, uint32_t value) {
+  for (; len; len--, adr++, value >>= 8) {
+    eeprom_update_byte((uint8_t*)adr, value & 0xff);
+  }
+}
+
+/************************************************************
+ * clear (public)
+ * Reset the Counters of an Output after a Relay Replacement
+ * (BLOCKING, EEPROM Writes)
+ * @param[in] outPin Output (0-31), STATS_ALL: all Outputs
+ *                   and Inputs
+ ************************************************************/
+void usageStats::clear (uint8_t outPin) {
+  uint8_t i;
+  for (i = 0; i < MCP_OUT_PINS; i++) {
+    if ((outPin == i) || (outPin == STATS_ALL)) {
+      _switches[i] = 0;
+      _onSecs[i] = 0;
+      setCounter(EE_OFFSET_STATS_SWITCH + (i * 3), 3, 0);
+      setCounter(EE_OFFSET_STATS_ON_TIME + (i * 2), 2, 0);
+    }
+  }
+  if (outPin == STATS_ALL) {
+    for (i = 0; i < MCP_IN_PINS; i++) {
+      _presses[i] = 0;
+      setCounter(EE_OFFSET_STATS_PRESS + (i * 2), 2, 0);
+    }
+  }
+}
+
+/************************************************************
+ * switches, onTime, presses (public)
+ * Totals: EEPROM + Delta
+ * @param[in] outPin Output (0-31)
+ * @param[in] inPin  Input (0-31)
+ * @returns Switches, On-Time [min], Presses
+ ************************************************************/
+uint32_t usageStats::switches (uint8_t outPin) {
+  return (getCounter(EE_OFFSET_STATS_SWITCH + (outPin * 3), 3) + _switches[outPin]);
+}
+
+uint32_t usageStats::onTime (uint8_t outPin) {
+  return (getCounter(EE_OFFSET_STATS_ON_TIME + (outPin * 2), 2) * 60 + _onSecs[outPin] / 60);
+}
+
+uint16_t usageStats::presses (uint8_t inPin) {
+  uint32_t total;
+  total = getCounter(EE_OFFSET_STATS_PRESS + (inPin * 2), 2) + _presses[inPin];
+  return ((total > 0xffff) ? 0xffff : total);
+}
+
+/************************************************************
+ * printState (public)
+ * e.g. "Stats: 3 Flushes, 0 lost - next Flush in 1234s"
+ *      " - Out 5: 1234 Switches, 567min on"
+ *      " - In 3: 45 Presses"
+ * (only Outputs and Inputs used)
+ ************************************************************/
+void usageStats::printState (void) {
+  uint8_t i;
+  uint32_t n;
+  DBG.print(F("Stats: "));
+  DBG.print(_flushes);
+  DBG.print(F(" Flushes, "));
+  DBG.print(_lost);
+  if (_flushPos != STATS_IDLE) {
+    DBG.println(F(" lost - Flush running"));
+  } else {
+    DBG.print(F(" lost - next Flush in "));
+    DBG.print((STATS_FLUSH_INTERVAL - (millis() - _lastFlush)) / 1000);
+    DBG.println(F("s"));
+  }
+  for (i = 0; i < MCP_OUT_PINS; i++) {
+    n = switches(i);
+    if (n == 0) {
+      continue;
+    }
+    DBG.print(F(" - Out "));
+    DBG.print(i);
+    DBG.print(F(": "));
+    DBG.print(n);
+    DBG.print(F(" Switches, "));
+    DBG.print(onTime(i));
+    DBG.println(F("min on"));
+  }
+  for (i = 0; i < MCP_IN_PINS; i++) {
+    n = presses(i);
+    if (n == 0) {
+      continue;
+    }
+    DBG.print(F(" - In "));
+    DBG.print(i);
+    DBG.print(F(": "));
+    DBG.print(n);
+    DBG.println(F(" Presses"));
+  }
+}
@@ -0,0 +1,76 @@
+/************************************************************
+ * This File implements the Relay Wear and Usage Statistics
+ ************************************************************
+ * - Per Output: Switch Counter and cumulative On-Time,
+ *   per Input: Press Counter
+ * - outputs() is called by setOutputs(), inputs() by the
+ *   Scan with every Change: the XOR of old and new State
+ *   is counted in one Pass over the changed Bits (Delta
+ *   Counters in RAM)
+ * - tick() adds one Second of On-Time to each Output which
+ *   is on, and flushes the Deltas to the EEPROM Totals every
+ *   STATS_FLUSH_INTERVAL (earlier if a Delta Counter is
+ *   nearly full). The Flush is deferred: one Field per
+ *   Loop and only when the EEPROM is ready (no Wait for a
+ *   Write), only changed Bytes are written.
+ * - Wear: the Totals (96 Counters) fill the free EEPROM, a
+ *   second Copy does not fit. The Write Rate is bounded
+ *   instead: each Byte is written at most once per Flush
+ *   (1/h: 8760 Writes per Year, > 10 Years at 100k Cycles)
+ * - Deltas not flushed are lost with a Reset (max.
+ *   STATS_FLUSH_INTERVAL, On-Time below one Hour stays in
+ *   RAM)
+ ************************************************************
+ * EEPROM (Runtime Data, not in the Configuration Image):
+ * - Switches: 3 Byte per Output (max. 16.7M)
+ * - On-Time:  2 Byte per Output [h] (max. 7.4 Years)
+ * - Presses:  2 Byte per Input (max. 65535)
+ * Counters stop at their Maximum
+ * RAM: ~140 Byte (Deltas)
+ ************************************************************/
+#ifndef _USAGESTATS_H_
+#define _USAGESTATS_H_
+
+#include <Arduino.h>
+#include <debugOptions.h>
+#include <myHWconfig.h>
+
+#define STATS_FLUSH_INTERVAL  3600000UL  // [ms] Flush of the Deltas to EEPROM
+#define STATS_FLUSH_MIN         60000UL  // [ms] min. Time between Flushes (Delta full)
+#define STATS_DELTA_FULL          200    // Delta Counter: Flush requested
+#define STATS_MARK               0xA5    // EEPROM Area initialized
+#define STATS_FIELDS   (2 * MCP_OUT_PINS + MCP_IN_PINS)  // Switches, On-Time, Presses
+#define STATS_IDLE               0xff    // no Flush running
+#define STATS_ALL                0xff    // clear(): all Counters
+
+class usageStats {
+    public:
+    // public functions
+    void begin (void);
+    void outputs (uint32_t oldState, uint32_t newState);
+    void inputs (uint32_t oldState, uint32_t newState);
+    void tick (uint32_t outState);
+    void flush (void);
+    void clear (uint8_t outPin);
+    uint32_t switches (uint8_t outPin);
+    uint32_t onTime (uint8_t outPin);
+    uint16_t presses (uint8_t inPin);
+    void printState (void);
+
+    private:
+    void count (uint8_t* delta, uint32_t changed);
+    void flushField (uint8_t pos);
+    static uint32_t getCounter (uint16_t adr, uint8_t len);
+    static void setCounter (uint16_t adr, uint8_t len, uint32_t value);
+    uint8_t  _switches[MCP_OUT_PINS]; //!< Switches since last Flush
+    uint8_t  _presses[MCP_IN_PINS];   //!< Presses since last Flush
+    uint16_t _onSecs[MCP_OUT_PINS];   //!< [s] On-Time since last Flush
+    uint32_t _lastSecond;             //!< millis() of the last On-Time Second
+    uint32_t _lastFlush;              //!< millis() of the last Flush
+    uint8_t  _flushPos;               //!< next Field to flush, STATS_IDLE
+    boolean  _full;                   //!< a Delta Counter is nearly full
+    uint16_t _flushes;                //!< Flushes since Reset
+    uint16_t _lost;                   //!< Counts lost (Delta Counter full)
+};
+
+#endif  // _USAGESTATS_H_
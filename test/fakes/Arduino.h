@@ -0,0 +1,269 @@
+/************************************************************
+ * Host Stand-In of the Arduino Core (env:native)
+ ************************************************************
+ * Only what the Modules under Test use:
+ * - millis() and micros() return a simulated Clock, moved
+ *   by the Tests with fakeAdvance() (and delay()). With
+ *   fakeRealTime set they return the Time of the Host
+ *   (Benchmarks).
+ * - Serial collects its Output in Serial.out, Input is
+ *   fed by the Tests with fakeSerialIn()
+ * - Flash is plain Memory: PROGMEM, F() and PSTR() are
+ *   empty, pgm_read_xxx() read the Pointer
+ * - Pins: digitalRead() returns fakePinLevel[pin], SDA is
+ *   held low by a Slave for fakeSdaHeld Clocks on SCL. Each
+ *   Pin is a Port of its own, its Level in Bit 0 of the
+ *   Input Register (portInputRegister(), ISRs)
+ * The Objects are defined in fakeMain.h, included once by
+ * each Test.
+ ************************************************************/
+#ifndef _FAKE_ARDUINO_H_
+#define _FAKE_ARDUINO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+// C++ Headers of the Fakes and Tests before the Macros min() and max()
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <limits>
+#include <string>
+#include <vector>
+
+#define ARDUINO             10819
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH                  0x1
+#define LOW                   0x0
+#define INPUT                 0x0
+#define OUTPUT                0x1
+#define INPUT_PULLUP          0x2
+#define CHANGE                  1
+#define FALLING                 2
+#define RISING                  3
+#define DEC                    10
+#define HEX                    16
+#define OCT                     8
+#define BIN                     2
+#define SDA                    18
+#define SCL                    19
+#define FAKE_PINS              20
+
+#define min(a,b)              ((a)<(b)?(a):(b))
+#define max(a,b)              ((a)>(b)?(a):(b))
+#define constrain(x,lo,hi)    ((x)<(lo)?(lo):((x)>(hi)?(hi):(x)))
+#define bitRead(v,b)          (((v) >> (b)) & 0x01)
+#define bitSet(v,b)           ((v) |= (1UL << (b)))
+#define bitClear(v,b)         ((v) &= ~(1UL << (b)))
+#define bitWrite(v,b,x)       ((x) ? bitSet(v, b) : bitClear(v, b))
+#define digitalPinToInterrupt(p)  ((p) == 2 ? 0 : ((p) == 3 ? 1 : -1))
+#define NOT_AN_INTERRUPT      -1
+#define interrupts()
+#define noInterrupts()
+
+/********************************************************
+ * Flash
+ ********************************************************/
+class __FlashStringHelper;
+#define PROGMEM
+#define PSTR(s)               (s)
+#define F(s)                  (reinterpret_cast<const __FlashStringHelper*>(s))
+#define pgm_read_byte(p)      (*(const uint8_t*)(p))
+#define pgm_read_word(p)      fakePgmRead(p)
+#define pgm_read_dword(p)     fakePgmRead(p)
+#define pgm_read_ptr(p)       fakePgmRead(p)
+#define strcmp_P              strcmp
+#define strncmp_P             strncmp
+#define strcasecmp_P          strcasecmp
+#define strncasecmp_P         strncasecmp
+#define strlen_P              strlen
+#define strcpy_P              strcpy
+#define memcpy_P              memcpy
+
+// Value of the Type stored (a Word is an int16_t, a Pointer ... on the AVR)
+template <class T> inline T fakePgmRead (const T* p) {
+  return (*p);
+}
+
+/********************************************************
+ * Clock
+ ********************************************************/
+extern uint32_t fakeMillis;             //!< simulated millis()
+extern uint32_t fakeMicros;             //!< simulated micros()
+extern boolean  fakeRealTime;           //!< Clock of the Host
+
+// uint32_t as unsigned long on the AVR: Differences wrap at 32 Bit
+uint32_t millis (void);
+uint32_t micros (void);
+
+inline void fakeAdvance (uint32_t ms) {
+  fakeMillis += ms;
+  fakeMicros += ms * 1000UL;
+}
+
+inline void fakeAdvanceMicros (uint32_t us) {
+  fakeMicros += us;
+  fakeMillis = fakeMicros / 1000UL;
+}
+
+inline void delay (unsigned long ms) {
+  fakeAdvance(ms);
+}
+
+inline void delayMicroseconds (unsigned int us) {
+  fakeAdvanceMicros(us);
+}
+
+/********************************************************
+ * Pins
+ ********************************************************/
+extern uint8_t fakePinLevel[FAKE_PINS];    //!< read by digitalRead()
+extern uint8_t fakeSdaHeld;                //!< SCL Clocks until SDA is released
+
+inline void pinMode (uint8_t pin, uint8_t mode) {
+  // SCL driven low: one Clock for a Slave holding SDA
+  if ((pin == SCL) && (mode == OUTPUT) && fakeSdaHeld) {
+    fakeSdaHeld--;
+  }
+}
+
+inline void digitalWrite (uint8_t pin, uint8_t val) {
+  (void)pin;
+  (void)val;
+}
+
+inline int digitalRead (uint8_t pin) {
+  if ((pin == SDA) && fakeSdaHeld) {
+    return (LOW);
+  }
+  return ((pin < FAKE_PINS) ? fakePinLevel[pin] : LOW);
+}
+
+// Port Access: one Port per Pin, Input Register = fakePinLevel[pin]
+#define digitalPinToPort(p)       (p)
+#define digitalPinToBitMask(p)    ((uint8_t)0x01)
+#define portInputRegister(port)   (&fakePinLevel[(port)])
+
+inline void attachInterrupt (uint8_t irq, void (*isr)(void), int mode) {
+  (void)irq;
+  (void)isr;
+  (void)mode;
+}
+
+inline void detachInterrupt (uint8_t irq) {
+  (void)irq;
+}
+
+/********************************************************
+ * Print (as the Arduino Core: Numbers without Padding,
+ * println() ends with CR LF)
+ ********************************************************/
+class Print {
+    public:
+    virtual ~Print () {}
+    virtual size_t write (uint8_t c) = 0;
+    virtual size_t write (const uint8_t* buf, size_t n) {
+      size_t i;
+      for (i = 0; i < n; i++) {
+        write(buf[i]);
+      }
+      return (n);
+    }
+    size_t write (const char* s) {
+      return (write((const uint8_t*)s, strlen(s)));
+    }
+    virtual void flush (void) {}
+    size_t print (const __FlashStringHelper* s) { return (write((const char*)s)); }
+    size_t print (const char* s) { return (write(s)); }
+    size_t print (char c) { return (write((uint8_t)c)); }
+    size_t print (unsigned char n, int base = DEC) { return (printNumber(n, base)); }
+    size_t print (int n, int base = DEC) { return (print((long)n, base)); }
+    size_t print (unsigned int n, int base = DEC) { return (printNumber(n, base)); }
+    size_t print (long n, int base = DEC) {
+      if ((base == DEC) && (n < 0)) {
+        return (write('-') + printNumber(0UL - (unsigned long)n, DEC));
+      }
+      return (printNumber((uint32_t)n, base));
+    }
+    size_t print (unsigned long n, int base = DEC) { return (printNumber(n, base)); }
+    size_t print (double n, int digits = 2) {
+      char buf[32];
+      snprintf(buf, sizeof(buf), "%.*f", digits, n);
+      return (write(buf));
+    }
+    size_t println (void) { return (write("\r\n")); }
+    template <class T> size_t println (T v) {
+      size_t n = print(v);
+      return (n + println());
+    }
+    template <class T> size_t println (T v, int base) {
+      size_t n = print(v, base);
+      return (n + println());
+    }
+
+    private:
+    size_t printNumber (unsigned long n, int base) {
+      char buf[8 * sizeof(long) + 1];
+      char* s = &buf[sizeof(buf) - 1];
+      *s = 0;
+      if (base < 2) {
+        base = DEC;
+      }
+      do {
+        char c = n % base;
+        n /= base;
+        *--s = (c < 10) ? (c + '0') : (c + 'A' - 10);
+      } while (n);
+      return (write(s));
+    }
+};
+
+/********************************************************
+ * Stream
+ ********************************************************/
+class Stream : public Print {
+    public:
+    virtual int available (void) = 0;
+    virtual int read (void) = 0;
+    virtual int peek (void) = 0;
+    void setTimeout (unsigned long ms) { (void)ms; }
+};
+
+/********************************************************
+ * Serial: Output to Serial.out, Input from Serial.in
+ ********************************************************/
+class HardwareSerial : public Stream {
+    public:
+    void begin (unsigned long baud) { (void)baud; }
+    void end (void) {}
+    virtual size_t write (uint8_t c) {
+      out += (char)c;
+      if (echo) {
+        putchar(c);
+      }
+      return (1);
+    }
+    using Print::write;
+    virtual int available (void) { return ((int)(in.size() - inPos)); }
+    virtual int read (void) { return ((inPos < in.size()) ? (uint8_t)in[inPos++] : -1); }
+    virtual int peek (void) { return ((inPos < in.size()) ? (uint8_t)in[inPos] : -1); }
+    operator bool () { return (true); }
+    std::string out;                    //!< everything written
+    std::string in;                     //!< Input to be read
+    size_t      inPos;                  //!< next Byte of in
+    boolean     echo;                   //!< copy the Output to stdout
+};
+
+extern HardwareSerial Serial;
+
+inline void fakeSerialIn (const uint8_t* buf, size_t n) {
+  Serial.in.append((const char*)buf, n);
+}
+
+#endif  // _FAKE_ARDUINO_H_
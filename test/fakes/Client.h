@@ -0,0 +1,28 @@
+/************************************************************
+ * Host Stand-In of the Arduino Client Interface (env:native)
+ * (Interface of Client.h, implemented by fakeClient in
+ * fakeNet.h)
+ ************************************************************/
+#ifndef _FAKE_CLIENT_H_
+#define _FAKE_CLIENT_H_
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+class Client : public Stream {
+    public:
+    virtual int connect (IPAddress ip, uint16_t port) = 0;
+    virtual int connect (const char* host, uint16_t port) = 0;
+    virtual size_t write (uint8_t c) = 0;
+    virtual size_t write (const uint8_t* buf, size_t n) = 0;
+    virtual int available (void) = 0;
+    virtual int read (void) = 0;
+    virtual int read (uint8_t* buf, size_t n) = 0;
+    virtual int peek (void) = 0;
+    virtual void flush (void) = 0;
+    virtual void stop (void) = 0;
+    virtual uint8_t connected (void) = 0;
+    virtual operator bool () = 0;
+};
+
+#endif  // _FAKE_CLIENT_H_
@@ -0,0 +1,42 @@
+/************************************************************
+ * Host Stand-In of the EEPROM Library (env:native)
+ ************************************************************
+ * The EEPROM is the Array fakeEeprom (erased: 0xff), shared
+ * with avr/eeprom.h. Each changed Byte is counted in
+ * fakeEepromWrites.
+ ************************************************************/
+#ifndef _FAKE_EEPROM_H_
+#define _FAKE_EEPROM_H_
+
+#include <Arduino.h>
+
+#define E2END               0x3FF     // last Address (ATmega328P: 1 KByte)
+
+extern uint8_t  fakeEeprom[E2END + 1];
+extern uint32_t fakeEepromWrites;       //!< Bytes written (changed)
+extern boolean  fakeEepromBusy;         //!< eeprom_is_ready() returns false
+
+inline void fakeEepromErase (void) {
+  memset(fakeEeprom, 0xff, sizeof(fakeEeprom));
+  fakeEepromWrites = 0;
+  fakeEepromBusy = false;
+}
+
+inline void fakeEepromWrite (uint16_t adr, uint8_t val) {
+  if (fakeEeprom[adr & E2END] != val) {
+    fakeEeprom[adr & E2END] = val;
+    fakeEepromWrites++;
+  }
+}
+
+class EEPROMClass {
+    public:
+    uint8_t read (int idx) { return (fakeEeprom[idx & E2END]); }
+    void write (int idx, uint8_t val) { fakeEepromWrite(idx, val); }
+    void update (int idx, uint8_t val) { fakeEepromWrite(idx, val); }
+    uint16_t length (void) { return (E2END + 1); }
+};
+
+static EEPROMClass EEPROM __attribute__ ((unused));
+
+#endif  // _FAKE_EEPROM_H_
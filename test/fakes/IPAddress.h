@@ -0,0 +1,23 @@
+/************************************************************
+ * Host Stand-In of IPAddress (env:native)
+ ************************************************************/
+#ifndef _FAKE_IPADDRESS_H_
+#define _FAKE_IPADDRESS_H_
+
+#include <Arduino.h>
+
+class IPAddress {
+    public:
+    IPAddress (void) { _adr = 0; }
+    IPAddress (uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+      _adr = ((uint32_t)a << 24) | ((uint32_t)b << 16) | ((uint32_t)c << 8) | d;
+    }
+    uint8_t operator[] (int i) const { return ((_adr >> (8 * (3 - i))) & 0xff); }
+    bool operator== (const IPAddress& ip) const { return (_adr == ip._adr); }
+    bool operator!= (const IPAddress& ip) const { return (_adr != ip._adr); }
+
+    private:
+    uint32_t _adr;                    //!< MSB: first Octet
+};
+
+#endif  // _FAKE_IPADDRESS_H_
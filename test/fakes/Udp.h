@@ -0,0 +1,28 @@
+/************************************************************
+ * Host Stand-In of the Arduino UDP Interface (env:native)
+ * (Interface of Udp.h, implemented by fakeUdp in fakeNet.h)
+ ************************************************************/
+#ifndef _FAKE_UDP_H_
+#define _FAKE_UDP_H_
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+class UDP : public Stream {
+    public:
+    virtual uint8_t begin (uint16_t port) = 0;
+    virtual uint8_t beginMulticast (IPAddress group, uint16_t port) { (void)group; (void)port; return (0); }
+    virtual void stop (void) = 0;
+    virtual int beginPacket (IPAddress ip, uint16_t port) = 0;
+    virtual int endPacket (void) = 0;
+    virtual size_t write (uint8_t c) = 0;
+    virtual size_t write (const uint8_t* buf, size_t n) = 0;
+    virtual int parsePacket (void) = 0;
+    virtual int available (void) = 0;
+    virtual int read (void) = 0;
+    virtual int read (uint8_t* buf, size_t n) = 0;
+    virtual int peek (void) = 0;
+    virtual void flush (void) = 0;
+};
+
+#endif  // _FAKE_UDP_H_
@@ -0,0 +1,176 @@
+/************************************************************
+ * Host Stand-In of the Wire Library (env:native)
+ ************************************************************
+ * The Bus holds FAKE_WIRE_CHIPS MCP23017 (Address 0x20 +
+ * n), each with its Registers (IOCON.BANK = 0, sequential
+ * Operation: the Register Pointer is incremented):
+ * - a Write sets the Pointer and writes the following
+ *   Bytes, GPIO is written to OLAT
+ * - a Read returns the Registers from the Pointer on, GPIO
+ *   and INTCAP return OLAT for Outputs and pins for Inputs
+ * Faults: present = false (NACK of the Address), fail: the
+ * next n Transfers time out. Each Transfer to a Chip is
+ * counted (writes, reads), the Bytes on the Wire of all
+ * Transfers in bytes (Address and Data, no Start/Stop/ACK).
+ ************************************************************/
+#ifndef _FAKE_WIRE_H_
+#define _FAKE_WIRE_H_
+
+#include <Arduino.h>
+
+#define WIRE_HAS_TIMEOUT      1
+#define FAKE_WIRE_CHIPS       8
+#define FAKE_WIRE_REGS       22     // MCP23017 Registers
+#define FAKE_WIRE_BUF        32     // Wire Buffer
+#define FAKE_WIRE_IODIRA   0x00
+#define FAKE_WIRE_INTCAPA  0x10
+#define FAKE_WIRE_GPIOA    0x12
+#define FAKE_WIRE_OLATA    0x14
+
+/********************************************************
+ * One MCP23017 on the Bus
+ ********************************************************/
+typedef struct {
+  boolean  present;                   //!< answers its Address
+  uint8_t  regs[FAKE_WIRE_REGS];      //!< Registers
+  uint8_t  pointer;                   //!< Register Pointer
+  uint16_t pins;                      //!< Level of the Input Pins (B: high Byte)
+  uint32_t writes;                    //!< Write Transfers
+  uint32_t reads;                     //!< Read Transfers
+} fakeChip;
+
+class TwoWire {
+    public:
+    void begin (void) { active = true; }
+    void end (void) { active = false; }
+    void setClock (uint32_t hz) { clock = hz; }
+    void setWireTimeout (uint32_t us, boolean reset) { (void)us; (void)reset; }
+
+    void beginTransmission (uint8_t adr) {
+      _adr = adr;
+      _txLen = 0;
+    }
+    void beginTransmission (int adr) { beginTransmission((uint8_t)adr); }
+
+    size_t write (uint8_t c) {
+      if (_txLen >= FAKE_WIRE_BUF) {
+        return (0);
+      }
+      _tx[_txLen++] = c;
+      return (1);
+    }
+    size_t write (const uint8_t* buf, size_t n) {
+      size_t i;
+      for (i = 0; i < n; i++) {
+        write(buf[i]);
+      }
+      return (n);
+    }
+
+    // @returns 0: ok, 2: NACK Address, 5: Timeout
+    uint8_t endTransmission (boolean stop = true) {
+      fakeChip* c;
+      uint8_t i;
+      (void)stop;
+      if (!active || fail) {
+        if (fail) {
+          fail--;
+        }
+        return (5);
+      }
+      c = chip(_adr);
+      if (c == NULL) {
+        return (2);
+      }
+      bytes += 1 + _txLen;
+      if (_txLen > 0) {
+        c->pointer = _tx[0] % FAKE_WIRE_REGS;
+      }
+      if (_txLen > 1) {
+        c->writes++;
+      }
+      for (i = 1; i < _txLen; i++) {
+        if ((c->pointer & ~1) == FAKE_WIRE_GPIOA) {
+          c->regs[c->pointer + 2] = _tx[i];
+        } else if ((c->pointer & ~1) != FAKE_WIRE_INTCAPA) {
+          c->regs[c->pointer] = _tx[i];
+        }
+        c->pointer = (c->pointer + 1) % FAKE_WIRE_REGS;
+      }
+      return (0);
+    }
+
+    // @returns Bytes received
+    uint8_t requestFrom (int adr, int n) {
+      fakeChip* c;
+      uint8_t port;
+      _rxLen = 0;
+      _rxPos = 0;
+      if (!active || fail) {
+        if (fail) {
+          fail--;
+        }
+        return (0);
+      }
+      c = chip((uint8_t)adr);
+      if (c == NULL) {
+        return (0);
+      }
+      c->reads++;
+      for (; (n > 0) && (_rxLen < FAKE_WIRE_BUF); n--) {
+        port = c->pointer & 1;
+        if (((c->pointer & ~1) == FAKE_WIRE_GPIOA) || ((c->pointer & ~1) == FAKE_WIRE_INTCAPA)) {
+          _rx[_rxLen++] = (c->regs[FAKE_WIRE_OLATA + port] & ~c->regs[FAKE_WIRE_IODIRA + port]) |
+                          ((c->pins >> (8 * port)) & c->regs[FAKE_WIRE_IODIRA + port]);
+        } else {
+          _rx[_rxLen++] = c->regs[c->pointer];
+        }
+        c->pointer = (c->pointer + 1) % FAKE_WIRE_REGS;
+      }
+      bytes += 1 + _rxLen;
+      return (_rxLen);
+    }
+    uint8_t requestFrom (uint8_t adr, uint8_t n) { return (requestFrom((int)adr, (int)n)); }
+
+    int available (void) { return (_rxLen - _rxPos); }
+    int read (void) { return ((_rxPos < _rxLen) ? _rx[_rxPos++] : -1); }
+
+    // Chip at the Address, NULL if none answers
+    fakeChip* chip (uint8_t adr) {
+      if ((adr < 0x20) || (adr >= 0x20 + FAKE_WIRE_CHIPS) || !chips[adr - 0x20].present) {
+        return (NULL);
+      }
+      return (&chips[adr - 0x20]);
+    }
+
+    // all Chips present with Power-On Registers
+    void reset (void) {
+      uint8_t i;
+      memset(chips, 0, sizeof(chips));
+      for (i = 0; i < FAKE_WIRE_CHIPS; i++) {
+        chips[i].present = true;
+        chips[i].regs[FAKE_WIRE_IODIRA] = 0xff;
+        chips[i].regs[FAKE_WIRE_IODIRA + 1] = 0xff;
+      }
+      fail = 0;
+      bytes = 0;
+    }
+
+    fakeChip chips[FAKE_WIRE_CHIPS];  //!< Chips 0x20 ... 0x27
+    uint8_t  fail;                    //!< next Transfers to time out
+    boolean  active;                  //!< between begin() and end()
+    uint32_t clock;                   //!< [Hz]
+    uint32_t bytes;                   //!< Bytes on the Wire
+
+    private:
+    uint8_t  _adr;
+    uint8_t  _tx[FAKE_WIRE_BUF];
+    uint8_t  _txLen;
+    uint8_t  _rx[FAKE_WIRE_BUF];
+    uint8_t  _rxLen;
+    uint8_t  _rxPos;
+};
+
+extern TwoWire Wire;
+
+#endif  // _FAKE_WIRE_H_
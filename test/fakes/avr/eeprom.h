@@ -0,0 +1,69 @@
+/************************************************************
+ * Host Stand-In of avr/eeprom.h (env:native)
+ ************************************************************
+ * Addresses are Pointers into the EEPROM (as on the AVR),
+ * the Data is kept in fakeEeprom (see EEPROM.h).
+ * Multi-Byte Values are Little Endian.
+ ************************************************************/
+#ifndef _FAKE_AVR_EEPROM_H_
+#define _FAKE_AVR_EEPROM_H_
+
+#include <EEPROM.h>
+
+#define FAKE_EE_ADR(p)        ((uint16_t)(uintptr_t)(p))
+
+inline boolean eeprom_is_ready (void) {
+  return (!fakeEepromBusy);
+}
+
+inline void eeprom_read_block (void* dst, const void* src, size_t n) {
+  size_t i;
+  for (i = 0; i < n; i++) {
+    ((uint8_t*)dst)[i] = fakeEeprom[(FAKE_EE_ADR(src) + i) & E2END];
+  }
+}
+
+inline void eeprom_update_block (const void* src, void* dst, size_t n) {
+  size_t i;
+  for (i = 0; i < n; i++) {
+    fakeEepromWrite(FAKE_EE_ADR(dst) + i, ((const uint8_t*)src)[i]);
+  }
+}
+
+inline void eeprom_write_block (const void* src, void* dst, size_t n) {
+  eeprom_update_block(src, dst, n);
+}
+
+inline uint8_t eeprom_read_byte (const uint8_t* p) {
+  return (fakeEeprom[FAKE_EE_ADR(p) & E2END]);
+}
+
+inline void eeprom_update_byte (uint8_t* p, uint8_t val) {
+  fakeEepromWrite(FAKE_EE_ADR(p), val);
+}
+
+inline void eeprom_write_byte (uint8_t* p, uint8_t val) {
+  fakeEepromWrite(FAKE_EE_ADR(p), val);
+}
+
+inline uint16_t eeprom_read_word (const uint16_t* p) {
+  uint16_t val;
+  eeprom_read_block(&val, p, sizeof(val));
+  return (val);
+}
+
+inline void eeprom_update_word (uint16_t* p, uint16_t val) {
+  eeprom_update_block(&val, p, sizeof(val));
+}
+
+inline uint32_t eeprom_read_dword (const uint32_t* p) {
+  uint32_t val;
+  eeprom_read_block(&val, p, sizeof(val));
+  return (val);
+}
+
+inline void eeprom_update_dword (uint32_t* p, uint32_t val) {
+  eeprom_update_block(&val, p, sizeof(val));
+}
+
+#endif  // _FAKE_AVR_EEPROM_H_
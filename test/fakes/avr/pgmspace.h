@@ -0,0 +1,10 @@
+/************************************************************
+ * Host Stand-In of avr/pgmspace.h (env:native)
+ * Flash is plain Memory, see Arduino.h
+ ************************************************************/
+#ifndef _FAKE_AVR_PGMSPACE_H_
+#define _FAKE_AVR_PGMSPACE_H_
+
+#include <Arduino.h>
+
+#endif  // _FAKE_AVR_PGMSPACE_H_
@@ -0,0 +1,65 @@
+/************************************************************
+ * Objects of the Host Stand-Ins (env:native)
+ ************************************************************
+ * Included once by each Test (test_main.cpp), defines the
+ * Clock, Pins, EEPROM, Serial and Wire of Arduino.h,
+ * EEPROM.h and Wire.h.
+ * fakeReset() before each Test: Clock 0, Pins high, EEPROM
+ * erased, Serial empty, all MCP23017 present (Power-On).
+ ************************************************************/
+#ifndef _FAKE_MAIN_H_
+#define _FAKE_MAIN_H_
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <Wire.h>
+#include <chrono>
+
+uint32_t fakeMillis;
+uint32_t fakeMicros;
+boolean  fakeRealTime;
+uint8_t  fakePinLevel[FAKE_PINS];
+uint8_t  fakeSdaHeld;
+uint8_t  fakeEeprom[E2END + 1];
+uint32_t fakeEepromWrites;
+boolean  fakeEepromBusy;
+HardwareSerial Serial;
+TwoWire Wire;
+
+/************************************************************
+ * fakeHostMicros
+ * @returns Time of the Host since the first Call [us]
+ ************************************************************/
+static uint64_t fakeHostMicros (void) {
+  static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  return (std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+uint32_t millis (void) {
+  return (fakeRealTime ? (uint32_t)(fakeHostMicros() / 1000) : fakeMillis);
+}
+
+uint32_t micros (void) {
+  return (fakeRealTime ? (uint32_t)fakeHostMicros() : fakeMicros);
+}
+
+/************************************************************
+ * fakeReset
+ * Start of a Test: Power-On State of all Stand-Ins
+ ************************************************************/
+inline void fakeReset (void) {
+  fakeMillis = 0;
+  fakeMicros = 0;
+  fakeRealTime = false;
+  memset(fakePinLevel, HIGH, sizeof(fakePinLevel));
+  fakeSdaHeld = 0;
+  fakeEepromErase();
+  Serial.out.clear();
+  Serial.in.clear();
+  Serial.inPos = 0;
+  Serial.echo = false;
+  Wire.reset();
+  Wire.begin();
+}
+
+#endif  // _FAKE_MAIN_H_
@@ -0,0 +1,191 @@
+/************************************************************
+ * Host Stand-Ins of the W5500 Sockets (env:native)
+ ************************************************************
+ * - fakeUdp: UDP Socket on an in-memory Network. A Packet
+ *   sent to a Group is queued at each Socket joined to the
+ *   Group and Port (the Sender too, as Multicast Loopback).
+ *   drop: the next n Packets sent are lost.
+ * - fakeClient: TCP Connection of a Server. The Request is
+ *   read from in, the Response is collected in out, each
+ *   Socket Write is counted. Waiting for more Data of an
+ *   open Connection takes 1ms of the simulated Clock.
+ ************************************************************/
+#ifndef _FAKE_NET_H_
+#define _FAKE_NET_H_
+
+#include <Arduino.h>
+#include <Udp.h>
+#include <Client.h>
+#include <deque>
+#include <vector>
+
+class fakeUdp : public UDP {
+    public:
+    fakeUdp (void) {
+      _joined = false;
+      _pos = 0;
+      drop = 0;
+      sent = 0;
+    }
+    virtual ~fakeUdp () { stop(); }
+
+    virtual uint8_t begin (uint16_t port) {
+      return (beginMulticast(IPAddress(), port));
+    }
+    virtual uint8_t beginMulticast (IPAddress group, uint16_t port) {
+      stop();
+      _group = group;
+      _port = port;
+      _joined = true;
+      sockets().push_back(this);
+      return (1);
+    }
+    virtual void stop (void) {
+      std::vector<fakeUdp*>& s = sockets();
+      size_t i;
+      for (i = 0; i < s.size(); i++) {
+        if (s[i] == this) {
+          s.erase(s.begin() + i);
+          break;
+        }
+      }
+      _joined = false;
+      _queue.clear();
+    }
+
+    virtual int beginPacket (IPAddress ip, uint16_t port) {
+      _txGroup = ip;
+      _txPort = port;
+      _tx.clear();
+      return (1);
+    }
+    virtual size_t write (uint8_t c) {
+      _tx += (char)c;
+      return (1);
+    }
+    virtual size_t write (const uint8_t* buf, size_t n) {
+      _tx.append((const char*)buf, n);
+      return (n);
+    }
+    virtual int endPacket (void) {
+      std::vector<fakeUdp*>& s = sockets();
+      size_t i;
+      sent++;
+      if (drop) {
+        drop--;
+        return (1);
+      }
+      for (i = 0; i < s.size(); i++) {
+        if ((s[i]->_group == _txGroup) && (s[i]->_port == _txPort)) {
+          s[i]->_queue.push_back(_tx);
+        }
+      }
+      return (1);
+    }
+
+    // @returns Size of the next Packet, 0 if none
+    virtual int parsePacket (void) {
+      if (_queue.empty()) {
+        _rx.clear();
+        return (0);
+      }
+      _rx = _queue.front();
+      _queue.pop_front();
+      _pos = 0;
+      return ((int)_rx.size());
+    }
+    virtual int available (void) { return ((int)(_rx.size() - _pos)); }
+    virtual int read (void) { return ((_pos < _rx.size()) ? (uint8_t)_rx[_pos++] : -1); }
+    virtual int read (uint8_t* buf, size_t n) {
+      size_t i;
+      for (i = 0; (i < n) && (_pos < _rx.size()); i++) {
+        buf[i] = (uint8_t)_rx[_pos++];
+      }
+      return ((int)i);
+    }
+    virtual int peek (void) { return ((_pos < _rx.size()) ? (uint8_t)_rx[_pos] : -1); }
+    virtual void flush (void) { _pos = _rx.size(); }
+
+    // send a Packet from outside the Bus (e.g. a foreign Frame)
+    void inject (const uint8_t* buf, size_t n) {
+      _queue.push_back(std::string((const char*)buf, n));
+    }
+
+    uint8_t  drop;                    //!< next Packets sent are lost
+    uint32_t sent;                    //!< Packets sent
+
+    private:
+    static std::vector<fakeUdp*>& sockets (void) {
+      static std::vector<fakeUdp*> s;
+      return (s);
+    }
+    boolean     _joined;
+    IPAddress   _group;
+    uint16_t    _port;
+    IPAddress   _txGroup;
+    uint16_t    _txPort;
+    std::string _tx;                  //!< Packet being sent
+    std::string _rx;                  //!< Packet being read
+    size_t      _pos;                 //!< next Byte of _rx
+    std::deque<std::string> _queue;   //!< received Packets
+};
+
+class fakeClient : public Client {
+    public:
+    fakeClient (void) { open(""); }
+
+    // new Connection with the Request
+    void open (const std::string& request) {
+      in = request;
+      out.clear();
+      writes = 0;
+      _pos = 0;
+      _open = true;
+    }
+
+    virtual int connect (IPAddress ip, uint16_t port) { (void)ip; (void)port; return (0); }
+    virtual int connect (const char* host, uint16_t port) { (void)host; (void)port; return (0); }
+    virtual size_t write (uint8_t c) {
+      return (write(&c, 1));
+    }
+    virtual size_t write (const uint8_t* buf, size_t n) {
+      if (!_open) {
+        return (0);
+      }
+      out.append((const char*)buf, n);
+      writes++;
+      return (n);
+    }
+    virtual int available (void) {
+      if (!_open) {
+        return (0);
+      }
+      if (_pos >= in.size()) {
+        fakeAdvance(1);
+      }
+      return ((int)(in.size() - _pos));
+    }
+    virtual int read (void) { return ((_open && (_pos < in.size())) ? (uint8_t)in[_pos++] : -1); }
+    virtual int read (uint8_t* buf, size_t n) {
+      size_t i;
+      for (i = 0; (i < n) && _open && (_pos < in.size()); i++) {
+        buf[i] = (uint8_t)in[_pos++];
+      }
+      return (i ? (int)i : -1);
+    }
+    virtual int peek (void) { return ((_open && (_pos < in.size())) ? (uint8_t)in[_pos] : -1); }
+    virtual void flush (void) {}
+    virtual void stop (void) { _open = false; }
+    virtual uint8_t connected (void) { return (_open); }
+    virtual operator bool () { return (_open); }
+
+    std::string in;                   //!< Request
+    std::string out;                  //!< Response
+    uint32_t    writes;               //!< Socket Writes
+
+    private:
+    size_t  _pos;                     //!< next Byte of in
+    boolean _open;                    //!< not stopped by the Server
+};
+
+#endif  // _FAKE_NET_H_
@@ -0,0 +1,195 @@
+/************************************************************
+ * Unit Tests of the Event Bus (env:native)
+ ************************************************************
+ * Three Nodes on the in-memory Multicast Network of the
+ * UDP Stand-In (fakeUdp): Delivery of Output Frames, Drop
+ * of Duplicates and of invalid Frames, lost Packets and
+ * the Restart of a Node (new Epoch).
+ ************************************************************/
+#include <unity.h>
+#include <fakeMain.h>
+#include <fakeNet.h>
+#include <eventBus.h>
+
+#define TEST_GROUP            239, 0, 0, 57
+#define TEST_NODES            3         // Nodes 1 ... 3
+
+// Outputs switched by the Handler of each Node
+typedef struct {
+  uint8_t  calls;                     //!< Calls of the Handler
+  uint32_t on;                        //!< Masks of the last Call
+  uint32_t off;
+  uint32_t toggle;
+} testOutputs;
+
+fakeUdp sock[TEST_NODES];
+eventBus bus[TEST_NODES];
+testOutputs g_out[TEST_NODES];
+
+/************************************************************
+ * switchOutputs
+ * Keep the Masks of an Output Frame of a Node
+ ************************************************************/
+static void switchOutputs (uint8_t n, uint32_t on, uint32_t off, uint32_t toggle) {
+  g_out[n].calls++;
+  g_out[n].on = on;
+  g_out[n].off = off;
+  g_out[n].toggle = toggle;
+}
+
+static void outputs1 (uint32_t on, uint32_t off, uint32_t toggle) { switchOutputs(0, on, off, toggle); }
+static void outputs2 (uint32_t on, uint32_t off, uint32_t toggle) { switchOutputs(1, on, off, toggle); }
+static void outputs3 (uint32_t on, uint32_t off, uint32_t toggle) { switchOutputs(2, on, off, toggle); }
+
+static const busHandler handlers[TEST_NODES] = {outputs1, outputs2, outputs3};
+
+/************************************************************
+ * start
+ * (Re-)Start a Node
+ * @param[in] node  Node (1 ... TEST_NODES)
+ * @param[in] epoch Epoch of this Start
+ ************************************************************/
+static void start (uint8_t node, uint8_t epoch) {
+  sock[node - 1].beginMulticast(IPAddress(TEST_GROUP), BUS_PORT);
+  bus[node - 1].begin(sock[node - 1], IPAddress(TEST_GROUP), node, epoch, handlers[node - 1]);
+}
+
+/************************************************************
+ * pollAll
+ * Main Loop of all Nodes
+ ************************************************************/
+static void pollAll (void) {
+  uint8_t i;
+  fakeAdvance(1);
+  for (i = 0; i < TEST_NODES; i++) {
+    bus[i].poll();
+  }
+}
+
+/************************************************************
+ * state
+ * @param[in] node Node (1 ... TEST_NODES)
+ * @returns Output of printState()
+ ************************************************************/
+static std::string state (uint8_t node) {
+  Serial.out.clear();
+  bus[node - 1].printState();
+  return (Serial.out);
+}
+
+void setUp (void) {
+  uint8_t i;
+  fakeReset();
+  fakeAdvance(100000);
+  memset(g_out, 0, sizeof(g_out));
+  for (i = 0; i < TEST_NODES; i++) {
+    start(i + 1, 1);
+    sock[i].drop = 0;
+    sock[i].sent = 0;
+  }
+}
+
+void tearDown (void) {
+}
+
+void test_outputs_to_one_node (void) {
+  bus[0].sendOutputs(2, 0x01, 0x02, 0x80000000UL);
+  pollAll();
+  TEST_ASSERT_EQUAL(BUS_REPEAT, sock[0].sent);
+  TEST_ASSERT_EQUAL(1, g_out[1].calls);
+  TEST_ASSERT_EQUAL_HEX32(0x01, g_out[1].on);
+  TEST_ASSERT_EQUAL_HEX32(0x02, g_out[1].off);
+  TEST_ASSERT_EQUAL_HEX32(0x80000000UL, g_out[1].toggle);
+  // not the Target, own Frame
+  TEST_ASSERT_EQUAL(0, g_out[2].calls);
+  TEST_ASSERT_EQUAL(0, g_out[0].calls);
+  TEST_ASSERT_TRUE(state(2).find("RX 1 - Dup 1 - Bad 0") != std::string::npos);
+}
+
+void test_outputs_to_all_nodes (void) {
+  bus[2].sendOutputs(BUS_ALL, 0x10, 0, 0);
+  pollAll();
+  TEST_ASSERT_EQUAL(1, g_out[0].calls);
+  TEST_ASSERT_EQUAL(1, g_out[1].calls);
+  TEST_ASSERT_EQUAL(0, g_out[2].calls);
+}
+
+void test_lost_copy (void) {
+  // first Copy lost, the Repeat gets through
+  sock[0].drop = 1;
+  bus[0].sendOutputs(2, 0x01, 0, 0);
+  pollAll();
+  TEST_ASSERT_EQUAL(1, g_out[1].calls);
+  TEST_ASSERT_TRUE(state(2).find("Dup 0") != std::string::npos);
+}
+
+void test_late_frame_is_dropped (void) {
+  // Seq 1 of Node 1, Epoch 1
+  const uint8_t old[BUS_OUTPUTS_LEN] = {BUS_MAGIC, (BUS_VERSION << 4) | BUS_TYPE_OUTPUTS, 1, 1, 0, 1,
+                                        2, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0};
+  uint8_t i;
+  for (i = 0; i < 3; i++) {
+    bus[0].sendOutputs(2, 0x01, 0, 0);
+    pollAll();
+  }
+  TEST_ASSERT_EQUAL(3, g_out[1].calls);
+  // Replay of an older Frame (same Epoch, old Seq)
+  sock[1].inject(old, sizeof(old));
+  pollAll();
+  TEST_ASSERT_EQUAL(3, g_out[1].calls);
+}
+
+void test_quick_reboot_is_accepted (void) {
+  uint8_t i;
+  for (i = 0; i < 5; i++) {
+    bus[0].sendOutputs(2, 0x01, 0, 0);
+    pollAll();
+  }
+  // Node 1 restarts within the Peer Timeout: Seq 0 again, new Epoch
+  start(1, 2);
+  bus[0].sendOutputs(2, 0x04, 0, 0);
+  pollAll();
+  TEST_ASSERT_EQUAL(6, g_out[1].calls);
+  TEST_ASSERT_EQUAL_HEX32(0x04, g_out[1].on);
+}
+
+void test_bad_frames (void) {
+  const uint8_t magic[BUS_STATE_LEN] = {0x00, (BUS_VERSION << 4) | BUS_TYPE_STATE, 1, 1, 0, 9};
+  const uint8_t version[BUS_STATE_LEN] = {BUS_MAGIC, (1 << 4) | BUS_TYPE_STATE, 1, 1, 0, 9};
+  const uint8_t length[BUS_STATE_LEN - 1] = {BUS_MAGIC, (BUS_VERSION << 4) | BUS_TYPE_STATE, 1, 1, 0, 9};
+  const uint8_t node[BUS_STATE_LEN] = {BUS_MAGIC, (BUS_VERSION << 4) | BUS_TYPE_STATE, BUS_ALL, 1, 0, 9};
+  uint8_t big[BUS_FRAME_MAX + 1] = {BUS_MAGIC, (BUS_VERSION << 4) | BUS_TYPE_OUTPUTS, 1, 1, 0, 9, 2};
+  sock[1].inject(magic, sizeof(magic));
+  sock[1].inject(version, sizeof(version));
+  sock[1].inject(length, sizeof(length));
+  sock[1].inject(node, sizeof(node));
+  sock[1].inject(big, sizeof(big));
+  pollAll();
+  pollAll();
+  TEST_ASSERT_EQUAL(0, g_out[1].calls);
+  TEST_ASSERT_TRUE(state(2).find("RX 0 - Dup 0 - Bad 5") != std::string::npos);
+}
+
+void test_state_frames (void) {
+  bus[0].update(0x8001, 0x3);
+  pollAll();
+  TEST_ASSERT_TRUE(state(2).find(" - Node 1: Out 0x8001 In 0x3 - 0ms ago") != std::string::npos);
+  // no Change: no Frame until BUS_STATE_INTERVAL
+  bus[0].update(0x8001, 0x3);
+  TEST_ASSERT_EQUAL(1, sock[0].sent);
+  fakeAdvance(BUS_STATE_INTERVAL);
+  bus[0].update(0x8001, 0x3);
+  TEST_ASSERT_EQUAL(2, sock[0].sent);
+}
+
+int main (void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_outputs_to_one_node);
+  RUN_TEST(test_outputs_to_all_nodes);
+  RUN_TEST(test_lost_copy);
+  RUN_TEST(test_late_frame_is_dropped);
+  RUN_TEST(test_quick_reboot_is_accepted);
+  RUN_TEST(test_bad_frames);
+  RUN_TEST(test_state_frames);
+  return (UNITY_END());
+}
@@ -0,0 +1,211 @@
+/************************************************************
+ * Unit Tests of the Button Scan Scheduling (env:native)
+ ************************************************************
+ * The Scanner of scanButtons() (main.cpp) is rebuilt on the
+ * Stand-Ins: an Edge on an Input raises the IRQ and is read
+ * at once, without IRQ the Inputs are read only when
+ * nextScan() asks for it. The Reads are counted by the Wire
+ * Stand-In (one readGPIOAB() per Input Chip and Scan).
+ * Input in_S11 is a Standard Input (Class 0: T0 20ms,
+ * T1 1s, T2 200ms) without Hold Events and Chords.
+ ************************************************************/
+#include <unity.h>
+#include <fakeMain.h>
+#include <mcp23017_DC.h>
+#include <buttons.h>
+
+#define TEST_PIN         in_S11     // Input under Test
+#define TEST_CLICKS           4     // recorded Clicks
+
+config myconfig;
+timerWheel mytimers;
+buttons mybuttons;
+mcp23017 mcp[2];
+uint8_t  g_clickType[TEST_CLICKS];  //!< recorded Clicks
+uint8_t  g_clickPin[TEST_CLICKS];
+uint8_t  g_clicks;                  //!< Number of Clicks
+boolean  g_irq;                     //!< Edge since the last Scan
+uint32_t g_edgeTime;                //!< Time of the first Edge [ms]
+uint32_t g_lastScanTime;            //!< Time of the last Scan [ms]
+uint16_t g_scanWait;                //!< nextScan() of the last Scan
+
+/************************************************************
+ * click
+ * Click Handler: record the Click
+ ************************************************************/
+static void click (uint8_t clickType, uint8_t inPin, uint16_t duration) {
+  (void)duration;
+  if (g_clicks < TEST_CLICKS) {
+    g_clickType[g_clicks] = clickType;
+    g_clickPin[g_clicks] = inPin;
+  }
+  g_clicks++;
+}
+
+/************************************************************
+ * scan
+ * Read both Input Chips, feed the State Machine
+ * (as scanButtons())
+ ************************************************************/
+static void scan (uint32_t edgeTime) {
+  uint16_t in0;
+  uint16_t in1;
+  g_lastScanTime = millis();
+  mcp[0].readGPIOAB(in0);
+  mcp[1].readGPIOAB(in1);
+  mybuttons.update((uint32_t)in0 + ((uint32_t)in1 << 16), (uint16_t)edgeTime);
+  g_scanWait = mybuttons.nextScan((uint16_t)g_lastScanTime);
+}
+
+/************************************************************
+ * run
+ * Main Loop for some Time: scan on IRQ or when due
+ * @param[in] ms Duration
+ ************************************************************/
+static void run (uint32_t ms) {
+  for (; ms; ms--) {
+    fakeAdvance(1);
+    mytimers.tick();
+    if (g_irq) {
+      g_irq = false;
+      scan(g_edgeTime);
+    } else if ((g_scanWait != BUTTON_NO_SCAN) && (millis() - g_lastScanTime >= g_scanWait)) {
+      scan(millis());
+    }
+  }
+}
+
+/************************************************************
+ * input
+ * Edge on the Input under Test (raises the IRQ)
+ * @param[in] pressed new Level
+ ************************************************************/
+static void input (boolean pressed) {
+  fakeChip* c = &Wire.chips[TEST_PIN / 16];
+  if (pressed) {
+    c->pins |= (1 << (TEST_PIN % 16));
+  } else {
+    c->pins &= ~(1 << (TEST_PIN % 16));
+  }
+  if (!g_irq) {
+    g_edgeTime = millis();
+  }
+  g_irq = true;
+}
+
+/************************************************************
+ * bounce
+ * Contact Bounce: n Pulses of 1ms, then the stable Level
+ * @param[in] pressed stable Level
+ * @param[in] n       Pulses
+ ************************************************************/
+static void bounce (boolean pressed, uint8_t n) {
+  for (; n; n--) {
+    input(pressed);
+    run(1);
+    input(!pressed);
+    run(1);
+  }
+  input(pressed);
+}
+
+/************************************************************
+ * reads
+ * @returns Reads of each Input Chip since setUp()
+ ************************************************************/
+static uint32_t reads (void) {
+  TEST_ASSERT_EQUAL_UINT32(Wire.chips[0].reads, Wire.chips[1].reads);
+  return (Wire.chips[0].reads);
+}
+
+void setUp (void) {
+  uint8_t cls;
+  boolean invert;
+  boolean pullup;
+  boolean hold;
+  fakeReset();
+  fakeAdvance(100000);
+  myconfig.resetToFactoryDefaults();
+  myconfig.begin();
+  myconfig.getInputFromEEprom(TEST_PIN, cls, invert, pullup, hold);
+  TEST_ASSERT_EQUAL(BUTTON_CLASS_STANDARD, cls);
+  TEST_ASSERT_FALSE(hold);
+  mytimers.begin();
+  mcp[0].begin(0, &Wire);
+  mcp[1].begin(1, &Wire);
+  mybuttons.begin(myconfig, mytimers, click);
+  g_clicks = 0;
+  g_irq = false;
+  g_lastScanTime = millis();
+  g_scanWait = BUTTON_NO_SCAN;
+  Wire.chips[0].reads = 0;
+  Wire.chips[1].reads = 0;
+}
+
+void tearDown (void) {
+}
+
+void test_no_reads_while_idle (void) {
+  run(10000);
+  TEST_ASSERT_EQUAL_UINT32(0, reads());
+  TEST_ASSERT_EQUAL(0, g_clicks);
+}
+
+void test_bounced_click (void) {
+  bounce(true, 3);
+  run(120);
+  bounce(false, 2);
+  run(1000);
+  TEST_ASSERT_EQUAL(1, g_clicks);
+  TEST_ASSERT_EQUAL(BUTTON_CLICK, g_clickType[0]);
+  TEST_ASSERT_EQUAL(TEST_PIN, g_clickPin[0]);
+  // Press: 7 Edges + 2 Scans within T0, Release: 5 Edges
+  // + 2 Scans within T0 + End of the Double-Click Window
+  TEST_ASSERT_EQUAL_UINT32(17, reads());
+  // idle again
+  run(10000);
+  TEST_ASSERT_EQUAL_UINT32(17, reads());
+}
+
+void test_double_click (void) {
+  input(true);
+  run(80);
+  input(false);
+  run(100);
+  input(true);
+  run(80);
+  input(false);
+  run(1000);
+  TEST_ASSERT_EQUAL(1, g_clicks);
+  TEST_ASSERT_EQUAL(BUTTON_CLICK_DOUBLE, g_clickType[0]);
+  // 4 Edges + 2 Scans within T0 of the first three, the
+  // second Release decides the Double-Click
+  TEST_ASSERT_EQUAL_UINT32(10, reads());
+}
+
+void test_long_click (void) {
+  uint32_t n;
+  input(true);
+  run(BUTTON_T1 + 100);
+  TEST_ASSERT_EQUAL(1, g_clicks);
+  TEST_ASSERT_EQUAL(BUTTON_CLICK_LONG, g_clickType[0]);
+  // Edge + 2 Scans within T0 + Long-Click Boundary
+  n = reads();
+  TEST_ASSERT_EQUAL_UINT32(4, n);
+  // held: no Reads until the Release
+  run(10000);
+  TEST_ASSERT_EQUAL_UINT32(n, reads());
+  input(false);
+  run(1000);
+  TEST_ASSERT_EQUAL(1, g_clicks);
+  TEST_ASSERT_EQUAL_UINT32(n + 1, reads());
+}
+
+int main (void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_no_reads_while_idle);
+  RUN_TEST(test_bounced_click);
+  RUN_TEST(test_double_click);
+  RUN_TEST(test_long_click);
+  return (UNITY_END());
+}
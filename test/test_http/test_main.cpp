@@ -0,0 +1,221 @@
+/************************************************************
+ * Unit Tests and Budget of the HTTP Server (env:native)
+ ************************************************************
+ * The Requests are read from the Socket Stand-In
+ * (fakeClient), the Response and the Number of Socket
+ * Writes are checked. Waiting for Data takes 1ms of the
+ * simulated Clock, so an incomplete Request times out.
+ * The Budget (HTTP_BUDGET per Request) is measured on the
+ * Clock of the Host.
+ ************************************************************/
+#include <unity.h>
+#include <fakeMain.h>
+#include <fakeNet.h>
+#include <httpServer.h>
+
+#define TEST_BUDGET_REQUESTS  1000     // Requests of the Budget Test
+
+config myconfig;
+httpServer myhttp;
+fakeClient client;
+int16_t g_cmd;                         //!< last Command, -1: none
+char g_time[32];                       //!< last Time, "": none
+
+/************************************************************
+ * httpValue
+ * Value Handler with fixed Values
+ ************************************************************/
+static void httpValue (uint8_t key, Print& out) {
+  switch (key) {
+    case HTTP_VAL_VERSION:
+      out.print(F("test"));
+      break;
+    case HTTP_VAL_UPTIME:
+      out.print(42);
+      break;
+    case HTTP_VAL_OUTPUTS:
+      out.print(0x61UL);
+      break;
+    case HTTP_VAL_ROLLERS:
+      out.print(F("0,100,255,255"));
+      break;
+    case HTTP_VAL_MINUTE:
+      out.print(-1);
+      break;
+    default:
+      out.print(0);
+      break;
+  }
+}
+
+/************************************************************
+ * httpCommand
+ * Command Handler, keeps the Command
+ ************************************************************/
+static void httpCommand (uint8_t cmdByte) {
+  g_cmd = cmdByte;
+}
+
+/************************************************************
+ * httpTime
+ * Time Handler, keeps the Time as Text
+ ************************************************************/
+static void httpTime (uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second) {
+  snprintf(g_time, sizeof(g_time), "%04u-%02u-%02u %02u:%02u:%02u", year, month, day, hour, minute, second);
+}
+
+/************************************************************
+ * request
+ * Handle one Request on a new Connection
+ * @param[in] text Request
+ * @returns Response
+ ************************************************************/
+static std::string request (const char* text) {
+  client.open(text);
+  myhttp.handle(client);
+  TEST_ASSERT_FALSE(client.connected());
+  return (client.out);
+}
+
+/************************************************************
+ * body
+ * @param[in] response Status Line, Header and Body
+ * @returns Body
+ ************************************************************/
+static std::string body (const std::string& response) {
+  size_t pos = response.find("\r\n\r\n");
+  return ((pos == std::string::npos) ? "" : response.substr(pos + 4));
+}
+
+void setUp (void) {
+  fakeReset();
+  myconfig.resetToFactoryDefaults();
+  myconfig.begin();
+  myhttp.begin(myconfig, httpValue, httpCommand, httpTime);
+  g_cmd = -1;
+  g_time[0] = 0;
+}
+
+void tearDown (void) {
+}
+
+void test_get_state (void) {
+  std::string r = request("GET /state HTTP/1.0\r\nHost: ha\r\n\r\n");
+  TEST_ASSERT_EQUAL(0, r.find("HTTP/1.0 200 OK\r\n"));
+  TEST_ASSERT_EQUAL_STRING("{\"fw\":\"test\",\"uptime\":42,\"out\":97,\"in\":0,\"rollers\":[0,100,255,255],\"minute\":-1}",
+                           body(r).c_str());
+  TEST_ASSERT_EQUAL(-1, g_cmd);
+}
+
+void test_root_is_state (void) {
+  TEST_ASSERT_EQUAL_STRING(body(request("GET /state HTTP/1.0\r\n\r\n")).c_str(),
+                           body(request("GET /?x=1 HTTP/1.0\r\n\r\n")).c_str());
+}
+
+void test_errors (void) {
+  TEST_ASSERT_EQUAL(0, request("GET /nothing HTTP/1.0\r\n\r\n").find("HTTP/1.0 404 Not Found\r\n"));
+  TEST_ASSERT_EQUAL(0, request("PUT /state HTTP/1.0\r\n\r\n").find("HTTP/1.0 405 "));
+  TEST_ASSERT_EQUAL(0, request("POST /state HTTP/1.0\r\n\r\n").find("HTTP/1.0 405 "));
+  TEST_ASSERT_EQUAL(0, request("GET /cmd HTTP/1.0\r\n\r\n").find("HTTP/1.0 405 "));
+  TEST_ASSERT_EQUAL_STRING("{\"error\":405}", body(client.out).c_str());
+  TEST_ASSERT_EQUAL(0, request("GARBAGE\r\n\r\n").find("HTTP/1.0 400 "));
+  Serial.out.clear();
+  myhttp.printState();
+  TEST_ASSERT_TRUE(Serial.out.find("5 Requests, 5 Errors") != std::string::npos);
+}
+
+void test_post_cmd (void) {
+  std::string r = request("POST /cmd HTTP/1.0\r\nContent-Length: 6\r\n\r\nc=0x61");
+  TEST_ASSERT_EQUAL(0, r.find("HTTP/1.0 200 OK\r\n"));
+  TEST_ASSERT_EQUAL(0x61, g_cmd);
+  TEST_ASSERT_EQUAL(0, body(r).find("{\"fw\":"));
+  request("POST /cmd HTTP/1.0\r\ncontent-length: 8\r\n\r\nc=33&x=1");
+  TEST_ASSERT_EQUAL(33, g_cmd);
+}
+
+void test_post_cmd_invalid (void) {
+  TEST_ASSERT_EQUAL(0, request("POST /cmd HTTP/1.0\r\nContent-Length: 5\r\n\r\nc=256").find("HTTP/1.0 400 "));
+  TEST_ASSERT_EQUAL(0, request("POST /cmd HTTP/1.0\r\nContent-Length: 3\r\n\r\nx=1").find("HTTP/1.0 400 "));
+  TEST_ASSERT_EQUAL(0, request("POST /cmd HTTP/1.0\r\n\r\n").find("HTTP/1.0 400 "));
+  TEST_ASSERT_EQUAL(-1, g_cmd);
+}
+
+void test_post_time (void) {
+  std::string r = request("POST /time HTTP/1.0\r\nContent-Length: 21\r\n\r\nt=2026-10-19T21:30:05");
+  TEST_ASSERT_EQUAL(0, r.find("HTTP/1.0 200 OK\r\n"));
+  TEST_ASSERT_EQUAL_STRING("2026-10-19 21:30:05", g_time);
+  TEST_ASSERT_EQUAL(0, body(r).find("{\"fw\":"));
+  TEST_ASSERT_EQUAL(-1, g_cmd);
+}
+
+void test_post_time_invalid (void) {
+  TEST_ASSERT_EQUAL(0, request("GET /time HTTP/1.0\r\n\r\n").find("HTTP/1.0 405 "));
+  TEST_ASSERT_EQUAL(0, request("POST /time HTTP/1.0\r\nContent-Length: 21\r\n\r\nt=2026-13-19T21:30:05").find("HTTP/1.0 400 "));
+  TEST_ASSERT_EQUAL(0, request("POST /time HTTP/1.0\r\nContent-Length: 21\r\n\r\nt=2026-10-19T24:30:05").find("HTTP/1.0 400 "));
+  TEST_ASSERT_EQUAL(0, request("POST /time HTTP/1.0\r\nContent-Length: 21\r\n\r\nt=2026-10-19 21:30:05").find("HTTP/1.0 400 "));
+  TEST_ASSERT_EQUAL(0, request("POST /time HTTP/1.0\r\nContent-Length: 18\r\n\r\nt=2026-10-19T21:30").find("HTTP/1.0 400 "));
+  TEST_ASSERT_EQUAL(0, request("POST /time HTTP/1.0\r\nContent-Length: 21\r\n\r\nt=2026-1x-19T21:30:05").find("HTTP/1.0 400 "));
+  TEST_ASSERT_EQUAL_STRING("", g_time);
+}
+
+void test_timeout (void) {
+  uint32_t t = millis();
+  // Header never ends
+  TEST_ASSERT_EQUAL(0, request("GET /state HTTP/1.0\r\n").find("HTTP/1.0 408 "));
+  TEST_ASSERT_LESS_OR_EQUAL(HTTP_TIMEOUT + 2, millis() - t);
+  TEST_ASSERT_TRUE(millis() - t > HTTP_TIMEOUT);
+}
+
+void test_long_lines_are_cut (void) {
+  std::string req("GET /state HTTP/1.0\r\nCookie: ");
+  req.append(500, 'x');
+  req.append("\r\n\r\n");
+  TEST_ASSERT_EQUAL(0, request(req.c_str()).find("HTTP/1.0 200 OK\r\n"));
+}
+
+void test_response_in_chunks (void) {
+  std::string r = request("GET /config HTTP/1.0\r\n\r\n");
+  // full Chunks, the last one partly: no Write smaller than needed
+  TEST_ASSERT_TRUE(r.size() > 4 * HTTP_CHUNK);
+  TEST_ASSERT_EQUAL((r.size() + HTTP_CHUNK - 1) / HTTP_CHUNK, client.writes);
+  TEST_ASSERT_EQUAL(0, body(r).find("{\"click\":["));
+}
+
+void test_counters (void) {
+  request("GET /state HTTP/1.0\r\n\r\n");
+  request("GET /x HTTP/1.0\r\n\r\n");
+  TEST_ASSERT_TRUE(body(request("GET /counters HTTP/1.0\r\n\r\n")).find("\"http\":{\"requests\":2,\"errors\":1,") != std::string::npos);
+}
+
+void test_budget (void) {
+  uint16_t i;
+  uint32_t t;
+  char msg[80];
+  fakeRealTime = true;
+  t = micros();
+  for (i = 0; i < TEST_BUDGET_REQUESTS; i++) {
+    request("GET /config HTTP/1.0\r\n\r\n");
+  }
+  t = micros() - t;
+  TEST_ASSERT_TRUE(body(request("GET /counters HTTP/1.0\r\n\r\n")).find("\"overBudget\":0}") != std::string::npos);
+  snprintf(msg, sizeof(msg), "GET /config: %u us per Request, %u Requests/s (Host)",
+           (unsigned)(t / TEST_BUDGET_REQUESTS), (unsigned)(1000000ULL * TEST_BUDGET_REQUESTS / (t ? t : 1)));
+  TEST_MESSAGE(msg);
+}
+
+int main (void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_get_state);
+  RUN_TEST(test_root_is_state);
+  RUN_TEST(test_errors);
+  RUN_TEST(test_post_cmd);
+  RUN_TEST(test_post_cmd_invalid);
+  RUN_TEST(test_post_time);
+  RUN_TEST(test_post_time_invalid);
+  RUN_TEST(test_timeout);
+  RUN_TEST(test_long_lines_are_cut);
+  RUN_TEST(test_response_in_chunks);
+  RUN_TEST(test_counters);
+  RUN_TEST(test_budget);
+  return (UNITY_END());
+}
@@ -0,0 +1,125 @@
+/************************************************************
+ * Unit Tests of the MCP23017 Error Accounting and Bus
+ * Recovery (env:native)
+ ************************************************************
+ * The Chips are the Register Models of the Wire Stand-In,
+ * Faults are injected by the Library (injectFaults), by the
+ * Bus (Timeouts, missing Chip) and by a Slave holding SDA.
+ ************************************************************/
+#include <unity.h>
+#include <fakeMain.h>
+#include <mcp23017_DC.h>
+
+#define TEST_OUT_CHIP         2     // Chip with Outputs (as mcp[2])
+
+mcp23017 mcp;
+
+void setUp (void) {
+  fakeReset();
+  mcp23017::injectFaults(0);
+}
+
+void tearDown (void) {
+}
+
+void test_begin_sets_inputs (void) {
+  TEST_ASSERT_EQUAL(MCP23017_OK, mcp.begin(TEST_OUT_CHIP, &Wire));
+  TEST_ASSERT_EQUAL_HEX8(0xff, Wire.chips[TEST_OUT_CHIP].regs[MCP23017_IODIRA]);
+  TEST_ASSERT_EQUAL_HEX8(0xff, Wire.chips[TEST_OUT_CHIP].regs[MCP23017_IODIRB]);
+  TEST_ASSERT_EQUAL(0, mcp.errorCount());
+}
+
+void test_missing_chip_is_counted (void) {
+  Wire.chips[TEST_OUT_CHIP].present = false;
+  TEST_ASSERT_EQUAL(MCP23017_ERR_NACK_ADR, mcp.begin(TEST_OUT_CHIP, &Wire));
+  TEST_ASSERT_EQUAL(1, mcp.errorCount());
+  TEST_ASSERT_EQUAL(MCP23017_ERR_NACK_ADR, mcp.lastError());
+}
+
+void test_write_and_read_ports (void) {
+  uint16_t value;
+  mcp.begin(TEST_OUT_CHIP, &Wire);
+  // Port A Outputs, Port B Inputs
+  mcp.writeRegister(MCP23017_IODIRA, 0x00);
+  Wire.chips[TEST_OUT_CHIP].pins = 0x5a00;
+  TEST_ASSERT_EQUAL(MCP23017_OK, mcp.writeGPIOAB(0x00c3));
+  TEST_ASSERT_EQUAL_HEX8(0xc3, Wire.chips[TEST_OUT_CHIP].regs[MCP23017_OLATA]);
+  TEST_ASSERT_EQUAL(MCP23017_OK, mcp.readGPIOAB(value));
+  TEST_ASSERT_EQUAL_HEX16(0x5ac3, value);
+}
+
+void test_injected_faults (void) {
+  uint16_t value;
+  mcp.begin(TEST_OUT_CHIP, &Wire);
+  mcp23017::injectFaults(2);
+  TEST_ASSERT_EQUAL(MCP23017_ERR_TIMEOUT, mcp.writeGPIOAB(0x0001));
+  TEST_ASSERT_EQUAL(MCP23017_ERR_TIMEOUT, mcp.readGPIOAB(value));
+  TEST_ASSERT_EQUAL(MCP23017_OK, mcp.readGPIOAB(value));
+  TEST_ASSERT_EQUAL(2, mcp.errorCount());
+  TEST_ASSERT_EQUAL(MCP23017_ERR_TIMEOUT, mcp.lastError());
+}
+
+void test_bus_timeout_is_counted (void) {
+  uint8_t value;
+  mcp.begin(TEST_OUT_CHIP, &Wire);
+  Wire.fail = 1;
+  TEST_ASSERT_EQUAL(MCP23017_ERR_TIMEOUT, mcp.readRegister(MCP23017_GPIOA, value));
+  TEST_ASSERT_EQUAL(MCP23017_OK, mcp.readRegister(MCP23017_GPIOA, value));
+  TEST_ASSERT_EQUAL(1, mcp.errorCount());
+}
+
+void test_clear_bus_releases_sda (void) {
+  uint32_t t;
+  // Slave holds SDA for 5 Clocks
+  fakeSdaHeld = 5;
+  t = micros();
+  TEST_ASSERT_EQUAL(MCP23017_OK, mcp23017::clearBus(&Wire, 100000UL));
+  TEST_ASSERT_EQUAL(0, fakeSdaHeld);
+  TEST_ASSERT_TRUE(Wire.active);
+  TEST_ASSERT_EQUAL_UINT32(100000UL, Wire.clock);
+  TEST_ASSERT_LESS_OR_EQUAL(200, micros() - t);
+}
+
+void test_clear_bus_is_bounded (void) {
+  uint32_t t;
+  // SDA stuck: 9 Clocks, then the Bus is reported
+  fakeSdaHeld = 100;
+  t = micros();
+  TEST_ASSERT_EQUAL(MCP23017_ERR_BUS, mcp23017::clearBus(&Wire, 100000UL));
+  TEST_ASSERT_EQUAL(100 - 9, fakeSdaHeld);
+  TEST_ASSERT_TRUE(Wire.active);
+  TEST_ASSERT_LESS_OR_EQUAL(200, micros() - t);
+}
+
+void test_restore_after_chip_reset (void) {
+  uint8_t i;
+  mcp.begin(TEST_OUT_CHIP, &Wire);
+  mcp.writeRegister(MCP23017_IODIRA, 0x00);
+  mcp.writeRegister(MCP23017_IODIRB, 0x00);
+  mcp.writeGPIOAB(0x8001);
+  // Power-On Reset of the Chip (e.g. Brown-Out of the Expander)
+  memset(Wire.chips[TEST_OUT_CHIP].regs, 0, MCP23017_REGS);
+  Wire.chips[TEST_OUT_CHIP].regs[MCP23017_IODIRA] = 0xff;
+  Wire.chips[TEST_OUT_CHIP].regs[MCP23017_IODIRB] = 0xff;
+  i = Wire.chips[TEST_OUT_CHIP].writes;
+  TEST_ASSERT_EQUAL(MCP23017_OK, mcp.restore());
+  // one Transfer restores all Registers
+  TEST_ASSERT_EQUAL(i + 1, Wire.chips[TEST_OUT_CHIP].writes);
+  TEST_ASSERT_EQUAL_HEX8(0x00, Wire.chips[TEST_OUT_CHIP].regs[MCP23017_IODIRA]);
+  TEST_ASSERT_EQUAL_HEX8(0x00, Wire.chips[TEST_OUT_CHIP].regs[MCP23017_IODIRB]);
+  TEST_ASSERT_EQUAL_HEX8(0x01, Wire.chips[TEST_OUT_CHIP].regs[MCP23017_OLATA]);
+  TEST_ASSERT_EQUAL_HEX8(0x80, Wire.chips[TEST_OUT_CHIP].regs[MCP23017_OLATB]);
+}
+
+int main (void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_begin_sets_inputs);
+  RUN_TEST(test_missing_chip_is_counted);
+  RUN_TEST(test_write_and_read_ports);
+  RUN_TEST(test_injected_faults);
+  RUN_TEST(test_bus_timeout_is_counted);
+  RUN_TEST(test_clear_bus_releases_sda);
+  RUN_TEST(test_clear_bus_is_bounded);
+  RUN_TEST(test_restore_after_chip_reset);
+  return (UNITY_END());
+}
@@ -0,0 +1,129 @@
+/************************************************************
+ * Unit Tests of the I2C Access Benchmark (env:native)
+ ************************************************************
+ * The CSV Lines of runI2cBench() are parsed, the Column
+ * bytes/op is compared with the Bytes on the Wire counted
+ * by the Wire Stand-In for one Operation of each Test.
+ ************************************************************/
+#include <unity.h>
+#include <fakeMain.h>
+#include <i2cBench.h>
+
+#define TEST_IN_CHIP          0     // Chip with Inputs (as mcp[0])
+#define TEST_OUT_CHIP         2     // Chip with Outputs (as mcp[2])
+#define TEST_CLOCK       400000     // I2C Clock of the Firmware
+#define TEST_TESTS            6     // Tests per Clock
+#define TEST_CLOCKS           3     // Clocks
+
+// one parsed CSV Line
+typedef struct {
+  char     test[16];
+  uint32_t clock;
+  unsigned runs;
+  unsigned bytes;
+} benchLine;
+
+mcp23017 mcpIn;
+mcp23017 mcpOut;
+benchLine g_lines[TEST_TESTS * TEST_CLOCKS];
+uint8_t g_num;                          //!< parsed Lines
+
+/************************************************************
+ * parse
+ * Parse the BENCH Lines of the Serial Output
+ ************************************************************/
+static void parse (void) {
+  size_t pos = 0;
+  unsigned us;
+  unsigned cus;
+  unsigned long clock;
+  benchLine* l;
+  g_num = 0;
+  while ((pos = Serial.out.find("\nBENCH,", pos)) != std::string::npos) {
+    pos++;
+    TEST_ASSERT_TRUE(g_num < TEST_TESTS * TEST_CLOCKS);
+    l = &g_lines[g_num++];
+    TEST_ASSERT_EQUAL(6, sscanf(Serial.out.c_str() + pos, "BENCH,native,%15[^,],%lu,%u,%u.%u,%u",
+                                l->test, &clock, &l->runs, &us, &cus, &l->bytes));
+    l->clock = clock;
+  }
+}
+
+/************************************************************
+ * wireBytes
+ * @param[in] test Name of the Test
+ * @returns Bytes on the Wire of one Operation of the Test
+ ************************************************************/
+static uint32_t wireBytes (const char* test) {
+  uint8_t v8;
+  uint16_t v16;
+  uint8_t buf[22];
+  Wire.bytes = 0;
+  if (!strcmp(test, "reg")) {
+    mcpIn.readRegister(MCP23017_GPIOA, v8);
+  } else if (!strcmp(test, "8bit")) {
+    mcpIn.readGPIO(0, v8);
+    mcpIn.readGPIO(1, v8);
+  } else if (!strcmp(test, "16bit")) {
+    mcpIn.readGPIOAB(v16);
+  } else if (!strcmp(test, "burst")) {
+    mcpIn.readRegisters(MCP23017_IODIRA, buf, sizeof(buf));
+  } else if (!strcmp(test, "intcap")) {
+    mcpIn.readINTCAPAB(v16);
+  } else if (!strcmp(test, "write")) {
+    mcpOut.writeGPIOAB(0x00c3);
+  } else {
+    TEST_ASSERT_EQUAL_STRING("known Test", test);
+  }
+  return (Wire.bytes);
+}
+
+void setUp (void) {
+  fakeReset();
+  mcpIn.begin(TEST_IN_CHIP, &Wire);
+  mcpOut.begin(TEST_OUT_CHIP, &Wire);
+  Wire.setClock(TEST_CLOCK);
+  Wire.bytes = 0;
+  Serial.out.clear();
+}
+
+void tearDown (void) {
+}
+
+void test_lines_and_clocks (void) {
+  uint8_t i;
+  runI2cBench(mcpIn, mcpOut, 0x00c3, TEST_CLOCK, F("native"));
+  parse();
+  TEST_ASSERT_EQUAL(TEST_TESTS * TEST_CLOCKS, g_num);
+  for (i = 0; i < g_num; i++) {
+    TEST_ASSERT_EQUAL(BENCH_RUNS, g_lines[i].runs);
+  }
+  TEST_ASSERT_EQUAL_UINT32(100000, g_lines[0].clock);
+  TEST_ASSERT_EQUAL_UINT32(400000, g_lines[TEST_TESTS].clock);
+  TEST_ASSERT_EQUAL_UINT32(800000, g_lines[2 * TEST_TESTS].clock);
+  // Clock of the Firmware restored
+  TEST_ASSERT_EQUAL_UINT32(TEST_CLOCK, Wire.clock);
+}
+
+void test_bytes_on_the_wire (void) {
+  uint8_t i;
+  uint32_t total;
+  uint32_t sum = 0;
+  runI2cBench(mcpIn, mcpOut, 0x00c3, TEST_CLOCK, F("native"));
+  total = Wire.bytes;
+  parse();
+  TEST_ASSERT_EQUAL(TEST_TESTS * TEST_CLOCKS, g_num);
+  for (i = 0; i < g_num; i++) {
+    TEST_ASSERT_EQUAL(wireBytes(g_lines[i].test), g_lines[i].bytes);
+    sum += g_lines[i].bytes;
+  }
+  // the Benchmark transfers what its Lines report
+  TEST_ASSERT_EQUAL_UINT32(sum * BENCH_RUNS, total);
+}
+
+int main (void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_lines_and_clocks);
+  RUN_TEST(test_bytes_on_the_wire);
+  return (UNITY_END());
+}
@@ -0,0 +1,118 @@
+/************************************************************
+ * Unit Tests of the Pin Permutation (env:native)
+ ************************************************************
+ * The Table Lookups of pinMap.cpp are compared with a Loop
+ * over the Bits of the IN_xx/OUT_xx Definitions
+ * (myHWconfig.h) for single Bits and for TEST_WORDS random
+ * Words.
+ ************************************************************/
+#include <unity.h>
+#include <fakeMain.h>
+#include <stdlib.h>
+#include <pinMap.h>
+
+#define TEST_WORDS       200000UL   // random Words per Direction
+
+// Expander Bit of each Terminal
+static const uint8_t inBit[32] = {
+  IN_01, IN_02, IN_03, IN_04, IN_05, IN_06, IN_07, IN_08,
+  IN_09, IN_10, IN_11, IN_12, IN_13, IN_14, IN_15, IN_16,
+  IN_17, IN_18, IN_19, IN_20, IN_21, IN_22, IN_23, IN_24,
+  IN_25, IN_26, IN_27, IN_28, IN_29, IN_30, IN_31, IN_32
+};
+static const uint8_t outBit[32] = {
+  OUT_01, OUT_02, OUT_03, OUT_04, OUT_05, OUT_06, OUT_07, OUT_08,
+  OUT_09, OUT_10, OUT_11, OUT_12, OUT_13, OUT_14, OUT_15, OUT_16,
+  OUT_17, OUT_18, OUT_19, OUT_20, OUT_21, OUT_22, OUT_23, OUT_24,
+  OUT_25, OUT_26, OUT_27, OUT_28, OUT_29, OUT_30, OUT_31, OUT_32
+};
+
+/************************************************************
+ * inputsByBit
+ * @param[in] inState Expander Bits
+ * @returns Terminal Order, one Bit after the other
+ ************************************************************/
+static uint32_t inputsByBit (uint32_t inState) {
+  uint8_t t;
+  uint32_t v = 0;
+  for (t = 0; t < 32; t++) {
+    if (inState & (1UL << inBit[t])) {
+      v |= 1UL << t;
+    }
+  }
+  return (v);
+}
+
+/************************************************************
+ * outputsByBit
+ * @param[in] terminals Terminal Order
+ * @returns Expander Bits, one Bit after the other
+ ************************************************************/
+static uint32_t outputsByBit (uint32_t terminals) {
+  uint8_t t;
+  uint32_t v = 0;
+  for (t = 0; t < 32; t++) {
+    if (terminals & (1UL << t)) {
+      v |= 1UL << outBit[t];
+    }
+  }
+  return (v);
+}
+
+/************************************************************
+ * randomWord
+ * @returns 32 random Bits
+ ************************************************************/
+static uint32_t randomWord (void) {
+  return (((uint32_t)(rand() & 0xffff) << 16) | (uint32_t)(rand() & 0xffff));
+}
+
+void setUp (void) {
+  fakeReset();
+  srand(46);
+}
+
+void tearDown (void) {
+}
+
+void test_single_bits (void) {
+  uint8_t t;
+  for (t = 0; t < 32; t++) {
+    TEST_ASSERT_EQUAL_HEX32(1UL << t, inputsToLogical(1UL << inBit[t]));
+    TEST_ASSERT_EQUAL_HEX32(1UL << outBit[t], outputsToPhysical(1UL << t));
+  }
+  // Examples of the Header
+  TEST_ASSERT_EQUAL_HEX32(1UL << 0, inputsToLogical(1UL << 8));
+  TEST_ASSERT_EQUAL_HEX32(1UL << 15, outputsToPhysical(1UL << 0));
+  TEST_ASSERT_EQUAL_HEX32(1UL << 0, outputsToPhysical(1UL << 8));
+}
+
+void test_random_words_inputs (void) {
+  uint32_t i;
+  uint32_t w;
+  TEST_ASSERT_EQUAL_HEX32(0, inputsToLogical(0));
+  TEST_ASSERT_EQUAL_HEX32(0xffffffffUL, inputsToLogical(0xffffffffUL));
+  for (i = 0; i < TEST_WORDS; i++) {
+    w = randomWord();
+    TEST_ASSERT_EQUAL_HEX32(inputsByBit(w), inputsToLogical(w));
+  }
+}
+
+void test_random_words_outputs (void) {
+  uint32_t i;
+  uint32_t w;
+  TEST_ASSERT_EQUAL_HEX32(0, outputsToPhysical(0));
+  TEST_ASSERT_EQUAL_HEX32(0xffffffffUL, outputsToPhysical(0xffffffffUL));
+  for (i = 0; i < TEST_WORDS; i++) {
+    w = randomWord();
+    TEST_ASSERT_EQUAL_HEX32(outputsByBit(w), outputsToPhysical(w));
+  }
+}
+
+int main (void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_single_bits);
+  RUN_TEST(test_random_words_inputs);
+  RUN_TEST(test_random_words_outputs);
+  return (UNITY_END());
+}
@@ -0,0 +1,358 @@
+/************************************************************
+ * Unit Tests of the Input to Output Pipeline (env:native)
+ ************************************************************
+ * An Edge passes the Stages of main.cpp on the Stand-Ins:
+ *   ISR (iqrHandler: trace irq, irqQueue push)
+ *   -> scanButtons (pop, read the Input Chips, TRACE_SCAN)
+ *   -> buttons::update -> processClick (TRACE_CLASSIFY)
+ *   -> executeCommand (TRACE_DISPATCH) -> setOutputs (write
+ *      the Output Chips, written())
+ * The Main Loop and the I2C Transfers take simulated Time:
+ * TEST_LOOP_US from the ISR to scanButtons(), TEST_BYTE_US
+ * per Byte on the Wire (Wire.bytes). The Event recorded by
+ * the latencyTrace is read back with printRing().
+ * Input in_S11 toggles out_L5 on a Click (mySettings.h),
+ * Special Events and Rules are not executed here.
+ ************************************************************/
+#include <unity.h>
+#include <fakeMain.h>
+#include <mcp23017_DC.h>
+#include <buttons.h>
+#include <irqQueue.h>
+#include <latencyTrace.h>
+
+#define TEST_PIN         in_S11     // Input under Test
+#define TEST_OUT         out_L5     // its Output (Click)
+#define TEST_CLOCK       100000     // I2C Clock of the Test
+#define TEST_BYTE_US         90     // [us] 9 Bits at TEST_CLOCK
+#define TEST_LOOP_US        100     // [us] ISR -> scanButtons()
+#define TEST_SCAN_US  (TEST_LOOP_US + 10 * TEST_BYTE_US)  // 2x readGPIOAB: 5 Bytes each
+#define TEST_WRITE_US  (8 * TEST_BYTE_US)                 // 2x writeGPIOAB: 4 Bytes each
+
+// one Event of printRing() [us since IRQ], -1: Stage not reached
+typedef struct {
+  long scan;
+  long classify;
+  long dispatch;
+  long write;
+} ringEvent;
+
+config myconfig;
+timerWheel mytimers;
+buttons mybuttons;
+irqQueue myirqs;
+latencyTrace mytrace;
+mcp23017 mcp[4];
+uint32_t g_lastOutState;            //!< Outputs (setOutputs)
+uint32_t g_lastButtonState;         //!< Inputs of the last Scan
+uint32_t g_lastButtonScanTime;      //!< [ms]
+uint16_t g_buttonScanWait;          //!< nextScan() of the last Scan
+uint32_t g_wireBytes;               //!< Wire.bytes already timed
+uint8_t  g_clicks;                  //!< Clicks dispatched
+
+/************************************************************
+ * wire
+ * Time of the I2C Transfers since the last Call
+ ************************************************************/
+static void wire (void) {
+  fakeAdvanceMicros((Wire.bytes - g_wireBytes) * TEST_BYTE_US);
+  g_wireBytes = Wire.bytes;
+}
+
+/************************************************************
+ * isr
+ * IRQ Handler (as iqrHandler())
+ ************************************************************/
+static void isr (void) {
+  mytrace.irq();
+  myirqs.push();
+}
+
+/************************************************************
+ * setOutputs
+ * Write the Output Chips if changed (as setOutputs())
+ ************************************************************/
+static void setOutputs (uint32_t newOutState) {
+  if (g_lastOutState != newOutState) {
+    g_lastOutState = newOutState;
+    mcp[2].writeGPIOAB((uint16_t)(newOutState & 0xffff));
+    mcp[3].writeGPIOAB((uint16_t)((newOutState >> 16) & 0xffff));
+    wire();
+    mytrace.written();
+  }
+}
+
+/************************************************************
+ * click
+ * Click Handler (as processClick() and executeCommand()
+ * for Output Commands)
+ ************************************************************/
+static void click (uint8_t clickType, uint8_t inPin, uint16_t duration) {
+  uint8_t cmdByte;
+  uint8_t cmd;
+  uint8_t par;
+  (void)duration;
+  mytrace.mark(TRACE_CLASSIFY);
+  g_clicks++;
+  cmdByte = myconfig.getClickCommandFromEEprom(clickType, inPin, cmd, par);
+  mytrace.dispatch(true);
+  par = cmdByte & 0x1f;
+  switch (cmdByte & 0xe0) {
+    case EVENT_ON:
+      mytrace.mark(TRACE_DISPATCH);
+      setOutputs(g_lastOutState | (1UL << par));
+      break;
+    case EVENT_OFF:
+      mytrace.mark(TRACE_DISPATCH);
+      setOutputs(g_lastOutState & ~(1UL << par));
+      break;
+    case EVENT_TOGGLE:
+      mytrace.mark(TRACE_DISPATCH);
+      setOutputs(g_lastOutState ^ (1UL << par));
+      break;
+  }
+  mytrace.mark(TRACE_DISPATCH);
+  mytrace.dispatch(false);
+  mytrace.finish();
+}
+
+/************************************************************
+ * scan
+ * Read the Inputs on IRQ or when due (as scanButtons())
+ ************************************************************/
+static void scan (void) {
+  uint32_t thisstate;
+  boolean dothisscan = false;
+  uint16_t in0;
+  uint16_t in1;
+  uint32_t edgetime = millis();
+  irqEvent ev;
+  if (myirqs.pop(ev)) {
+    edgetime -= (micros() - ev.time) / 1000;
+    if ((int32_t)(edgetime - g_lastButtonScanTime) < 0) {
+      edgetime = g_lastButtonScanTime;
+    }
+    while (myirqs.pop(ev)) {
+    }
+    dothisscan = true;
+  } else if (g_buttonScanWait != BUTTON_NO_SCAN) {
+    dothisscan = (millis() - g_lastButtonScanTime >= g_buttonScanWait);
+  }
+  if (dothisscan) {
+    g_lastButtonScanTime = millis();
+    mcp[0].readGPIOAB(in0);
+    mcp[1].readGPIOAB(in1);
+    wire();
+    // INT released by the Read
+    fakePinLevel[INT_PIN] = HIGH;
+    thisstate = (uint32_t)in0 + ((uint32_t)in1 << 16);
+    mytrace.mark(TRACE_SCAN);
+    g_lastButtonState = thisstate;
+    mybuttons.update(thisstate, (uint16_t)edgetime);
+    g_buttonScanWait = mybuttons.nextScan((uint16_t)g_lastButtonScanTime);
+    if ((thisstate == 0) && !mybuttons.busy() && myirqs.empty()) {
+      mytrace.cancel();
+    }
+  }
+}
+
+/************************************************************
+ * run
+ * Main Loop for some Time
+ * @param[in] ms Duration
+ ************************************************************/
+static void run (uint32_t ms) {
+  for (; ms; ms--) {
+    fakeAdvance(1);
+    mytimers.tick();
+    scan();
+  }
+}
+
+/************************************************************
+ * edge
+ * Edge on the Input under Test: INT_PIN low, ISR
+ * @param[in] pressed new Level
+ ************************************************************/
+static void edge (boolean pressed) {
+  fakeChip* c = &Wire.chips[TEST_PIN / 16];
+  if (pressed) {
+    c->pins |= (1 << (TEST_PIN % 16));
+  } else {
+    c->pins &= ~(1 << (TEST_PIN % 16));
+  }
+  fakePinLevel[INT_PIN] = LOW;
+  isr();
+}
+
+/************************************************************
+ * input
+ * Edge, then one Pass of the Main Loop
+ * @param[in] pressed new Level
+ ************************************************************/
+static void input (boolean pressed) {
+  edge(pressed);
+  fakeAdvanceMicros(TEST_LOOP_US);
+  mytimers.tick();
+  scan();
+}
+
+/************************************************************
+ * lastEvent
+ * @returns newest Event of printRing()
+ ************************************************************/
+static ringEvent lastEvent (void) {
+  ringEvent e = {-1, -1, -1, -1};
+  unsigned long irq;
+  size_t pos;
+  Serial.out.clear();
+  mytrace.printRing();
+  pos = Serial.out.rfind(':');
+  TEST_ASSERT_TRUE(pos != std::string::npos);
+  pos = Serial.out.rfind('\n', pos);
+  TEST_ASSERT_TRUE(sscanf(Serial.out.c_str() + pos + 1, " %lu: %ld %ld %ld %ld",
+                          &irq, &e.scan, &e.classify, &e.dispatch, &e.write) >= 3);
+  return (e);
+}
+
+/************************************************************
+ * statLine
+ * @param[in] name Stage as printed (e.g. "Total   ")
+ * @returns Line of the Stage printed by printStats()
+ ************************************************************/
+static std::string statLine (const char* name) {
+  size_t pos;
+  Serial.out.clear();
+  mytrace.printStats();
+  pos = Serial.out.find(name);
+  if (pos == std::string::npos) {
+    return ("");
+  }
+  return (Serial.out.substr(pos, Serial.out.find('\r', pos) - pos));
+}
+
+void setUp (void) {
+  fakeReset();
+  fakeAdvance(100000);
+  Wire.setClock(TEST_CLOCK);
+  myconfig.resetToFactoryDefaults();
+  myconfig.begin();
+  mytimers.begin();
+  mcp[0].begin(0, &Wire);
+  mcp[1].begin(1, &Wire);
+  mcp[2].begin(2, &Wire);
+  mcp[3].begin(3, &Wire);
+  myirqs.begin(INT_PIN);
+  mytrace.begin();
+  mybuttons.begin(myconfig, mytimers, click);
+  g_lastOutState = 0;
+  g_lastButtonState = 0;
+  g_lastButtonScanTime = millis();
+  g_buttonScanWait = BUTTON_NO_SCAN;
+  g_wireBytes = Wire.bytes;
+  g_clicks = 0;
+}
+
+void tearDown (void) {
+}
+
+void test_click_to_output (void) {
+  ringEvent e;
+  input(true);
+  run(80);
+  input(false);
+  run(1000);
+  TEST_ASSERT_EQUAL(1, g_clicks);
+  // Output written to the Output Chips
+  TEST_ASSERT_EQUAL_HEX32(1UL << TEST_OUT, g_lastOutState);
+  TEST_ASSERT_EQUAL_HEX16((uint16_t)(g_lastOutState & 0xffff),
+                          Wire.chips[2].regs[FAKE_WIRE_OLATA] + (Wire.chips[2].regs[FAKE_WIRE_OLATA + 1] << 8));
+  TEST_ASSERT_EQUAL_HEX16((uint16_t)(g_lastOutState >> 16),
+                          Wire.chips[3].regs[FAKE_WIRE_OLATA] + (Wire.chips[3].regs[FAKE_WIRE_OLATA + 1] << 8));
+  // Stages of the Event opened by the Press
+  e = lastEvent();
+  TEST_ASSERT_EQUAL(TEST_SCAN_US, e.scan);
+  // Click decided at the End of the Double-Click Window
+  TEST_ASSERT_GREATER_OR_EQUAL((80 + BUTTON_T2) * 1000L, e.classify);
+  TEST_ASSERT_LESS_OR_EQUAL((80 + BUTTON_T2 + 5) * 1000L, e.classify);
+  TEST_ASSERT_EQUAL(e.classify, e.dispatch);
+  TEST_ASSERT_EQUAL(e.dispatch + TEST_WRITE_US, e.write);
+  TEST_ASSERT_EQUAL_STRING("Write    1 720 720 720 720", statLine("Write").c_str());
+  // a second Click toggles back, a new Event
+  input(true);
+  run(80);
+  input(false);
+  run(1000);
+  TEST_ASSERT_EQUAL(2, g_clicks);
+  TEST_ASSERT_EQUAL_HEX32(0, g_lastOutState);
+  TEST_ASSERT_EQUAL_STRING("Scan     2 1000 1000 1000 1000", statLine("Scan").c_str());
+}
+
+void test_queued_edges (void) {
+  ringEvent e;
+  // Bounce: three Edges before the Main Loop runs
+  edge(true);
+  fakeAdvanceMicros(200);
+  edge(false);
+  fakeAdvanceMicros(200);
+  edge(true);
+  fakeAdvanceMicros(TEST_LOOP_US);
+  scan();
+  // one Scan for all Edges, dated from the first one
+  TEST_ASSERT_TRUE(myirqs.empty());
+  TEST_ASSERT_EQUAL(0, myirqs.overflows());
+  run(80);
+  input(false);
+  run(1000);
+  TEST_ASSERT_EQUAL(1, g_clicks);
+  e = lastEvent();
+  TEST_ASSERT_EQUAL(400 + TEST_SCAN_US, e.scan);
+  TEST_ASSERT_EQUAL(e.dispatch + TEST_WRITE_US, e.write);
+}
+
+void test_long_click_without_write (void) {
+  ringEvent e;
+  // Long-Click of in_S11: Special Event, no Output Change here
+  input(true);
+  run(BUTTON_T1 + 100);
+  TEST_ASSERT_EQUAL(1, g_clicks);
+  TEST_ASSERT_EQUAL_HEX32(0, g_lastOutState);
+  e = lastEvent();
+  TEST_ASSERT_EQUAL(TEST_SCAN_US, e.scan);
+  TEST_ASSERT_GREATER_OR_EQUAL(BUTTON_T1 * 1000L, e.classify);
+  TEST_ASSERT_EQUAL(e.classify, e.dispatch);
+  TEST_ASSERT_EQUAL(-1, e.write);
+  input(false);
+  run(1000);
+  TEST_ASSERT_EQUAL_STRING("Write    0", statLine("Write").c_str());
+  TEST_ASSERT_EQUAL_STRING("Total    1", statLine("Total").substr(0, 10).c_str());
+}
+
+void test_noise_is_cancelled (void) {
+  ringEvent e;
+  // Glitch shorter than T0: no Click, Event discarded
+  input(true);
+  fakeAdvanceMicros(500);
+  input(false);
+  run(1000);
+  TEST_ASSERT_EQUAL(0, g_clicks);
+  TEST_ASSERT_EQUAL_STRING("Total    0", statLine("Total").c_str());
+  // the next Press opens a new Event
+  input(true);
+  run(80);
+  input(false);
+  run(1000);
+  TEST_ASSERT_EQUAL(1, g_clicks);
+  e = lastEvent();
+  TEST_ASSERT_EQUAL(TEST_SCAN_US, e.scan);
+  TEST_ASSERT_EQUAL_STRING("Total    1", statLine("Total").substr(0, 10).c_str());
+}
+
+int main (void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_click_to_output);
+  RUN_TEST(test_queued_edges);
+  RUN_TEST(test_long_click_without_write);
+  RUN_TEST(test_noise_is_cancelled);
+  return (UNITY_END());
+}
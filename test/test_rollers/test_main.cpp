@@ -0,0 +1,155 @@
+/************************************************************
+ * Unit Tests of the Roller Group Commands (env:native)
+ ************************************************************
+ * The Roller Table of the Factory Defaults (mySettings.h) is
+ * written to the EEPROM Stand-In, the Output Handler applies
+ * the Interlock as setOutputs() and counts the Writes.
+ * - ROLLER_STAGGER 0 (Default): the Rollers of one Command
+ *   start and stop with ONE Write
+ * - ROLLER_STAGGER > 0: the Motor Starts follow on Timers,
+ *   e.g. PLATFORMIO_BUILD_FLAGS=-DROLLER_STAGGER=300
+ *   pio test -e native -f test_rollers
+ ************************************************************/
+#include <unity.h>
+#include <fakeMain.h>
+#include <rollers.h>
+
+config myconfig;
+timerWheel mytimers;
+rollers myrollers;
+uint32_t g_out;                       //!< State of the Outputs
+uint8_t  g_writes;                    //!< Writes of the Outputs
+
+/************************************************************
+ * rollerOutputs
+ * Output Handler of the Rollers (as setOutputs())
+ ************************************************************/
+static void rollerOutputs (uint32_t clearMask, uint32_t setMask) {
+  g_out = myrollers.interlock(g_out, (g_out & ~clearMask) | setMask);
+  g_writes++;
+}
+
+/************************************************************
+ * run
+ * Main Loop for some Time: Timer Ticks, then flush()
+ * @param[in] ms Duration
+ ************************************************************/
+static void run (uint32_t ms) {
+  for (; ms >= TIMER_TICK; ms -= TIMER_TICK) {
+    fakeAdvance(TIMER_TICK);
+    mytimers.tick();
+    myrollers.flush();
+  }
+}
+
+/************************************************************
+ * pinMask
+ * @param[in] mask Rollers (ROLL_1 ... ROLL_4)
+ * @param[in] up   true: Up Outputs, false: Down Outputs
+ * @returns Outputs of the Rollers
+ ************************************************************/
+static uint32_t pinMask (uint8_t mask, boolean up) {
+  uint8_t r;
+  uint8_t upPin, downPin, upTime, downTime, defaultTime;
+  uint32_t m = 0;
+  for (r = 0; r < ROLLER_NUM; r++) {
+    if (mask & (1 << r)) {
+      myconfig.getRollerFromEEprom(r + 1, upPin, downPin, upTime, downTime, defaultTime);
+      m |= 1UL << (up ? upPin : downPin);
+    }
+  }
+  return (m);
+}
+
+void setUp (void) {
+  fakeReset();
+  myconfig.resetToFactoryDefaults();
+  myconfig.begin();
+  mytimers.begin();
+  myrollers.begin(myconfig, mytimers, rollerOutputs);
+  g_out = 0;
+  g_writes = 0;
+}
+
+void tearDown (void) {
+}
+
+#if ROLLER_STAGGER == 0
+void test_group_starts_with_one_write (void) {
+  myrollers.command(EVENT_ROLLER_UP, ROLL_1 + ROLL_2);
+  TEST_ASSERT_EQUAL(1, g_writes);
+  TEST_ASSERT_EQUAL_HEX32(pinMask(ROLL_1 + ROLL_2, true), g_out);
+}
+
+void test_all_rollers_with_one_write (void) {
+  myrollers.command(EVENT_ROLLER_DOWN, ROLL_1 + ROLL_2 + ROLL_3 + ROLL_4);
+  TEST_ASSERT_EQUAL(1, g_writes);
+  TEST_ASSERT_EQUAL_HEX32(pinMask(ROLL_1 + ROLL_2 + ROLL_3 + ROLL_4, false), g_out);
+}
+
+void test_group_stops_with_one_write (void) {
+  myrollers.command(EVENT_ROLLER_UP, ROLL_1 + ROLL_2);
+  run(5000);
+  myrollers.command(EVENT_ROLLER_STOP, ROLL_1 + ROLL_2);
+  TEST_ASSERT_EQUAL(2, g_writes);
+  TEST_ASSERT_EQUAL_HEX32(0, g_out);
+}
+
+void test_group_arrives_with_one_write (void) {
+  // same Travel Time up: both Deadlines expire in the same Tick
+  myrollers.command(EVENT_ROLLER_UP, ROLL_1 + ROLL_2);
+  run(30000);
+  TEST_ASSERT_EQUAL(2, g_writes);
+  TEST_ASSERT_EQUAL_HEX32(0, g_out);
+  TEST_ASSERT_EQUAL(0, myrollers.position(1));
+  TEST_ASSERT_EQUAL(0, myrollers.position(2));
+}
+#else
+void test_group_starts_staggered (void) {
+  uint32_t t = millis();
+  myrollers.command(EVENT_ROLLER_UP, ROLL_1 + ROLL_2 + ROLL_3);
+  // not blocking: first Motor at once, the others on Timers
+  TEST_ASSERT_EQUAL_UINT32(t, millis());
+  TEST_ASSERT_EQUAL(1, g_writes);
+  TEST_ASSERT_EQUAL_HEX32(pinMask(ROLL_1, true), g_out);
+  run(ROLLER_STAGGER + TIMER_TICK);
+  TEST_ASSERT_EQUAL(2, g_writes);
+  TEST_ASSERT_EQUAL_HEX32(pinMask(ROLL_1 + ROLL_2, true), g_out);
+  run(ROLLER_STAGGER);
+  TEST_ASSERT_EQUAL(3, g_writes);
+  TEST_ASSERT_EQUAL_HEX32(pinMask(ROLL_1 + ROLL_2 + ROLL_3, true), g_out);
+}
+
+void test_stop_cancels_staggered_starts (void) {
+  myrollers.command(EVENT_ROLLER_UP, ROLL_1 + ROLL_2 + ROLL_3);
+  myrollers.command(EVENT_ROLLER_STOP, ROLL_1 + ROLL_2 + ROLL_3);
+  run(3 * ROLLER_STAGGER);
+  TEST_ASSERT_EQUAL(2, g_writes);
+  TEST_ASSERT_EQUAL_HEX32(0, g_out);
+}
+#endif // ROLLER_STAGGER
+
+void test_reversal_waits_for_dead_time (void) {
+  myrollers.command(EVENT_ROLLER_UP, ROLL_1);
+  run(1000);
+  myrollers.command(EVENT_ROLLER_DOWN, ROLL_1);
+  // Motor off at once, never both Outputs on
+  TEST_ASSERT_EQUAL_HEX32(0, g_out);
+  run(ROLLER_DEAD_TIME + 2 * TIMER_TICK);
+  TEST_ASSERT_EQUAL_HEX32(pinMask(ROLL_1, false), g_out);
+}
+
+int main (void) {
+  UNITY_BEGIN();
+#if ROLLER_STAGGER == 0
+  RUN_TEST(test_group_starts_with_one_write);
+  RUN_TEST(test_all_rollers_with_one_write);
+  RUN_TEST(test_group_stops_with_one_write);
+  RUN_TEST(test_group_arrives_with_one_write);
+#else
+  RUN_TEST(test_group_starts_staggered);
+  RUN_TEST(test_stop_cancels_staggered_starts);
+#endif // ROLLER_STAGGER
+  RUN_TEST(test_reversal_waits_for_dead_time);
+  return (UNITY_END());
+}
@@ -0,0 +1,119 @@
+/************************************************************
+ * Unit Tests and Benchmark of the Rule Engine (env:native)
+ ************************************************************
+ * The Rules are written to the EEPROM Stand-In in the
+ * Format of mySettings.h and compiled by reload().
+ * The Benchmark runs on the Clock of the Host with a Table
+ * of RULE_BENCH_TABLE (100, platformio.ini) Rules, the
+ * EEPROM of the Nano holds RULE_MAX Rules only.
+ ************************************************************/
+#include <unity.h>
+#include <fakeMain.h>
+#include <rules.h>
+
+config myconfig;
+rules myrules;
+
+/************************************************************
+ * putRule
+ * Write a Rule to the EEPROM (most significant Byte first)
+ * @param[in] num     Number of the Rule (0 to RULE_MAX-1)
+ * @param[in] trigger RULE_TRIGGER(Click Type, Input)
+ * @param[in] action  One-Byte Command
+ * @param[in] outOn   Outputs which must be on
+ * @param[in] outOff  Outputs which must be off
+ * @param[in] inOn    Inputs which must be active
+ * @param[in] inOff   Inputs which must not be active
+ ************************************************************/
+static void putRule (uint8_t num, uint8_t trigger, uint8_t action, uint32_t outOn, uint32_t outOff, uint32_t inOn, uint32_t inOff) {
+  const uint8_t r[RULE_SIZE] = {trigger, action, MASK_BYTES(outOn), MASK_BYTES(outOff), MASK_BYTES(inOn), MASK_BYTES(inOff)};
+  memcpy(&fakeEeprom[EE_OFFSET_RULE + (num * RULE_SIZE)], r, RULE_SIZE);
+}
+
+void setUp (void) {
+  fakeReset();
+  myconfig.resetToFactoryDefaults();
+  myconfig.begin();
+}
+
+void tearDown (void) {
+}
+
+void test_factory_rule (void) {
+  uint8_t action = EVENT_NULL;
+  myrules.begin(myconfig);
+  // Leaving only if the Balkon is off
+  TEST_ASSERT_TRUE(myrules.match(RULE_TRIGGER(BUTTON_CLICK_LONG, in_S11), 0, 0, action));
+  TEST_ASSERT_EQUAL_HEX8(EVENT_SPECIAL + SE_LEAVING, action);
+  TEST_ASSERT_FALSE(myrules.match(RULE_TRIGGER(BUTTON_CLICK_LONG, in_S11), 1UL << out_6D1, 0, action));
+  TEST_ASSERT_FALSE(myrules.match(RULE_TRIGGER(BUTTON_CLICK, in_S11), 0, 0, action));
+}
+
+void test_first_rule_wins (void) {
+  uint8_t action = EVENT_NULL;
+  putRule(0, RULE_TRIGGER(BUTTON_CLICK, 3), EVENT_ON + 1, 0x10, 0, 0, 0);
+  putRule(1, RULE_TRIGGER(BUTTON_CLICK, 3), EVENT_ON + 2, 0, 0, 0, 0);
+  myrules.begin(myconfig);
+  TEST_ASSERT_TRUE(myrules.match(RULE_TRIGGER(BUTTON_CLICK, 3), 0x10, 0, action));
+  TEST_ASSERT_EQUAL_HEX8(EVENT_ON + 1, action);
+  TEST_ASSERT_TRUE(myrules.match(RULE_TRIGGER(BUTTON_CLICK, 3), 0, 0, action));
+  TEST_ASSERT_EQUAL_HEX8(EVENT_ON + 2, action);
+}
+
+void test_input_condition (void) {
+  uint8_t action = EVENT_NULL;
+  putRule(0, RULE_TRIGGER(BUTTON_CLICK, 4), EVENT_TOGGLE + 5, 0, 0, 0x100, 0x200);
+  myrules.begin(myconfig);
+  TEST_ASSERT_TRUE(myrules.match(RULE_TRIGGER(BUTTON_CLICK, 4), 0, 0x100, action));
+  TEST_ASSERT_EQUAL_HEX8(EVENT_TOGGLE + 5, action);
+  TEST_ASSERT_FALSE(myrules.match(RULE_TRIGGER(BUTTON_CLICK, 4), 0, 0x300, action));
+  TEST_ASSERT_FALSE(myrules.match(RULE_TRIGGER(BUTTON_CLICK, 4), 0, 0, action));
+}
+
+void test_invalid_rule_is_dropped (void) {
+  uint8_t action = EVENT_NULL;
+  // Output 0 on and off: never holds
+  putRule(0, RULE_TRIGGER(BUTTON_CLICK, 6), EVENT_ON + 1, 0x01, 0x01, 0, 0);
+  myrules.begin(myconfig);
+  TEST_ASSERT_FALSE(myrules.match(RULE_TRIGGER(BUTTON_CLICK, 6), 0x01, 0, action));
+  Serial.out.clear();
+  myrules.printState();
+  TEST_ASSERT_TRUE(Serial.out.find("1 invalid") != std::string::npos);
+}
+
+void test_reload_after_change (void) {
+  uint8_t action = EVENT_NULL;
+  myrules.begin(myconfig);
+  putRule(0, RULE_NONE, 0, 0, 0, 0, 0);
+  myrules.reload();
+  TEST_ASSERT_FALSE(myrules.match(RULE_TRIGGER(BUTTON_CLICK_LONG, in_S11), 0, 0, action));
+}
+
+void test_bench_100_rules (void) {
+  size_t pos;
+  unsigned runs;
+  unsigned us;
+  unsigned cus;
+  char msg[64];
+  myrules.begin(myconfig);
+  fakeRealTime = true;
+  myrules.bench(F("native"));
+  TEST_ASSERT_TRUE(Serial.out.find("# Rule Benchmark - Rules: 100 ") != std::string::npos);
+  pos = Serial.out.find("BENCH,native,rules,0,");
+  TEST_ASSERT_TRUE(pos != std::string::npos);
+  TEST_ASSERT_EQUAL(3, sscanf(Serial.out.c_str() + pos, "BENCH,native,rules,0,%u,%u.%u,0", &runs, &us, &cus));
+  TEST_ASSERT_EQUAL(RULE_BENCH_RUNS, runs);
+  snprintf(msg, sizeof(msg), "%u.%02u us per %u Rules (Table of %u)", us, cus, RULE_BENCH_RULES, RULE_BENCH_TABLE);
+  TEST_MESSAGE(msg);
+}
+
+int main (void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_factory_rule);
+  RUN_TEST(test_first_rule_wins);
+  RUN_TEST(test_input_condition);
+  RUN_TEST(test_invalid_rule_is_dropped);
+  RUN_TEST(test_reload_after_change);
+  RUN_TEST(test_bench_100_rules);
+  return (UNITY_END());
+}
@@ -0,0 +1,213 @@
+/************************************************************
+ * Unit Tests of the Time-of-Day Scheduler (env:native)
+ ************************************************************
+ * The Schedule is written to the EEPROM Stand-In in the
+ * Format of mySettings.h (Action = # of the Entry), the
+ * Handler records each executed Entry with the Time of Day.
+ * The Clock runs on the simulated millis(), one tick() per
+ * Minute.
+ * - Daylight Saving Time (SUN_DST_EU): 2026-03-29 and
+ *   2026-10-25 are the last Sundays of March and October
+ ************************************************************/
+#include <unity.h>
+#include <fakeMain.h>
+#include <scheduler.h>
+
+#define TEST_RUNS            32     // recorded Entries
+#define TEST_MON              0     // Weekdays of setTime()
+#define TEST_SUN              6
+
+config myconfig;
+scheduler myscheduler;
+uint8_t  g_action[TEST_RUNS];       //!< Action of each executed Entry
+uint16_t g_minute[TEST_RUNS];       //!< Minute of Day of its Execution
+uint8_t  g_runs;                    //!< executed Entries
+
+/************************************************************
+ * due
+ * Schedule Handler: record the Entry
+ ************************************************************/
+static void due (uint8_t action) {
+  if (g_runs < TEST_RUNS) {
+    g_action[g_runs] = action;
+    g_minute[g_runs] = myscheduler.minuteOfDay();
+  }
+  g_runs++;
+}
+
+/************************************************************
+ * putSchedule
+ * Write the Schedule to the EEPROM
+ * @param[in] table Entries: Weekdays, Hour, Minute, Action
+ * @param[in] num   Number of Entries
+ ************************************************************/
+static void putSchedule (const uint8_t (*table)[4], uint8_t num) {
+  fakeEeprom[EE_OFFSET_SCHEDULE] = num;
+  memcpy(&fakeEeprom[EE_OFFSET_SCHEDULE + 1], table, num * 4);
+}
+
+/************************************************************
+ * run
+ * Main Loop for some Minutes
+ * @param[in] minutes Duration
+ ************************************************************/
+static void run (uint32_t minutes) {
+  for (; minutes; minutes--) {
+    fakeAdvance(60000UL);
+    myscheduler.tick();
+  }
+}
+
+/************************************************************
+ * start
+ * Set Clock and Date (as the Serial Commands)
+ ************************************************************/
+static void start (uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute) {
+  myscheduler.setTime(0, hour, minute, 0);
+  myscheduler.setDate(year, month, day);
+}
+
+void setUp (void) {
+  fakeReset();
+  myconfig.resetToFactoryDefaults();
+  myconfig.begin();
+  g_runs = 0;
+}
+
+void tearDown (void) {
+}
+
+void test_not_synchronized (void) {
+  const uint8_t table[][4] = {{SCHED_DAILY, 0, 1, 1}};
+  putSchedule(table, 1);
+  myscheduler.begin(myconfig, due);
+  run(2 * SCHED_MINUTES);
+  TEST_ASSERT_FALSE(myscheduler.synced());
+  TEST_ASSERT_EQUAL(0, g_runs);
+}
+
+void test_spring_forward (void) {
+  const uint8_t table[][4] = {
+    {SCHED_DAILY, 1, 30, 1}, {SCHED_DAILY, 2, 0, 2}, {SCHED_DAILY, 2, 30, 3},
+    {SCHED_DAILY, 2, 59, 4}, {SCHED_DAILY, 3, 0, 5}, {SCHED_DAILY, 3, 1, 6}
+  };
+  putSchedule(table, 6);
+  myscheduler.begin(myconfig, due);
+  start(2026, 3, 29, 1, 0);
+  run(3 * 60);
+  // 02:00 - 02:59 do not exist
+  TEST_ASSERT_EQUAL(3, g_runs);
+  TEST_ASSERT_EQUAL(1, g_action[0]);
+  TEST_ASSERT_EQUAL(5, g_action[1]);
+  TEST_ASSERT_EQUAL(3 * 60, g_minute[1]);
+  TEST_ASSERT_EQUAL(6, g_action[2]);
+  // 01:00 + 3h: 05:00 DST
+  TEST_ASSERT_EQUAL(5 * 60, myscheduler.minuteOfDay());
+  Serial.out.clear();
+  myscheduler.printTime();
+  TEST_ASSERT_EQUAL_STRING("Time: 2026-03-29 Su 05:00:00 DST\r\n", Serial.out.c_str());
+}
+
+void test_fall_back (void) {
+  const uint8_t table[][4] = {
+    {SCHED_DAILY, 1, 30, 1}, {SCHED_DAILY, 2, 0, 2}, {SCHED_DAILY, 2, 30, 3},
+    {SCHED_DAILY, 2, 59, 4}, {SCHED_DAILY, 3, 0, 5}, {SCHED_DAILY, 3, 1, 6}
+  };
+  putSchedule(table, 6);
+  myscheduler.begin(myconfig, due);
+  // 01:00 is Summer Time on this Day
+  start(2026, 10, 25, 1, 0);
+  Serial.out.clear();
+  myscheduler.printTime();
+  TEST_ASSERT_EQUAL_STRING("Time: 2026-10-25 Su 01:00:00 DST\r\n", Serial.out.c_str());
+  run(3 * 60);
+  // 02:00 - 02:59 twice on the Clock, once executed
+  TEST_ASSERT_EQUAL(5, g_runs);
+  TEST_ASSERT_EQUAL(1, g_action[0]);
+  TEST_ASSERT_EQUAL(2, g_action[1]);
+  TEST_ASSERT_EQUAL(3, g_action[2]);
+  TEST_ASSERT_EQUAL(4, g_action[3]);
+  TEST_ASSERT_EQUAL(5, g_action[4]);
+  TEST_ASSERT_EQUAL(3 * 60, g_minute[4]);
+  // 01:00 DST + 3h: 03:00 Standard Time
+  TEST_ASSERT_EQUAL(3 * 60, myscheduler.minuteOfDay());
+  run(60);
+  TEST_ASSERT_EQUAL(6, g_runs);
+  TEST_ASSERT_EQUAL(6, g_action[5]);
+}
+
+void test_midnight_rollover (void) {
+  const uint8_t table[][4] = {
+    {SCHED_DAILY, 0, 0, 1}, {SCHED_DAILY, 0, 1, 2}, {SCHED_DAILY, 23, 59, 3}
+  };
+  putSchedule(table, 3);
+  myscheduler.begin(myconfig, due);
+  start(2026, 12, 31, 23, 58);
+  run(3);
+  TEST_ASSERT_EQUAL(3, g_runs);
+  TEST_ASSERT_EQUAL(3, g_action[0]);
+  TEST_ASSERT_EQUAL(1, g_action[1]);
+  TEST_ASSERT_EQUAL(0, g_minute[1]);
+  TEST_ASSERT_EQUAL(2, g_action[2]);
+  Serial.out.clear();
+  myscheduler.printTime();
+  TEST_ASSERT_EQUAL_STRING("Time: 2027-01-01 Fr 00:01:00\r\n", Serial.out.c_str());
+  // each Entry once per Day
+  run(SCHED_MINUTES);
+  TEST_ASSERT_EQUAL(6, g_runs);
+}
+
+void test_weekday_mask (void) {
+  const uint8_t table[][4] = {
+    {SCHED_WORKDAYS, 6, 30, 1}, {SCHED_WEEKEND, 8, 30, 2}, {SCHED_SUN, 12, 0, 3}
+  };
+  uint8_t i;
+  uint8_t workdays = 0;
+  uint8_t weekend = 0;
+  uint8_t sunday = 0;
+  putSchedule(table, 3);
+  myscheduler.begin(myconfig, due);
+  // without Date: Weekday of setTime()
+  myscheduler.setTime(TEST_MON, 0, 0, 0);
+  run(7 * SCHED_MINUTES);
+  TEST_ASSERT_EQUAL(TEST_MON, myscheduler.weekday());
+  for (i = 0; i < g_runs; i++) {
+    workdays += (g_action[i] == 1);
+    weekend += (g_action[i] == 2);
+    sunday += (g_action[i] == 3);
+  }
+  TEST_ASSERT_EQUAL(8, g_runs);
+  TEST_ASSERT_EQUAL(5, workdays);
+  TEST_ASSERT_EQUAL(2, weekend);
+  TEST_ASSERT_EQUAL(1, sunday);
+  // Sunday: the last Entries of the Week
+  TEST_ASSERT_EQUAL(2, g_action[6]);
+  TEST_ASSERT_EQUAL(3, g_action[7]);
+}
+
+void test_set_time_skips_entries (void) {
+  const uint8_t table[][4] = {
+    {SCHED_DAILY, 7, 0, 1}, {SCHED_DAILY, 8, 0, 2}, {SCHED_DAILY, 9, 0, 3}
+  };
+  putSchedule(table, 3);
+  myscheduler.begin(myconfig, due);
+  myscheduler.setTime(TEST_SUN, 6, 0, 0);
+  run(90);
+  TEST_ASSERT_EQUAL(1, g_runs);
+  // Clock set forward: 08:00 is not executed
+  myscheduler.setTime(TEST_SUN, 8, 30, 0);
+  run(60);
+  TEST_ASSERT_EQUAL(2, g_runs);
+  TEST_ASSERT_EQUAL(3, g_action[1]);
+}
+
+int main (void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_not_synchronized);
+  RUN_TEST(test_spring_forward);
+  RUN_TEST(test_fall_back);
+  RUN_TEST(test_midnight_rollover);
+  RUN_TEST(test_weekday_mask);
+  RUN_TEST(test_set_time_skips_entries);
+  return (UNITY_END());
+}
@@ -0,0 +1,170 @@
+/************************************************************
+ * Unit Tests of the Usage Statistics (env:native)
+ ************************************************************
+ * Counting of the changed Bits, On-Time on the simulated
+ * Clock and the deferred Flush into the EEPROM Stand-In
+ * (each changed Byte counted in fakeEepromWrites,
+ * fakeEepromBusy: a Write in Progress).
+ ************************************************************/
+#include <unity.h>
+#include <fakeMain.h>
+#include <usageStats.h>
+
+usageStats mystats;
+
+/************************************************************
+ * runFlush
+ * Main Loop until the running Flush is finished
+ * @returns Calls of tick()
+ ************************************************************/
+static uint16_t runFlush (uint32_t outState) {
+  uint16_t n = 0;
+  do {
+    mystats.tick(outState);
+    n++;
+    Serial.out.clear();
+    mystats.printState();
+  } while ((Serial.out.find("Flush running") != std::string::npos) && (n < 1000));
+  return (n);
+}
+
+void setUp (void) {
+  fakeReset();
+  mystats.begin();
+  fakeEepromWrites = 0;
+}
+
+void tearDown (void) {
+}
+
+void test_begin_clears_area_once (void) {
+  fakeEepromErase();
+  mystats.begin();
+  TEST_ASSERT_EQUAL_HEX8(STATS_MARK, fakeEeprom[EE_OFFSET_STATS_MARK]);
+  TEST_ASSERT_EQUAL(0, mystats.switches(0));
+  TEST_ASSERT_EQUAL(0, mystats.presses(31));
+  fakeEepromWrites = 0;
+  mystats.begin();
+  TEST_ASSERT_EQUAL(0, fakeEepromWrites);
+}
+
+void test_outputs_count_changed_bits (void) {
+  mystats.outputs(0, 0x80000005UL);
+  mystats.outputs(0x80000005UL, 0x80000004UL);
+  TEST_ASSERT_EQUAL(2, mystats.switches(0));
+  TEST_ASSERT_EQUAL(1, mystats.switches(2));
+  TEST_ASSERT_EQUAL(1, mystats.switches(31));
+  TEST_ASSERT_EQUAL(0, mystats.switches(1));
+  // Deltas in RAM only
+  TEST_ASSERT_EQUAL(0, fakeEepromWrites);
+}
+
+void test_inputs_count_presses (void) {
+  mystats.inputs(0, 0x3);
+  mystats.inputs(0x3, 0x2);
+  mystats.inputs(0x2, 0x3);
+  TEST_ASSERT_EQUAL(2, mystats.presses(0));
+  TEST_ASSERT_EQUAL(1, mystats.presses(1));
+}
+
+void test_on_time (void) {
+  uint16_t i;
+  for (i = 0; i < 90 * 60; i++) {
+    fakeAdvance(1000);
+    mystats.tick(0x08);
+  }
+  runFlush(0x08);
+  TEST_ASSERT_EQUAL(90, mystats.onTime(3));
+  TEST_ASSERT_EQUAL(0, mystats.onTime(2));
+  // whole Hours in EEPROM (LSB first), the Rest in RAM
+  TEST_ASSERT_EQUAL_HEX8(1, fakeEeprom[EE_OFFSET_STATS_ON_TIME + 3 * 2]);
+}
+
+void test_flush_is_deferred (void) {
+  uint16_t n;
+  mystats.outputs(0, 0x01);
+  mystats.flush();
+  // EEPROM busy: no Progress
+  fakeEepromBusy = true;
+  mystats.tick(0);
+  mystats.tick(0);
+  TEST_ASSERT_EQUAL(0, fakeEepromWrites);
+  fakeEepromBusy = false;
+  // one Field per Loop
+  n = runFlush(0);
+  TEST_ASSERT_EQUAL(STATS_FIELDS, n);
+  TEST_ASSERT_EQUAL(1, fakeEepromWrites);
+  TEST_ASSERT_EQUAL_HEX8(1, fakeEeprom[EE_OFFSET_STATS_SWITCH]);
+  TEST_ASSERT_EQUAL(1, mystats.switches(0));
+  TEST_ASSERT_TRUE(Serial.out.find("Stats: 1 Flushes, 0 lost") != std::string::npos);
+}
+
+void test_flush_interval (void) {
+  mystats.outputs(0, 0x02);
+  fakeAdvance(STATS_FLUSH_INTERVAL - 1000);
+  mystats.tick(0);
+  TEST_ASSERT_EQUAL(0, fakeEepromWrites);
+  fakeAdvance(1000);
+  runFlush(0);
+  TEST_ASSERT_EQUAL(1, fakeEepromWrites);
+  TEST_ASSERT_EQUAL(1, mystats.switches(1));
+}
+
+void test_each_byte_once_per_flush (void) {
+  uint16_t i;
+  // 256 Switches of all Outputs: Delta Counters stop at 255
+  for (i = 0; i < 128; i++) {
+    mystats.outputs(0, 0xffffffffUL);
+    mystats.outputs(0xffffffffUL, 0);
+  }
+  mystats.flush();
+  runFlush(0);
+  TEST_ASSERT_EQUAL(MCP_OUT_PINS, fakeEepromWrites);
+  TEST_ASSERT_EQUAL(255, mystats.switches(7));
+  TEST_ASSERT_TRUE(Serial.out.find("32 lost") != std::string::npos);
+  // Carry into the second Byte: 2 Bytes per Output, each once
+  fakeEepromWrites = 0;
+  mystats.outputs(0, 0xffffffffUL);
+  mystats.flush();
+  runFlush(0);
+  TEST_ASSERT_EQUAL(2 * MCP_OUT_PINS, fakeEepromWrites);
+  TEST_ASSERT_EQUAL(256, mystats.switches(7));
+}
+
+void test_full_delta_flushes_early (void) {
+  uint16_t i;
+  for (i = 0; i < STATS_DELTA_FULL; i++) {
+    mystats.inputs(0, 0x10);
+  }
+  mystats.tick(0);
+  TEST_ASSERT_EQUAL(0, fakeEepromWrites);
+  fakeAdvance(STATS_FLUSH_MIN);
+  runFlush(0);
+  TEST_ASSERT_EQUAL(STATS_DELTA_FULL, mystats.presses(4));
+  TEST_ASSERT_EQUAL_HEX8(STATS_DELTA_FULL, fakeEeprom[EE_OFFSET_STATS_PRESS + 4 * 2]);
+}
+
+void test_clear_output (void) {
+  mystats.outputs(0, 0x03);
+  mystats.flush();
+  runFlush(0);
+  mystats.clear(0);
+  TEST_ASSERT_EQUAL(0, mystats.switches(0));
+  TEST_ASSERT_EQUAL(1, mystats.switches(1));
+  mystats.clear(STATS_ALL);
+  TEST_ASSERT_EQUAL(0, mystats.switches(1));
+}
+
+int main (void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_begin_clears_area_once);
+  RUN_TEST(test_outputs_count_changed_bits);
+  RUN_TEST(test_inputs_count_presses);
+  RUN_TEST(test_on_time);
+  RUN_TEST(test_flush_is_deferred);
+  RUN_TEST(test_flush_interval);
+  RUN_TEST(test_each_byte_once_per_flush);
+  RUN_TEST(test_full_delta_flushes_early);
+  RUN_TEST(test_clear_output);
+  return (UNITY_END());
+}
@@ -0,0 +1,111 @@
+/************************************************************
+ * Unit Tests of the Sunrise/Sunset Calculation (env:native)
+ ************************************************************
+ * sunCalc() (Integer Arithmetic) is compared for each Day
+ * of a Year with the same NOAA Formulas in double at the
+ * configured Location (mySettings.h).
+ ************************************************************/
+#include <unity.h>
+#include <math.h>
+#include <fakeMain.h>
+#include <mySettings.h>
+#include <sunCalc.h>
+
+#define TEST_MAX_ERROR      1.0     // [min] Error against double
+
+/************************************************************
+ * sunRef
+ * Reference: NOAA Approximation in double
+ * @param[in]  dayOfYear 1 .. 366
+ * @param[in]  utcOffset Local Time - UTC [min]
+ * @param[out] sunrise   Minute of Day (local)
+ * @param[out] sunset    Minute of Day (local)
+ ************************************************************/
+static void sunRef (uint16_t dayOfYear, int16_t utcOffset, double& sunrise, double& sunset) {
+  double g;
+  double eq;
+  double decl;
+  double lat;
+  double ha;
+  double noon;
+  g = 2.0 * M_PI / 365.0 * (dayOfYear - 1);
+  eq = 229.18 * (0.000075 + 0.001868 * cos(g) - 0.032077 * sin(g)
+                 - 0.014615 * cos(2 * g) - 0.040849 * sin(2 * g));
+  decl = 0.006918 - 0.399912 * cos(g) + 0.070257 * sin(g) - 0.006758 * cos(2 * g)
+       + 0.000907 * sin(2 * g) - 0.002697 * cos(3 * g) + 0.00148 * sin(3 * g);
+  lat = SUN_LATITUDE / 100.0 * M_PI / 180.0;
+  ha = acos((cos(90.833 * M_PI / 180.0) - sin(lat) * sin(decl)) / (cos(lat) * cos(decl)));
+  noon = 720.0 - 4.0 * (SUN_LONGITUDE / 100.0) - eq + utcOffset;
+  sunrise = noon - 4.0 * (ha * 180.0 / M_PI);
+  sunset = noon + 4.0 * (ha * 180.0 / M_PI);
+}
+
+void setUp (void) {
+  fakeReset();
+}
+
+void tearDown (void) {
+}
+
+void test_year_against_double (void) {
+  uint16_t day;
+  uint16_t rise;
+  uint16_t set;
+  double refRise;
+  double refSet;
+  double err;
+  double maxErr = 0;
+  char msg[64];
+  for (day = 1; day <= 366; day++) {
+    sunCalc(day, SUN_TIMEZONE, rise, set);
+    sunRef(day, SUN_TIMEZONE, refRise, refSet);
+    TEST_ASSERT_TRUE(rise != SUN_NONE);
+    TEST_ASSERT_TRUE(set != SUN_NONE);
+    err = fabs(rise - refRise);
+    if (fabs(set - refSet) > err) {
+      err = fabs(set - refSet);
+    }
+    if (err > maxErr) {
+      maxErr = err;
+    }
+  }
+  snprintf(msg, sizeof(msg), "max. Error %.2f min in 366 Days", maxErr);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_TRUE(maxErr <= TEST_MAX_ERROR);
+}
+
+void test_seasons (void) {
+  uint16_t rise;
+  uint16_t set;
+  uint16_t winter;
+  uint16_t summer;
+  // Day Length: Winter Solstice < Equinox < Summer Solstice
+  sunCalc(355, SUN_TIMEZONE, rise, set);
+  winter = set - rise;
+  sunCalc(172, SUN_TIMEZONE, rise, set);
+  summer = set - rise;
+  sunCalc(80, SUN_TIMEZONE, rise, set);
+  TEST_ASSERT_TRUE(winter < set - rise);
+  TEST_ASSERT_TRUE(set - rise < summer);
+  // Equinox: about 12 Hours
+  TEST_ASSERT_LESS_OR_EQUAL(15, abs((int)(set - rise) - 12 * 60));
+}
+
+void test_utc_offset (void) {
+  uint16_t rise;
+  uint16_t set;
+  uint16_t dstRise;
+  uint16_t dstSet;
+  sunCalc(200, SUN_TIMEZONE, rise, set);
+  sunCalc(200, SUN_TIMEZONE + 60, dstRise, dstSet);
+  TEST_ASSERT_EQUAL(rise + 60, dstRise);
+  TEST_ASSERT_EQUAL(set + 60, dstSet);
+}
+
+int main (void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_year_against_double);
+  RUN_TEST(test_seasons);
+  RUN_TEST(test_utc_offset);
+  return (UNITY_END());
+}
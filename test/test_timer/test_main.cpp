@@ -0,0 +1,235 @@
+/************************************************************
+ * Unit Tests and Benchmark of the Timer Wheel (env:native)
+ ************************************************************
+ * The Wheel runs on the simulated Clock, tick() is called
+ * every Millisecond as by the Main Loop. The Benchmark
+ * compares tick() with a linear Scan of TIMER_NUM
+ * Deadlines (the Timers before the Wheel), measured on the
+ * Clock of the Host.
+ ************************************************************/
+#include <unity.h>
+#include <fakeMain.h>
+#include <timerWheel.h>
+
+#define TEST_TIMERS           8         // Timers with recorded Expiry
+#define TEST_PERIOD         100         // [ms] periodic Timer
+#define TEST_BENCH_TICKS 100000UL       // Ticks per Benchmark
+
+timerWheel mytimers;
+uint32_t g_fired[TEST_TIMERS];          //!< millis() of the last Expiry
+uint8_t  g_count[TEST_TIMERS];          //!< Expiries
+uint8_t  g_handle[TEST_TIMERS];         //!< Handles for the Callbacks
+uint8_t  g_periodic;                    //!< Handle of the periodic Timer
+volatile uint32_t g_sink;               //!< keeps the Benchmark Loops
+
+/************************************************************
+ * fired
+ * Callback: record the Expiry of Timer arg
+ ************************************************************/
+static void fired (uint8_t arg) {
+  g_fired[arg] = millis();
+  g_count[arg]++;
+}
+
+/************************************************************
+ * cancelOthers
+ * Callback: cancel Timer 1 (same Slot) and 2 (running)
+ ************************************************************/
+static void cancelOthers (uint8_t arg) {
+  fired(arg);
+  mytimers.cancel(g_handle[1]);
+  mytimers.cancel(g_handle[2]);
+}
+
+/************************************************************
+ * periodic
+ * Callback: restart itself every TEST_PERIOD
+ ************************************************************/
+static void periodic (uint8_t arg) {
+  fired(arg);
+  g_periodic = mytimers.start(TEST_PERIOD, periodic, arg);
+}
+
+/************************************************************
+ * run
+ * Main Loop for some Time: tick() every Millisecond
+ * @param[in] ms Duration
+ ************************************************************/
+static void run (uint32_t ms) {
+  for (; ms; ms--) {
+    fakeAdvance(1);
+    mytimers.tick();
+  }
+}
+
+void setUp (void) {
+  fakeReset();
+  memset(g_fired, 0, sizeof(g_fired));
+  memset(g_count, 0, sizeof(g_count));
+  mytimers.begin();
+}
+
+void tearDown (void) {
+}
+
+void test_never_early (void) {
+  uint32_t t;
+  // started within a Tick: counted from the last Tick
+  run(7);
+  t = millis();
+  mytimers.start(25, fired, 0);
+  run(100);
+  TEST_ASSERT_EQUAL(1, g_count[0]);
+  TEST_ASSERT_TRUE(g_fired[0] - t >= 25);
+  TEST_ASSERT_TRUE(g_fired[0] - t <= 25 + TIMER_TICK);
+}
+
+void test_rounds_above_one_revolution (void) {
+  uint32_t t;
+  uint32_t ms;
+  uint8_t h;
+  // 3 Revolutions + 5 Ticks: same Slot as a Timer of 5 Ticks
+  ms = 3UL * TIMER_SLOTS * TIMER_TICK + 5 * TIMER_TICK;
+  t = millis();
+  h = mytimers.start(ms, fired, 0);
+  mytimers.start(5 * TIMER_TICK, fired, 1);
+  run(ms - 1);
+  TEST_ASSERT_EQUAL(1, g_count[1]);
+  TEST_ASSERT_EQUAL(0, g_count[0]);
+  TEST_ASSERT_TRUE(mytimers.active(h));
+  TEST_ASSERT_LESS_OR_EQUAL(TIMER_TICK, mytimers.remaining(h));
+  run(TIMER_TICK);
+  TEST_ASSERT_EQUAL(1, g_count[0]);
+  TEST_ASSERT_EQUAL_UINT32(ms, g_fired[0] - t);
+}
+
+void test_millis_wrap (void) {
+  uint32_t t;
+  fakeMillis = 0xffffffffUL - 500;
+  mytimers.begin();
+  t = millis();
+  mytimers.start(1000, fired, 0);
+  run(999);
+  TEST_ASSERT_EQUAL(0, g_count[0]);
+  run(TIMER_TICK);
+  TEST_ASSERT_EQUAL(1, g_count[0]);
+  TEST_ASSERT_TRUE(g_fired[0] < t);
+  TEST_ASSERT_EQUAL_UINT32(1000, g_fired[0] - t);
+}
+
+void test_cancel_from_callback (void) {
+  g_handle[0] = mytimers.start(50, cancelOthers, 0);
+  g_handle[1] = mytimers.start(50, fired, 1);
+  g_handle[2] = mytimers.start(500, fired, 2);
+  run(1000);
+  // Timer 0 or 1 runs first in the Slot: one of both Callbacks
+  TEST_ASSERT_EQUAL(1, g_count[0] + g_count[1]);
+  TEST_ASSERT_EQUAL(0, g_count[2]);
+  TEST_ASSERT_EQUAL(0, mytimers.used());
+}
+
+void test_start_from_callback (void) {
+  uint32_t t;
+  t = millis();
+  g_periodic = mytimers.start(TEST_PERIOD, periodic, 3);
+  run(10 * TEST_PERIOD);
+  // no Drift: every TEST_PERIOD
+  TEST_ASSERT_EQUAL(10, g_count[3]);
+  TEST_ASSERT_EQUAL_UINT32(10 * TEST_PERIOD, g_fired[3] - t);
+  TEST_ASSERT_EQUAL(1, mytimers.used());
+  mytimers.cancel(g_periodic);
+  run(10 * TEST_PERIOD);
+  TEST_ASSERT_EQUAL(10, g_count[3]);
+  TEST_ASSERT_EQUAL(0, mytimers.used());
+}
+
+void test_pool_exhaustion (void) {
+  uint8_t i;
+  uint8_t h;
+  for (i = 0; i < TIMER_NUM; i++) {
+    h = mytimers.start(1000 + i, fired, i % TEST_TIMERS);
+    TEST_ASSERT_NOT_EQUAL(TIMER_NONE, h);
+  }
+  TEST_ASSERT_EQUAL(TIMER_NUM, mytimers.used());
+  TEST_ASSERT_EQUAL(TIMER_NONE, mytimers.start(10, fired, 0));
+  mytimers.cancel(h);
+  TEST_ASSERT_EQUAL(h, mytimers.start(10, fired, 0));
+  run(2000);
+  TEST_ASSERT_EQUAL(0, mytimers.used());
+}
+
+void test_max_duration (void) {
+  uint8_t h;
+  h = mytimers.start(0xffffffffUL, fired, 0);
+  TEST_ASSERT_TRUE(mytimers.active(h));
+  TEST_ASSERT_LESS_OR_EQUAL(TIMER_MAX, mytimers.remaining(h));
+  TEST_ASSERT_TRUE(mytimers.remaining(h) > TIMER_MAX - TIMER_TICK);
+}
+
+/************************************************************
+ * Linear Scan: one Deadline per Timer, all compared on
+ * every Tick
+ ************************************************************/
+typedef struct {
+  uint32_t deadline;
+  boolean  active;
+} linearTimer;
+
+static void linearTick (linearTimer* t, uint32_t now) {
+  uint8_t i;
+  for (i = 0; i < TIMER_NUM; i++) {
+    if (t[i].active && ((int32_t)(now - t[i].deadline) >= 0)) {
+      t[i].active = false;
+      g_sink++;
+    }
+  }
+}
+
+void test_bench_against_linear_scan (void) {
+  linearTimer linear[TIMER_NUM];
+  uint32_t i;
+  uint64_t t;
+  uint32_t wheelNs;
+  uint32_t linearNs;
+  char msg[80];
+  // all Timers running, none expires during the Benchmark
+  for (i = 0; i < TIMER_NUM; i++) {
+    mytimers.start(TIMER_MAX - i * TIMER_TICK, fired, 0);
+    linear[i].deadline = millis() + TIMER_MAX - i * TIMER_TICK;
+    linear[i].active = true;
+  }
+  t = fakeHostMicros();
+  for (i = 0; i < TEST_BENCH_TICKS; i++) {
+    fakeAdvance(TIMER_TICK);
+    mytimers.tick();
+  }
+  wheelNs = (uint32_t)((fakeHostMicros() - t) * 1000 / TEST_BENCH_TICKS);
+  t = fakeHostMicros();
+  for (i = 0; i < TEST_BENCH_TICKS; i++) {
+    fakeAdvance(TIMER_TICK);
+    linearTick(linear, millis());
+  }
+  linearNs = (uint32_t)((fakeHostMicros() - t) * 1000 / TEST_BENCH_TICKS);
+  TEST_ASSERT_EQUAL(TIMER_NUM, mytimers.used());
+  TEST_ASSERT_EQUAL(0, g_count[0]);
+  // BENCH,<firmware>,<test>,0,<runs>,<ns per Tick>,<Timers>
+  snprintf(msg, sizeof(msg), "BENCH,native,timerWheel,0,%lu,%u,%u",
+           (unsigned long)TEST_BENCH_TICKS, (unsigned)wheelNs, (unsigned)TIMER_NUM);
+  TEST_MESSAGE(msg);
+  snprintf(msg, sizeof(msg), "BENCH,native,linearScan,0,%lu,%u,%u",
+           (unsigned long)TEST_BENCH_TICKS, (unsigned)linearNs, (unsigned)TIMER_NUM);
+  TEST_MESSAGE(msg);
+}
+
+int main (void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_never_early);
+  RUN_TEST(test_rounds_above_one_revolution);
+  RUN_TEST(test_millis_wrap);
+  RUN_TEST(test_cancel_from_callback);
+  RUN_TEST(test_start_from_callback);
+  RUN_TEST(test_pool_exhaustion);
+  RUN_TEST(test_max_duration);
+  RUN_TEST(test_bench_against_linear_scan);
+  return (UNITY_END());
+}
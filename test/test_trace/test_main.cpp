@@ -0,0 +1,144 @@
+/************************************************************
+ * Unit Tests of the Latency Trace (env:native)
+ ************************************************************
+ * The Stages of a Click are marked in the Order of main.cpp
+ * (IRQ, Scan, Classify, Dispatch, Write) on the simulated
+ * Clock, the Statistics printed by printStats() are checked.
+ ************************************************************/
+#include <unity.h>
+#include <fakeMain.h>
+#include <latencyTrace.h>
+
+latencyTrace mytrace;
+
+/************************************************************
+ * click
+ * One traced Click as processed by main.cpp
+ * @param[in] scan     [us] IRQ -> Inputs read
+ * @param[in] classify [us] Scan -> Click detected
+ * @param[in] dispatch [us] Classify -> Command executed
+ * @param[in] write    [us] Dispatch -> Outputs written, 0: no Write
+ ************************************************************/
+static void click (uint32_t scan, uint32_t classify, uint32_t dispatch, uint32_t write) {
+  mytrace.irq();
+  fakeAdvanceMicros(scan);
+  mytrace.mark(TRACE_SCAN);
+  fakeAdvanceMicros(classify);
+  mytrace.mark(TRACE_CLASSIFY);
+  mytrace.dispatch(true);
+  fakeAdvanceMicros(dispatch);
+  if (write) {
+    mytrace.mark(TRACE_DISPATCH);
+    fakeAdvanceMicros(write);
+    mytrace.written();
+  }
+  mytrace.mark(TRACE_DISPATCH);
+  mytrace.dispatch(false);
+  mytrace.finish();
+  fakeAdvance(100);
+}
+
+/************************************************************
+ * statLine
+ * @param[in] name Stage as printed (e.g. "Total   ")
+ * @returns Line of the Stage printed by printStats()
+ ************************************************************/
+static std::string statLine (const char* name) {
+  size_t pos;
+  Serial.out.clear();
+  mytrace.printStats();
+  pos = Serial.out.find(name);
+  if (pos == std::string::npos) {
+    return ("");
+  }
+  return (Serial.out.substr(pos, Serial.out.find('\r', pos) - pos));
+}
+
+void setUp (void) {
+  fakeReset();
+  fakeAdvance(1000);
+  mytrace.begin();
+}
+
+void tearDown (void) {
+}
+
+void test_stages_of_a_click (void) {
+  click(300, 200, 100, 400);
+  TEST_ASSERT_EQUAL_STRING("Scan     1 300 300 300 300", statLine("Scan").c_str());
+  TEST_ASSERT_EQUAL_STRING("Classify 1 200 200 200 200", statLine("Classify").c_str());
+  TEST_ASSERT_EQUAL_STRING("Dispatch 1 100 100 100 100", statLine("Dispatch").c_str());
+  TEST_ASSERT_EQUAL_STRING("Write    1 400 400 400 400", statLine("Write").c_str());
+  TEST_ASSERT_EQUAL_STRING("Total    1 1000 1000 1000 1000", statLine("Total").c_str());
+}
+
+void test_min_avg_max_p99 (void) {
+  uint8_t i;
+  // 99 fast Clicks and one slow: p99 in the Bucket of the fast ones
+  for (i = 0; i < 99; i++) {
+    click(100, 100, 100, 100);
+  }
+  click(100, 100, 100, 20000);
+  TEST_ASSERT_EQUAL_STRING("Total    100 400 599 20300 1023", statLine("Total").c_str());
+}
+
+void test_noise_is_discarded (void) {
+  // IRQ without Click (Bounce, Release)
+  mytrace.irq();
+  fakeAdvanceMicros(300);
+  mytrace.mark(TRACE_SCAN);
+  mytrace.cancel();
+  TEST_ASSERT_EQUAL_STRING("Total    0", statLine("Total").c_str());
+}
+
+void test_click_without_write (void) {
+  // Command without Output Change: closed after Dispatch
+  click(300, 200, 100, 0);
+  TEST_ASSERT_EQUAL_STRING("Write    0", statLine("Write").c_str());
+  TEST_ASSERT_EQUAL_STRING("Total    1 600 600 600 600", statLine("Total").c_str());
+}
+
+void test_foreign_write_is_ignored (void) {
+  // Write of a Timer while the Click is classified: not part of the Event
+  mytrace.irq();
+  fakeAdvanceMicros(300);
+  mytrace.mark(TRACE_SCAN);
+  fakeAdvanceMicros(200);
+  mytrace.mark(TRACE_CLASSIFY);
+  fakeAdvanceMicros(50);
+  mytrace.written();
+  mytrace.mark(TRACE_DISPATCH);
+  mytrace.dispatch(true);
+  fakeAdvanceMicros(100);
+  mytrace.mark(TRACE_DISPATCH);
+  fakeAdvanceMicros(400);
+  mytrace.written();
+  mytrace.dispatch(false);
+  mytrace.finish();
+  TEST_ASSERT_EQUAL_STRING("Dispatch 1 150 150 150 150", statLine("Dispatch").c_str());
+  TEST_ASSERT_EQUAL_STRING("Total    1 1050 1050 1050 1050", statLine("Total").c_str());
+}
+
+void test_ring_keeps_last_events (void) {
+  uint8_t i;
+  for (i = 0; i < TRACE_RING_SIZE + 2; i++) {
+    click(100 + i, 100, 100, 100);
+  }
+  Serial.out.clear();
+  mytrace.printRing();
+  // oldest two Events overwritten
+  TEST_ASSERT_TRUE(Serial.out.find(": 101 ") == std::string::npos);
+  TEST_ASSERT_TRUE(Serial.out.find(": 102 ") != std::string::npos);
+  TEST_ASSERT_TRUE(Serial.out.find(": 109 ") != std::string::npos);
+}
+
+int main (void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_stages_of_a_click);
+  RUN_TEST(test_min_avg_max_p99);
+  RUN_TEST(test_noise_is_discarded);
+  RUN_TEST(test_click_without_write);
+  RUN_TEST(test_foreign_write_is_ignored);
+  RUN_TEST(test_ring_keeps_last_events);
+  return (UNITY_END());
+}
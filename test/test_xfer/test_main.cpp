@@ -0,0 +1,308 @@
+/************************************************************
+ * Unit Tests of the Configuration Transfer (env:native)
+ ************************************************************
+ * The Tests play the Host (tools/cfgImage.py): Frames are
+ * fed to the Serial Stand-In, the Answers (ACK, NAK, EOT,
+ * CAN) are taken from Serial.out, Debug Text in between is
+ * skipped. The uploaded Image is a Pattern, EE_CONFIG_SIZE
+ * gives 22 full Chunks and a last one of 16 Bytes.
+ ************************************************************/
+#include <unity.h>
+#include <fakeMain.h>
+#include <configXfer.h>
+
+#define TEST_CHUNKS  ((EE_CONFIG_SIZE + XFER_CHUNK - 1) / XFER_CHUNK)
+
+config myconfig;
+configXfer myxfer;
+uint8_t  g_image[EE_CONFIG_SIZE];   //!< Image of the Host
+uint8_t  g_reloads;                 //!< Calls of the Handler
+
+/************************************************************
+ * reload
+ * Transfer Handler: count the Calls
+ ************************************************************/
+static void reload (void) {
+  g_reloads++;
+}
+
+/************************************************************
+ * crc32
+ * CRC-32 of the Host (zlib)
+ * @param[in] crc CRC of the previous Bytes (0 at Start)
+ * @param[in] buf Bytes
+ * @param[in] n Number of Bytes
+ * @returns CRC including buf
+ ************************************************************/
+static uint32_t crc32 (uint32_t crc, const uint8_t* buf, uint16_t n) {
+  uint8_t i;
+  crc = ~crc;
+  while (n--) {
+    crc ^= *buf++;
+    for (i = 0; i < 8; i++) {
+      crc = (crc & 1) ? ((crc >> 1) ^ 0xEDB88320UL) : (crc >> 1);
+    }
+  }
+  return (~crc);
+}
+
+/************************************************************
+ * answers
+ * @returns Control Bytes sent by the Controller since the
+ *          last Call (without Debug Text)
+ ************************************************************/
+static std::string answers (void) {
+  std::string a;
+  size_t i;
+  for (i = 0; i < Serial.out.size(); i++) {
+    switch ((uint8_t)Serial.out[i]) {
+      case XFER_EOT:
+      case XFER_ACK:
+      case XFER_NAK:
+      case XFER_CAN:
+        a += Serial.out[i];
+        break;
+    }
+  }
+  Serial.out.clear();
+  return (a);
+}
+
+/************************************************************
+ * sendFrame
+ * Send a Frame to the Controller and let it poll
+ * @param[in] seq     Sequence Number
+ * @param[in] data    Data
+ * @param[in] len     Length of Data
+ * @param[in] corrupt flip a Bit of the CRC
+ ************************************************************/
+static void sendFrame (uint8_t seq, const uint8_t* data, uint8_t len, boolean corrupt) {
+  uint8_t frame[XFER_CHUNK + 7];
+  uint32_t crc;
+  uint8_t i;
+  frame[0] = XFER_STX;
+  frame[1] = seq;
+  frame[2] = len;
+  memcpy(&frame[3], data, len);
+  crc = crc32(0, &frame[1], len + 2);
+  if (corrupt) {
+    crc ^= 0x100;
+  }
+  for (i = 0; i < 4; i++) {
+    frame[len + 3 + i] = (uint8_t)(crc >> (8 * i));
+  }
+  fakeSerialIn(frame, len + 7);
+  fakeAdvance(10);
+  myxfer.poll();
+}
+
+/************************************************************
+ * sendHeader
+ * Send Frame 0: Size and CRC-32 of g_image
+ ************************************************************/
+static void sendHeader (void) {
+  uint8_t header[6];
+  uint32_t crc;
+  uint8_t i;
+  crc = crc32(0, g_image, EE_CONFIG_SIZE);
+  header[0] = EE_CONFIG_SIZE & 0xff;
+  header[1] = EE_CONFIG_SIZE >> 8;
+  for (i = 0; i < 4; i++) {
+    header[2 + i] = (uint8_t)(crc >> (8 * i));
+  }
+  sendFrame(0, header, sizeof(header), false);
+}
+
+/************************************************************
+ * sendChunk
+ * Send a Chunk of g_image
+ * @param[in] seq 1 ... TEST_CHUNKS
+ ************************************************************/
+static void sendChunk (uint8_t seq) {
+  uint16_t offset = (uint16_t)(seq - 1) * XFER_CHUNK;
+  sendFrame(seq, &g_image[offset], min(XFER_CHUNK, EE_CONFIG_SIZE - offset), false);
+}
+
+/************************************************************
+ * eepromEqual
+ * @returns true if the Image in EEPROM is g_image
+ ************************************************************/
+static boolean eepromEqual (void) {
+  return (memcmp(fakeEeprom, g_image, EE_CONFIG_SIZE) == 0);
+}
+
+void setUp (void) {
+  uint16_t i;
+  fakeReset();
+  myconfig.resetToFactoryDefaults();
+  myconfig.begin();
+  myxfer.begin(myconfig, reload);
+  for (i = 0; i < EE_CONFIG_SIZE; i++) {
+    g_image[i] = (uint8_t)(i * 7 + 3);
+  }
+  g_reloads = 0;
+  Serial.out.clear();
+}
+
+void tearDown (void) {
+}
+
+void test_upload (void) {
+  uint8_t seq;
+  myxfer.startUpload();
+  TEST_ASSERT_EQUAL_STRING("\x06", answers().c_str());
+  sendHeader();
+  TEST_ASSERT_EQUAL_STRING("\x06", answers().c_str());
+  for (seq = 1; seq < TEST_CHUNKS; seq++) {
+    sendChunk(seq);
+    TEST_ASSERT_EQUAL_STRING("\x06", answers().c_str());
+  }
+  sendChunk(TEST_CHUNKS);
+  TEST_ASSERT_EQUAL_STRING("\x06\x04", answers().c_str());
+  TEST_ASSERT_FALSE(myxfer.active());
+  TEST_ASSERT_TRUE(eepromEqual());
+  TEST_ASSERT_TRUE(myconfig.getImageValidFromEEprom());
+  TEST_ASSERT_EQUAL(1, g_reloads);
+}
+
+void test_ack_lost_resend (void) {
+  uint8_t seq;
+  std::string a;
+  myxfer.startUpload();
+  sendHeader();
+  // ACK of the Header lost
+  sendHeader();
+  TEST_ASSERT_EQUAL_STRING("\x06\x06\x06", answers().c_str());
+  sendChunk(1);
+  sendChunk(1);
+  TEST_ASSERT_EQUAL_STRING("\x06\x06", answers().c_str());
+  // the Repetition did not advance: Chunk 3 is not expected
+  sendChunk(3);
+  TEST_ASSERT_EQUAL_STRING("\x15", answers().c_str());
+  for (seq = 2; seq <= TEST_CHUNKS; seq++) {
+    sendChunk(seq);
+  }
+  a = answers();
+  // an ACK for each Chunk, EOT after the last one
+  TEST_ASSERT_EQUAL(TEST_CHUNKS, a.size());
+  TEST_ASSERT_EQUAL_STRING("\x06\x04", a.c_str() + a.size() - 2);
+  TEST_ASSERT_FALSE(myxfer.active());
+  TEST_ASSERT_TRUE(eepromEqual());
+  TEST_ASSERT_TRUE(myconfig.getImageValidFromEEprom());
+}
+
+void test_bad_crc (void) {
+  myxfer.startUpload();
+  sendHeader();
+  sendFrame(1, g_image, XFER_CHUNK, true);
+  TEST_ASSERT_EQUAL_STRING("\x06\x06\x15", answers().c_str());
+  TEST_ASSERT_TRUE(myxfer.active());
+  // nothing written before a valid Chunk
+  TEST_ASSERT_TRUE(myconfig.getImageValidFromEEprom());
+  TEST_ASSERT_NOT_EQUAL(g_image[0], fakeEeprom[0]);
+  sendChunk(1);
+  TEST_ASSERT_EQUAL_STRING("\x06", answers().c_str());
+  TEST_ASSERT_EQUAL_MEMORY(g_image, fakeEeprom, XFER_CHUNK);
+}
+
+void test_short_chunk (void) {
+  myxfer.startUpload();
+  sendHeader();
+  sendChunk(1);
+  // not the last Chunk: must be full
+  sendFrame(2, &g_image[XFER_CHUNK], XFER_CHUNK / 2, false);
+  TEST_ASSERT_EQUAL_STRING("\x06\x06\x06\x18", answers().c_str());
+  TEST_ASSERT_FALSE(myxfer.active());
+  // partly written Image stays invalid, also after a Restart
+  TEST_ASSERT_FALSE(myconfig.getImageValidFromEEprom());
+  TEST_ASSERT_EQUAL(1, g_reloads);
+  myconfig.begin();
+  TEST_ASSERT_FALSE(myconfig.getImageValidFromEEprom());
+}
+
+void test_timeout_then_upload (void) {
+  uint8_t seq;
+  myxfer.startUpload();
+  sendHeader();
+  sendChunk(1);
+  sendChunk(2);
+  answers();
+  fakeAdvance(XFER_TIMEOUT + 1);
+  myxfer.poll();
+  TEST_ASSERT_EQUAL_STRING("\x18", answers().c_str());
+  TEST_ASSERT_FALSE(myxfer.active());
+  TEST_ASSERT_FALSE(myconfig.getImageValidFromEEprom());
+  // a complete Upload makes it valid again
+  myxfer.startUpload();
+  sendHeader();
+  for (seq = 1; seq <= TEST_CHUNKS; seq++) {
+    sendChunk(seq);
+  }
+  TEST_ASSERT_TRUE(eepromEqual());
+  TEST_ASSERT_TRUE(myconfig.getImageValidFromEEprom());
+  TEST_ASSERT_EQUAL(2, g_reloads);
+}
+
+void test_download (void) {
+  uint8_t image[EE_CONFIG_SIZE];
+  const uint8_t* f;
+  uint8_t ack = XFER_ACK;
+  uint8_t nak = XFER_NAK;
+  uint16_t offset = 0;
+  uint32_t crc;
+  uint32_t headerCrc = 0;
+  uint8_t seq;
+  uint8_t len;
+  uint8_t i;
+  memcpy(fakeEeprom, g_image, EE_CONFIG_SIZE);
+  myxfer.startDownload();
+  for (seq = 0; seq <= TEST_CHUNKS; seq++) {
+    f = (const uint8_t*)Serial.out.data();
+    TEST_ASSERT_EQUAL(XFER_STX, f[0]);
+    TEST_ASSERT_EQUAL(seq, f[1]);
+    len = f[2];
+    TEST_ASSERT_EQUAL(len + 7, Serial.out.size());
+    crc = 0;
+    for (i = 0; i < 4; i++) {
+      crc |= (uint32_t)f[len + 3 + i] << (8 * i);
+    }
+    TEST_ASSERT_EQUAL_HEX32(crc32(0, &f[1], len + 2), crc);
+    if (seq == 0) {
+      TEST_ASSERT_EQUAL(6, len);
+      TEST_ASSERT_EQUAL(EE_CONFIG_SIZE, f[3] + (f[4] << 8));
+      for (i = 0; i < 4; i++) {
+        headerCrc |= (uint32_t)f[5 + i] << (8 * i);
+      }
+    } else {
+      memcpy(&image[offset], &f[3], len);
+      offset += len;
+    }
+    if (seq == 1) {
+      // NAK: the same Frame again
+      Serial.out.clear();
+      fakeSerialIn(&nak, 1);
+      myxfer.poll();
+      TEST_ASSERT_EQUAL(1, ((const uint8_t*)Serial.out.data())[1]);
+    }
+    Serial.out.clear();
+    fakeSerialIn(&ack, 1);
+    myxfer.poll();
+  }
+  TEST_ASSERT_EQUAL_STRING("\x04", answers().c_str());
+  TEST_ASSERT_FALSE(myxfer.active());
+  TEST_ASSERT_EQUAL(EE_CONFIG_SIZE, offset);
+  TEST_ASSERT_EQUAL_MEMORY(g_image, image, EE_CONFIG_SIZE);
+  TEST_ASSERT_EQUAL_HEX32(crc32(0, g_image, EE_CONFIG_SIZE), headerCrc);
+  TEST_ASSERT_EQUAL(0, g_reloads);
+}
+
+int main (void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_upload);
+  RUN_TEST(test_ack_lost_resend);
+  RUN_TEST(test_bad_crc);
+  RUN_TEST(test_short_chunk);
+  RUN_TEST(test_timeout_then_upload);
+  RUN_TEST(test_download);
+  return (UNITY_END());
+}
@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+"""Backup and restore the configuration of a controller over serial.
+
+Transfers the binary configuration image (EEPROM 0 ... EE_CONFIG_SIZE)
+with the frame protocol of src/configXfer.h:
+
+    STX Seq Len Data[Len] CRC-32[4]
+
+Usage:
+    cfgImage.py PORT get FILE    download the image into FILE
+    cfgImage.py PORT put FILE    upload FILE, verified by the controller
+
+Needs pyserial (pip install pyserial).
+"""
+import struct
+import sys
+import time
+import zlib
+
+import serial
+
+STX = 0x02
+EOT = 0x04
+ACK = 0x06
+NAK = 0x15
+CAN = 0x18
+CHUNK = 32
+TIMEOUT = 5.0
+RETRIES = 5
+
+
+class XferError(Exception):
+    pass
+
+
+def read_byte(port, deadline):
+    """Next byte from the port, None after the deadline."""
+    while time.time() < deadline:
+        b = port.read(1)
+        if b:
+            return b[0]
+    return None
+
+
+def wait_control(port):
+    """Skip debug text, return the next control byte."""
+    deadline = time.time() + TIMEOUT
+    while True:
+        b = read_byte(port, deadline)
+        if b is None:
+            raise XferError("timeout")
+        if b in (EOT, ACK, NAK, CAN):
+            return b
+
+
+def read_frame(port):
+    """Skip debug text, return (seq, data) of the next valid frame or None."""
+    deadline = time.time() + TIMEOUT
+    while True:
+        b = read_byte(port, deadline)
+        if b is None:
+            raise XferError("timeout")
+        if b == CAN:
+            raise XferError("aborted by controller")
+        if b == STX:
+            break
+    head = port.read(2)
+    if len(head) < 2 or head[1] > CHUNK:
+        return None
+    rest = port.read(head[1] + 4)
+    if len(rest) < head[1] + 4:
+        return None
+    data = rest[:-4]
+    (crc,) = struct.unpack("<I", rest[-4:])
+    if crc != zlib.crc32(head + data):
+        return None
+    return head[0], data
+
+
+def send_frame(port, seq, data):
+    body = bytes([seq, len(data)]) + data
+    port.write(bytes([STX]) + body + struct.pack("<I", zlib.crc32(body)))
+    for _ in range(RETRIES):
+        answer = wait_control(port)
+        if answer == ACK:
+            return
+        if answer == CAN:
+            raise XferError("aborted by controller")
+        port.write(bytes([STX]) + body + struct.pack("<I", zlib.crc32(body)))
+    raise XferError("frame %d not accepted" % seq)
+
+
+def command(port, line):
+    port.reset_input_buffer()
+    port.write(line.encode() + b"\n")
+
+
+def download(port):
+    command(port, "cfgget")
+    image = bytearray()
+    size = None
+    crc = None
+    seq = 0
+    errors = 0
+    while size is None or len(image) < size:
+        frame = read_frame(port)
+        if frame is None or frame[0] not in (seq, seq - 1):
+            errors += 1
+            if errors > RETRIES:
+                port.write(bytes([CAN]))
+                raise XferError("too many errors")
+            port.write(bytes([NAK]))
+            continue
+        if frame[0] == seq:
+            if seq == 0:
+                size, crc = struct.unpack("<HI", frame[1])
+            else:
+                image += frame[1]
+            seq += 1
+        port.write(bytes([ACK]))
+    if wait_control(port) != EOT:
+        raise XferError("no end of transfer")
+    if zlib.crc32(bytes(image)) != crc:
+        raise XferError("CRC mismatch")
+    return bytes(image)
+
+
+def upload(port, image):
+    command(port, "cfgput")
+    if wait_control(port) != ACK:
+        raise XferError("controller not ready")
+    send_frame(port, 0, struct.pack("<HI", len(image), zlib.crc32(image)))
+    for seq, offset in enumerate(range(0, len(image), CHUNK), start=1):
+        send_frame(port, seq & 0xFF, image[offset:offset + CHUNK])
+    if wait_control(port) != EOT:
+        raise XferError("verification failed")
+
+
+def main(argv):
+    if len(argv) != 4 or argv[2] not in ("get", "put"):
+        print(__doc__)
+        return 2
+    port = serial.Serial(argv[1], 115200, timeout=0.2)
+    # opening the port resets the Nano
+    time.sleep(2.0)
+    try:
+        if argv[2] == "get":
+            image = download(port)
+            with open(argv[3], "wb") as f:
+                f.write(image)
+            print("%d Bytes, CRC-32 %08x" % (len(image), zlib.crc32(image)))
+        else:
+            with open(argv[3], "rb") as f:
+                image = f.read()
+            upload(port, image)
+            print("%d Bytes written and verified" % len(image))
+    except XferError as e:
+        print("ERROR: %s" % e)
+        return 1
+    finally:
+        port.close()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
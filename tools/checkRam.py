@@ -0,0 +1,35 @@
+"""PlatformIO extra script: fail the build on too much static RAM.
+
+The ATmega328P has 2048 bytes of SRAM, shared by .data, .bss and the
+stack. After linking, the output of avr-size is printed and the build
+fails if .data + .bss exceed custom_ram_limit of platformio.ini (the
+rest is left to the stack).
+
+    extra_scripts = post:tools/checkRam.py
+    custom_ram_limit = 1792
+"""
+import subprocess
+
+Import("env")  # noqa: F821 (SCons)
+
+
+def check_ram(source, target, env):
+    """Print avr-size of the firmware, fail above the limit."""
+    elf = str(target[0])
+    limit = int(env.GetProjectOption("custom_ram_limit"))
+    out = subprocess.check_output([env.subst("$SIZETOOL"), "-A", elf],
+                                  universal_newlines=True)
+    print(out)
+    used = 0
+    for line in out.splitlines():
+        fields = line.split()
+        if len(fields) >= 2 and fields[0] in (".data", ".bss", ".noinit"):
+            used += int(fields[1])
+    print("Static RAM: %d of %d bytes (stack: %d bytes left)"
+          % (used, limit, 2048 - used))
+    if used > limit:
+        print("Error: static RAM above custom_ram_limit")
+        env.Exit(1)
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", check_ram)  # noqa: F821